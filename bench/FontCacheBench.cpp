@@ -7,14 +7,25 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTypeface.h"
 #include "include/private/base/SkTemplates.h"
+#include "src/base/SkArenaAlloc.h"
 #include "src/core/SkChecksum.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <memory>
+#include <vector>
+
 #include "bench/gUniqueGlyphIDs.h"
 
 #define gUniqueGlyphIDs_Sentinel    0xFFFF
@@ -198,3 +209,71 @@ private:
 };
 DEF_BENCH( return new FontPathBench(true); )
 DEF_BENCH( return new FontPathBench(false); )
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Generates glyph images on several threads at once, bypassing the strike cache so that every
+// glyph goes through the typeface's scaler context. With `sharedTypeface` all threads contend for
+// one typeface; otherwise each thread has its own typeface made from the same font file.
+class FontGlyphGenerationBench : public Benchmark {
+    const int fThreads;
+    const bool fSharedTypeface;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::vector<sk_sp<SkTypeface>> fTypefaces;
+
+public:
+    FontGlyphGenerationBench(int threads, bool sharedTypeface)
+            : fThreads(threads), fSharedTypeface(sharedTypeface) {
+        fName.printf("font-glyphgen-mt%d-%s", threads, sharedTypeface ? "shared" : "pertypeface");
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        for (int i = 0; i < fThreads; ++i) {
+            sk_sp<SkTypeface> typeface = fSharedTypeface && i > 0
+                    ? fTypefaces[0]
+                    : ToolUtils::CreateTypefaceFromResource("fonts/Roboto-Regular.ttf");
+            if (!typeface) {
+                typeface = ToolUtils::DefaultTypeface();
+            }
+            fTypefaces.push_back(std::move(typeface));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        const SkPaint paint;
+        const SkSurfaceProps props(0, kUnknown_SkPixelGeometry);
+        for (int loop = 0; loop < loops; ++loop) {
+            SkTaskGroup(*fExecutor).batch(fThreads, [&](int threadIndex) {
+                SkFont font(fTypefaces[threadIndex], 12 + (loop + threadIndex) % 8);
+                font.setEdging(SkFont::Edging::kAntiAlias);
+                auto strikeSpec = SkStrikeSpec::MakeMask(
+                        font, paint, props, SkScalerContextFlags::kNone, SkMatrix::I());
+                std::unique_ptr<SkScalerContext> context = strikeSpec.createScalerContext();
+
+                SkSTArenaAlloc<4096> alloc;
+                for (SkUnichar c = ' '; c < 'z'; ++c) {
+                    SkGlyph glyph = context->makeGlyph(SkPackedGlyphID{font.unicharToGlyph(c)},
+                                                       &alloc);
+                    glyph.setImage(&alloc, context.get());
+                }
+            });
+        }
+    }
+
+private:
+    using INHERITED = Benchmark;
+};
+DEF_BENCH( return new FontGlyphGenerationBench(1, true); )
+DEF_BENCH( return new FontGlyphGenerationBench(8, true); )
+DEF_BENCH( return new FontGlyphGenerationBench(8, false); )
@@ -11,6 +11,8 @@
 #include "include/core/SkPaint.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/effects/SkGradientShader.h"
 
 #include "tools/ToolUtils.h"
@@ -38,6 +40,12 @@ static const SkColor gColors[] = {
 static const SkColor gShallowColors[] = { 0xFF555555, 0xFF444444 };
 static const SkScalar gPos[] = {0.25f, 0.75f};
 
+// Unevenly spaced stops for 16 of gColors, which the raster backend has to search per pixel.
+static const SkScalar gHiPos[] = {
+    0.00f, 0.02f, 0.05f, 0.11f, 0.17f, 0.20f, 0.31f, 0.40f,
+    0.44f, 0.52f, 0.61f, 0.67f, 0.75f, 0.83f, 0.94f, 1.00f,
+};
+
 // We have several special-cases depending on the number (and spacing) of colors, so
 // try to exercise those here.
 static const GradData gGradData[] = {
@@ -46,6 +54,7 @@ static const GradData gGradData[] = {
     { 3, gColors, nullptr, "_3color" },
     { 2, gShallowColors, nullptr, "_shallow" },
     { 2, gColors, gPos, "_pos" },
+    { 16, gColors, gHiPos, "_hicolor_pos" },
 };
 
 /// Ignores scale
@@ -256,6 +265,38 @@ private:
     const GeomType fGeomType;
 };
 
+// Evaluates the gradient on the raster backend through a cached LUT (SkSurfaceProps's
+// kGradientLUT_Flag) instead of per-pixel stop evaluation, for comparison with the matching
+// GradientBench.
+class GradientLUTBench : public GradientBench {
+public:
+    GradientLUTBench(GradType gradType, GradData data) : GradientBench(gradType, data) {
+        fLUTName.printf("%s_lut", this->GradientBench::onGetName());
+    }
+
+protected:
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kRaster; }
+
+    const char* onGetName() override { return fLUTName.c_str(); }
+
+    void onPerCanvasPreDraw(SkCanvas* canvas) override {
+        const SkSurfaceProps props(SkSurfaceProps::kGradientLUT_Flag, kUnknown_SkPixelGeometry);
+        fSurface = canvas->makeSurface(canvas->imageInfo(), &props);
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        this->GradientBench::onDraw(loops, fSurface ? fSurface->getCanvas() : canvas);
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        fSurface = nullptr;
+    }
+
+private:
+    SkString         fLUTName;
+    sk_sp<SkSurface> fSurface;
+};
+
 DEF_BENCH( return new GradientBench(kLinear_GradType, gGradData[0]); )
 DEF_BENCH( return new GradientBench(kLinear_GradType, gGradData[1]); )
 DEF_BENCH( return new GradientBench(kLinear_GradType, gGradData[2]); )
@@ -296,6 +337,19 @@ DEF_BENCH( return new GradientBench(kConicalOutZero_GradType); )
 DEF_BENCH( return new GradientBench(kConicalOutZero_GradType, gGradData[1]); )
 DEF_BENCH( return new GradientBench(kConicalOutZero_GradType, gGradData[2]); )
 
+DEF_BENCH( return new GradientBench(kLinear_GradType, gGradData[5]); )
+DEF_BENCH( return new GradientBench(kRadial_GradType, gGradData[5]); )
+DEF_BENCH( return new GradientBench(kSweep_GradType, gGradData[5]); )
+DEF_BENCH( return new GradientBench(kConical_GradType, gGradData[5]); )
+DEF_BENCH( return new GradientLUTBench(kLinear_GradType, gGradData[1]); )
+DEF_BENCH( return new GradientLUTBench(kLinear_GradType, gGradData[5]); )
+DEF_BENCH( return new GradientLUTBench(kRadial_GradType, gGradData[1]); )
+DEF_BENCH( return new GradientLUTBench(kRadial_GradType, gGradData[5]); )
+DEF_BENCH( return new GradientLUTBench(kSweep_GradType, gGradData[1]); )
+DEF_BENCH( return new GradientLUTBench(kSweep_GradType, gGradData[5]); )
+DEF_BENCH( return new GradientLUTBench(kConical_GradType, gGradData[1]); )
+DEF_BENCH( return new GradientLUTBench(kConical_GradType, gGradData[5]); )
+
 // Dithering
 DEF_BENCH( return new GradientBench(kLinear_GradType, gGradData[3], true); )
 DEF_BENCH( return new GradientBench(kLinear_GradType, gGradData[3], false); )
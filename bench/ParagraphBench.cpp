@@ -8,6 +8,7 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkString.h"
@@ -97,4 +98,84 @@ private:
 
 DEF_BENCH( return new ParagraphBench; )
 
+// Lays out a batch of independent paragraphs with Paragraph::LayoutAll, on a pool of the given
+// number of threads (0 lays them out on the calling thread), to show how layout scales.
+class ParagraphLayoutAllBench final : public Benchmark {
+    static constexpr int kParagraphCount = 256;
+    static constexpr SkScalar kWidth = 300;
+
+    SkString fName;
+    int fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<skia::textlayout::FontCollection> fFontCollection;
+    std::vector<std::unique_ptr<skia::textlayout::Paragraph>> fParagraphs;
+    std::vector<skia::textlayout::Paragraph*> fParagraphPtrs;
+    std::vector<SkScalar> fWidths;
+
+public:
+    explicit ParagraphLayoutAllBench(int threads) : fThreads(threads) {
+        fName.printf("skparagraph_layoutall_%dthreads", threads);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering && !fParagraphs.empty();
+    }
+
+    void onDelayedSetup() override {
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+        fFontCollection = sk_make_sp<skia::textlayout::FontCollection>();
+        fFontCollection->setDefaultFontManager(ToolUtils::TestFontMgr());
+
+        skia::textlayout::TextStyle style;
+        style.setFontFamilies({SkString("Roboto")});
+        style.setColor(SK_ColorBLACK);
+        skia::textlayout::ParagraphStyle paragraphStyle;
+
+        for (int i = 0; i < kParagraphCount; ++i) {
+            auto builder = skia::textlayout::ParagraphBuilder::make(paragraphStyle,
+                                                                    fFontCollection);
+            if (!builder) {
+                fParagraphs.clear();
+                return;
+            }
+            SkString text;
+            text.printf("Paragraph %d. Lorem ipsum dolor sit amet, consectetur adipiscing elit, "
+                        "sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. "
+                        "Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris "
+                        "nisi ut aliquip ex ea commodo consequat.", i);
+            builder->pushStyle(style);
+            builder->addText(text.c_str());
+            builder->pop();
+            fParagraphs.push_back(builder->Build());
+            fParagraphPtrs.push_back(fParagraphs.back().get());
+            fWidths.push_back(kWidth);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            for (auto paragraph : fParagraphPtrs) {
+                paragraph->markDirty();
+            }
+            skia::textlayout::Paragraph::LayoutAll(fParagraphPtrs, fWidths, fExecutor.get());
+        }
+    }
+
+private:
+    using INHERITED = Benchmark;
+};
+
+DEF_BENCH( return new ParagraphLayoutAllBench(0); )
+DEF_BENCH( return new ParagraphLayoutAllBench(1); )
+DEF_BENCH( return new ParagraphLayoutAllBench(2); )
+DEF_BENCH( return new ParagraphLayoutAllBench(4); )
+DEF_BENCH( return new ParagraphLayoutAllBench(8); )
+
 #endif // SK_ENABLE_PARAGRAPH
@@ -7,23 +7,47 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkShader.h"
+#include "include/core/SkString.h"
 #include "include/effects/SkPerlinNoiseShader.h"
+#include "src/shaders/SkPerlinNoiseShaderImpl.h"
+#include "src/shaders/SkShaderBase.h"
 
 class PerlinNoiseBench : public Benchmark {
     SkISize fSize;
 
 public:
-    PerlinNoiseBench()  {
+    enum class Mode {
+        kShared,     // one shader for all draws
+        kPerDraw,    // a new, identical shader for every draw, as SVG and Skottie do per frame
+        kBakedTile,  // the stitched tile baked once and repeated as an image
+    };
+
+    PerlinNoiseBench(int numOctaves = 3, bool stitchTiles = false, Mode mode = Mode::kShared)
+            : fNumOctaves(numOctaves)
+            , fStitchTiles(stitchTiles)
+            , fMode(mode) {
         fSize = SkISize::Make(80, 80);
+        fName = "perlinnoise";
+        if (numOctaves != 3) {
+            fName.appendf("_octaves_%d", numOctaves);
+        }
+        if (stitchTiles) {
+            fName.append("_stitched");
+        }
+        switch (mode) {
+            case Mode::kShared:                                 break;
+            case Mode::kPerDraw:   fName.append("_per_draw");   break;
+            case Mode::kBakedTile: fName.append("_baked_tile"); break;
+        }
     }
 
 protected:
     const char* onGetName() override {
-        return "perlinnoise";
+        return fName.c_str();
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
-        this->test(loops, canvas, 0, 0, 0.1f, 0.1f, 3, 0, false);
+        this->test(loops, canvas, 0, 0, 0.1f, 0.1f, fNumOctaves, 0, fStitchTiles);
     }
 
 private:
@@ -38,20 +62,47 @@ private:
         canvas->restore();
     }
 
+    sk_sp<SkShader> makeShader(float baseFrequencyX, float baseFrequencyY, int numOctaves,
+                               float seed, bool stitchTiles) {
+        sk_sp<SkShader> shader = SkShaders::MakeFractalNoise(
+                baseFrequencyX, baseFrequencyY, numOctaves, seed, stitchTiles ? &fSize : nullptr);
+        if (fMode == Mode::kBakedTile &&
+            as_SB(shader)->type() == SkShaderBase::ShaderType::kPerlinNoise) {
+            auto* noise = static_cast<SkPerlinNoiseShader*>(shader.get());
+            if (sk_sp<SkShader> baked = noise->makeBakedTileShader()) {
+                return baked;
+            }
+        }
+        return shader;
+    }
+
     void test(int loops, SkCanvas* canvas, int x, int y,
               float baseFrequencyX, float baseFrequencyY, int numOctaves, float seed,
               bool stitchTiles) {
         SkPaint paint;
-        paint.setShader(SkShaders::MakeFractalNoise(
-                baseFrequencyX, baseFrequencyY, numOctaves, seed, stitchTiles ? &fSize : nullptr));
+        paint.setShader(this->makeShader(
+                baseFrequencyX, baseFrequencyY, numOctaves, seed, stitchTiles));
         for (int i = 0; i < loops; i++) {
+            if (fMode == Mode::kPerDraw) {
+                paint.setShader(this->makeShader(
+                        baseFrequencyX, baseFrequencyY, numOctaves, seed, stitchTiles));
+            }
             this->drawClippedRect(canvas, x, y, paint);
         }
     }
 
+    SkString   fName;
+    const int  fNumOctaves;
+    const bool fStitchTiles;
+    const Mode fMode;
+
     using INHERITED = Benchmark;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new PerlinNoiseBench(); )
+DEF_BENCH( return new PerlinNoiseBench(3, false, PerlinNoiseBench::Mode::kPerDraw); )
+DEF_BENCH( return new PerlinNoiseBench(24); )
+DEF_BENCH( return new PerlinNoiseBench(3, true); )
+DEF_BENCH( return new PerlinNoiseBench(3, true, PerlinNoiseBench::Mode::kBakedTile); )
@@ -29,7 +29,8 @@ enum BBH  { kNone, kRTree };
 enum Mode { kTiled, kRandom };
 class TiledPlaybackBench : public Benchmark {
 public:
-    TiledPlaybackBench(BBH bbh, Mode mode) : fBBH(bbh), fMode(mode), fName("tiled_playback") {
+    TiledPlaybackBench(BBH bbh, Mode mode, bool extendedOpts = false)
+            : fBBH(bbh), fMode(mode), fExtendedOpts(extendedOpts), fName("tiled_playback") {
         switch (fBBH) {
             case kNone:     fName.append("_none"    ); break;
             case kRTree:    fName.append("_rtree"   ); break;
@@ -38,6 +39,9 @@ public:
             case kTiled:  fName.append("_tiled" ); break;
             case kRandom: fName.append("_random"); break;
         }
+        if (fExtendedOpts) {
+            fName.append("_extopts");
+        }
     }
 
     const char* onGetName() override { return fName.c_str(); }
@@ -51,6 +55,8 @@ public:
         }
 
         SkPictureRecorder recorder;
+        // Most of the opaque rects are hidden by later ones, which the extended opts drop.
+        recorder.setExtendedOptimizations(fExtendedOpts);
         SkCanvas* canvas = recorder.beginRecording(1024, 1024, factory.get());
             SkRandom rand;
             for (int i = 0; i < 10000; i++) {
@@ -90,6 +96,7 @@ public:
 private:
     BBH                 fBBH;
     Mode                fMode;
+    bool                fExtendedOpts;
     SkString            fName;
     sk_sp<SkPicture>    fPic;
 };
@@ -98,3 +105,5 @@ DEF_BENCH( return new TiledPlaybackBench(kNone,     kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kNone,     kTiled ); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kTiled ); )
+DEF_BENCH( return new TiledPlaybackBench(kRTree,    kRandom, /*extendedOpts=*/true); )
+DEF_BENCH( return new TiledPlaybackBench(kRTree,    kTiled,  /*extendedOpts=*/true); )
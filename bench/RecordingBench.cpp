@@ -34,14 +34,19 @@ SkISize PictureCentricBench::onGetSize() {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH)
+RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH,
+                               bool extendedOpts, bool presize)
     : INHERITED(name, pic)
     , fUseBBH(useBBH)
+    , fExtendedOpts(extendedOpts)
+    , fPresize(presize)
 {}
 
 void RecordingBench::onDraw(int loops, SkCanvas*) {
     SkRTreeFactory factory;
     SkPictureRecorder recorder;
+    recorder.setExtendedOptimizations(fExtendedOpts);
+    recorder.setPresizeFromPreviousRecording(fPresize);
     while (loops --> 0) {
         fSrc->playback(recorder.beginRecording(fSrc->cullRect(), fUseBBH ? &factory : nullptr));
         (void)recorder.finishRecordingAsPicture();
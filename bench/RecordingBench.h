@@ -29,13 +29,16 @@ protected:
 
 class RecordingBench : public PictureCentricBench {
 public:
-    RecordingBench(const char* name, const SkPicture*, bool useBBH);
+    RecordingBench(const char* name, const SkPicture*, bool useBBH, bool extendedOpts = false,
+                   bool presize = false);
 
 protected:
     void onDraw(int loops, SkCanvas*) override;
 
 private:
     bool fUseBBH;
+    bool fExtendedOpts;
+    bool fPresize;
 
     using INHERITED = PictureCentricBench;
 };
@@ -6,6 +6,9 @@
 #if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
 
 #include "modules/skshaper/include/SkShaper.h"
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+#include "modules/skshaper/include/SkShaper_harfbuzz.h"
+#endif
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
@@ -13,17 +16,23 @@
 
 namespace {
 struct ShaperBench : public Benchmark {
-    ShaperBench(const char* r, const char* n) : fResource(r), fName(n) {}
+    ShaperBench(const char* r, const char* n, int wordCacheLimit = 0)
+        : fResource(r), fName(n), fWordCacheLimit(wordCacheLimit) {}
     std::unique_ptr<SkShaper> fShaper;
     sk_sp<SkData> fData;
     const char* fResource;
     const char* fName;
+    int fWordCacheLimit;
     const char* onGetName() override { return fName; }
     bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
     void onDelayedSetup() override {
         fShaper = SkShaper::Make();
         fData = GetResourceAsData(fResource);
     }
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+    void onPreDraw(SkCanvas*) override { SkShapers::HB::SetWordCacheLimit(fWordCacheLimit); }
+    void onPostDraw(SkCanvas*) override { SkShapers::HB::SetWordCacheLimit(0); }
+#endif
     void onDraw(int loops, SkCanvas*) override {
         if (!fData || !fShaper) { return; }
         SkFont font = ToolUtils::DefaultFont();
@@ -75,4 +84,14 @@ SHAPER_BENCH(tifnagh)
 SHAPER_BENCH(vai)
 #undef SHAPER_BENCH
 
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+#define SHAPER_WORDCACHE_BENCH(X) \
+    DEF_BENCH(return new ShaperBench("text/" #X ".txt", "shaper_wordcache_" #X, 4096);)
+SHAPER_WORDCACHE_BENCH(cyrillic)
+SHAPER_WORDCACHE_BENCH(english)
+SHAPER_WORDCACHE_BENCH(greek)
+SHAPER_WORDCACHE_BENCH(han_simplified)
+#undef SHAPER_WORDCACHE_BENCH
+#endif
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
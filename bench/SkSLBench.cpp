@@ -7,12 +7,20 @@
 #include "bench/Benchmark.h"
 #include "bench/ResultsWriter.h"
 #include "bench/SkSLBench.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPaint.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/effects/SkRuntimeEffect.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkRasterPipeline.h"
+#include "src/core/SkRuntimeEffectPriv.h"
 #include "src/gpu/ganesh/GrCaps.h"
 #include "src/gpu/ganesh/GrRecordingContextPriv.h"
 #include "src/gpu/ganesh/mock/GrMockCaps.h"
+#include "src/sksl/SkSLBatchCompiler.h"
 #include "src/sksl/SkSLCompiler.h"
 #include "src/sksl/SkSLModuleLoader.h"
 #include "src/sksl/SkSLParser.h"
@@ -24,6 +32,7 @@
 #include "src/sksl/codegen/SkSLWGSLCodeGenerator.h"
 #include "src/sksl/ir/SkSLFunctionDeclaration.h"
 #include "src/sksl/ir/SkSLProgram.h"
+#include "tools/Resources.h"
 
 #include <regex>
 
@@ -513,6 +522,63 @@ void main()
 
 COMPILER_BENCH(tiny, "void main() { sk_FragColor = half4(1); }");
 
+// Compiles a warmup-sized batch of fragment shaders to GLSL with SkSL::CompileBatch, to measure how
+// well compilation scales across threads.
+class SkSLBatchCompileBench : public Benchmark {
+public:
+    SkSLBatchCompileBench(int threads)
+            : fName(SkStringPrintf("sksl_batch_compile_glsl_%dthreads", threads))
+            , fThreads(threads)
+            , fCaps(GrContextOptions(), GrMockOptions()) {
+        for (int i = 0; i < 16; ++i) {
+            for (const char* src : {large_SRC, medium_SRC, small_SRC, tiny_SRC}) {
+                fJobs.push_back({SkSL::ProgramKind::kFragment, src, SkSL::ProgramSettings{}});
+            }
+        }
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const SkSL::ShaderCaps* shaderCaps = fCaps.shaderCaps();
+        auto toGLSL = [shaderCaps](SkSL::Program& program, std::string* out) {
+            return SkSL::ToGLSL(program, shaderCaps, out);
+        };
+        for (int i = 0; i < loops; i++) {
+            std::vector<SkSL::BatchCompileResult> results =
+                    SkSL::CompileBatch(fJobs, fExecutor.get(), fThreads, toGLSL);
+            for (const SkSL::BatchCompileResult& result : results) {
+                if (!result.fProgram) {
+                    SK_ABORT("shader compilation failed: %s\n", result.fErrorText.c_str());
+                }
+            }
+        }
+    }
+
+private:
+    SkString fName;
+    int fThreads;
+    GrMockCaps fCaps;
+    std::vector<SkSL::BatchCompileJob> fJobs;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH(return new SkSLBatchCompileBench(1);)
+DEF_BENCH(return new SkSLBatchCompileBench(2);)
+DEF_BENCH(return new SkSLBatchCompileBench(4);)
+DEF_BENCH(return new SkSLBatchCompileBench(8);)
+
 #define GRAPHITE_BENCH(name, text)                                                                \
     static constexpr char name##_SRC[] = text;                                                    \
     DEF_BENCH(return new SkSLCompileBench(#name, name##_SRC, /*optimize=*/true, Output::kGrMtl);) \
@@ -787,3 +853,266 @@ DEF_BENCH(return new SkSLModuleLoaderBench("sksl_module_loader_graphite",
                                                    SkSL::ProgramKind::kGraphiteVertex,
                                                    SkSL::ProgramKind::kGraphiteFragment,
                                            });)
+
+// Measures the time from a cold start (no modules loaded) until the first runtime shader has been
+// compiled, after preloading the modules a typical client needs; either serially, or with sibling
+// modules compiled concurrently on a thread pool.
+class SkSLTimeToFirstCompileBench : public Benchmark {
+public:
+    SkSLTimeToFirstCompileBench(const char* name, int threads)
+            : fName(name), fThreads(threads) {}
+
+    const char* onGetName() override {
+        return fName;
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    bool shouldLoop() const override {
+        return false;
+    }
+
+    void onDelayedSetup() override {
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onPreDraw(SkCanvas*) override {
+        SkSL::ModuleLoader::Get().unloadModules();
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkASSERT(loops == 1);
+        static constexpr SkSL::ProgramKind kKinds[] = {
+                SkSL::ProgramKind::kVertex,
+                SkSL::ProgramKind::kFragment,
+                SkSL::ProgramKind::kCompute,
+                SkSL::ProgramKind::kRuntimeShader,
+                SkSL::ProgramKind::kPrivateRuntimeShader,
+        };
+        SkSL::ModuleLoader::PreloadModules(kKinds, fExecutor.get());
+        SkSL::Compiler compiler;
+        SkSL::ProgramSettings settings;
+        std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+                SkSL::ProgramKind::kRuntimeShader,
+                "half4 main(float2 xy) { return half4(sin(xy.x), cos(xy.y), 0, 1); }",
+                settings);
+        if (!program) {
+            SK_ABORT("shader compilation failed: %s\n", compiler.errorText().c_str());
+        }
+    }
+
+private:
+    const char* fName;
+    int fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH(return new SkSLTimeToFirstCompileBench("sksl_time_to_first_compile_serial",
+                                                 /*threads=*/0);)
+DEF_BENCH(return new SkSLTimeToFirstCompileBench("sksl_time_to_first_compile_parallel",
+                                                 /*threads=*/4);)
+
+// Shades a raster bitmap with arithmetic-heavy SkSL, either through the raster pipeline stages
+// alone or with runs of slot arithmetic replaced by generated code (AppendStagesOptions).
+class SkSLRasterPipelineNativeCodeBench : public Benchmark {
+public:
+    SkSLRasterPipelineNativeCodeBench(bool useNativeCode) : fUseNativeCode(useNativeCode) {
+        fName = useNativeCode ? "sksl_rp_native_code" : "sksl_rp_stages";
+    }
+
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        SkRuntimeEffect::Options options;
+        if (fUseNativeCode) {
+            SkRuntimeEffectPriv::UseRPNativeCode(&options);
+        }
+        sk_sp<SkRuntimeEffect> effect = SkRuntimeEffect::MakeForShader(SkString(R"(
+            half4 main(float2 p) {
+                float2 q = p * 0.0078125;
+                float3 c = float3(q.x, q.y, q.x + q.y);
+                for (int i = 0; i < 4; ++i) {
+                    c = c * float3(1.5, 0.75, 0.5) + float3(q.y, 0.25, q.x);
+                    c = min(c, float3(4)) - max(c * 0.125, float3(0.0625));
+                }
+                return half4(half3(c * 0.25), 1);
+            }
+        )"), options).effect;
+        SkASSERT(effect);
+        fPaint.setShader(effect->makeShader(/*uniforms=*/nullptr, /*children=*/{}));
+        fBitmap.allocN32Pixels(256, 256);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas canvas(fBitmap);
+        for (int i = 0; i < loops; i++) {
+            canvas.drawPaint(fPaint);
+        }
+    }
+
+private:
+    SkString fName;
+    SkPaint fPaint;
+    SkBitmap fBitmap;
+    bool fUseNativeCode;
+};
+
+DEF_BENCH(return new SkSLRasterPipelineNativeCodeBench(/*useNativeCode=*/false);)
+DEF_BENCH(return new SkSLRasterPipelineNativeCodeBench(/*useNativeCode=*/true);)
+
+// Real-world effects used to measure the raster pipeline stage optimizer.
+// BlueNeurons is also the shader in skottie's SkSLEffect sample (skottie-sksl-effect.json).
+static constexpr struct {
+    const char* fName;
+    const char* fResource;
+    SkSL::ProgramKind fKind;
+} kRasterPipelineEffects[] = {
+    {"blue_neurons",         "sksl/realistic/BlueNeurons.rts",
+                             SkSL::ProgramKind::kRuntimeShader},
+    {"hsl_color_filter",     "sksl/realistic/HSLColorFilter.rtcf",
+                             SkSL::ProgramKind::kRuntimeColorFilter},
+    {"high_contrast_filter", "sksl/realistic/HighContrastFilter.rtcf",
+                             SkSL::ProgramKind::kRuntimeColorFilter},
+};
+
+static std::string load_effect_source(const char* resource) {
+    sk_sp<SkData> data = GetResourceAsData(resource);
+    return data ? std::string(static_cast<const char*>(data->data()), data->size())
+                : std::string();
+}
+
+// Picks uniform values that keep the effects above on their interesting paths.
+static sk_sp<SkData> effect_uniforms(const SkRuntimeEffect& effect) {
+    sk_sp<SkData> data = SkData::MakeZeroInitialized(effect.uniformSize());
+    for (const SkRuntimeEffect::Uniform& u : effect.uniforms()) {
+        auto* dst = SkTAddOffset<float>(data->writable_data(), u.offset);
+        if (u.name == "iResolution") {
+            dst[0] = dst[1] = 256;
+            dst[2] = 1;
+        } else if (u.name == "iTime") {
+            dst[0] = 1;
+        } else if (u.name == "invertStyle") {
+            dst[0] = 2;
+        } else if (u.name == "contrast") {
+            dst[0] = 0.5f;
+        }
+    }
+    return data;
+}
+
+// Shades a raster bitmap with one of kRasterPipelineEffects, with or without the stage optimizer.
+class SkSLRasterPipelineEffectBench : public Benchmark {
+public:
+    SkSLRasterPipelineEffectBench(int effectIndex, bool optimizeStages)
+            : fEffectIndex(effectIndex), fOptimizeStages(optimizeStages) {
+        fName.printf("sksl_rp_%s_%s", kRasterPipelineEffects[effectIndex].fName,
+                     optimizeStages ? "optimized" : "unoptimized");
+    }
+
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        const auto& info = kRasterPipelineEffects[fEffectIndex];
+        SkString sksl(load_effect_source(info.fResource));
+        SkRuntimeEffect::Options options;
+        if (!fOptimizeStages) {
+            SkRuntimeEffectPriv::DisableRPStageOptimization(&options);
+        }
+        if (info.fKind == SkSL::ProgramKind::kRuntimeShader) {
+            sk_sp<SkRuntimeEffect> effect = SkRuntimeEffect::MakeForShader(sksl, options).effect;
+            SkASSERT(effect);
+            fPaint.setShader(effect->makeShader(effect_uniforms(*effect), /*children=*/{}));
+        } else {
+            sk_sp<SkRuntimeEffect> effect =
+                    SkRuntimeEffect::MakeForColorFilter(sksl, options).effect;
+            SkASSERT(effect);
+            // Filter a gradient, so the filter is evaluated per pixel.
+            const SkPoint pts[] = {{0, 0}, {256, 256}};
+            const SkColor colors[] = {SK_ColorRED, SK_ColorCYAN};
+            fPaint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                          SkTileMode::kClamp));
+            fPaint.setColorFilter(effect->makeColorFilter(effect_uniforms(*effect)));
+        }
+        fBitmap.allocN32Pixels(256, 256);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas canvas(fBitmap);
+        for (int i = 0; i < loops; i++) {
+            canvas.drawPaint(fPaint);
+        }
+    }
+
+private:
+    SkString fName;
+    SkPaint fPaint;
+    SkBitmap fBitmap;
+    int fEffectIndex;
+    bool fOptimizeStages;
+};
+
+DEF_BENCH(return new SkSLRasterPipelineEffectBench(0, /*optimizeStages=*/false);)
+DEF_BENCH(return new SkSLRasterPipelineEffectBench(0, /*optimizeStages=*/true);)
+DEF_BENCH(return new SkSLRasterPipelineEffectBench(1, /*optimizeStages=*/false);)
+DEF_BENCH(return new SkSLRasterPipelineEffectBench(1, /*optimizeStages=*/true);)
+DEF_BENCH(return new SkSLRasterPipelineEffectBench(2, /*optimizeStages=*/false);)
+DEF_BENCH(return new SkSLRasterPipelineEffectBench(2, /*optimizeStages=*/true);)
+
+static int count_raster_pipeline_stages(const SkSL::Program& program, bool optimizeStages) {
+    const SkSL::FunctionDeclaration* main = program.getFunction("main");
+    std::unique_ptr<SkSL::RP::Program> rasterProg =
+            main ? SkSL::MakeRasterPipelineProgram(program, *main->definition()) : nullptr;
+    if (!rasterProg) {
+        return -1;
+    }
+    std::vector<float> uniforms(rasterProg->numUniforms());
+    SkSTArenaAlloc<2048> alloc;
+    SkRasterPipeline pipeline(&alloc);
+    SkSL::RP::AppendStagesOptions options;
+    options.optimizeStages = optimizeStages;
+    rasterProg->appendStages(&pipeline, &alloc, /*callbacks=*/nullptr, SkSpan(uniforms), options);
+    return pipeline.getNumStages();
+}
+
+// Not timed: reports how many raster pipeline stages each of kRasterPipelineEffects compiles to,
+// with and without the stage optimizer.
+void RunSkSLRasterPipelineBenchmarks(NanoJSONResultsWriter* log) {
+    SkSL::Compiler compiler;
+    for (const auto& info : kRasterPipelineEffects) {
+        std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+                info.fKind, load_effect_source(info.fResource), SkSL::ProgramSettings{});
+        if (!program) {
+            continue;
+        }
+        for (bool optimize : {false, true}) {
+            int numStages = count_raster_pipeline_stages(*program, optimize);
+            if (numStages < 0) {
+                continue;
+            }
+            SkString name = SkStringPrintf("sksl_rp_stages_%s_%s", info.fName,
+                                           optimize ? "optimized" : "unoptimized");
+            SkDEBUGCODE(SkDebugf("%s: %d stages\n", name.c_str(), numStages);)
+            log->beginObject(name.c_str());        // test
+            log->beginObject("meta");              //   config
+            log->appendS32("stages", numStages);   //     sub_result
+            log->endObject();                      //   config
+            log->endObject();                      // test
+        }
+    }
+}
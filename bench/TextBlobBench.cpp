@@ -11,6 +11,8 @@
 #include "include/core/SkPaint.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/base/SkTemplates.h"
@@ -109,3 +111,111 @@ class TextBlobMakeBench : public SkTextBlobBench {
     }
 };
 DEF_BENCH( return new TextBlobMakeBench(); )
+
+/*
+ * A blob made of many short runs, one per word, as text shaped a word or a style span at a time
+ * comes out. Runs alternate between fontCount fonts; with one font, every run can share the strike
+ * and the blitter of the run before.
+ */
+class TextBlobManyRunsBench : public Benchmark {
+public:
+    explicit TextBlobManyRunsBench(int fontCount) : fFontCount(fontCount) {
+        fName.printf("TextBlobManyRunsBench_%dfonts", fontCount);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        static constexpr const char* kWords[] = {"Keep", "your", "sentences", "short,", "but",
+                                                 "not", "overly", "so."};
+        SkFont fonts[2];
+        fonts[0].setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle()));
+        fonts[1].setTypeface(ToolUtils::CreatePortableTypeface("sans-serif", SkFontStyle()));
+        for (SkFont& font : fonts) {
+            font.setSubpixel(true);
+        }
+
+        SkTextBlobBuilder builder;
+        SkScalar x = 10, y = 20;
+        for (int i = 0; i < 200; ++i) {
+            const SkFont& font = fonts[i % fFontCount];
+            const char* word = kWords[i % std::size(kWords)];
+            const size_t length = strlen(word);
+            const int glyphCount = font.countText(word, length, SkTextEncoding::kUTF8);
+            const SkTextBlobBuilder::RunBuffer& run = builder.allocRunPosH(font, glyphCount, y);
+            font.textToGlyphs(word, length, SkTextEncoding::kUTF8, run.glyphs, glyphCount);
+            font.getXPos(run.glyphs, glyphCount, run.pos, x);
+            x += font.measureText(word, length, SkTextEncoding::kUTF8) + 4;
+            if (x > 500) {
+                x = 10;
+                y += 16;
+            }
+        }
+        fBlob = builder.make();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        for (int i = 0; i < loops; i++) {
+            canvas->drawTextBlob(fBlob, 0, 0, paint);
+        }
+    }
+
+private:
+    const int fFontCount;
+    SkString fName;
+    sk_sp<SkTextBlob> fBlob;
+};
+DEF_BENCH( return new TextBlobManyRunsBench(1); )
+DEF_BENCH( return new TextBlobManyRunsBench(2); )
+
+/*
+ * Text drawn to a raster surface under a transform that changes every frame, as in an animation.
+ * Drawing from masks needs a new strike for every rotation and scale; drawing from distance fields
+ * reuses one distance field per glyph.
+ */
+class TextBlobAnimatedTransformBench : public Benchmark {
+public:
+    explicit TextBlobAnimatedTransformBench(bool distanceFields)
+            : fDistanceFields(distanceFields) {
+        fName.printf("TextBlobAnimatedTransformBench_%s", distanceFields ? "sdf" : "masks");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return Backend::kNonRendering == backend; }
+
+    void onDelayedSetup() override {
+        SkFont font(ToolUtils::CreatePortableTypeface("serif", SkFontStyle()), 24);
+        const char* text = "Keep your sentences short, but not overly so.";
+        fBlob = SkTextBlob::MakeFromText(text, strlen(text), font);
+
+        const SkSurfaceProps props(
+                fDistanceFields ? SkSurfaceProps::kDistanceFieldText_Flag : 0,
+                kUnknown_SkPixelGeometry);
+        fSurface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(640, 480), &props);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas* canvas = fSurface->getCanvas();
+        SkPaint paint;
+        for (int i = 0; i < loops; i++) {
+            canvas->save();
+            canvas->translate(320, 240);
+            canvas->rotate(i % 360);
+            const SkScalar scale = 1 + (i % 100) / 100.0f;
+            canvas->scale(scale, scale);
+            canvas->drawTextBlob(fBlob, -250, 0, paint);
+            canvas->restore();
+        }
+    }
+
+private:
+    const bool fDistanceFields;
+    SkString fName;
+    sk_sp<SkTextBlob> fBlob;
+    sk_sp<SkSurface> fSurface;
+};
+DEF_BENCH( return new TextBlobAnimatedTransformBench(false); )
+DEF_BENCH( return new TextBlobAnimatedTransformBench(true); )
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkData.h"
+#include "include/core/SkString.h"
+#include "src/base/SkUTF.h"
+#include "tools/Resources.h"
+
+#include <vector>
+
+// Converts a large document, made of many copies of a text resource, between UTF-8 and UTF-16.
+class UTFBench : public Benchmark {
+public:
+    UTFBench(const char* resource, const char* name) : fResource(resource) {
+        fName.printf("utf_%s", name);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        sk_sp<SkData> data = GetResourceAsData(fResource);
+        if (!data) {
+            return;
+        }
+        while (fUTF8.size() < (1 << 20)) {
+            fUTF8.append((const char*)data->data(), data->size());
+        }
+        int utf16Length = SkUTF::UTF8ToUTF16(nullptr, 0, fUTF8.c_str(), fUTF8.size());
+        if (utf16Length < 0) {
+            fUTF8.reset();
+            return;
+        }
+        fUTF16.resize(utf16Length);
+        SkUTF::UTF8ToUTF16(fUTF16.data(), utf16Length, fUTF8.c_str(), fUTF8.size());
+        fScratch.resize(fUTF8.size());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (fUTF8.isEmpty()) {
+            return;
+        }
+        int count = 0;
+        while (loops-- > 0) {
+            count += SkUTF::CountUTF8(fUTF8.c_str(), fUTF8.size());
+            count += SkUTF::CountUTF16(fUTF16.data(), fUTF16.size() * sizeof(uint16_t));
+            count += SkUTF::UTF8ToUTF16(fUTF16.data(), fUTF16.size(),
+                                        fUTF8.c_str(), fUTF8.size());
+            count += SkUTF::UTF16ToUTF8(fScratch.data(), fScratch.size(),
+                                        fUTF16.data(), fUTF16.size());
+        }
+        fCount = count;
+    }
+
+private:
+    const char* fResource;
+    SkString fName;
+    SkString fUTF8;
+    std::vector<uint16_t> fUTF16;
+    std::vector<char> fScratch;
+    int fCount = 0;
+};
+
+DEF_BENCH(return new UTFBench("text/english.txt", "english");)
+DEF_BENCH(return new UTFBench("text/cyrillic.txt", "cyrillic");)
+DEF_BENCH(return new UTFBench("text/han_simplified.txt", "han_simplified");)
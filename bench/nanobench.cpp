@@ -39,6 +39,7 @@
 #include "src/base/SkTime.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkOSFile.h"
+#include "src/core/SkPicturePriv.h"
 #include "src/core/SkTaskGroup.h"
 #include "src/core/SkTraceEvent.h"
 #include "src/utils/SkJSONWriter.h"
@@ -143,6 +144,10 @@ static DEFINE_string(zoom, "1.0,0",
                      "Comma-separated zoomMax,zoomPeriodMs factors for a periodic SKP zoom "
                      "function that ping-pongs between 1.0 and zoomMax.");
 static DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
+static DEFINE_bool(extendedRecordOpts, false,
+                   "Run the extended SkRecord optimizations when recording SKPs?");
+static DEFINE_bool(presizeRecording, false,
+                   "Size each SKP recording from the previous one, as when recording per frame?");
 static DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
 static DEFINE_int(flushEvery, 10, "Flush --outResultsFile every Nth run.");
 static DEFINE_bool(gpuStats, false, "Print GPU stats after each gpu benchmark?");
@@ -962,7 +967,8 @@ public:
             fBenchType  = "recording";
             fSKPBytes = static_cast<double>(pic->approximateBytesUsed());
             fSKPOps   = pic->approximateOpCount();
-            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh);
+            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh,
+                                      FLAGS_extendedRecordOpts, FLAGS_presizeRecording);
         }
 
         // Add all .skps as DeserializePictureBenchs.
@@ -980,6 +986,24 @@ public:
             return new DeserializePictureBench(name.c_str(), std::move(data));
         }
 
+        // And again re-encoded in the compact SkRecord format, to compare load times.
+        while (fCurrentCompactPicture < fSKPs.size()) {
+            const SkString& path = fSKPs[fCurrentCompactPicture++];
+            sk_sp<SkPicture> pic = ReadPicture(path.c_str());
+            if (!pic) {
+                continue;
+            }
+            SkDynamicMemoryWStream stream;
+            SkPicturePriv::SerializeCompact(pic.get(), &stream);
+            sk_sp<SkData> data = stream.detachAsData();
+            SkString name = SkOSPath::Basename(path.c_str());
+            fSourceType = "skp";
+            fBenchType  = "deserial_compact";
+            fSKPBytes = static_cast<double>(data->size());
+            fSKPOps   = 0;
+            return new DeserializePictureBench(name.c_str(), std::move(data));
+        }
+
         // Then once each for each scale as SKPBenches (playback).
         while (fCurrentScale < fScales.size()) {
             while (fCurrentSKP < fSKPs.size()) {
@@ -989,13 +1013,14 @@ public:
                     continue;
                 }
 
-                if (FLAGS_bbh) {
+                if (FLAGS_bbh || FLAGS_extendedRecordOpts) {
                     // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one.
                     SkRTreeFactory factory;
                     SkPictureRecorder recorder;
+                    recorder.setExtendedOptimizations(FLAGS_extendedRecordOpts);
                     pic->playback(recorder.beginRecording(pic->cullRect().width(),
                                                           pic->cullRect().height(),
-                                                          &factory));
+                                                          FLAGS_bbh ? &factory : nullptr));
                     pic = recorder.finishRecordingAsPicture();
                 }
                 SkString name = SkOSPath::Basename(path.c_str());
@@ -1302,6 +1327,7 @@ private:
     const char* fBenchType;   // How we bench it: micro, recording, playback, ...
     int fCurrentRecording = 0;
     int fCurrentDeserialPicture = 0;
+    int fCurrentCompactPicture = 0;
     int fCurrentMSKP = 0;
     int fCurrentScale = 0;
     int fCurrentSKP = 0;
@@ -1454,6 +1480,7 @@ int main(int argc, char** argv) {
     // loaded, so we won't be able to capture a delta for them.
     log.beginObject("results");
     RunSkSLModuleBenchmarks(&log);
+    RunSkSLRasterPipelineBenchmarks(&log);
 
     int runs = 0;
     BenchmarkStream benchStream;
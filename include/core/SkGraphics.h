@@ -69,6 +69,24 @@ public:
      */
     static int SetFontCacheCountLimit(int count);
 
+    /**
+     *  Return the max number of bytes that should be used by the cache of signed distance
+     *  fields that raster surfaces with SkSurfaceProps::kDistanceFieldText_Flag draw text from.
+     */
+    static size_t GetDistanceFieldTextCacheLimit();
+
+    /**
+     *  Specify the max number of bytes that should be used by the distance field text cache,
+     *  and return the previous limit. If the cache is using more than this, it is purged
+     *  immediately to meet the new limit.
+     */
+    static size_t SetDistanceFieldTextCacheLimit(size_t bytes);
+
+    /**
+     *  Return the number of bytes currently used by the distance field text cache.
+     */
+    static size_t GetDistanceFieldTextCacheUsed();
+
     /**
      *  Return the current limit to the number of entries in the typeface cache.
      *  A cache "entry" is associated with each typeface.
@@ -82,6 +100,24 @@ public:
      */
     static int SetTypefaceCacheCountLimit(int count);
 
+    /**
+     *  Return the current limit to the number of entries in the SkRuntimeEffect cache. Effects
+     *  created from identical SkSL and options share one compiled program while cached. Only
+     *  Skia's internal effects, and those made with SkRuntimeEffect::Options::useSharedCache, go
+     *  through this cache. An effect takes up to two entries: one for its SkSL and one for its
+     *  tokens, which SkSL differing only in whitespace and comments shares.
+     */
+    static int GetRuntimeEffectCacheCountLimit();
+
+    /**
+     *  Set the limit to the number of entries in the SkRuntimeEffect cache, and return the
+     *  previous value. If this new value is lower than the previous, entries are purged
+     *  immediately to meet the new limit. Zero disables the cache. The limit is divided among
+     *  independently locked parts of the cache, so entries may be evicted before the whole cache
+     *  reaches it, but the cache never holds more.
+     */
+    static int SetRuntimeEffectCacheCountLimit(int count);
+
     /**
      *  For debugging purposes, this will attempt to purge the font cache. It
      *  does not change the limit, but will cause subsequent font measures and
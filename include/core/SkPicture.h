@@ -16,6 +16,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 class SkCanvas;
 class SkData;
@@ -256,9 +257,12 @@ private:
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
         bool textBlobsOnly=false) const;
-    static sk_sp<SkPicture> MakeFromStreamPriv(SkStream*, const SkDeserialProcs*,
-                                               class SkTypefacePlayback*,
-                                               int recursionLimit);
+    // If `unported` is set, a picture stored as SkPictureData is returned there (with its header
+    // in `unportedInfo`) instead of being forwardported, and the returned picture is null.
+    static sk_sp<SkPicture> MakeFromStreamPriv(
+            SkStream*, const SkDeserialProcs*, class SkTypefacePlayback*, int recursionLimit,
+            std::unique_ptr<class SkPictureData>* unported = nullptr,
+            struct SkPictInfo* unportedInfo = nullptr);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
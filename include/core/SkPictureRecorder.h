@@ -90,8 +90,24 @@ public:
      */
     sk_sp<SkDrawable> finishRecordingAsDrawable();
 
+    /**
+     *  If enabled, finishing a recording also runs more expensive optimizations over it: draws
+     *  hidden behind later opaque rects are dropped, abutting rects with the same paint are merged,
+     *  and clips and matrix changes that have no effect are removed. Disabled by default.
+     */
+    void setExtendedOptimizations(bool enabled) { fExtendedOptimizations = enabled; }
+
+    /**
+     *  If enabled, each recording starts with as much storage as the previous recordings from this
+     *  recorder needed, rather than growing it op by op. The presize grows with the recordings at
+     *  once and shrinks gradually when they get smaller. This suits recording similar content
+     *  repeatedly, e.g. once per frame. Disabled by default.
+     */
+    void setPresizeFromPreviousRecording(bool enabled) { fPresizeFromPrevious = enabled; }
+
 private:
     void reset();
+    void finishRecord();
 
     /** Replay the current (partially recorded) operation stream into
         canvas. This call doesn't close the current recording.
@@ -103,6 +119,10 @@ private:
     void partialReplay(SkCanvas* canvas) const;
 
     bool                        fActivelyRecording;
+    bool                        fExtendedOptimizations = false;
+    bool                        fPresizeFromPrevious = false;
+    int                         fPresizeOpCount = 0;
+    size_t                      fPresizeBytes = 0;
     SkRect                      fCullRect;
     sk_sp<SkBBoxHierarchy>      fBBH;
     std::unique_ptr<SkRecorder> fRecorder;
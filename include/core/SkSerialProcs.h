@@ -15,6 +15,7 @@
 #include <optional>
 
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPicture;
 class SkTypeface;
@@ -112,6 +113,16 @@ struct SK_API SkDeserialProcs {
     // parameters and returns a bool). Given that there are only two valid implementations of that
     // proc, we just insert the bool directly.
     bool                         fAllowSkSL = true;
+
+    // If set, each picture's images are decoded concurrently on this executor once all of their
+    // encoded data has been read, and nested pictures are replayed concurrently once parsed. The
+    // image procs must then be thread-safe, and must not depend on the order they are called in.
+    SkExecutor*                  fExecutor = nullptr;
+
+    // If true, images whose header Skia's codecs can read stay encoded until they are first drawn,
+    // and only then are passed to the image procs to decode. fImageCtx must then outlive the
+    // deserialized picture. (Without image procs, images are always decoded lazily.)
+    bool                         fLazyImages = false;
 };
 
 #endif
@@ -60,6 +60,14 @@ public:
         // If set, all rendering will have dithering enabled
         // Currently this only impacts GPU backends
         kAlwaysDither_Flag = 1 << 2,
+        // If set, raster surfaces draw text of 16 to 256 pixels from cached signed distance
+        // fields, which are reused across text sizes, scales and rotations, and larger text as
+        // paths. Ignored by other backends.
+        kDistanceFieldText_Flag = 1 << 3,
+        // If set, raster surfaces draw gradients with many stops, or that interpolate in a color
+        // space other than the destination's, from a cached table of their colors. Ignored by
+        // other backends.
+        kGradientLUT_Flag = 1 << 4,
     };
 
     /** No flags, unknown pixel geometry, platform-default contrast/gamma. */
@@ -94,6 +102,14 @@ public:
         return SkToBool(fFlags & kAlwaysDither_Flag);
     }
 
+    bool isDistanceFieldText() const {
+        return SkToBool(fFlags & kDistanceFieldText_Flag);
+    }
+
+    bool isGradientLUT() const {
+        return SkToBool(fFlags & kGradientLUT_Flag);
+    }
+
     bool operator==(const SkSurfaceProps& that) const {
         return fFlags == that.fFlags && fPixelGeometry == that.fPixelGeometry &&
         fTextContrast == that.fTextContrast && fTextGamma == that.fTextGamma;
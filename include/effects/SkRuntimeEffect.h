@@ -127,6 +127,11 @@ public:
         // painted.)
         bool forceUnoptimized = false;
 
+        // Shares the effect through a process-wide cache of compiled effects, sized by
+        // SkGraphics::SetRuntimeEffectCacheCountLimit. Off by default, so callers that cache
+        // effects themselves are not subject to Skia's cache policy.
+        bool useSharedCache = false;
+
     private:
         friend class SkRuntimeEffect;
         friend class SkRuntimeEffectPriv;
@@ -134,6 +139,11 @@ public:
         // This flag allows Runtime Effects to access Skia implementation details like sk_FragCoord
         // and functions with private identifiers (e.g. $rgb_to_hsl).
         bool allowPrivateAccess = false;
+        // These flags select how the raster pipeline backend runs the effect, for testing and
+        // benchmarking: with or without its stage optimizer, and with or without generated native
+        // code for slot arithmetic. They don't change the results.
+        bool optimizeRPStages = true;
+        bool useRPNativeCode = false;
         // When not 0, this field allows Skia to assign a stable key to a known runtime effect
         uint32_t fStableKey = 0;
 
@@ -181,6 +191,32 @@ public:
         return MakeForBlender(std::move(sksl), Options{});
     }
 
+    // Effects made with Options::useSharedCache are kept in a process-wide cache, keyed by their
+    // SkSL, kind and options (see SkGraphics::SetRuntimeEffectCacheCountLimit). SkSL that differs
+    // from a cached effect's only in whitespace and comments reuses that effect's compiled
+    // program; source() still returns the SkSL that was passed in. Any other edit, even to a
+    // single function, compiles the whole effect again.
+    // A PersistentCache stores compiled effects in storage that outlives the process. On a miss,
+    // `load` is asked for data previously passed to `store` under the same key; that data holds
+    // the optimized program text, which is quicker to compile than the original SkSL. Keys
+    // identify the SkSL compiler that stored the data, so data from another build is never
+    // matched; builds that change the compiler within a milestone should define
+    // SK_RUNTIME_EFFECT_CACHE_BUILD_ID (e.g. to their source revision). An effect created from
+    // stored data still reports the original SkSL from source(). If the stored data fails to
+    // compile, the original SkSL is used instead.
+    class SK_API PersistentCache {
+    public:
+        virtual ~PersistentCache() = default;
+
+        virtual sk_sp<SkData> load(const SkData& key) = 0;
+        virtual void store(const SkData& key, const SkData& data) = 0;
+    };
+
+    // Sets the persistent tier consulted by MakeForColorFilter, MakeForShader and MakeForBlender.
+    // The cache is not owned and must outlive its use; pass nullptr to disable. It may be called
+    // from multiple threads at once. Returns the previous persistent cache.
+    static PersistentCache* SetPersistentCache(PersistentCache*);
+
     // Object that allows passing a SkShader, SkColorFilter or SkBlender as a child
     class SK_API ChildPtr {
     public:
@@ -278,6 +314,8 @@ private:
         kAlwaysOpaque_Flag        = 0x040,
         kAlphaUnchanged_Flag      = 0x080,
         kDisableOptimization_Flag = 0x100,
+        kDisableRPStageOpts_Flag  = 0x200,
+        kUseRPNativeCode_Flag     = 0x400,
     };
 
     SkRuntimeEffect(std::unique_ptr<SkSL::Program> baseProgram,
@@ -288,6 +326,9 @@ private:
                     std::vector<SkSL::SampleUsage>&& sampleUsages,
                     uint32_t flags);
 
+    // Shares `original`'s compiled program, but reports `source` as its SkSL.
+    SkRuntimeEffect(const SkRuntimeEffect& original, std::string source);
+
     sk_sp<SkRuntimeEffect> makeUnoptimizedClone();
 
     static Result MakeFromSource(SkString sksl, const Options& options, SkSL::ProgramKind kind);
@@ -317,8 +358,13 @@ private:
     uint32_t fHash;
     uint32_t fStableKey;
 
-    std::unique_ptr<SkSL::Program> fBaseProgram;
+    std::shared_ptr<SkSL::Program> fBaseProgram;
+    // The caller's SkSL, when fBaseProgram was compiled from other text (see PersistentCache), or
+    // is shared with an effect made from differently formatted SkSL.
+    std::unique_ptr<const std::string> fSource;
     std::unique_ptr<SkSL::RP::Program> fRPProgram;
+    // The effect whose fBaseProgram this one shares, and which builds its fRPProgram.
+    sk_sp<const SkRuntimeEffect> fRPProgramOwner;
     mutable SkOnce fCompileRPProgramOnce;
     const SkSL::FunctionDefinition& fMain;
     std::vector<Uniform> fUniforms;
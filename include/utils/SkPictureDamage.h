@@ -0,0 +1,47 @@
+/*
+ * Copyright 2024 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureDamage_DEFINED
+#define SkPictureDamage_DEFINED
+
+#include "include/core/SkRegion.h"
+#include "include/core/SkTypes.h"
+
+class SkCanvas;
+class SkPicture;
+
+/**
+ *  Helpers for redrawing only the parts of a frame that changed, when each frame is recorded as
+ *  a complete SkPicture and rendered into a persistent (e.g. raster SkSurface) target.
+ *
+ *  All regions are in the pictures' local coordinate space, rounded out to whole units.
+ */
+class SK_API SkPictureDamage {
+public:
+    /**
+     *  Returns a conservative region outside of which 'next' renders exactly as 'prev' did.
+     *  The two pictures are compared op by op; an op that differs in content or in its
+     *  recorded bounds damages its old and new bounds. If either picture cannot be inspected
+     *  (or 'prev' is null), the union of both cull rects is returned.
+     */
+    static SkRegion Compute(const SkPicture* prev, const SkPicture& next);
+
+    /**
+     *  Assuming 'canvas' holds the rendering of the previous frame, clears 'damage' to
+     *  transparent and replays 'next' clipped to it. Ops that do not intersect a damage rect
+     *  are skipped by the picture's bounding box hierarchy, if it was recorded with one.
+     */
+    static void Replay(SkCanvas*, const SkPicture& next, const SkRegion& damage);
+
+    /**
+     *  Compute() followed by Replay(). Returns the damage so the caller can present only the
+     *  rects it contains.
+     */
+    static SkRegion Update(SkCanvas*, const SkPicture* prev, const SkPicture& next);
+};
+
+#endif
@@ -9,6 +9,8 @@
 #include "modules/skparagraph/include/Paragraph.h"
 #include "modules/skparagraph/src/ParagraphBuilderImpl.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
+#include "modules/skshaper/utils/FactoryHelpers.h"
+#include "modules/skunicode/include/SkUnicode.h"
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
@@ -62,4 +64,43 @@ struct ParagraphBench : public Benchmark {
 PARAGRAPH_BENCH(english)
 #undef PARAGRAPH_BENCH
 
+namespace {
+// Computes the code unit flags ParagraphImpl builds its cluster table from, for a large document
+// made of many copies of a text resource.
+struct CodeUnitFlagsBench : public Benchmark {
+    CodeUnitFlagsBench(const char* r, const char* n) : fResource(r), fName(n) {}
+    sk_sp<SkUnicode> fUnicode;
+    SkString fText;
+    const char* fResource;
+    const char* fName;
+    const char* onGetName() override { return fName; }
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+    void onDelayedSetup() override {
+        fUnicode = sk_ref_sp(SkShapers::BestAvailable()->getUnicode());
+        if (sk_sp<SkData> data = GetResourceAsData(fResource)) {
+            while (fText.size() < (1 << 20)) {
+                fText.append((const char*)data->data(), data->size());
+            }
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fUnicode || fText.isEmpty()) {
+            return;
+        }
+        skia_private::TArray<SkUnicode::CodeUnitFlags, true> flags;
+        while (loops-- > 0) {
+            fUnicode->computeCodeUnitFlags(fText.data(), fText.size(), /*replaceTabs=*/true,
+                                           &flags);
+        }
+    }
+};
+}  // namespace
+
+#define CODEUNITFLAGS_BENCH(X) \
+    DEF_BENCH(return new CodeUnitFlagsBench("text/" #X ".txt", "codeunitflags_" #X);)
+CODEUNITFLAGS_BENCH(english)
+CODEUNITFLAGS_BENCH(cyrillic)
+CODEUNITFLAGS_BENCH(han_simplified)
+#undef CODEUNITFLAGS_BENCH
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
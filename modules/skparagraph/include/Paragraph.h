@@ -10,6 +10,7 @@
 #include <unordered_set>
 
 class SkCanvas;
+class SkExecutor;
 
 namespace skia {
 namespace textlayout {
@@ -41,6 +42,13 @@ public:
 
     virtual void layout(SkScalar width) = 0;
 
+    // Lays out paragraphs[i] at widths[i] for every i, spread over the executor's threads, and
+    // returns once they are all done (without an executor, lays them out on this thread).
+    // The paragraphs can share a FontCollection, but not be in two batches at the same time.
+    static void LayoutAll(SkSpan<Paragraph* const> paragraphs,
+                          SkSpan<const SkScalar> widths,
+                          SkExecutor* executor);
+
     virtual void paint(SkCanvas* canvas, SkScalar x, SkScalar y) = 0;
 
     virtual void paint(ParagraphPainter* painter, SkScalar x, SkScalar y) = 0;
@@ -74,12 +82,19 @@ public:
     virtual std::unordered_set<SkUnichar> unresolvedCodepoints() = 0;
 
     // Experimental API that allows fast way to update some of "immutable" paragraph attributes
-    // but not the text itself
     virtual void updateTextAlign(TextAlign textAlign) = 0;
     virtual void updateFontSize(size_t from, size_t to, SkScalar fontSize) = 0;
     virtual void updateForegroundPaint(size_t from, size_t to, SkPaint paint) = 0;
     virtual void updateBackgroundPaint(size_t from, size_t to, SkPaint paint) = 0;
 
+    // Replaces the UTF-8 text [from:to) with text, which takes the style of the text before it.
+    // The paragraph has to be laid out again before it is painted or measured; that layout
+    // reshapes only the words around the edits made since the previous one and keeps the lines
+    // above them (falling back to a full layout for bidi text, placeholders, letter and word
+    // spacing, justification, ellipsis and max lines, and for a new width).
+    // Returns false, changing nothing, if the range is out of the text or cuts into a placeholder.
+    virtual bool updateText(size_t from, size_t to, const SkString& text) = 0;
+
     enum VisitorFlags {
         kWhiteSpace_VisitorFlag = 1 << 0,
     };
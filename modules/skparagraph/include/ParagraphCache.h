@@ -2,11 +2,14 @@
 #ifndef ParagraphCache_DEFINED
 #define ParagraphCache_DEFINED
 
+#include "include/core/SkString.h"
 #include "include/private/base/SkMutex.h"
 #include "src/core/SkLRUCache.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>  // std::function
-
-#define PARAGRAPH_CACHE_STATS
+#include <memory>
 
 namespace skia {
 namespace textlayout {
@@ -17,6 +20,24 @@ class ParagraphCacheValue;
 
 class ParagraphCache {
 public:
+    // Counters since construction or the last reset(). They are updated without locking the
+    // whole cache, so a snapshot taken while other threads lay out paragraphs is approximate.
+    struct Stats {
+        uint64_t fRequests = 0;     // findParagraph calls while the cache is on
+        uint64_t fHits = 0;
+        uint64_t fMisses = 0;
+        uint64_t fInsertions = 0;
+        uint64_t fEvictions = 0;    // entries dropped to stay within the limits
+        int fEntries = 0;
+        size_t fBytes = 0;          // approximate memory held by the entries
+    };
+
+    static constexpr int kDefaultMaxEntries = 128;
+    static constexpr size_t kDefaultMaxBytes = SIZE_MAX;
+    // The entries are spread over this many independently locked LRU maps, chosen by the key's
+    // hash, so layout threads only contend when they hit the same shard.
+    static constexpr int kShardCount = 8;
+
     ParagraphCache();
     ~ParagraphCache();
 
@@ -25,40 +46,57 @@ public:
     bool updateParagraph(ParagraphImpl* paragraph);
     bool findParagraph(ParagraphImpl* paragraph);
 
+    // Sets how many entries and how many (approximate) bytes the cache may hold, evicting the
+    // least recently used entries if it is over either. The limits are split evenly between the
+    // shards, rounding up, and each shard keeps at least one entry.
+    void setLimits(int maxEntries, size_t maxBytes);
+    int maxEntries() const { return fMaxEntries.load(std::memory_order_relaxed); }
+    size_t maxBytes() const { return fMaxBytes.load(std::memory_order_relaxed); }
+
+    Stats stats() const;
+
     // For testing
     void setChecker(std::function<void(ParagraphImpl* impl, const char*, bool)> checker) {
         fChecker = std::move(checker);
     }
     void printStatistics();
     void turnOn(bool value) { fCacheIsOn = value; }
-    int count() { return fLRUCacheMap.count(); }
+    int count() const;
 
     bool isPossiblyTextEditing(ParagraphImpl* paragraph);
 
  private:
 
     struct Entry;
+    struct Shard;
     void updateFrom(const ParagraphImpl* paragraph, Entry* entry);
     void updateTo(ParagraphImpl* paragraph, const Entry* entry);
 
-     mutable SkMutex fParagraphMutex;
-     std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
+    Shard& shardFor(const ParagraphCacheKey& key) const;
+    // Evicts from shard until it is within its share of the limits.
+    void purge(Shard& shard);
+    void rememberLastCached(const SkString& text);
 
-    static const int kMaxEntries = 128;
+     std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
 
     struct KeyHash {
         uint32_t operator()(const ParagraphCacheKey& key) const;
     };
 
-    SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fLRUCacheMap;
+    std::unique_ptr<Shard[]> fShards;
+    std::atomic<int> fMaxEntries;
+    std::atomic<size_t> fMaxBytes;
     bool fCacheIsOn;
-    ParagraphCacheValue* fLastCachedValue;
 
-#ifdef PARAGRAPH_CACHE_STATS
-    int fTotalRequests;
-    int fCacheMisses;
-    int fHashMisses; // cache hit but hash table missed
-#endif
+    // The start and end of the text last added, for isPossiblyTextEditing.
+    mutable SkMutex fLastCachedMutex;
+    SkString fLastCachedPrefix SK_GUARDED_BY(fLastCachedMutex);
+    SkString fLastCachedSuffix SK_GUARDED_BY(fLastCachedMutex);
+
+    std::atomic<uint64_t> fRequests{0};
+    std::atomic<uint64_t> fMisses{0};
+    std::atomic<uint64_t> fInsertions{0};
+    std::atomic<uint64_t> fEvictions{0};
 };
 
 }  // namespace textlayout
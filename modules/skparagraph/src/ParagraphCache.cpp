@@ -1,4 +1,7 @@
 // Copyright 2019 Google LLC.
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <memory>
 
 #include "modules/skparagraph/include/FontArguments.h"
@@ -78,7 +81,8 @@ public:
         , fBidiRegions(paragraph->fBidiRegions)
         , fHasLineBreaks(paragraph->fHasLineBreaks)
         , fHasWhitespacesInside(paragraph->fHasWhitespacesInside)
-        , fTrailingSpaces(paragraph->fTrailingSpaces) { }
+        , fTrailingSpaces(paragraph->fTrailingSpaces)
+        , fBytes(this->computeBytes()) { }
 
     // Input == key
     ParagraphCacheKey fKey;
@@ -94,8 +98,29 @@ public:
     bool fHasLineBreaks;
     bool fHasWhitespacesInside;
     TextIndex fTrailingSpaces;
+
+    // Approximately how much memory the value holds, for the cache's byte limit.
+    size_t fBytes;
+
+private:
+    size_t computeBytes() const;
 };
 
+size_t ParagraphCacheValue::computeBytes() const {
+    size_t bytes = sizeof(ParagraphCacheValue) + fKey.text().size();
+    for (const Run& run : fRuns) {
+        // Glyph IDs, positions, offsets and cluster indexes
+        bytes += sizeof(Run) +
+                 run.size() * (sizeof(SkGlyphID) + 2 * sizeof(SkPoint) + sizeof(uint32_t));
+    }
+    bytes += fClusters.size() * sizeof(Cluster);
+    bytes += fClustersIndexFromCodeUnit.size() * sizeof(size_t);
+    bytes += fCodeUnitProperties.size() * sizeof(SkUnicode::CodeUnitFlags);
+    bytes += fWords.size() * sizeof(size_t);
+    bytes += fBidiRegions.size() * sizeof(SkUnicode::BidiRegion);
+    return bytes;
+}
+
 uint32_t ParagraphCacheKey::mix(uint32_t hash, uint32_t data) {
     hash += data;
     hash += (hash << 10);
@@ -238,17 +263,26 @@ struct ParagraphCache::Entry {
     std::unique_ptr<ParagraphCacheValue> fValue;
 };
 
+struct ParagraphCache::Shard {
+    // The shard enforces its limits itself in purge(), so it can account for the evicted bytes.
+    Shard() : fLRUCacheMap(std::numeric_limits<int>::max()) {}
+
+    mutable SkMutex fMutex;
+    SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fLRUCacheMap
+            SK_GUARDED_BY(fMutex);
+    size_t fBytes SK_GUARDED_BY(fMutex) = 0;
+    int fMaxEntries SK_GUARDED_BY(fMutex) = 0;
+    size_t fMaxBytes SK_GUARDED_BY(fMutex) = 0;
+};
+
 ParagraphCache::ParagraphCache()
     : fChecker([](ParagraphImpl* impl, const char*, bool){ })
-    , fLRUCacheMap(kMaxEntries)
-    , fCacheIsOn(true)
-    , fLastCachedValue(nullptr)
-#ifdef PARAGRAPH_CACHE_STATS
-    , fTotalRequests(0)
-    , fCacheMisses(0)
-    , fHashMisses(0)
-#endif
-{ }
+    , fShards(new Shard[kShardCount])
+    , fMaxEntries(0)
+    , fMaxBytes(0)
+    , fCacheIsOn(true) {
+    this->setLimits(kDefaultMaxEntries, kDefaultMaxBytes);
+}
 
 ParagraphCache::~ParagraphCache() { }
 
@@ -272,13 +306,31 @@ void ParagraphCache::updateTo(ParagraphImpl* paragraph, const Entry* entry) {
     }
 }
 
+ParagraphCache::Stats ParagraphCache::stats() const {
+    Stats stats;
+    stats.fRequests = fRequests.load(std::memory_order_relaxed);
+    stats.fMisses = fMisses.load(std::memory_order_relaxed);
+    stats.fHits = stats.fRequests - std::min(stats.fMisses, stats.fRequests);
+    stats.fInsertions = fInsertions.load(std::memory_order_relaxed);
+    stats.fEvictions = fEvictions.load(std::memory_order_relaxed);
+    for (int i = 0; i < kShardCount; ++i) {
+        SkAutoMutexExclusive lock(fShards[i].fMutex);
+        stats.fEntries += fShards[i].fLRUCacheMap.count();
+        stats.fBytes += fShards[i].fBytes;
+    }
+    return stats;
+}
+
 void ParagraphCache::printStatistics() {
+    Stats stats = this->stats();
     SkDebugf("--- Paragraph Cache ---\n");
-    SkDebugf("Total requests: %d\n", fTotalRequests);
-    SkDebugf("Cache misses: %d\n", fCacheMisses);
-    SkDebugf("Cache miss %%: %f\n", (fTotalRequests > 0) ? 100.f * fCacheMisses / fTotalRequests : 0.f);
-    int cacheHits = fTotalRequests - fCacheMisses;
-    SkDebugf("Hash miss %%: %f\n", (cacheHits > 0) ? 100.f * fHashMisses / cacheHits : 0.f);
+    SkDebugf("Total requests: %llu\n", (unsigned long long)stats.fRequests);
+    SkDebugf("Cache misses: %llu\n", (unsigned long long)stats.fMisses);
+    SkDebugf("Cache miss %%: %f\n",
+             (stats.fRequests > 0) ? 100.f * stats.fMisses / stats.fRequests : 0.f);
+    SkDebugf("Insertions: %llu\n", (unsigned long long)stats.fInsertions);
+    SkDebugf("Evictions: %llu\n", (unsigned long long)stats.fEvictions);
+    SkDebugf("Entries: %d (%zu bytes)\n", stats.fEntries, stats.fBytes);
     SkDebugf("---------------------\n");
 }
 
@@ -287,32 +339,77 @@ void ParagraphCache::abandon() {
 }
 
 void ParagraphCache::reset() {
-    SkAutoMutexExclusive lock(fParagraphMutex);
-#ifdef PARAGRAPH_CACHE_STATS
-    fTotalRequests = 0;
-    fCacheMisses = 0;
-    fHashMisses = 0;
-#endif
-    fLRUCacheMap.reset();
-    fLastCachedValue = nullptr;
+    for (int i = 0; i < kShardCount; ++i) {
+        SkAutoMutexExclusive lock(fShards[i].fMutex);
+        fShards[i].fLRUCacheMap.reset();
+        fShards[i].fBytes = 0;
+    }
+    {
+        SkAutoMutexExclusive lock(fLastCachedMutex);
+        fLastCachedPrefix.reset();
+        fLastCachedSuffix.reset();
+    }
+    fRequests = 0;
+    fMisses = 0;
+    fInsertions = 0;
+    fEvictions = 0;
+}
+
+int ParagraphCache::count() const {
+    int count = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        SkAutoMutexExclusive lock(fShards[i].fMutex);
+        count += fShards[i].fLRUCacheMap.count();
+    }
+    return count;
+}
+
+void ParagraphCache::setLimits(int maxEntries, size_t maxBytes) {
+    maxEntries = std::max(maxEntries, 1);
+    fMaxEntries = maxEntries;
+    fMaxBytes = maxBytes;
+    const int shardEntries = std::max((maxEntries + kShardCount - 1) / kShardCount, 1);
+    const size_t shardBytes = maxBytes == SIZE_MAX ? SIZE_MAX
+                                                   : maxBytes / kShardCount +
+                                                     (maxBytes % kShardCount != 0 ? 1 : 0);
+    for (int i = 0; i < kShardCount; ++i) {
+        SkAutoMutexExclusive lock(fShards[i].fMutex);
+        fShards[i].fMaxEntries = shardEntries;
+        fShards[i].fMaxBytes = shardBytes;
+        this->purge(fShards[i]);
+    }
+}
+
+ParagraphCache::Shard& ParagraphCache::shardFor(const ParagraphCacheKey& key) const {
+    // The low bits of the hash pick the bucket inside the shard's own table, so use the high ones.
+    return fShards[(key.hash() >> 24) % kShardCount];
+}
+
+void ParagraphCache::purge(Shard& shard) {
+    // Keep the most recent entry even if it is over the byte limit on its own.
+    while (shard.fLRUCacheMap.count() > shard.fMaxEntries ||
+           (shard.fBytes > shard.fMaxBytes && shard.fLRUCacheMap.count() > 1)) {
+        const std::unique_ptr<Entry>* entry = shard.fLRUCacheMap.leastRecentlyUsed();
+        SkASSERT(entry);
+        shard.fBytes -= (*entry)->fValue->fBytes;
+        shard.fLRUCacheMap.removeLeastRecentlyUsed();
+        fEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
 bool ParagraphCache::findParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
+    fRequests.fetch_add(1, std::memory_order_relaxed);
     ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    Shard& shard = this->shardFor(key);
+    SkAutoMutexExclusive lock(shard.fMutex);
+    std::unique_ptr<Entry>* entry = shard.fLRUCacheMap.find(key);
 
     if (!entry) {
         // We have a cache miss
-#ifdef PARAGRAPH_CACHE_STATS
-        ++fCacheMisses;
-#endif
+        fMisses.fetch_add(1, std::memory_order_relaxed);
         fChecker(paragraph, "missingParagraph", true);
         return false;
     }
@@ -325,13 +422,11 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
-#ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
-#endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
-
     ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    Shard& shard = this->shardFor(key);
+    SkAutoMutexExclusive lock(shard.fMutex);
+
+    std::unique_ptr<Entry>* entry = shard.fLRUCacheMap.find(key);
     if (!entry) {
         // isTooMuchMemoryWasted(paragraph) not needed for now
         if (isPossiblyTextEditing(paragraph)) {
@@ -339,9 +434,12 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
             return false;
         }
         ParagraphCacheValue* value = new ParagraphCacheValue(std::move(key), paragraph);
-        fLRUCacheMap.insert(value->fKey, std::make_unique<Entry>(value));
+        shard.fBytes += value->fBytes;
+        shard.fLRUCacheMap.insert(value->fKey, std::make_unique<Entry>(value));
+        fInsertions.fetch_add(1, std::memory_order_relaxed);
         fChecker(paragraph, "addedParagraph", true);
-        fLastCachedValue = value;
+        this->rememberLastCached(value->fKey.text());
+        this->purge(shard);
         return true;
     } else {
         // We do not have to update the paragraph
@@ -351,25 +449,38 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
 
 // Special situation: (very) long paragraph that is close to the last formatted paragraph
 #define NOCACHE_PREFIX_LENGTH 40
+void ParagraphCache::rememberLastCached(const SkString& text) {
+    SkAutoMutexExclusive lock(fLastCachedMutex);
+    if (text.size() < NOCACHE_PREFIX_LENGTH) {
+        // Too short to be compared with
+        fLastCachedPrefix.reset();
+        fLastCachedSuffix.reset();
+        return;
+    }
+    fLastCachedPrefix.set(text.c_str(), NOCACHE_PREFIX_LENGTH);
+    fLastCachedSuffix.set(text.c_str() + text.size() - NOCACHE_PREFIX_LENGTH,
+                          NOCACHE_PREFIX_LENGTH);
+}
+
 bool ParagraphCache::isPossiblyTextEditing(ParagraphImpl* paragraph) {
-    if (fLastCachedValue == nullptr) {
+    SkAutoMutexExclusive lock(fLastCachedMutex);
+    if (fLastCachedPrefix.isEmpty()) {
         return false;
     }
 
-    auto& lastText = fLastCachedValue->fKey.text();
     auto& text = paragraph->fText;
 
-    if ((lastText.size() < NOCACHE_PREFIX_LENGTH) || (text.size() < NOCACHE_PREFIX_LENGTH)) {
-        // Either last text or the current are too short
+    if (text.size() < NOCACHE_PREFIX_LENGTH) {
+        // The current text is too short
         return false;
     }
 
-    if (std::strncmp(lastText.c_str(), text.c_str(), NOCACHE_PREFIX_LENGTH) == 0) {
+    if (std::strncmp(fLastCachedPrefix.c_str(), text.c_str(), NOCACHE_PREFIX_LENGTH) == 0) {
         // Texts have the same starts
         return true;
     }
 
-    if (std::strncmp(lastText.c_str() + lastText.size() - NOCACHE_PREFIX_LENGTH, &text[text.size() - NOCACHE_PREFIX_LENGTH], NOCACHE_PREFIX_LENGTH) == 0) {
+    if (std::strncmp(fLastCachedSuffix.c_str(), &text[text.size() - NOCACHE_PREFIX_LENGTH], NOCACHE_PREFIX_LENGTH) == 0) {
         // Texts have the same ends
         return true;
     }
@@ -22,6 +22,7 @@
 #include "modules/skunicode/include/SkUnicode.h"
 #include "tools/fonts/FontToolUtils.h"
 #include "src/base/SkUTF.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTextBlobPriv.h"
 
 #include <algorithm>
@@ -112,6 +113,12 @@ SkScalar littleRound(SkScalar a) {
         return SkScalarFloorToScalar(a);
     }
 }
+
+// Shaping replaces soft hyphens with hard ones in the text itself (or the other way around)
+bool has_hyphens(const SkString& text) {
+    return strstr(text.c_str(), "\xC2\xAD") != nullptr ||
+           strstr(text.c_str(), "\xE2\x80\x90") != nullptr;
+}
 }  // namespace
 
 TextRange operator*(const TextRange& a, const TextRange& b) {
@@ -136,6 +143,23 @@ Paragraph::Paragraph(ParagraphStyle style, sk_sp<FontCollection> fonts)
     SkASSERT(fFontCollection);
 }
 
+void Paragraph::LayoutAll(SkSpan<Paragraph* const> paragraphs,
+                          SkSpan<const SkScalar> widths,
+                          SkExecutor* executor) {
+    SkASSERT(paragraphs.size() == widths.size());
+    const int count = SkToInt(std::min(paragraphs.size(), widths.size()));
+    if (executor == nullptr) {
+        for (int i = 0; i < count; ++i) {
+            paragraphs[i]->layout(widths[i]);
+        }
+        return;
+    }
+
+    SkTaskGroup tasks(*executor);
+    tasks.batch(count, [&](int i) { paragraphs[i]->layout(widths[i]); });
+    tasks.wait();
+}
+
 void drawTextWithSoftHyphen(SkCanvas* canvas,
                             const char* text,
                             float x,
@@ -285,6 +309,18 @@ void ParagraphImpl::layout(SkScalar rawWidth) {
         floorWidth = SkScalarFloorToScalar(floorWidth);
     }
 
+    fLinesKeptByLastLayout.reset();
+    if (fPendingEdit.has_value()) {
+        const TextEdit edit = *fPendingEdit;
+        fPendingEdit.reset();
+        if (this->layoutAfterEdit(edit, floorWidth)) {
+            this->finishLayout(floorWidth);
+            return;
+        }
+        // Everything depends on the text
+        fState = kUnknown;
+    }
+
     if ((!SkIsFinite(rawWidth) || fLongestLine <= floorWidth) &&
         fState >= kLineBroken &&
          fLines.size() == 1 && fLines.front().ellipsis() == nullptr) {
@@ -363,6 +399,10 @@ void ParagraphImpl::layout(SkScalar rawWidth) {
         fState = kFormatted;
     }
 
+    this->finishLayout(floorWidth);
+}
+
+void ParagraphImpl::finishLayout(SkScalar floorWidth) {
     this->fOldWidth = floorWidth;
     this->fOldHeight = this->fHeight;
 
@@ -384,7 +424,7 @@ void ParagraphImpl::layout(SkScalar rawWidth) {
         fMaxIntrinsicWidth = fMinIntrinsicWidth;
     }
 
-    //SkDebugf("layout('%s', %f): %f %f\n", fText.c_str(), rawWidth, fMinIntrinsicWidth, fMaxIntrinsicWidth);
+    //SkDebugf("layout('%s', %f): %f %f\n", fText.c_str(), floorWidth, fMinIntrinsicWidth, fMaxIntrinsicWidth);
 }
 
 void ParagraphImpl::paint(SkCanvas* canvas, SkScalar x, SkScalar y) {
@@ -417,6 +457,11 @@ bool ParagraphImpl::computeCodeUnitProperties() {
         return false;
     }
 
+    // The text may have changed since the last time (see updateText)
+    fBidiRegions.clear();
+    fHasLineBreaks = false;
+    fHasWhitespacesInside = false;
+
     // Get bidi regions
     auto textDirection = fParagraphStyle.getTextDirection() == TextDirection::kLtr
                               ? SkUnicode::TextDirection::kLTR
@@ -755,9 +800,14 @@ bool ParagraphImpl::shapeTextIntoEndlessLine() {
     return result;
 }
 
-void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth) {
+void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth, size_t fromLine) {
 
-    if (!fHasLineBreaks &&
+    // Keep the lines above fromLine; the wrapper continues from the state it saved for it
+    SkASSERT(fromLine == 0 || fromLine < SkToSizeT(fLineBreakStates.size()));
+    fLines.pop_back_n(fLines.size() - fromLine);
+
+    if (fromLine == 0 &&
+        !fHasLineBreaks &&
         !fHasWhitespacesInside &&
         fPlaceholders.size() == 1 &&
         fRuns.size() == 1 && fRuns[0].fAdvance.fX <= maxWidth) {
@@ -823,6 +873,7 @@ void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth) {
         fIdeographicBaseline = fLines.empty() ? fEmptyMetrics.ideographicBaseline() : fLines.front().ideographicBaseline();
         fExceededMaxLines = false;
         fHasWordBreaks = false;
+        fLineBreakStates.clear();
         return;
     }
 
@@ -851,7 +902,8 @@ void ParagraphImpl::breakShapedTextIntoLines(SkScalar maxWidth) {
                     line.createEllipsis(maxWidth, this->getEllipsis(), true);
                 }
                 fLongestLine = std::max(fLongestLine, nearlyZero(advance.fX) ? widthWithSpaces : advance.fX);
-            });
+            },
+            fromLine);
 
     fHeight = textWrapper.height();
     fWidth = maxWidth;
@@ -1281,6 +1333,7 @@ void ParagraphImpl::updateFontSize(size_t from, size_t to, SkScalar fontSize) {
   }
 
   fState = std::min(fState, kIndexed);
+  fPendingEdit.reset();
   fOldWidth = 0;
   fOldHeight = 0;
 }
@@ -1315,6 +1368,296 @@ void ParagraphImpl::updateBackgroundPaint(size_t from, size_t to, SkPaint paint)
     }
 }
 
+bool ParagraphImpl::updateText(size_t from, size_t to, const SkString& text) {
+    if (from > to || to > fText.size()) {
+        return false;
+    }
+    // The last placeholder is the fake one that ends the text
+    for (int i = 0; i < fPlaceholders.size() - 1; ++i) {
+        auto range = fPlaceholders[i].fRange;
+        if (range.start < to && from < range.end) {
+            return false;
+        }
+    }
+
+    // The inserted text continues the block before it; the blocks inside the replaced text
+    // shrink to its end
+    const auto length = text.size();
+    auto moveStart = [&](TextIndex index) {
+        if (index < from || index == 0) {
+            return index;
+        }
+        return index < to ? from + length : index - to + from + length;
+    };
+    auto moveEnd = [&](TextIndex index) {
+        if (index < from) {
+            return index;
+        }
+        return index <= to ? from + length : index - to + from + length;
+    };
+
+    TArray<Block, true> blocks;
+    TArray<BlockIndex, true> newBlockIndex;
+    for (auto& block : fTextStyles) {
+        newBlockIndex.push_back(blocks.size());
+        TextRange range(moveStart(block.fRange.start), moveEnd(block.fRange.end));
+        if (block.fStyle.isPlaceholder() && range.width() != block.fRange.width()) {
+            return false;
+        }
+        if (range.width() == 0 && block.fRange.width() != 0 &&
+            (!blocks.empty() || &block != &fTextStyles.back())) {
+            continue;
+        }
+        blocks.emplace_back(range, block.fStyle);
+    }
+    newBlockIndex.push_back(blocks.size());
+    fTextStyles = std::move(blocks);
+
+    TextIndex textBefore = 0;
+    for (auto& placeholder : fPlaceholders) {
+        if (placeholder.fRange.start >= to) {
+            placeholder.fRange = TextRange(placeholder.fRange.start - to + from + length,
+                                           placeholder.fRange.end - to + from + length);
+        }
+        placeholder.fBlocksBefore = BlockRange(newBlockIndex[placeholder.fBlocksBefore.start],
+                                               newBlockIndex[placeholder.fBlocksBefore.end]);
+        placeholder.fTextBefore = TextRange(textBefore, placeholder.fRange.start);
+        textBefore = placeholder.fRange.end;
+    }
+
+    // Shaping may have changed the hyphens in the text the runs were shaped from
+    const bool incremental = fState == kFormatted && !has_hyphens(fText);
+    fText.remove(from, to - from);
+    fText.insert(from, text);
+
+    // Merge the edit with the ones since the last layout
+    if (fPendingEdit.has_value()) {
+        auto& edit = *fPendingEdit;
+        auto oldEnd = to > edit.fNewEnd ? to - edit.fNewEnd + edit.fOldEnd : edit.fOldEnd;
+        auto newEnd = std::max(edit.fNewEnd, to) - to + from + length;
+        edit = {std::min(edit.fStart, from), oldEnd, newEnd};
+    } else if (incremental) {
+        fPendingEdit = TextEdit{from, to, from + length};
+    }
+    fState = kUnknown;
+
+    fWords.clear();
+    fUTF8IndexForUTF16Index.clear();
+    fUTF16IndexForUTF8Index.clear();
+    // SkOnce has no reset
+    new (&fillUTF16MappingOnce) SkOnce();
+    fPicture = nullptr;
+    return true;
+}
+
+// Append the glyphs of run in [glyphs.start:glyphs.end) to runs, moved by textShift in the text
+// and by xShift along the line (slicing the same way OneLineShaper does)
+void ParagraphImpl::appendRunSlice(TArray<Run, false>* runs, const Run& run,
+                                   GlyphRange glyphs, ptrdiff_t textShift, SkScalar xShift) {
+    auto textStart = glyphs.start == 0 ? run.fTextRange.start : run.globalClusterIndex(glyphs.start);
+    auto textEnd = glyphs.end == run.size() ? run.fTextRange.end : run.globalClusterIndex(glyphs.end);
+    auto runAdvance = SkVector::Make(run.posX(glyphs.end) - run.posX(glyphs.start), run.fAdvance.fY);
+    const SkShaper::RunHandler::RunInfo info = {
+            run.fFont,
+            run.fBidiLevel,
+            runAdvance,
+            glyphs.width(),
+            SkShaper::RunHandler::Range(textStart - run.fClusterStart, textEnd - textStart)
+    };
+    auto& piece = runs->emplace_back(this,
+                                     info,
+                                     run.fClusterStart + textShift,
+                                     run.heightMultiplier(),
+                                     run.useHalfLeading(),
+                                     run.baselineShift(),
+                                     runs->size(),
+                                     run.posX(glyphs.start) + xShift);
+    for (size_t i = glyphs.start; i <= glyphs.end; ++i) {
+        auto index = i - glyphs.start;
+        if (i < glyphs.end) {
+            piece.fGlyphs[index] = run.fGlyphs[i];
+            piece.fClusterIndexes[index] = run.fClusterIndexes[i];
+        }
+        piece.fPositions[index] = run.fPositions[i];
+        piece.fOffsets[index] = run.fOffsets[i];
+        piece.addX(index, xShift);
+    }
+}
+
+bool ParagraphImpl::layoutAfterEdit(const TextEdit& edit, SkScalar floorWidth) {
+    if (fRuns.empty() || fLines.empty() || fOldWidth != floorWidth || !SkIsFinite(floorWidth) ||
+        fPlaceholders.size() != 1 || fUnresolvedGlyphs != 0 ||
+        fParagraphStyle.getTextDirection() != TextDirection::kLtr ||
+        fParagraphStyle.effective_align() == TextAlign::kJustify ||
+        !fParagraphStyle.unlimited_lines() || fParagraphStyle.ellipsized() ||
+        has_hyphens(fText)) {
+        return false;
+    }
+    for (auto& block : fTextStyles) {
+        if (!SkScalarNearlyZero(block.fStyle.getLetterSpacing()) ||
+            !SkScalarNearlyZero(block.fStyle.getWordSpacing())) {
+            return false;
+        }
+    }
+    const ptrdiff_t delta = edit.fNewEnd - edit.fOldEnd;
+    const TextIndex oldSize = fText.size() - delta;
+    TextIndex runsEnd = 0;
+    for (auto& run : fRuns) {
+        if (!run.leftToRight() || run.textRange().start != runsEnd) {
+            return false;
+        }
+        runsEnd = run.textRange().end;
+    }
+    if (runsEnd != oldSize) {
+        return false;
+    }
+
+    // Reshape whole words: widen the edit to the spaces around it
+    // (these tables still describe the text of the last layout)
+    auto oldClusterStart = [this](TextIndex index) {
+        return index == 0 ||
+               fClustersIndexFromCodeUnit[index] != fClustersIndexFromCodeUnit[index - 1];
+    };
+    TextIndex start = edit.fStart;
+    while (start > 0 && !(fText.c_str()[start - 1] == ' ' && oldClusterStart(start))) {
+        --start;
+    }
+    TextIndex newEnd = edit.fNewEnd;
+    while (newEnd < fText.size() &&
+           !(fText.c_str()[newEnd] == ' ' && oldClusterStart(newEnd - delta))) {
+        ++newEnd;
+    }
+    const TextIndex oldEnd = newEnd - delta;
+    auto oldPosX = [this, oldSize](TextIndex index) {
+        if (index == oldSize) {
+            return fRuns.back().posX(fRuns.back().size());
+        }
+        auto& cluster = fClusters[fClustersIndexFromCodeUnit[index]];
+        return fRuns[cluster.runIndex()].posX(cluster.startPos());
+    };
+    const SkScalar startX = oldPosX(start);
+    const SkScalar oldEndX = oldPosX(oldEnd);
+
+    // Shape the words on their own
+    TArray<Block, true> windowStyles;
+    for (auto& block : fTextStyles) {
+        auto range = block.fRange * TextRange(start, newEnd);
+        if (range.width() > 0) {
+            windowStyles.emplace_back(range.start - start, range.end - start, block.fStyle);
+        }
+    }
+    const size_t windowSize = newEnd - start;
+    TArray<Placeholder, true> windowPlaceholders;
+    windowPlaceholders.emplace_back(windowSize, windowSize, PlaceholderStyle(),
+                                    fPlaceholders.back().fTextStyle,
+                                    BlockRange(0, windowStyles.size()), TextRange(0, windowSize));
+    ParagraphImpl window(SkString(fText.c_str() + start, windowSize), fParagraphStyle,
+                         std::move(windowStyles), std::move(windowPlaceholders),
+                         fFontCollection, fUnicode);
+    if (windowSize > 0) {
+        if (!window.computeCodeUnitProperties()) {
+            return false;
+        }
+        OneLineShaper shaper(&window);
+        if (!shaper.shape() || shaper.unresolvedGlyphs() != 0) {
+            return false;
+        }
+        for (auto& run : window.fRuns) {
+            if (!run.leftToRight()) {
+                return false;
+            }
+        }
+    }
+    if (!this->computeCodeUnitProperties()) {
+        return false;
+    }
+    for (auto& region : fBidiRegions) {
+        if (region.level % 2 != 0) {
+            return false;
+        }
+    }
+
+    // From here on fRuns is being rebuilt: the runs before the words, the new words and the runs
+    // after them moved by the change in the text and in the width
+    SkScalar windowWidth = 0;
+    for (auto& run : window.fRuns) {
+        windowWidth += run.fAdvance.fX;
+    }
+    const SkScalar shiftX = startX + windowWidth - oldEndX;
+    auto glyphAt = [this](TextIndex index) {
+        return fClusters[fClustersIndexFromCodeUnit[index]].startPos();
+    };
+
+    TArray<Run, false> runs;
+    for (auto& run : fRuns) {
+        if (run.textRange().start >= start) {
+            break;
+        }
+        if (run.textRange().end <= start) {
+            runs.emplace_back(std::move(run));
+        } else {
+            this->appendRunSlice(&runs, run, GlyphRange(0, glyphAt(start)), 0, 0);
+        }
+    }
+    for (auto& run : window.fRuns) {
+        this->appendRunSlice(&runs, run, GlyphRange(0, run.size()), start, startX);
+    }
+    for (auto& run : fRuns) {
+        if (run.textRange().end <= oldEnd) {
+            continue;
+        }
+        if (run.textRange().start < oldEnd) {
+            this->appendRunSlice(&runs, run, GlyphRange(glyphAt(oldEnd), run.size()), delta, shiftX);
+        } else if (run.fGlyphData.use_count() > 1) {
+            // The glyphs are shared with a copy of the run (in ParagraphCache)
+            this->appendRunSlice(&runs, run, GlyphRange(0, run.size()), delta, shiftX);
+        } else {
+            run.fTextRange = TextRange(run.fTextRange.start + delta, run.fTextRange.end + delta);
+            run.fClusterStart += delta;
+            run.fOffset.fX += shiftX;
+            for (auto& position : run.fPositions) {
+                position.fX += shiftX;
+            }
+            runs.emplace_back(std::move(run));
+        }
+    }
+    fRuns.swap(runs);
+
+    fFontSwitches.clear();
+    for (auto& run : fRuns) {
+        run.fIndex = &run - fRuns.begin();
+        fFontSwitches.emplace_back(run.textRange().start, run.font());
+    }
+    fClusters.clear();
+    fClustersIndexFromCodeUnit.clear();
+    fClustersIndexFromCodeUnit.push_back_n(fText.size() + 1, EMPTY_INDEX);
+    this->applySpacingAndBuildClusterTable();
+
+    // The line before the edit may take some of its words, so break the lines again from there
+    size_t fromLine = 0;
+    while (fromLine < SkToSizeT(fLines.size()) && fLines[fromLine].textWithNewlines().end <= start) {
+        ++fromLine;
+    }
+    fromLine = fromLine > 0 ? fromLine - 1 : 0;
+    if (fromLine >= SkToSizeT(fLineBreakStates.size())) {
+        fromLine = 0;
+    }
+
+    this->resetContext();
+    this->resolveStrut();
+    this->computeEmptyMetrics();
+    this->breakShapedTextIntoLines(floorWidth, fromLine);
+    fLinesKeptByLastLayout = fromLine;
+    // The lines we kept may have cached pointers to the old runs
+    for (size_t i = 0; i < fromLine; ++i) {
+        fLines[i].resetTextBlobCache();
+    }
+    this->resetShifts();
+    this->formatLines(fWidth);
+    fState = kFormatted;
+    return true;
+}
+
 TArray<TextIndex> ParagraphImpl::countSurroundingGraphemes(TextRange textRange) const {
     textRange = textRange.intersection({0, fText.size()});
     TArray<TextIndex> graphemes;
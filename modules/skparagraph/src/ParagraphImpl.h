@@ -29,6 +29,7 @@
 #include "src/core/SkTHash.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -136,6 +137,9 @@ public:
         return SkSpan<Placeholder>(fPlaceholders.data(), fPlaceholders.size());
     }
     SkSpan<TextLine> lines() { return SkSpan<TextLine>(fLines.data(), fLines.size()); }
+    // If the last layout only reshaped the words around an edit (see updateText), the number of
+    // lines it kept from the layout before
+    std::optional<size_t> linesKeptByLastLayout() const { return fLinesKeptByLastLayout; }
     const ParagraphStyle& paragraphStyle() const { return fParagraphStyle; }
     SkSpan<Cluster> clusters() { return SkSpan<Cluster>(fClusters.begin(), fClusters.size()); }
     sk_sp<FontCollection> fontCollection() const { return fFontCollection; }
@@ -183,6 +187,7 @@ public:
         if (fState > kIndexed) {
             fState = kIndexed;
         }
+        fPendingEdit.reset();
     }
 
     int32_t unresolvedGlyphs() override;
@@ -201,12 +206,13 @@ public:
     void applySpacingAndBuildClusterTable();
     void buildClusterTable();
     bool shapeTextIntoEndlessLine();
-    void breakShapedTextIntoLines(SkScalar maxWidth);
+    void breakShapedTextIntoLines(SkScalar maxWidth, size_t fromLine = 0);
 
     void updateTextAlign(TextAlign textAlign) override;
     void updateFontSize(size_t from, size_t to, SkScalar fontSize) override;
     void updateForegroundPaint(size_t from, size_t to, SkPaint paint) override;
     void updateBackgroundPaint(size_t from, size_t to, SkPaint paint) override;
+    bool updateText(size_t from, size_t to, const SkString& text) override;
 
     void visit(const Visitor&) override;
     void extendedVisit(const ExtendedVisitor&) override;
@@ -260,6 +266,18 @@ private:
 
     void computeEmptyMetrics();
 
+    // The part of the text changed by updateText() since the last layout: [fStart:fOldEnd) in the
+    // text of the last layout became [fStart:fNewEnd) in the current text
+    struct TextEdit {
+        TextIndex fStart;
+        TextIndex fOldEnd;
+        TextIndex fNewEnd;
+    };
+    bool layoutAfterEdit(const TextEdit& edit, SkScalar floorWidth);
+    void appendRunSlice(skia_private::TArray<Run, false>* runs, const Run& run,
+                        GlyphRange glyphs, ptrdiff_t textShift, SkScalar xShift);
+    void finishLayout(SkScalar floorWidth);
+
     // Input
     skia_private::TArray<StyleBlock<SkScalar>> fLetterSpaceStyles;
     skia_private::TArray<StyleBlock<SkScalar>> fWordSpaceStyles;
@@ -289,6 +307,21 @@ private:
     std::unordered_set<SkUnichar> fUnresolvedCodepoints;
 
     skia_private::TArray<TextLine, false> fLines;   // kFormatted   (cached: width, max lines, ellipsis, text align)
+
+    // The line breaker's state at the start of every line, so it can continue from any of them
+    struct LineBreakState {
+        ClusterIndex fCluster;
+        size_t fPos;
+        SkScalar fHeight;
+        SkScalar fMinIntrinsicWidth;
+        SkScalar fMaxIntrinsicWidth;
+        SkScalar fSoftLineMaxIntrinsicWidth;
+        SkScalar fLongestLine;
+        SkScalar fMaxWidthWithTrailingSpaces;
+    };
+    skia_private::TArray<LineBreakState, true> fLineBreakStates;
+    std::optional<TextEdit> fPendingEdit;
+    std::optional<size_t> fLinesKeptByLastLayout;
     sk_sp<SkPicture> fPicture;          // kRecorded    (cached: text styles)
 
     skia_private::TArray<ResolvedFontDescriptor> fFontSwitches;
@@ -106,6 +106,10 @@ public:
     void paint(ParagraphPainter* painter, SkScalar x, SkScalar y);
     void visit(SkScalar x, SkScalar y);
     void ensureTextBlobCachePopulated();
+    void resetTextBlobCache() {
+        fTextBlobCache.clear();
+        fTextBlobCachePopulated = false;
+    }
 
     void createEllipsis(SkScalar maxWidth, const SkString& ellipsis, bool ltr);
 
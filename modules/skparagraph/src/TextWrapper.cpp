@@ -288,11 +288,17 @@ std::tuple<Cluster*, size_t, SkScalar> TextWrapper::trimStartSpaces(Cluster* end
 // TODO: refactor the code for line ending (with/without ellipsis)
 void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
                                      SkScalar maxWidth,
-                                     const AddLineToParagraph& addLine) {
+                                     const AddLineToParagraph& addLine,
+                                     size_t fromLine) {
     fHeight = 0;
     fMinIntrinsicWidth = std::numeric_limits<SkScalar>::min();
     fMaxIntrinsicWidth = std::numeric_limits<SkScalar>::min();
 
+    auto& states = parent->fLineBreakStates;
+    if (fromLine == 0) {
+        states.clear();
+    }
+
     auto span = parent->clusters();
     if (span.empty()) {
         return;
@@ -313,8 +319,32 @@ void TextWrapper::breakTextIntoLines(ParagraphImpl* parent,
     auto start = span.begin();
     InternalLineMetrics maxRunMetrics;
     bool needEllipsis = false;
+    if (fromLine > 0) {
+        const auto& state = states[fromLine];
+        fEndLine.clean();
+        fEndLine.startFrom(start + state.fCluster, state.fPos);
+        fHeight = state.fHeight;
+        fMinIntrinsicWidth = state.fMinIntrinsicWidth;
+        fMaxIntrinsicWidth = state.fMaxIntrinsicWidth;
+        softLineMaxIntrinsicWidth = state.fSoftLineMaxIntrinsicWidth;
+        parent->fLongestLine = state.fLongestLine;
+        parent->fMaxWidthWithTrailingSpaces = state.fMaxWidthWithTrailingSpaces;
+        fLineNumber = fromLine + 1;
+        firstLine = false;
+        states.pop_back_n(states.size() - fromLine);
+    }
     while (fEndLine.endCluster() != end) {
 
+        SkASSERT(SkToSizeT(states.size()) == parent->lines().size());
+        states.push_back({SkToSizeT(fEndLine.startCluster() - start),
+                          fEndLine.startPos(),
+                          fHeight,
+                          fMinIntrinsicWidth,
+                          fMaxIntrinsicWidth,
+                          softLineMaxIntrinsicWidth,
+                          parent->fLongestLine,
+                          parent->fMaxWidthWithTrailingSpaces});
+
         this->lookAhead(maxWidth, end, parent->getApplyRoundingHack());
 
         auto lastLine = (hasEllipsis && unlimitedLines) || fLineNumber >= maxLines;
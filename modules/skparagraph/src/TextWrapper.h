@@ -179,9 +179,12 @@ public:
                                                   SkVector advance,
                                                   InternalLineMetrics metrics,
                                                   bool addEllipsis)>;
+    // Lines above fromLine are kept as they are, and breaking continues from the state saved
+    // at the start of fromLine by an earlier call
     void breakTextIntoLines(ParagraphImpl* parent,
                             SkScalar maxWidth,
-                            const AddLineToParagraph& addLine);
+                            const AddLineToParagraph& addLine,
+                            size_t fromLine = 0);
 
     SkScalar height() const { return fHeight; }
     SkScalar minIntrinsicWidth() const { return fMinIntrinsicWidth; }
@@ -7,6 +7,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkPaint.h"
@@ -5608,6 +5609,306 @@ UNIX_ONLY_TEST(SkParagraph_CacheStyles, reporter) {
     test(2, false);
 }
 
+UNIX_ONLY_TEST(SkParagraph_CacheLimitsAndStats, reporter) {
+    ParagraphCache cache;
+    cache.turnOn(true);
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setColor(SK_ColorBLACK);
+
+    auto layout = [&](const SkString& text) {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+        builder.pushStyle(text_style);
+        builder.addText(text.c_str(), text.size());
+        builder.pop();
+        auto paragraph = builder.Build();
+        auto impl = static_cast<ParagraphImpl*>(paragraph.get());
+        if (!cache.findParagraph(impl)) {
+            cache.updateParagraph(impl);
+        }
+    };
+
+    layout(SkString("text"));
+    layout(SkString("text"));
+    ParagraphCache::Stats stats = cache.stats();
+    REPORTER_ASSERT(reporter, stats.fRequests == 2);
+    REPORTER_ASSERT(reporter, stats.fHits == 1);
+    REPORTER_ASSERT(reporter, stats.fMisses == 1);
+    REPORTER_ASSERT(reporter, stats.fInsertions == 1);
+    REPORTER_ASSERT(reporter, stats.fEvictions == 0);
+    REPORTER_ASSERT(reporter, stats.fEntries == 1);
+    REPORTER_ASSERT(reporter, stats.fBytes > 0);
+
+    // One entry per shard
+    cache.setLimits(ParagraphCache::kShardCount, ParagraphCache::kDefaultMaxBytes);
+    for (int i = 0; i < 4 * ParagraphCache::kShardCount; ++i) {
+        layout(SkStringPrintf("text %d", i));
+    }
+    stats = cache.stats();
+    REPORTER_ASSERT(reporter, stats.fEntries <= ParagraphCache::kShardCount);
+    REPORTER_ASSERT(reporter, stats.fEntries == cache.count());
+    REPORTER_ASSERT(reporter, stats.fInsertions == 1 + 4 * ParagraphCache::kShardCount);
+    REPORTER_ASSERT(reporter, stats.fEvictions == stats.fInsertions - stats.fEntries);
+
+    // A byte limit below any entry's size still keeps the most recent entry in each shard
+    cache.setLimits(ParagraphCache::kDefaultMaxEntries, 1);
+    layout(SkString("text"));
+    REPORTER_ASSERT(reporter, cache.count() <= ParagraphCache::kShardCount);
+    REPORTER_ASSERT(reporter, cache.stats().fBytes > 0);
+
+    cache.reset();
+    stats = cache.stats();
+    REPORTER_ASSERT(reporter, stats.fRequests == 0 && stats.fEntries == 0 && stats.fBytes == 0);
+}
+
+// Lays out a paragraph after updateText() and checks it against a fresh layout of the same text
+// and styles
+static void check_updated_paragraph(skiatest::Reporter* reporter, Paragraph* paragraph,
+                                    Paragraph* fresh, const SkString& expected, SkScalar width) {
+    paragraph->layout(width);
+    auto impl = static_cast<ParagraphImpl*>(paragraph);
+    auto freshImpl = static_cast<ParagraphImpl*>(fresh);
+
+    REPORTER_ASSERT(reporter, SkString(impl->text().data(), impl->text().size()) == expected);
+    REPORTER_ASSERT(reporter, impl->lines().size() == freshImpl->lines().size());
+    for (size_t i = 0; i < std::min(impl->lines().size(), freshImpl->lines().size()); ++i) {
+        auto& line = impl->lines()[i];
+        auto& freshLine = freshImpl->lines()[i];
+        REPORTER_ASSERT(reporter, line.textWithNewlines() == freshLine.textWithNewlines());
+        REPORTER_ASSERT(reporter, line.clustersWithSpaces() == freshLine.clustersWithSpaces());
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(line.width(), freshLine.width()));
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(line.offset().fY, freshLine.offset().fY));
+    }
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(paragraph->getHeight(), fresh->getHeight()));
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(paragraph->getLongestLine(),
+                                                  fresh->getLongestLine()));
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(paragraph->getMinIntrinsicWidth(),
+                                                  fresh->getMinIntrinsicWidth()));
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(paragraph->getMaxIntrinsicWidth(),
+                                                  fresh->getMaxIntrinsicWidth()));
+    auto boxes = paragraph->getRectsForRange(0, expected.size(), RectHeightStyle::kTight,
+                                             RectWidthStyle::kTight);
+    auto freshBoxes = fresh->getRectsForRange(0, expected.size(), RectHeightStyle::kTight,
+                                              RectWidthStyle::kTight);
+    REPORTER_ASSERT(reporter, boxes.size() == freshBoxes.size());
+    for (size_t i = 0; i < std::min(boxes.size(), freshBoxes.size()); ++i) {
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(boxes[i].rect.fLeft,
+                                                      freshBoxes[i].rect.fLeft));
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(boxes[i].rect.fRight,
+                                                      freshBoxes[i].rect.fRight));
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(boxes[i].rect.fTop,
+                                                      freshBoxes[i].rect.fTop));
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(boxes[i].rect.fBottom,
+                                                      freshBoxes[i].rect.fBottom));
+    }
+}
+
+UNIX_ONLY_TEST(SkParagraph_UpdateText, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+    const SkScalar width = 300;
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setFontSize(20);
+    text_style.setColor(SK_ColorBLACK);
+
+    auto build = [&](const SkString& text) {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+        builder.pushStyle(text_style);
+        builder.addText(text.c_str(), text.size());
+        builder.pop();
+        auto paragraph = builder.Build();
+        paragraph->layout(width);
+        return paragraph;
+    };
+
+    SkString expected;
+    for (int i = 0; i < 4; ++i) {
+        expected.append("The quick brown fox jumps over the lazy dog. ");
+    }
+    auto paragraph = build(expected);
+    auto impl = static_cast<ParagraphImpl*>(paragraph.get());
+
+    auto update = [&](size_t from, size_t to, const char* text) {
+        REPORTER_ASSERT(reporter, paragraph->updateText(from, to, SkString(text)));
+        expected.remove(from, to - from);
+        expected.insert(from, text);
+    };
+    // Every layout after an edit matches the layout of the edited text from scratch, and only
+    // reshapes the words around the edit
+    auto check = [&]() {
+        auto fresh = build(expected);
+        check_updated_paragraph(reporter, paragraph.get(), fresh.get(), expected, width);
+        REPORTER_ASSERT(reporter, impl->linesKeptByLastLayout().has_value());
+        return impl->linesKeptByLastLayout().value_or(0);
+    };
+
+    update(10, 15, "red");                          // "brown" -> "red"
+    REPORTER_ASSERT(reporter, check() == 0);
+    update(90, 90, "extraordinarily ");             // Pushes words down to the next line
+    REPORTER_ASSERT(reporter, check() > 0);
+    update(0, 4, "");                               // At the start
+    REPORTER_ASSERT(reporter, check() == 0);
+    update(expected.size(), expected.size(), "The end.");
+    // The line breaker continues from the line above the edit, which was the last line or the
+    // one before it (if the new text did not fit on the last line)
+    REPORTER_ASSERT(reporter, check() + 2 >= impl->lines().size());
+    update(30, 120, "");                            // Across lines
+    update(5, 5, "very ");                          // Two edits in one layout
+    check();
+
+    // Without an edit, or with a new width, the layout is not incremental
+    paragraph->layout(width);
+    REPORTER_ASSERT(reporter, !impl->linesKeptByLastLayout().has_value());
+    update(5, 9, "");
+    paragraph->layout(width - 50);
+    REPORTER_ASSERT(reporter, !impl->linesKeptByLastLayout().has_value());
+
+    REPORTER_ASSERT(reporter, !paragraph->updateText(5, 2, SkString()));
+    REPORTER_ASSERT(reporter, !paragraph->updateText(0, expected.size() + 1, SkString()));
+}
+
+UNIX_ONLY_TEST(SkParagraph_UpdateTextAcrossStyles, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+    const SkScalar width = 300;
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setFontSize(20);
+    text_style.setColor(SK_ColorBLACK);
+    TextStyle big_style = text_style;
+    big_style.setFontSize(28);
+    big_style.setColor(SK_ColorRED);
+    const TextStyle* styles[] = {&text_style, &big_style};
+
+    // The text, and the style of each of its bytes as an index into styles
+    SkString expected;
+    std::vector<int> expectedStyles;
+    auto append = [&](const char* text, int style) {
+        expected.append(text);
+        expectedStyles.insert(expectedStyles.end(), strlen(text), style);
+    };
+    append("The quick brown fox jumps over the lazy dog. ", 0);
+    append("The quick brown fox jumps over the lazy dog. ", 0);
+    append("The quick brown fox jumps over the lazy dog. ", 1);
+    append("The quick brown fox jumps over the lazy dog. ", 0);
+
+    auto build = [&]() {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+        for (size_t start = 0; start < expected.size();) {
+            size_t end = start;
+            while (end < expected.size() && expectedStyles[end] == expectedStyles[start]) {
+                ++end;
+            }
+            builder.pushStyle(*styles[expectedStyles[start]]);
+            builder.addText(expected.c_str() + start, end - start);
+            builder.pop();
+            start = end;
+        }
+        auto paragraph = builder.Build();
+        paragraph->layout(width);
+        return paragraph;
+    };
+    auto paragraph = build();
+    auto impl = static_cast<ParagraphImpl*>(paragraph.get());
+
+    // The inserted text takes the style of the text before it
+    auto update = [&](size_t from, size_t to, const char* text) {
+        REPORTER_ASSERT(reporter, paragraph->updateText(from, to, SkString(text)));
+        const int style = expectedStyles[from > 0 ? from - 1 : 0];
+        expected.remove(from, to - from);
+        expected.insert(from, text);
+        expectedStyles.erase(expectedStyles.begin() + from, expectedStyles.begin() + to);
+        expectedStyles.insert(expectedStyles.begin() + from, strlen(text), style);
+    };
+    auto check = [&]() {
+        auto fresh = build();
+        check_updated_paragraph(reporter, paragraph.get(), fresh.get(), expected, width);
+        REPORTER_ASSERT(reporter, impl->linesKeptByLastLayout().has_value());
+    };
+    // The big style's text is [bigStart:bigEnd)
+    size_t bigStart, bigEnd;
+    auto findBig = [&]() {
+        bigStart = std::find(expectedStyles.begin(), expectedStyles.end(), 1) -
+                   expectedStyles.begin();
+        bigEnd = std::find(expectedStyles.begin() + bigStart, expectedStyles.end(), 0) -
+                 expectedStyles.begin();
+    };
+
+    findBig();
+    update(bigStart - 6, bigStart + 4, "");         // Deletes across the start of the big text
+    check();
+    findBig();
+    update(bigEnd - 3, bigEnd + 6, "grey ");        // Replaces across its end
+    check();
+    findBig();
+    update(bigStart, bigStart, "new ");             // Inserts in front of it, in the small style
+    check();
+    findBig();
+    update(bigStart + 2, bigStart + 2, "big ");     // Inserts inside it
+    check();
+    findBig();
+    update(bigStart - 2, bigEnd + 2, " ");          // Removes it, merging the text around it
+    check();
+    REPORTER_ASSERT(reporter, std::find(expectedStyles.begin(), expectedStyles.end(), 1) ==
+                              expectedStyles.end());
+}
+
+UNIX_ONLY_TEST(SkParagraph_LayoutAll, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setColor(SK_ColorBLACK);
+
+    // Build the same paragraphs twice, laying out one set on this thread and one on a pool
+    constexpr int kCount = 64;
+    std::vector<std::unique_ptr<Paragraph>> serial, parallel;
+    std::vector<Paragraph*> parallelPtrs;
+    std::vector<SkScalar> widths;
+    for (int i = 0; i < kCount; ++i) {
+        SkString text = SkStringPrintf("Paragraph %d is laid out on some thread, "
+                                       "but looks the same as when it is laid out serially.", i);
+        for (auto* paragraphs : {&serial, &parallel}) {
+            ParagraphBuilderImpl builder(paragraph_style, fontCollection, get_unicode());
+            builder.pushStyle(text_style);
+            builder.addText(text.c_str(), text.size());
+            builder.pop();
+            paragraphs->push_back(builder.Build());
+        }
+        parallelPtrs.push_back(parallel.back().get());
+        widths.push_back(100 + i);
+        serial.back()->layout(widths.back());
+    }
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    Paragraph::LayoutAll(parallelPtrs, widths, executor.get());
+
+    for (int i = 0; i < kCount; ++i) {
+        REPORTER_ASSERT(reporter, parallel[i]->lineNumber() == serial[i]->lineNumber());
+        REPORTER_ASSERT(reporter, parallel[i]->getHeight() == serial[i]->getHeight());
+        REPORTER_ASSERT(reporter, parallel[i]->getLongestLine() == serial[i]->getLongestLine());
+    }
+}
+
 UNIX_ONLY_TEST(SkParagraph_ParagraphWithLineBreak, reporter) {
     sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
     SKIP_IF_FONTS_NOT_FOUND(reporter, fontCollection)
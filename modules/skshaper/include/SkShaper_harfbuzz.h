@@ -13,6 +13,7 @@
 #include "modules/skshaper/include/SkShaper.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 
 class SkFontMgr;
@@ -33,6 +34,18 @@ SKSHAPER_API std::unique_ptr<SkShaper::ScriptRunIterator> ScriptRunIterator(cons
                                                                             SkFourByteTag script);
 
 SKSHAPER_API void PurgeCaches();
+
+// Shape runs in scripts that don't join across spaces (Latin, Cyrillic, CJK, ...) one word at a
+// time, reusing the glyphs of up to maxWords recently shaped words. Runs in fonts that substitute
+// or kern the space glyph are still shaped whole. Off (0) by default.
+SKSHAPER_API void SetWordCacheLimit(int maxWords);
+
+struct WordCacheStats {
+    int fWords = 0;        // Words in the cache now
+    uint64_t fHits = 0;    // Words found in the cache
+    uint64_t fMisses = 0;  // Words shaped and added to the cache
+};
+SKSHAPER_API WordCacheStats GetWordCacheStats();
 }  // namespace SkShapers::HB
 
 #endif
@@ -34,6 +34,7 @@
 #include "modules/skunicode/include/SkUnicode.h"
 #include "src/base/SkTDPQueue.h"
 #include "src/base/SkUTF.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkLRUCache.h"
 
 #if !defined(SK_DISABLE_LEGACY_SKSHAPER_FUNCTIONS)
@@ -43,6 +44,8 @@
 #include <hb-ot.h>
 #include <hb.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -65,6 +68,34 @@ using HBBlob   = std::unique_ptr<hb_blob_t  , SkFunctionObject<hb_blob_destroy>
 using HBFace   = std::unique_ptr<hb_face_t  , SkFunctionObject<hb_face_destroy>  >;
 using HBFont   = std::unique_ptr<hb_font_t  , SkFunctionObject<hb_font_destroy>  >;
 using HBBuffer = std::unique_ptr<hb_buffer_t, SkFunctionObject<hb_buffer_destroy>>;
+using HBSet    = std::unique_ptr<hb_set_t   , SkFunctionObject<hb_set_destroy>   >;
+
+// Shapers are often made for a single call (SkParagraph makes one per bidi region), so every
+// thread keeps the buffers of the last few shapers it destroyed to give to the next ones.
+constexpr int kMaxCachedBuffersPerThread = 4;
+
+STArray<kMaxCachedBuffersPerThread, HBBuffer>& thread_buffer_cache() {
+    static thread_local STArray<kMaxCachedBuffersPerThread, HBBuffer> gBuffers;
+    return gBuffers;
+}
+
+HBBuffer acquire_buffer() {
+    auto& buffers = thread_buffer_cache();
+    if (buffers.empty()) {
+        return HBBuffer(hb_buffer_create());
+    }
+    HBBuffer buffer = std::move(buffers.back());
+    buffers.pop_back();
+    return buffer;
+}
+
+void release_buffer(HBBuffer buffer) {
+    auto& buffers = thread_buffer_cache();
+    if (buffer && buffers.size() < kMaxCachedBuffersPerThread) {
+        hb_buffer_reset(buffer.get());
+        buffers.push_back(std::move(buffer));
+    }
+}
 
 using SkUnicodeBreak = std::unique_ptr<SkBreakIterator>;
 
@@ -627,6 +658,7 @@ public:
     ShaperHarfBuzz(sk_sp<SkUnicode>,
                    HBBuffer,
                    sk_sp<SkFontMgr>);
+    ~ShaperHarfBuzz() override { release_buffer(std::move(fBuffer)); }
 
 protected:
     sk_sp<SkUnicode> fUnicode;
@@ -640,6 +672,27 @@ protected:
                     const FontRunIterator&,
                     const Feature*, size_t featuresSize) const;
 private:
+    ShapedRun shapeUncached(const char* utf8, size_t utf8Bytes,
+                            const char* utf8Start,
+                            const char* utf8End,
+                            const BiDiRunIterator&,
+                            const LanguageRunIterator&,
+                            const ScriptRunIterator&,
+                            const FontRunIterator&,
+                            const Feature*, size_t featuresSize) const;
+    // Shape the run word by word, reusing the words in the word cache. Returns a run with no
+    // glyphs if the run has to be shaped as a whole.
+    ShapedRun shapeByWords(const char* utf8,
+                           const char* utf8Start,
+                           const char* utf8End,
+                           const BiDiRunIterator&,
+                           const LanguageRunIterator&,
+                           const ScriptRunIterator&,
+                           const FontRunIterator&,
+                           hb_language_t,
+                           const Feature*, size_t featuresSize) const;
+    hb_language_t language(const LanguageRunIterator&) const;
+
     const sk_sp<SkFontMgr> fFontMgr; // for fallback
     HBBuffer               fBuffer;
     hb_language_t          fUndefinedLanguage;
@@ -1243,8 +1296,10 @@ void ShapeDontWrapOrReorder::wrap(char const * const utf8, size_t utf8Bytes,
 
 class HBLockedFaceCache {
 public:
-    HBLockedFaceCache(SkLRUCache<SkTypefaceID, HBFont>& lruCache, SkMutex& mutex)
-        : fLRUCache(lruCache), fMutex(mutex)
+    HBLockedFaceCache(SkLRUCache<SkTypefaceID, HBFont>& lruCache,
+                      SkLRUCache<SkTypefaceID, bool>& wordCacheable,
+                      SkMutex& mutex)
+        : fLRUCache(lruCache), fWordCacheable(wordCacheable), fMutex(mutex)
     {
         fMutex.acquire();
     }
@@ -1262,28 +1317,331 @@ public:
     HBFont* insert(SkTypefaceID fontId, HBFont hbFont) {
         return fLRUCache.insert(fontId, std::move(hbFont));
     }
+    bool* findWordCacheable(SkTypefaceID fontId) {
+        return fWordCacheable.find(fontId);
+    }
+    void insertWordCacheable(SkTypefaceID fontId, bool wordCacheable) {
+        fWordCacheable.insert(fontId, wordCacheable);
+    }
     void reset() {
         fLRUCache.reset();
+        fWordCacheable.reset();
     }
 private:
     SkLRUCache<SkTypefaceID, HBFont>& fLRUCache;
+    SkLRUCache<SkTypefaceID, bool>& fWordCacheable;
     SkMutex& fMutex;
 };
 static HBLockedFaceCache get_hbFace_cache() {
     static SkMutex gHBFaceCacheMutex;
     static SkLRUCache<SkTypefaceID, HBFont> gHBFaceCache(100);
-    return HBLockedFaceCache(gHBFaceCache, gHBFaceCacheMutex);
+    static SkLRUCache<SkTypefaceID, bool> gHBWordCacheable(100);
+    return HBLockedFaceCache(gHBFaceCache, gHBWordCacheable, gHBFaceCacheMutex);
+}
+
+// The shaped glyphs of single words (and of the runs of spaces between them), for
+// SkShapers::HB::SetWordCacheLimit. A word is keyed by everything that goes into hb_shape.
+struct WordKey {
+    SkFont fFont;
+    hb_script_t fScript;
+    hb_language_t fLanguage;
+    hb_direction_t fDirection;
+    STArray<2, std::pair<SkFourByteTag, uint32_t>> fFeatures;
+    SkString fText;
+    uint32_t fHash;
+
+    bool operator==(const WordKey& that) const {
+        return fHash == that.fHash &&
+               fFont == that.fFont &&
+               fScript == that.fScript &&
+               fLanguage == that.fLanguage &&
+               fDirection == that.fDirection &&
+               fFeatures == that.fFeatures &&
+               fText == that.fText;
+    }
+    struct Hash {
+        uint32_t operator()(const WordKey& key) const { return key.fHash; }
+    };
+};
+
+struct ShapedWord {
+    std::unique_ptr<ShapedGlyph[]> fGlyphs;
+    size_t fNumGlyphs;
+    SkVector fAdvance;
+};
+
+// Longer words are shaped without going through the cache
+constexpr size_t kMaxCachedWordBytes = 64;
+
+std::atomic<int> gWordCacheLimit{0};
+
+class HBLockedWordCache {
+public:
+    HBLockedWordCache(SkLRUCache<WordKey, ShapedWord, WordKey::Hash>& lruCache,
+                      SkShapers::HB::WordCacheStats& stats,
+                      SkMutex& mutex)
+        : fLRUCache(lruCache), fStats(stats), fMutex(mutex)
+    {
+        fMutex.acquire();
+    }
+    HBLockedWordCache(const HBLockedWordCache&) = delete;
+    HBLockedWordCache& operator=(const HBLockedWordCache&) = delete;
+    HBLockedWordCache& operator=(HBLockedWordCache&&) = delete;
+
+    ~HBLockedWordCache() {
+        fMutex.release();
+    }
+
+    ShapedWord* find(const WordKey& key) {
+        ShapedWord* word = fLRUCache.find(key);
+        if (word) {
+            fStats.fHits++;
+        } else {
+            fStats.fMisses++;
+        }
+        return word;
+    }
+    ShapedWord* insert(const WordKey& key, ShapedWord word) {
+        return fLRUCache.insert(key, std::move(word));
+    }
+    void setMaxCount(int maxCount) {
+        fLRUCache.setMaxCount(maxCount);
+    }
+    void reset() {
+        fLRUCache.reset();
+    }
+    SkShapers::HB::WordCacheStats stats() const {
+        SkShapers::HB::WordCacheStats stats = fStats;
+        stats.fWords = fLRUCache.count();
+        return stats;
+    }
+private:
+    SkLRUCache<WordKey, ShapedWord, WordKey::Hash>& fLRUCache;
+    SkShapers::HB::WordCacheStats& fStats;
+    SkMutex& fMutex;
+};
+static HBLockedWordCache get_word_cache() {
+    static SkMutex gWordCacheMutex;
+    static SkLRUCache<WordKey, ShapedWord, WordKey::Hash> gWordCache(1);
+    static SkShapers::HB::WordCacheStats gWordCacheStats;
+    return HBLockedWordCache(gWordCache, gWordCacheStats, gWordCacheMutex);
+}
+
+// Scripts whose shaping does not join, reorder or kern glyphs across the spaces between words.
+// Runs in other scripts (Arabic, the Indic scripts, ...) are always shaped as a whole.
+bool script_is_word_cacheable(hb_script_t script) {
+    switch (script) {
+        case HB_SCRIPT_COMMON:
+        case HB_SCRIPT_INHERITED:
+        case HB_SCRIPT_LATIN:
+        case HB_SCRIPT_CYRILLIC:
+        case HB_SCRIPT_GREEK:
+        case HB_SCRIPT_ARMENIAN:
+        case HB_SCRIPT_GEORGIAN:
+        case HB_SCRIPT_HAN:
+        case HB_SCRIPT_HIRAGANA:
+        case HB_SCRIPT_KATAKANA:
+        case HB_SCRIPT_HANGUL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Whether no lookup of the typeface's GSUB and GPOS tables involves the space glyph, so that
+// shaping does not join, substitute or kern glyphs across the spaces between words. Fonts that may
+// be shaped with a legacy 'kern' table or with AAT tables are taken to kern across spaces.
+bool typeface_is_word_cacheable(const SkTypeface& typeface) {
+    HBLockedFaceCache cache = get_hbFace_cache();
+    SkTypefaceID dataId = typeface.uniqueID();
+    if (bool* wordCacheable = cache.findWordCacheable(dataId)) {
+        return *wordCacheable;
+    }
+    HBFont* typefaceFont = cache.find(dataId);
+    if (!typefaceFont) {
+        typefaceFont = cache.insert(dataId, create_typeface_hb_font(typeface));
+    }
+    if (!*typefaceFont) {
+        return false;
+    }
+
+    bool wordCacheable = true;
+    hb_face_t* face = hb_font_get_face(typefaceFont->get());
+    if (typeface.getTableSize(SkSetFourByteTag('m','o','r','x')) ||
+        typeface.getTableSize(SkSetFourByteTag('k','e','r','x')) ||
+        (typeface.getTableSize(SkSetFourByteTag('k','e','r','n')) &&
+         !hb_ot_layout_has_positioning(face)))
+    {
+        wordCacheable = false;
+    }
+    const hb_codepoint_t space = typeface.unicharToGlyph(' ');
+    HBSet glyphs(hb_set_create());
+    for (hb_tag_t table : {HB_OT_TAG_GSUB, HB_OT_TAG_GPOS}) {
+        unsigned lookupCount = hb_ot_layout_table_get_lookup_count(face, table);
+        for (unsigned i = 0; i < lookupCount && wordCacheable; ++i) {
+            hb_set_clear(glyphs.get());
+            hb_ot_layout_lookup_collect_glyphs(face, table, i, glyphs.get(), glyphs.get(),
+                                               glyphs.get(), glyphs.get());
+            wordCacheable = !hb_set_has(glyphs.get(), space);
+        }
+    }
+    cache.insertWordCacheable(dataId, wordCacheable);
+    return wordCacheable;
+}
+
+hb_language_t ShaperHarfBuzz::language(const LanguageRunIterator& language) const {
+    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
+    // The user must provide a language, but may provide data hb_language_from_string cannot use.
+    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
+    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
+    if (hbLanguage == HB_LANGUAGE_INVALID) {
+        hbLanguage = fUndefinedLanguage;
+    }
+    return hbLanguage;
 }
 
 ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
-                                  size_t const utf8Bytes,
-                                  char const * const utf8Start,
-                                  char const * const utf8End,
-                                  const BiDiRunIterator& bidi,
-                                  const LanguageRunIterator& language,
-                                  const ScriptRunIterator& script,
-                                  const FontRunIterator& font,
-                                  Feature const * const features, size_t const featuresSize) const
+                                size_t const utf8Bytes,
+                                char const * const utf8Start,
+                                char const * const utf8End,
+                                const BiDiRunIterator& bidi,
+                                const LanguageRunIterator& language,
+                                const ScriptRunIterator& script,
+                                const FontRunIterator& font,
+                                Feature const * const features,
+                                size_t const featuresSize) const
+{
+    if (gWordCacheLimit.load(std::memory_order_relaxed) > 0 && utf8Start < utf8End) {
+        ShapedRun run = this->shapeByWords(utf8, utf8Start, utf8End, bidi, language, script, font,
+                                           this->language(language), features, featuresSize);
+        if (run.fNumGlyphs > 0) {
+            return run;
+        }
+    }
+    return this->shapeUncached(utf8, utf8Bytes, utf8Start, utf8End, bidi, language, script, font,
+                               features, featuresSize);
+}
+
+ShapedRun ShaperHarfBuzz::shapeByWords(char const * const utf8,
+                                       char const * const utf8Start,
+                                       char const * const utf8End,
+                                       const BiDiRunIterator& bidi,
+                                       const LanguageRunIterator& language,
+                                       const ScriptRunIterator& script,
+                                       const FontRunIterator& font,
+                                       hb_language_t hbLanguage,
+                                       Feature const * const features,
+                                       size_t const featuresSize) const
+{
+    const size_t utf8runLength = utf8End - utf8Start;
+    ShapedRun empty(RunHandler::Range(utf8Start - utf8, utf8runLength),
+                    font.currentFont(), bidi.currentLevel(), nullptr, 0);
+
+    hb_script_t hbScript = hb_script_from_iso15924_tag((hb_tag_t)script.currentScript());
+    if (!script_is_word_cacheable(hbScript) ||
+        !typeface_is_word_cacheable(*font.currentFont().getTypeface()))
+    {
+        return empty;
+    }
+    // The words are shaped without the text around them, so only features that apply to the
+    // whole run can be applied to each of them
+    STArray<2, Feature> wordFeatures;
+    WordKey key;
+    for (const auto& feature : SkSpan(features, featuresSize)) {
+        if (feature.end < SkTo<size_t>(utf8Start - utf8) ||
+                          SkTo<size_t>(utf8End   - utf8)  <= feature.start)
+        {
+            continue;
+        }
+        if (!(feature.start <= SkTo<size_t>(utf8Start - utf8) &&
+                               SkTo<size_t>(utf8End   - utf8) <= feature.end))
+        {
+            return empty;
+        }
+        wordFeatures.push_back({feature.tag, feature.value, 0, SIZE_MAX});
+        key.fFeatures.push_back({feature.tag, feature.value});
+    }
+    key.fFont = font.currentFont();
+    key.fScript = hbScript;
+    key.fLanguage = hbLanguage;
+    key.fDirection = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR : HB_DIRECTION_RTL;
+    uint32_t baseHash = SkGoodHash()(key.fFont.getTypeface() ? key.fFont.getTypeface()->uniqueID()
+                                                             : 0);
+    for (SkScalar value : {key.fFont.getSize(), key.fFont.getScaleX(), key.fFont.getSkewX()}) {
+        baseHash = SkChecksum::Hash32(&value, sizeof(value), baseHash);
+    }
+    for (uint32_t value : {(uint32_t)hbScript, (uint32_t)key.fDirection,
+                           (uint32_t)key.fFont.getEdging(), (uint32_t)key.fFont.getHinting()}) {
+        baseHash = SkChecksum::Hash32(&value, sizeof(value), baseHash);
+    }
+    for (const auto& feature : key.fFeatures) {
+        baseHash = SkChecksum::Hash32(&feature, sizeof(feature), baseHash);
+    }
+
+    STArray<64, ShapedGlyph> glyphs;
+    SkVector advance = {0, 0};
+    const char* wordStart = utf8Start;
+    while (wordStart < utf8End) {
+        // A word is a run of spaces or a run of anything else
+        const bool spaces = *wordStart == ' ';
+        const char* wordEnd = wordStart + 1;
+        while (wordEnd < utf8End && (*wordEnd == ' ') == spaces) {
+            ++wordEnd;
+        }
+        const size_t wordLength = wordEnd - wordStart;
+        const uint32_t clusterShift = wordStart - utf8;
+
+        auto append = [&](const ShapedGlyph* wordGlyphs, size_t count, SkVector wordAdvance) {
+            for (size_t i = 0; i < count; ++i) {
+                ShapedGlyph& glyph = glyphs.push_back(wordGlyphs[i]);
+                glyph.fCluster += clusterShift;
+            }
+            advance += wordAdvance;
+        };
+
+        const bool cacheable = wordLength <= kMaxCachedWordBytes;
+        if (cacheable) {
+            key.fText.set(wordStart, wordLength);
+            key.fHash = SkChecksum::Hash32(wordStart, wordLength, baseHash);
+            HBLockedWordCache cache = get_word_cache();
+            if (ShapedWord* word = cache.find(key)) {
+                append(word->fGlyphs.get(), word->fNumGlyphs, word->fAdvance);
+                wordStart = wordEnd;
+                continue;
+            }
+        }
+
+        ShapedRun run = this->shapeUncached(wordStart, wordLength, wordStart, wordEnd,
+                                            bidi, language, script, font,
+                                            wordFeatures.data(), wordFeatures.size());
+        if (run.fNumGlyphs == 0) {
+            return empty;
+        }
+        append(run.fGlyphs.get(), run.fNumGlyphs, run.fAdvance);
+        if (cacheable) {
+            HBLockedWordCache cache = get_word_cache();
+            cache.insert(key, {std::move(run.fGlyphs), run.fNumGlyphs, run.fAdvance});
+        }
+        wordStart = wordEnd;
+    }
+
+    // Words are shaped in logical order, as are the glyphs of a whole run
+    std::unique_ptr<ShapedGlyph[]> runGlyphs(new ShapedGlyph[glyphs.size()]);
+    std::copy(glyphs.begin(), glyphs.end(), runGlyphs.get());
+    return ShapedRun(RunHandler::Range(utf8Start - utf8, utf8runLength), font.currentFont(),
+                     bidi.currentLevel(), std::move(runGlyphs), glyphs.size(), advance);
+}
+
+ShapedRun ShaperHarfBuzz::shapeUncached(char const * const utf8,
+                                          size_t const utf8Bytes,
+                                          char const * const utf8Start,
+                                          char const * const utf8End,
+                                          const BiDiRunIterator& bidi,
+                                          const LanguageRunIterator& language,
+                                          const ScriptRunIterator& script,
+                                          const FontRunIterator& font,
+                                          Feature const * const features,
+                                          size_t const featuresSize) const
 {
     size_t utf8runLength = utf8End - utf8Start;
     ShapedRun run(RunHandler::Range(utf8Start - utf8, utf8runLength),
@@ -1316,14 +1674,7 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     hb_direction_t direction = is_LTR(bidi.currentLevel()) ? HB_DIRECTION_LTR:HB_DIRECTION_RTL;
     hb_buffer_set_direction(buffer, direction);
     hb_buffer_set_script(buffer, hb_script_from_iso15924_tag((hb_tag_t)script.currentScript()));
-    // Buffers with HB_LANGUAGE_INVALID race since hb_language_get_default is not thread safe.
-    // The user must provide a language, but may provide data hb_language_from_string cannot use.
-    // Use "und" for the undefined language in this case (RFC5646 4.1 5).
-    hb_language_t hbLanguage = hb_language_from_string(language.currentLanguage(), -1);
-    if (hbLanguage == HB_LANGUAGE_INVALID) {
-        hbLanguage = fUndefinedLanguage;
-    }
-    hb_buffer_set_language(buffer, hbLanguage);
+    hb_buffer_set_language(buffer, this->language(language));
     hb_buffer_guess_segment_properties(buffer);
 
     // TODO: better cache HBFace (data) / hbfont (typeface)
@@ -1484,7 +1835,7 @@ std::unique_ptr<SkShaper> ShaperDrivenWrapper(sk_sp<SkUnicode> unicode,
     if (!unicode) {
         return nullptr;
     }
-    HBBuffer buffer(hb_buffer_create());
+    HBBuffer buffer = acquire_buffer();
     if (!buffer) {
         SkDEBUGF("Could not create hb_buffer");
         return nullptr;
@@ -1498,7 +1849,7 @@ std::unique_ptr<SkShaper> ShapeThenWrap(sk_sp<SkUnicode> unicode,
     if (!unicode) {
         return nullptr;
     }
-    HBBuffer buffer(hb_buffer_create());
+    HBBuffer buffer = acquire_buffer();
     if (!buffer) {
         SkDEBUGF("Could not create hb_buffer");
         return nullptr;
@@ -1512,7 +1863,7 @@ std::unique_ptr<SkShaper> ShapeDontWrapOrReorder(sk_sp<SkUnicode> unicode,
     if (!unicode) {
         return nullptr;
     }
-    HBBuffer buffer(hb_buffer_create());
+    HBBuffer buffer = acquire_buffer();
     if (!buffer) {
         SkDEBUGF("Could not create hb_buffer");
         return nullptr;
@@ -1532,7 +1883,27 @@ std::unique_ptr<SkShaper::ScriptRunIterator> ScriptRunIterator(const char* utf8,
 }
 
 void PurgeCaches() {
-    HBLockedFaceCache cache = get_hbFace_cache();
+    {
+        HBLockedFaceCache cache = get_hbFace_cache();
+        cache.reset();
+    }
+    HBLockedWordCache cache = get_word_cache();
     cache.reset();
 }
+
+void SetWordCacheLimit(int maxWords) {
+    maxWords = std::max(maxWords, 0);
+    HBLockedWordCache cache = get_word_cache();
+    gWordCacheLimit.store(maxWords, std::memory_order_relaxed);
+    if (maxWords == 0) {
+        cache.reset();
+    } else {
+        cache.setMaxCount(maxWords);
+    }
+}
+
+WordCacheStats GetWordCacheStats() {
+    HBLockedWordCache cache = get_word_cache();
+    return cache.stats();
+}
 }  // namespace SkShapers::HB
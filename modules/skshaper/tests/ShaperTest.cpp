@@ -17,12 +17,16 @@
 #include "modules/skshaper/include/SkShaper_skunicode.h"
 #include "modules/skunicode/include/SkUnicode.h"
 #include "src/base/SkZip.h"
+#include "src/core/SkPointPriv.h"
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 #if defined(SK_UNICODE_ICU_IMPLEMENTATION)
 #include "modules/skunicode/include/SkUnicode_icu.h"
@@ -226,6 +230,50 @@ void cluster_test(skiatest::Reporter* reporter, const char* resource) {
     shaper_test(reporter, resource, data.get());
 }
 
+// Collects the glyphs of every run, with their clusters and positions, and the run advances.
+struct GlyphCollector final : public SkShaper::RunHandler {
+    std::vector<SkGlyphID> fGlyphs;
+    std::vector<SkPoint> fPositions;
+    std::vector<uint32_t> fClusters;
+    std::vector<SkVector> fAdvances;
+
+    void beginLine() override {}
+    void runInfo(const SkShaper::RunHandler::RunInfo& info) override {}
+    void commitRunInfo() override {}
+    SkShaper::RunHandler::Buffer runBuffer(const SkShaper::RunHandler::RunInfo& info) override {
+        const size_t start = fGlyphs.size();
+        fGlyphs.resize(start + info.glyphCount);
+        fPositions.resize(start + info.glyphCount);
+        fClusters.resize(start + info.glyphCount);
+        return SkShaper::RunHandler::Buffer{fGlyphs.data() + start,
+                                            fPositions.data() + start,
+                                            nullptr,
+                                            fClusters.data() + start,
+                                            {0, 0}};
+    }
+    void commitRunBuffer(const RunInfo& info) override { fAdvances.push_back(info.fAdvance); }
+    void commitLine() override {}
+};
+
+void check_same_glyphs(skiatest::Reporter* reporter,
+                       const GlyphCollector& a,
+                       const GlyphCollector& b) {
+    REPORTER_ASSERT(reporter, a.fGlyphs == b.fGlyphs);
+    REPORTER_ASSERT(reporter, a.fClusters == b.fClusters);
+    REPORTER_ASSERT(reporter, a.fPositions.size() == b.fPositions.size());
+    for (size_t i = 0; i < std::min(a.fPositions.size(), b.fPositions.size()); ++i) {
+        REPORTER_ASSERT(reporter, SkPointPriv::EqualsWithinTolerance(a.fPositions[i],
+                                                                     b.fPositions[i]),
+                        "glyph %zu", i);
+    }
+    REPORTER_ASSERT(reporter, a.fAdvances.size() == b.fAdvances.size());
+    for (size_t i = 0; i < std::min(a.fAdvances.size(), b.fAdvances.size()); ++i) {
+        REPORTER_ASSERT(reporter, SkPointPriv::EqualsWithinTolerance(a.fAdvances[i],
+                                                                     b.fAdvances[i]),
+                        "run %zu", i);
+    }
+}
+
 #endif  // defined(SK_SHAPER_HARFBUZZ_AVAILABLE) && defined(SK_SHAPER_UNICODE_AVAILABLE)
 
 }  // namespace
@@ -234,6 +282,96 @@ void cluster_test(skiatest::Reporter* reporter, const char* resource) {
 
 DEF_TEST(Shaper_cluster_empty, r) { shaper_test(r, "empty", SkData::MakeEmpty().get()); }
 
+// The word cache and its counters are shared by the whole process, so this runs alone; shaping
+// in other tests would otherwise go through the cache while it is on here.
+DEF_SERIAL_TEST(Shaper_word_cache, r) {
+    auto unicode = get_unicode();
+    if (!unicode) {
+        ERRORF(r, "Could not create unicode.");
+        return;
+    }
+    auto shaper = SkShapers::HB::ShapeDontWrapOrReorder(unicode, SkFontMgr::RefEmpty());
+    // Ahem has no GSUB or GPOS table; SpaceKern kerns "A" against the space on either side of it.
+    sk_sp<SkTypeface> typeface = ToolUtils::CreateTypefaceFromResource("fonts/ahem.ttf");
+    sk_sp<SkTypeface> spaceKern = ToolUtils::CreateTypefaceFromResource("fonts/SpaceKern.ttf");
+    if (!shaper || !typeface || !spaceKern) {
+        ERRORF(r, "Could not create shaper or typeface.");
+        return;
+    }
+    SkFont font(typeface, 20);
+
+    auto shape = [&](const char* utf8, SkFourByteTag script, uint8_t bidiLevel) {
+        const size_t utf8Bytes = strlen(utf8);
+        auto fontIterator = SkShaper::TrivialFontRunIterator(font, utf8Bytes);
+        auto bidiIterator = SkShaper::TrivialBiDiRunIterator(bidiLevel, utf8Bytes);
+        auto scriptIterator = SkShaper::TrivialScriptRunIterator(script, utf8Bytes);
+        auto languageIterator = SkShaper::TrivialLanguageRunIterator("und", utf8Bytes);
+        GlyphCollector glyphs;
+        shaper->shape(utf8, utf8Bytes, fontIterator, bidiIterator, scriptIterator,
+                      languageIterator, nullptr, 0, SK_ScalarInfinity, &glyphs);
+        return glyphs;
+    };
+    constexpr SkFourByteTag latn = SkSetFourByteTag('l','a','t','n');
+    constexpr SkFourByteTag arab = SkSetFourByteTag('a','r','a','b');
+    const char* latin = "Sphinx of black quartz,  judge my vow. Sphinx of black quartz!";
+    const char* arabic = "\xd8\xb3\xd9\x84\xd8\xa7\xd9\x85 \xd8\xb9\xd9\x84\xd9\x8a\xd9\x83\xd9\x85";
+
+    const char* kerned = "A A";
+
+    SkShapers::HB::SetWordCacheLimit(0);
+    const GlyphCollector latinWhole = shape(latin, latn, 0);
+    const GlyphCollector arabicWhole = shape(arabic, arab, 1);
+    font.setTypeface(spaceKern);
+    const GlyphCollector kernedWhole = shape(kerned, latn, 0);
+    font.setTypeface(typeface);
+    REPORTER_ASSERT(r, !latinWhole.fGlyphs.empty());
+
+    // Word by word, the glyphs are the same as shaping the whole run, both when the words are
+    // shaped and added to the cache and when they are found in it.
+    SkShapers::HB::SetWordCacheLimit(100);
+    SkShapers::HB::WordCacheStats stats = SkShapers::HB::GetWordCacheStats();
+    check_same_glyphs(r, shape(latin, latn, 0), latinWhole);
+    SkShapers::HB::WordCacheStats newStats = SkShapers::HB::GetWordCacheStats();
+    // "Sphinx", " ", "of", " ", "black", " ", "quartz,", "  ", "judge", ...: 21 words, 10 of them
+    // different, so the repeated ones are found in the cache
+    REPORTER_ASSERT(r, newStats.fWords == 10, "%d", newStats.fWords);
+    REPORTER_ASSERT(r, newStats.fMisses - stats.fMisses == 10);
+    REPORTER_ASSERT(r, newStats.fHits - stats.fHits == 11);
+
+    stats = newStats;
+    check_same_glyphs(r, shape(latin, latn, 0), latinWhole);
+    newStats = SkShapers::HB::GetWordCacheStats();
+    REPORTER_ASSERT(r, newStats.fMisses == stats.fMisses);
+    REPORTER_ASSERT(r, newStats.fHits - stats.fHits == 21);
+
+    // Arabic runs are shaped as a whole, without the cache.
+    stats = newStats;
+    check_same_glyphs(r, shape(arabic, arab, 1), arabicWhole);
+    newStats = SkShapers::HB::GetWordCacheStats();
+    REPORTER_ASSERT(r, newStats.fWords == stats.fWords);
+    REPORTER_ASSERT(r, newStats.fMisses == stats.fMisses);
+    REPORTER_ASSERT(r, newStats.fHits == stats.fHits);
+
+    // So are runs in fonts whose lookups involve the space, which word by word would lose the
+    // kerning between the spaces and the "A"s.
+    font.setTypeface(spaceKern);
+    check_same_glyphs(r, shape(kerned, latn, 0), kernedWhole);
+    font.setTypeface(typeface);
+    newStats = SkShapers::HB::GetWordCacheStats();
+    REPORTER_ASSERT(r, newStats.fWords == stats.fWords);
+    REPORTER_ASSERT(r, newStats.fMisses == stats.fMisses);
+    REPORTER_ASSERT(r, newStats.fHits == stats.fHits);
+
+    // A smaller limit evicts the least recently used words, and shaping still works past it.
+    SkShapers::HB::SetWordCacheLimit(3);
+    REPORTER_ASSERT(r, SkShapers::HB::GetWordCacheStats().fWords == 3);
+    check_same_glyphs(r, shape(latin, latn, 0), latinWhole);
+    REPORTER_ASSERT(r, SkShapers::HB::GetWordCacheStats().fWords == 3);
+
+    SkShapers::HB::SetWordCacheLimit(0);
+    REPORTER_ASSERT(r, SkShapers::HB::GetWordCacheStats().fWords == 0);
+}
+
 #define SHAPER_TEST(X) DEF_TEST(Shaper_cluster_ ## X, r) { cluster_test(r, "text/" #X ".txt"); }
 SHAPER_TEST(arabic)
 SHAPER_TEST(armenian)
@@ -7,7 +7,13 @@
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkTemplates.h"
 #include "modules/skunicode/include/SkUnicode.h"
+#include "modules/skunicode/src/SkUnicodePriv.h"
 #include "src/base/SkBitmaskEnum.h"
+#include "src/base/SkUTF.h"
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+#include <cstdint>
 
 using namespace skia_private;
 
@@ -71,3 +77,80 @@ bool SkUnicode::hasControlFlag(SkUnicode::CodeUnitFlags flags) {
 bool SkUnicode::hasPartOfWhiteSpaceBreakFlag(SkUnicode::CodeUnitFlags flags) {
     return (flags & SkUnicode::kPartOfWhiteSpaceBreak) == SkUnicode::kPartOfWhiteSpaceBreak;
 }
+
+void SkUnicodePriv::ComputeCharacterFlags(SkUnicode* unicode, char utf8[], int utf8Units,
+                                          bool replaceTabs, bool ideographic,
+                                          TArray<SkUnicode::CodeUnitFlags, true>* results) {
+    using CodeUnitFlags = SkUnicode::CodeUnitFlags;
+    SkASSERT(results->size() == utf8Units + 1);
+
+    auto flagsOf = [&](SkUnichar unichar) {
+        CodeUnitFlags flags = SkUnicode::kNoCodeUnitFlag;
+        if (unicode->isTabulation(unichar)) {
+            flags |= SkUnicode::kTabulation;
+        }
+        if (unicode->isSpace(unichar)) {
+            flags |= SkUnicode::kPartOfIntraWordBreak;
+        }
+        if (unicode->isWhitespace(unichar)) {
+            flags |= SkUnicode::kPartOfWhiteSpaceBreak;
+        }
+        if (unicode->isControl(unichar)) {
+            flags |= SkUnicode::kControl;
+        }
+        if (ideographic && unicode->isIdeographic(unichar)) {
+            flags |= SkUnicode::kIdeographic;
+        }
+        return flags;
+    };
+    // The flags of the ASCII characters, looked up the first time each one is seen.
+    static constexpr uint16_t kUnknown = 0xFFFF;
+    uint16_t asciiFlags[128];
+    std::fill(std::begin(asciiFlags), std::end(asciiFlags), kUnknown);
+    auto asciiFlagsOf = [&](uint8_t c) {
+        if (asciiFlags[c] == kUnknown) {
+            asciiFlags[c] = flagsOf(c);
+        }
+        return (CodeUnitFlags)asciiFlags[c];
+    };
+    // Letters, digits and punctuation have none of the flags, whichever SkUnicode this is.
+    auto isPrintableAscii = [](auto c) { return (c > 0x20) & (c < 0x7F); };
+
+    const char* current = utf8;
+    const char* end = utf8 + utf8Units;
+    while (current < end) {
+        using U8 = skvx::Vec<16, uint8_t>;
+        while (end - current >= 16 && all(isPrintableAscii(U8::Load(current)))) {
+            current += 16;
+        }
+        while (current < end && isPrintableAscii((uint8_t)*current)) {
+            ++current;
+        }
+        if (current == end) {
+            break;
+        }
+
+        auto before = current - utf8;
+        CodeUnitFlags flags;
+        if ((uint8_t)*current < 0x80) {
+            flags = asciiFlagsOf(*current++);
+        } else {
+            SkUnichar unichar = SkUTF::NextUTF8(&current, end);
+            flags = flagsOf(unichar < 0 ? 0xFFFD : unichar);
+        }
+        auto after = current - utf8;
+        if (flags & SkUnicode::kTabulation) {
+            if (replaceTabs) {
+                (*results)[before] |= SkUnicode::kTabulation;
+                utf8[before] = ' ';
+                flags = asciiFlagsOf(' ');
+            }
+            flags &= ~SkUnicode::kTabulation;
+        }
+        if (flags != SkUnicode::kNoCodeUnitFlag) {
+            for (auto i = before; i < after; ++i) {
+                (*results)[i] |= flags;
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#ifndef SkUnicodePriv_DEFINED
+#define SkUnicodePriv_DEFINED
+
+#include "include/private/base/SkTArray.h"
+#include "modules/skunicode/include/SkUnicode.h"
+
+namespace SkUnicodePriv {
+// Adds the kPartOfIntraWordBreak, kPartOfWhiteSpaceBreak, kControl and (if ideographic)
+// kIdeographic flags of every code point in utf8 to results, which must already hold
+// utf8Units + 1 flags. If replaceTabs, tabs are flagged kTabulation and replaced by spaces.
+// Runs of printable ASCII are skipped in bulk. For the computeCodeUnitFlags implementations.
+void ComputeCharacterFlags(SkUnicode* unicode, char utf8[], int utf8Units, bool replaceTabs,
+                           bool ideographic,
+                           skia_private::TArray<SkUnicode::CodeUnitFlags, true>* results);
+}  // namespace SkUnicodePriv
+
+#endif  // SkUnicodePriv_DEFINED
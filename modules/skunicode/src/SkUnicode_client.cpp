@@ -13,6 +13,7 @@
 #include "include/private/base/SkTo.h"
 #include "modules/skunicode/include/SkUnicode.h"
 #include "modules/skunicode/src/SkBidiFactory_icu_subset.h"
+#include "modules/skunicode/src/SkUnicodePriv.h"
 #include "modules/skunicode/src/SkUnicode_hardcoded.h"
 #include "modules/skunicode/src/SkUnicode_icu_bidi.h"
 #include "src/base/SkBitmaskEnum.h"
@@ -123,32 +124,8 @@ public:
         for (auto& grapheme : fData->fGraphemeBreaks) {
             (*results)[grapheme] |= CodeUnitFlags::kGraphemeStart;
         }
-        const char* current = utf8;
-        const char* end = utf8 + utf8Units;
-        while (current < end) {
-            auto before = current - utf8;
-            SkUnichar unichar = SkUTF::NextUTF8(&current, end);
-            if (unichar < 0) unichar = 0xFFFD;
-            auto after = current - utf8;
-            if (replaceTabs && this->isTabulation(unichar)) {
-                results->at(before) |= SkUnicode::kTabulation;
-                if (replaceTabs) {
-                    unichar = ' ';
-                    utf8[before] = ' ';
-                }
-            }
-            for (auto i = before; i < after; ++i) {
-                if (this->isSpace(unichar)) {
-                    results->at(i) |= SkUnicode::kPartOfIntraWordBreak;
-                }
-                if (this->isWhitespace(unichar)) {
-                    results->at(i) |= SkUnicode::kPartOfWhiteSpaceBreak;
-                }
-                if (this->isControl(unichar)) {
-                    results->at(i) |= SkUnicode::kControl;
-                }
-            }
-        }
+        SkUnicodePriv::ComputeCharacterFlags(this, utf8, utf8Units, replaceTabs,
+                                             /*ideographic=*/false, results);
         return true;
     }
 
@@ -17,6 +17,7 @@
 #include "include/private/base/SkTo.h"
 #include "modules/skunicode/include/SkUnicode.h"
 #include "modules/skunicode/src/SkBidiFactory_icu_full.h"
+#include "modules/skunicode/src/SkUnicodePriv.h"
 #include "modules/skunicode/src/SkUnicode_icu_bidi.h"
 #include "modules/skunicode/src/SkUnicode_icupriv.h"
 #include "src/base/SkBitmaskEnum.h"
@@ -587,35 +588,8 @@ public:
             (*results)[pos] |= CodeUnitFlags::kGraphemeStart;
         });
 
-        const char* current = utf8;
-        const char* end = utf8 + utf8Units;
-        while (current < end) {
-            auto before = current - utf8;
-            SkUnichar unichar = SkUTF::NextUTF8(&current, end);
-            if (unichar < 0) unichar = 0xFFFD;
-            auto after = current - utf8;
-            if (replaceTabs && this->isTabulation(unichar)) {
-                results->at(before) |= SkUnicode::kTabulation;
-                if (replaceTabs) {
-                    unichar = ' ';
-                    utf8[before] = ' ';
-                }
-            }
-            for (auto i = before; i < after; ++i) {
-                if (this->isSpace(unichar)) {
-                    results->at(i) |= SkUnicode::kPartOfIntraWordBreak;
-                }
-                if (this->isWhitespace(unichar)) {
-                    results->at(i) |= SkUnicode::kPartOfWhiteSpaceBreak;
-                }
-                if (this->isControl(unichar)) {
-                    results->at(i) |= SkUnicode::kControl;
-                }
-                if (this->isIdeographic(unichar)) {
-                    results->at(i) |= SkUnicode::kIdeographic;
-                }
-            }
-        }
+        SkUnicodePriv::ComputeCharacterFlags(this, utf8, utf8Units, replaceTabs,
+                                             /*ideographic=*/true, results);
 
         return true;
     }
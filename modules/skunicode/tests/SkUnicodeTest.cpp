@@ -10,6 +10,7 @@
 #include "include/core/SkString.h"
 #include "include/core/SkTypeface.h"
 #include "src/base/SkBitmaskEnum.h"
+#include "src/base/SkUTF.h"
 #include "tests/Test.h"
 
 #include "modules/skunicode/include/SkUnicode.h"
@@ -366,3 +367,41 @@ UNIX_ONLY_TEST(SkUnicode_ICU4X_Ideographic, reporter) {
     SkUnicode_Ideographic(icu.get(), reporter);
 }
 #endif
+
+DEF_TEST_UNICODES(SkUnicode_CodeUnitFlagsLongText, reporter) {
+    if (!unicode) {
+        return;
+    }
+    // Long runs of printable ASCII around tabs, spaces, controls and multi-byte characters, so
+    // that the flags are computed both in bulk and one code point at a time.
+    SkString text("Lorem ipsum dolor sit amet,\tconsectetur\x01 adipiscing elit. "
+                  "\xE4\xB8\xAD\xE6\x96\x87 sed do eiusmod tempor incididunt\xE2\x80\x83ut labore\t");
+    SkString original = text;
+    TArray<SkUnicode::CodeUnitFlags, true> results;
+    REPORTER_ASSERT(reporter, unicode->computeCodeUnitFlags(text.data(), text.size(),
+                                                            /*replaceTabs=*/true, &results));
+    REPORTER_ASSERT(reporter, results.size() == SkToInt(text.size()) + 1);
+
+    const char* current = original.c_str();
+    const char* end = current + original.size();
+    while (current < end) {
+        size_t before = current - original.c_str();
+        SkUnichar unichar = SkUTF::NextUTF8(&current, end);
+        size_t after = current - original.c_str();
+        bool tab = unicode->isTabulation(unichar);
+        REPORTER_ASSERT(reporter, SkUnicode::hasTabulationFlag(results[before]) == tab);
+        if (tab) {
+            REPORTER_ASSERT(reporter, text[before] == ' ');
+            unichar = ' ';
+        }
+        for (size_t i = before; i < after; ++i) {
+            REPORTER_ASSERT(reporter, SkUnicode::hasPartOfWhiteSpaceBreakFlag(results[i]) ==
+                                      unicode->isWhitespace(unichar));
+            REPORTER_ASSERT(reporter, SkUnicode::hasControlFlag(results[i]) ==
+                                      unicode->isControl(unichar));
+            REPORTER_ASSERT(reporter,
+                            SkToBool(results[i] & SkUnicode::kPartOfIntraWordBreak) ==
+                            unicode->isSpace(unichar));
+        }
+    }
+}
@@ -4,6 +4,9 @@
 #include "src/base/SkUTF.h"
 
 #include "include/private/base/SkTFitsIn.h"
+#include "src/base/SkVx.h"
+
+#include <cstdint>
 
 static constexpr inline int32_t left_shift(int32_t value, int32_t shift) {
     return (int32_t) ((uint32_t) value << shift);
@@ -42,6 +45,15 @@ static bool utf8_type_is_valid_leading_byte(int type) { return type > 0; }
 
 static bool utf8_byte_is_continuation(uint8_t c) { return utf8_byte_type(c) == 0; }
 
+// Text is mostly ASCII, so the loops below first skip as much of it as they can 16 bytes (or 8
+// UTF-16 code units) at a time. CountUTF16 can skip anything but surrogates the same way.
+using U8x16 = skvx::Vec<16, uint8_t>;
+using U16x8 = skvx::Vec<8, uint16_t>;
+
+static bool utf8_is_ascii(const U8x16& v) { return all(v < 0x80); }
+
+static bool utf16_is_ascii(const U16x8& v) { return all(v < 0x80); }
+
 ////////////////////////////////////////////////////////////////////////////////
 
 int SkUTF::CountUTF8(const char* utf8, size_t byteLength) {
@@ -51,6 +63,13 @@ int SkUTF::CountUTF8(const char* utf8, size_t byteLength) {
     int count = 0;
     const char* stop = utf8 + byteLength;
     while (utf8 < stop) {
+        while (stop - utf8 >= 16 && utf8_is_ascii(U8x16::Load(utf8))) {
+            utf8 += 16;
+            count += 16;
+        }
+        if (utf8 == stop) {
+            break;
+        }
         int type = utf8_byte_type(*(const uint8_t*)utf8);
         if (!utf8_type_is_valid_leading_byte(type) || utf8 + type > stop) {
             return -1;  // Sequence extends beyond end.
@@ -75,6 +94,13 @@ int SkUTF::CountUTF16(const uint16_t* utf16, size_t byteLength) {
     const uint16_t* stop = src + (byteLength >> 1);
     int count = 0;
     while (src < stop) {
+        while (stop - src >= 8 && all((U16x8::Load(src) & 0xF800) != 0xD800)) {
+            src += 8;
+            count += 8;
+        }
+        if (src == stop) {
+            break;
+        }
         unsigned c = *src++;
         if (utf16_is_low_surrogate(c)) {
             return -1;
@@ -265,6 +291,21 @@ int SkUTF::UTF8ToUTF16(uint16_t dst[], int dstCapacity, const char src[], size_t
     uint16_t* endDst = dst + dstCapacity;
     const char* endSrc = src + srcByteLength;
     while (src < endSrc) {
+        while (endSrc - src >= 16 && (!dst || endDst - dst >= 16)) {
+            U8x16 ascii = U8x16::Load(src);
+            if (!utf8_is_ascii(ascii)) {
+                break;
+            }
+            if (dst) {
+                skvx::cast<uint16_t>(ascii).store(dst);
+                dst += 16;
+            }
+            src += 16;
+            dstLength += 16;
+        }
+        if (src == endSrc) {
+            break;
+        }
         SkUnichar uni = NextUTF8(&src, endSrc);
         if (uni < 0) {
             return -1;
@@ -297,6 +338,21 @@ int SkUTF::UTF16ToUTF8(char dst[], int dstCapacity, const uint16_t src[], size_t
     const char* endDst = dst + dstCapacity;
     const uint16_t* endSrc = src + srcLength;
     while (src < endSrc) {
+        while (endSrc - src >= 8 && (!dst || endDst - dst >= 8)) {
+            U16x8 ascii = U16x8::Load(src);
+            if (!utf16_is_ascii(ascii)) {
+                break;
+            }
+            if (dst) {
+                skvx::cast<uint8_t>(ascii).store(dst);
+                dst += 8;
+            }
+            src += 8;
+            dstLength += 8;
+        }
+        if (src == endSrc) {
+            break;
+        }
         SkUnichar uni = NextUTF16(&src, endSrc);
         if (uni < 0) {
             return -1;
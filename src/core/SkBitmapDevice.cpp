@@ -31,6 +31,7 @@
 #include "include/private/base/SkTo.h"
 #include "src/base/SkTLazy.h"
 #include "src/core/SkDraw.h"
+#include "src/core/SkImageInfoPriv.h"
 #include "src/core/SkImagePriv.h"
 #include "src/core/SkMatrixPriv.h"
 #include "src/core/SkRasterClip.h"
@@ -566,6 +567,57 @@ void SkBitmapDevice::drawAtlas(const SkRSXform xform[],
     BDDraw(this).drawAtlas(xform, tex, colors, count, std::move(blender), paint);
 }
 
+void SkBitmapDevice::drawEdgeAAImageSet(const SkCanvas::ImageSetEntry images[], int count,
+                                        const SkPoint dstClips[], const SkMatrix preViewMatrices[],
+                                        const SkSamplingOptions& sampling, const SkPaint& paint,
+                                        SkCanvas::SrcRectConstraint constraint) {
+    if (paint.getShader() || paint.getMaskFilter() || SkDrawTiler::NeedsTiling(this)) {
+        this->SkDevice::drawEdgeAAImageSet(images, count, dstClips, preViewMatrices, sampling,
+                                           paint, constraint);
+        return;
+    }
+
+    // An entry can share a pipeline with its neighbours when drawing it through a clamped shader
+    // over the whole image matches what drawImageRect would do: no dst clip, and a src rect that
+    // either fills the image or may be sampled outside of (fast constraint).
+    auto canBatch = [constraint](const SkCanvas::ImageSetEntry& entry) {
+        if (entry.fHasClip || SkColorTypeIsAlphaOnly(entry.fImage->colorType())) {
+            return false;
+        }
+        const SkRect bounds = SkRect::Make(entry.fImage->bounds());
+        return bounds.contains(entry.fSrcRect) &&
+               (constraint == SkCanvas::kFast_SrcRectConstraint ||
+                entry.fSrcRect.contains(bounds));
+    };
+
+    int clipIndex = 0;
+    for (int i = 0; i < count;) {
+        // Only consecutive entries are grouped so that overlapping entries keep their draw order.
+        int runEnd = i + 1;
+        if (canBatch(images[i])) {
+            while (runEnd < count && images[runEnd].fImage == images[i].fImage &&
+                   canBatch(images[runEnd])) {
+                ++runEnd;
+            }
+        }
+
+        SkBitmap bitmap;
+        // TODO: Elevate direct context requirement to public API and remove cheat.
+        auto dContext = as_IB(images[i].fImage.get())->directContext();
+        if (runEnd - i > 1 && as_IB(images[i].fImage.get())->getROPixels(dContext, &bitmap)) {
+            BDDraw(this).drawImageSet(bitmap, images + i, runEnd - i, preViewMatrices, sampling,
+                                      paint);
+        } else {
+            this->SkDevice::drawEdgeAAImageSet(images + i, runEnd - i, dstClips + clipIndex,
+                                               preViewMatrices, sampling, paint, constraint);
+            for (int j = i; j < runEnd; ++j) {
+                clipIndex += images[j].fHasClip ? 4 : 0;
+            }
+        }
+        i = runEnd;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkBitmapDevice::drawSpecial(SkSpecialImage* src,
@@ -82,6 +82,11 @@ public:
     void drawAtlas(const SkRSXform[], const SkRect[], const SkColor[], int count, sk_sp<SkBlender>,
                    const SkPaint&) override;
 
+    void drawEdgeAAImageSet(const SkCanvas::ImageSetEntry[], int count,
+                            const SkPoint dstClips[], const SkMatrix preViewMatrices[],
+                            const SkSamplingOptions&, const SkPaint&,
+                            SkCanvas::SrcRectConstraint) override;
+
     ///////////////////////////////////////////////////////////////////////////
 
     void pushClipStack() override;
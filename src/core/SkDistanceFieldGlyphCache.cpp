@@ -0,0 +1,182 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkDistanceFieldGlyphCache.h"
+
+#include "include/core/SkFont.h"
+#include "include/core/SkFontTypes.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/base/SkTArray.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDistanceFieldGen.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkMask.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrikeSpec.h"
+
+#include <cstring>
+#include <utility>
+
+using namespace skia_private;
+
+SkDistanceFieldGlyphCache* SkDistanceFieldGlyphCache::Get() {
+    static SkDistanceFieldGlyphCache* cache = new SkDistanceFieldGlyphCache;
+    return cache;
+}
+
+SkScalar SkDistanceFieldGlyphCache::BucketTextSize(SkScalar deviceTextSize) {
+    // The same buckets as the GPU backends' distance field text.
+    if (deviceTextSize <= 32) {
+        return 32;
+    }
+    if (deviceTextSize <= 72) {
+        return 72;
+    }
+    return 162;
+}
+
+bool SkDistanceFieldGlyphCache::Key::operator==(const Key& that) const {
+    return memcmp(this, &that, sizeof(Key)) == 0;
+}
+
+uint32_t SkDistanceFieldGlyphCache::Key::Hash::operator()(const Key& key) const {
+    return SkChecksum::Hash32(&key, sizeof(Key));
+}
+
+size_t SkDistanceFieldGlyphCache::SizeOf(const Glyph& glyph) {
+    size_t size = sizeof(Glyph);
+    if (glyph.hasDistanceField()) {
+        size += glyph.fBounds.width() * glyph.fBounds.height();
+    }
+    return size;
+}
+
+void SkDistanceFieldGlyphCache::findOrCreate(const SkFont& font,
+                                             SkSpan<const SkGlyphID> glyphIDs,
+                                             SkSpan<sk_sp<Glyph>> glyphs) {
+    SkASSERT(glyphIDs.size() == glyphs.size());
+
+    const auto makeKey = [&](SkGlyphID glyphID) {
+        Key key;
+        key.fTypefaceID = font.getTypeface()->uniqueID();
+        key.fGlyphID = glyphID;
+        key.fSize = font.getSize();
+        key.fScaleX = font.getScaleX();
+        key.fSkewX = font.getSkewX();
+        key.fEmbolden = font.isEmbolden();
+        return key;
+    };
+
+    STArray<64, int> missing;
+    {
+        SkAutoMutexExclusive lock{fMutex};
+        for (size_t i = 0; i < glyphIDs.size(); ++i) {
+            if (sk_sp<Glyph>* glyph = fGlyphs.find(makeKey(glyphIDs[i]))) {
+                glyphs[i] = *glyph;
+            } else {
+                missing.push_back(i);
+            }
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    // Render the missing glyphs without hinting or subpixel positioning, so that the outlines
+    // scale with the text size, and without gamma or contrast, which depend on the destination.
+    SkFont bucketFont = font;
+    bucketFont.setSubpixel(false);
+    bucketFont.setHinting(SkFontHinting::kNone);
+    bucketFont.setBaselineSnap(false);
+    if (bucketFont.getEdging() == SkFont::Edging::kSubpixelAntiAlias) {
+        bucketFont.setEdging(SkFont::Edging::kAntiAlias);
+    }
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(bucketFont, SkPaint(), SkSurfaceProps(),
+                                                     SkScalerContextFlags::kNone, SkMatrix::I());
+    SkBulkGlyphMetricsAndImages images{strikeSpec};
+    for (int i : missing) {
+        const SkGlyph* skGlyph = images.glyph(SkPackedGlyphID{glyphIDs[i]});
+        sk_sp<Glyph> glyph = sk_make_sp<Glyph>();
+        if (!skGlyph->isEmpty()) {
+#if !defined(SK_DISABLE_SDF_TEXT)
+            glyph->fBounds = skGlyph->iRect().makeOutset(SK_DistanceFieldPad, SK_DistanceFieldPad);
+            if (skGlyph->image() != nullptr) {
+                const SkMask mask = skGlyph->mask();
+                std::unique_ptr<uint8_t[]> distances{
+                        new uint8_t[SkComputeDistanceFieldSize(skGlyph->width(),
+                                                               skGlyph->height())]};
+                bool generated = false;
+                switch (mask.fFormat) {
+                    case SkMask::kBW_Format:
+                        generated = SkGenerateDistanceFieldFromBWImage(
+                                distances.get(), mask.fImage,
+                                skGlyph->width(), skGlyph->height(), mask.fRowBytes);
+                        break;
+                    case SkMask::kA8_Format:
+                        generated = SkGenerateDistanceFieldFromA8Image(
+                                distances.get(), mask.fImage,
+                                skGlyph->width(), skGlyph->height(), mask.fRowBytes);
+                        break;
+                    default:
+                        break;
+                }
+                if (generated) {
+                    glyph->fDistances = std::move(distances);
+                }
+            }
+#else
+            glyph->fBounds = skGlyph->iRect();
+#endif
+        }
+        glyphs[i] = glyph;
+    }
+
+    SkAutoMutexExclusive lock{fMutex};
+    for (int i : missing) {
+        const Key key = makeKey(glyphIDs[i]);
+        // Another thread may have made the same glyph in the meantime.
+        if (fGlyphs.find(key) == nullptr) {
+            fGlyphs.insert(key, glyphs[i]);
+            fBytesUsed += SizeOf(*glyphs[i]);
+        }
+    }
+    this->purgeToLimit();
+}
+
+size_t SkDistanceFieldGlyphCache::setByteLimit(size_t bytes) {
+    SkAutoMutexExclusive lock{fMutex};
+    size_t previous = fByteLimit;
+    fByteLimit = bytes;
+    this->purgeToLimit();
+    return previous;
+}
+
+size_t SkDistanceFieldGlyphCache::byteLimit() const {
+    SkAutoMutexExclusive lock{fMutex};
+    return fByteLimit;
+}
+
+size_t SkDistanceFieldGlyphCache::bytesUsed() const {
+    SkAutoMutexExclusive lock{fMutex};
+    return fBytesUsed;
+}
+
+void SkDistanceFieldGlyphCache::purgeAll() {
+    SkAutoMutexExclusive lock{fMutex};
+    fGlyphs.reset();
+    fBytesUsed = 0;
+}
+
+void SkDistanceFieldGlyphCache::purgeToLimit() {
+    // Glyphs still being drawn stay alive through their refs after they are purged.
+    while (fBytesUsed > fByteLimit && fGlyphs.count() > 0) {
+        fBytesUsed -= SizeOf(**fGlyphs.leastRecentlyUsed());
+        fGlyphs.removeLeastRecentlyUsed();
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDistanceFieldGlyphCache_DEFINED
+#define SkDistanceFieldGlyphCache_DEFINED
+
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkSpan.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkLoadUserConfig.h" // IWYU pragma: keep
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkLRUCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class SkFont;
+
+//  SK_DEFAULT_DISTANCE_FIELD_TEXT_CACHE_LIMIT can be set using -D on your compiler commandline, or
+//  by using the defines in SkUserConfig.h
+#ifndef SK_DEFAULT_DISTANCE_FIELD_TEXT_CACHE_LIMIT
+    #define SK_DEFAULT_DISTANCE_FIELD_TEXT_CACHE_LIMIT  (2 * 1024 * 1024)
+#endif
+
+// The signed distance fields the raster backend draws text from when a surface has
+// SkSurfaceProps::kDistanceFieldText_Flag. Each glyph has one distance field per size bucket,
+// rendered at the bucket's text size, which is resampled to draw the glyph at any size, scale or
+// rotation that falls in the bucket. Animating a transform therefore reuses the same few distance
+// fields instead of rasterizing a new strike for every frame, and the cache is bounded in bytes.
+class SkDistanceFieldGlyphCache {
+public:
+    class Glyph : public SkNVRefCnt<Glyph> {
+    public:
+        // The bounds of the distance field, padded by SK_DistanceFieldPad, in pixels of the
+        // bucket's text size relative to the glyph origin.
+        SkIRect fBounds = SkIRect::MakeEmpty();
+        // Null for empty glyphs and for glyphs which can't be drawn from a distance field, like
+        // color glyphs. Those are non-empty, and must be drawn another way.
+        std::unique_ptr<uint8_t[]> fDistances;
+
+        bool isEmpty() const { return fBounds.isEmpty(); }
+        bool hasDistanceField() const { return fDistances != nullptr; }
+    };
+
+    static SkDistanceFieldGlyphCache* Get();
+
+    // Text smaller than this on the device is drawn from masks, which look better that small.
+    static constexpr SkScalar kMinTextSize = 16;
+    // Text larger than this is not drawn from distance fields: it would magnify the largest
+    // field, made at 162, until its corners go round. The GPU backends draw text that large as
+    // paths; this matches the raster limit for paths in SkStrikeSpec::ShouldDrawAsPath.
+    static constexpr SkScalar kMaxTextSize = 256;
+    // The text size to draw distance fields at for text that is deviceTextSize on the device.
+    static SkScalar BucketTextSize(SkScalar deviceTextSize);
+
+    SkDistanceFieldGlyphCache() = default;
+
+    // Fill glyphs with the distance fields of glyphIDs in font, whose size must be a bucket text
+    // size. Distance fields not in the cache are made from the glyph masks of a strike at that
+    // size.
+    void findOrCreate(const SkFont& font,
+                      SkSpan<const SkGlyphID> glyphIDs,
+                      SkSpan<sk_sp<Glyph>> glyphs) SK_EXCLUDES(fMutex);
+
+    size_t setByteLimit(size_t bytes) SK_EXCLUDES(fMutex);
+    size_t byteLimit() const SK_EXCLUDES(fMutex);
+    size_t bytesUsed() const SK_EXCLUDES(fMutex);
+    void purgeAll() SK_EXCLUDES(fMutex);
+
+private:
+    // The glyph and everything about the font that changes the glyph's outline. Four-byte fields
+    // only, so the key has no padding and can be hashed as bytes.
+    struct Key {
+        uint32_t fTypefaceID;
+        uint32_t fGlyphID;
+        float fSize;
+        float fScaleX;
+        float fSkewX;
+        uint32_t fEmbolden;
+
+        bool operator==(const Key& that) const;
+        struct Hash {
+            uint32_t operator()(const Key& key) const;
+        };
+    };
+
+    static size_t SizeOf(const Glyph&);
+    void purgeToLimit() SK_REQUIRES(fMutex);
+
+    mutable SkMutex fMutex;
+    SkLRUCache<Key, sk_sp<Glyph>, Key::Hash> fGlyphs SK_GUARDED_BY(fMutex){INT32_MAX};
+    size_t fBytesUsed SK_GUARDED_BY(fMutex) = 0;
+    size_t fByteLimit SK_GUARDED_BY(fMutex) = SK_DEFAULT_DISTANCE_FIELD_TEXT_CACHE_LIMIT;
+};
+
+#endif  // SkDistanceFieldGlyphCache_DEFINED
@@ -49,6 +49,8 @@ public:
                              const SkPaint& paint) const;
 
     void paintMasks(SkZip<const SkGlyph*, SkPoint> accepted, const SkPaint& paint) const override;
+    void paintDeviceMasks(SkSpan<const SkMask> masks, const SkPaint& paint) const override;
+    SkIRect deviceClipBounds() const override;
 
     void drawPoints(SkCanvas::PointMode, size_t count, const SkPoint[],
                     const SkPaint&, SkDevice*) const;
@@ -59,6 +61,10 @@ public:
                       bool skipColorXform) const;
     void drawAtlas(const SkRSXform[], const SkRect[], const SkColor[], int count,
                    sk_sp<SkBlender>, const SkPaint&);
+    // Draws a run of unclipped image set entries that all sample 'bitmap', building the sampling
+    // pipeline and blitter once and re-binding only the per-entry matrix and alpha.
+    void drawImageSet(const SkBitmap&, const SkCanvas::ImageSetEntry[], int count,
+                      const SkMatrix preViewMatrices[], const SkSamplingOptions&, const SkPaint&);
 
 #if defined(SK_SUPPORT_LEGACY_ALPHA_BITMAP_AS_COVERAGE)
     void drawDevMask(const SkMask& mask, const SkPaint&) const;
@@ -467,6 +467,13 @@ void SkDrawBase::drawPath(const SkPath& origSrcPath, const SkPaint& origPaint,
 void SkDrawBase::paintMasks(SkZip<const SkGlyph*, SkPoint>, const SkPaint&) const {
     SkASSERT(false);
 }
+void SkDrawBase::paintDeviceMasks(SkSpan<const SkMask>, const SkPaint&) const {
+    SkASSERT(false);
+}
+SkIRect SkDrawBase::deviceClipBounds() const {
+    SkASSERT(false);
+    return SkIRect::MakeEmpty();
+}
 void SkDrawBase::drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect*,
                             const SkSamplingOptions&, const SkPaint&) const {
     SkASSERT(false);
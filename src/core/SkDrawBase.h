@@ -122,6 +122,8 @@ public:
 private:
     // not supported
     void paintMasks(SkZip<const SkGlyph*, SkPoint> accepted, const SkPaint& paint) const override;
+    void paintDeviceMasks(SkSpan<const SkMask> masks, const SkPaint& paint) const override;
+    SkIRect deviceClipBounds() const override;
     void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
                     const SkSamplingOptions&, const SkPaint&) const override;
 
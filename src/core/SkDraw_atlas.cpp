@@ -6,6 +6,8 @@
  */
 
 #include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkMatrix.h"
@@ -16,9 +18,11 @@
 #include "include/core/SkRSXform.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTileMode.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkBlendModePriv.h"
 #include "src/core/SkBlenderBase.h"
@@ -27,6 +31,7 @@
 #include "src/core/SkCoreBlitters.h"
 #include "src/core/SkDraw.h"
 #include "src/core/SkEffectPriv.h"
+#include "src/core/SkImagePriv.h"
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkRasterPipeline.h"
 #include "src/core/SkRasterPipelineOpContexts.h"
@@ -43,12 +48,16 @@ class SkBlender;
 class SkBlitter;
 enum class SkBlendMode;
 
-static void fill_rect(const SkMatrix& ctm, const SkRasterClip& rc,
-                      const SkRect& r, SkBlitter* blitter, SkPath* scratchPath) {
+static void fill_rect(const SkMatrix& ctm, const SkRasterClip& rc, const SkRect& r, bool aa,
+                      SkBlitter* blitter, SkPath* scratchPath) {
     if (ctm.rectStaysRect()) {
         SkRect dr;
         ctm.mapRect(&dr, r);
-        SkScan::FillRect(dr, rc, blitter);
+        if (aa) {
+            SkScan::AntiFillRect(dr, rc, blitter);
+        } else {
+            SkScan::FillRect(dr, rc, blitter);
+        }
     } else {
         SkPoint pts[4];
         r.toQuad(pts);
@@ -56,7 +65,11 @@ static void fill_rect(const SkMatrix& ctm, const SkRasterClip& rc,
 
         scratchPath->rewind();
         scratchPath->addPoly(pts, 4, true);
-        SkScan::FillPath(*scratchPath, rc, blitter);
+        if (aa) {
+            SkScan::AntiFillPath(*scratchPath, rc, blitter);
+        } else {
+            SkScan::FillPath(*scratchPath, rc, blitter);
+        }
     }
 }
 
@@ -145,7 +158,97 @@ void SkDraw::drawAtlas(const SkRSXform xform[],
             return;
         }
         if (transformShader->update(inv)) {
-            fill_rect(mx, *fRC, textures[i], blitter, &scratchPath);
+            fill_rect(mx, *fRC, textures[i], /*aa=*/false, blitter, &scratchPath);
+        }
+    }
+}
+
+void SkDraw::drawImageSet(const SkBitmap& bitmap,
+                          const SkCanvas::ImageSetEntry set[],
+                          int count,
+                          const SkMatrix preViewMatrices[],
+                          const SkSamplingOptions& sampling,
+                          const SkPaint& paint) {
+    SkASSERT(!paint.getShader() && !paint.getMaskFilter());
+
+    sk_sp<SkShader> imageShader = SkMakeBitmapShaderForPaint(paint, bitmap,
+                                                             SkTileMode::kClamp,
+                                                             SkTileMode::kClamp,
+                                                             sampling,
+                                                             /*localMatrix=*/nullptr,
+                                                             kNever_SkCopyPixelsMode);
+    if (!imageShader) {
+        return;
+    }
+
+    auto entryCTM = [&](int i) {
+        SkASSERT(set[i].fMatrixIndex < 0 || preViewMatrices);
+        return set[i].fMatrixIndex >= 0
+                ? SkMatrix::Concat(*fCTM, preViewMatrices[set[i].fMatrixIndex])
+                : *fCTM;
+    };
+
+    // The pipeline is built once for the whole run, so it has to be able to handle the most
+    // general entry: perspective if any entry needs it, and an alpha scale if any entry is
+    // translucent.
+    bool perspective = false;
+    bool translucent = false;
+    for (int i = 0; i < count; ++i) {
+        SkASSERT(!set[i].fHasClip);
+        perspective |= entryCTM(i).hasPerspective();
+        translucent |= paint.getAlphaf() * set[i].fAlpha != 1;
+    }
+
+    SkSTArenaAlloc<256> alloc;
+
+    SkPaint p(paint);
+    p.setStyle(SkPaint::kFill_Style);
+    p.setAlphaf(1.f);
+
+    auto transformShader = alloc.make<SkTransformShader>(*as_SB(imageShader), perspective);
+
+    SkRasterPipeline pipeline(&alloc);
+    SkSurfaceProps props = SkSurfacePropsCopyOrDefault(fProps);
+    SkStageRec rec = {&pipeline, &alloc, fDst.colorType(), fDst.colorSpace(),
+                      p.getColor4f(), props};
+    // As with drawAtlas, the CTM is folded into the per-entry matrix.
+    if (!as_SB(transformShader)->appendRootStages(rec, SkMatrix::I())) {
+        return;
+    }
+
+    bool isOpaque = transformShader->isOpaque();
+    float* alphaCtx = nullptr;
+    if (translucent) {
+        // late-bound once for each entry in the loop
+        alphaCtx = alloc.make<float>(1.f);
+        rec.fPipeline->append(SkRasterPipelineOp::scale_1_float, alphaCtx);
+        isOpaque = false;
+    }
+
+    auto blitter = SkCreateRasterPipelineBlitter(fDst, p, pipeline, isOpaque, &alloc,
+                                                 fRC->clipShader());
+    if (!blitter) {
+        return;
+    }
+    SkPath scratchPath;
+
+    for (int i = 0; i < count; ++i) {
+        const SkCanvas::ImageSetEntry& entry = set[i];
+        if (entry.fSrcRect.isEmpty() || entry.fDstRect.isEmpty()) {
+            continue;
+        }
+
+        const SkMatrix ctm = entryCTM(i);
+        SkMatrix mx = SkMatrix::Concat(ctm, SkMatrix::RectToRect(entry.fSrcRect, entry.fDstRect));
+        SkMatrix inv;
+        if (!mx.invert(&inv) || !transformShader->update(inv)) {
+            continue;
+        }
+        if (alphaCtx) {
+            *alphaCtx = paint.getAlphaf() * entry.fAlpha;
         }
+        // Mirrors SkDevice::drawEdgeAAImageSet: only anti-alias when all four edges request it.
+        fill_rect(ctm, *fRC, entry.fDstRect, entry.fAAFlags == SkCanvas::kAll_QuadAAFlags,
+                  blitter, &scratchPath);
     }
 }
@@ -10,6 +10,7 @@
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRegion.h"
+#include "include/core/SkSpan.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkArenaAlloc.h"
@@ -123,6 +124,47 @@ void SkDraw::paintMasks(SkZip<const SkGlyph*, SkPoint> accepted, const SkPaint&
     }
 }
 
+void SkDraw::paintDeviceMasks(SkSpan<const SkMask> masks, const SkPaint& paint) const {
+    // The size used for a typical blitter.
+    SkSTArenaAlloc<3308> alloc;
+    SkBlitter* blitter = SkBlitter::Choose(fDst,
+                                           *fCTM,
+                                           paint,
+                                           &alloc,
+                                           false,
+                                           fRC->clipShader(),
+                                           SkSurfacePropsCopyOrDefault(fProps));
+
+    SkAAClipBlitterWrapper wrapper{*fRC, blitter};
+    blitter = wrapper.getBlitter();
+
+    if (fRC->isBW() && !fRC->isRect()) {
+        for (const SkMask& mask : masks) {
+            SkASSERT(mask.fFormat == SkMask::kA8_Format);
+            for (SkRegion::Cliperator clipper(fRC->bwRgn(), mask.fBounds);
+                 !clipper.done();
+                 clipper.next()) {
+                blitter->blitMask(mask, clipper.rect());
+            }
+        }
+    } else {
+        SkIRect clipBounds = fRC->isBW() ? fRC->bwRgn().getBounds()
+                                         : fRC->aaRgn().getBounds();
+        for (const SkMask& mask : masks) {
+            SkASSERT(mask.fFormat == SkMask::kA8_Format);
+            SkIRect bounds;
+            if (bounds.intersect(mask.fBounds, clipBounds)) {
+                blitter->blitMask(mask, bounds);
+            }
+        }
+    }
+}
+
+SkIRect SkDraw::deviceClipBounds() const {
+    // fRC is in the coordinates of fDst, as is fCTM; under SkDrawTiler both are per tile.
+    return fRC->getBounds();
+}
+
 void SkDraw::drawGlyphRunList(SkCanvas* canvas,
                               SkGlyphRunListPainterCPU* glyphPainter,
                               const sktext::GlyphRunList& glyphRunList,
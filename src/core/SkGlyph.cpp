@@ -363,6 +363,12 @@ size_t SkGlyph::addImageFromBuffer(SkReadBuffer& buffer, SkArenaAlloc* alloc) {
         return 0;
     }
 
+    // A glyph merged more than once keeps its first image.
+    if (fImage != nullptr) {
+        buffer.skipByteArray(nullptr);
+        return 0;
+    }
+
     size_t memoryIncrease = 0;
 
     void* imageData = alloc->makeBytesAlignedTo(this->imageSize(), this->formatAlignment());
@@ -25,6 +25,11 @@
 #include "include/private/base/SkFloatingPoint.h"
 #include "include/private/base/SkSpan_impl.h"
 #include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkArenaAlloc.h"
+#include "src/core/SkDistanceFieldGen.h"
+#include "src/core/SkDistanceFieldGlyphCache.h"
 #include "src/core/SkGlyph.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkScalerContext.h"
@@ -33,6 +38,7 @@
 #include "src/text/GlyphRun.h"
 
 #include <algorithm>
+#include <cmath>
 #include <initializer_list>
 #include <tuple>
 #include <vector>
@@ -160,6 +166,90 @@ prepare_for_direct_mask_drawing(SkStrike* strike,
 
     return {acceptedBuffer.first(acceptedSize), rejectedBuffer.first(rejectedSize)};
 }
+
+#if !defined(SK_DISABLE_SDF_TEXT)
+bool can_draw_from_distance_fields(const SkSurfaceProps& props,
+                                   const SkPaint& paint,
+                                   const SkFont& runFont,
+                                   const SkMatrix& positionMatrix) {
+    const SkScalar deviceTextSize = runFont.getSize() * positionMatrix.getMaxScale();
+    return props.isDistanceFieldText() &&
+           !positionMatrix.hasPerspective() &&
+           paint.getStyle() == SkPaint::kFill_Style &&
+           !paint.getMaskFilter() &&
+           !paint.getPathEffect() &&
+           runFont.getEdging() != SkFont::Edging::kAlias &&
+           SkDistanceFieldGlyphCache::kMinTextSize <= deviceTextSize &&
+           deviceTextSize <= SkDistanceFieldGlyphCache::kMaxTextSize;
+}
+
+// Distance field text too large to draw from the fields is drawn as paths, as on the GPU.
+bool too_large_for_distance_fields(const SkSurfaceProps& props,
+                                   const SkFont& runFont,
+                                   const SkMatrix& positionMatrix) {
+    return props.isDistanceFieldText() &&
+           runFont.getSize() * positionMatrix.getMaxScale() >
+                   SkDistanceFieldGlyphCache::kMaxTextSize;
+}
+
+// Resample the distance field of glyph, mapped to the device by fieldToDevice, into an A8
+// coverage mask of the pixels it touches in clip, if it touches any.
+void make_distance_field_coverage(const SkDistanceFieldGlyphCache::Glyph& glyph,
+                                  const SkMatrix& fieldToDevice,
+                                  const SkIRect& clip,
+                                  SkArenaAlloc* alloc,
+                                  TArray<SkMask>* masks) {
+    SkIRect bounds = fieldToDevice.mapRect(SkRect::Make(glyph.fBounds)).roundOut();
+    SkMatrix deviceToField;
+    if (!bounds.intersect(clip) || !fieldToDevice.invert(&deviceToField)) {
+        return;
+    }
+
+    // Distances are stored in texels of the field. Scale them to device pixels.
+    const float fieldToDeviceScale =
+            std::sqrt(std::abs(fieldToDevice.getScaleX() * fieldToDevice.getScaleY() -
+                               fieldToDevice.getSkewX() * fieldToDevice.getSkewY()));
+    const float distanceScale = SK_DistanceFieldMagnitude / 128.0f * fieldToDeviceScale;
+
+    const int fieldWidth = glyph.fBounds.width();
+    const int fieldHeight = glyph.fBounds.height();
+    const uint8_t* const distances = glyph.fDistances.get();
+    auto texel = [&](int x, int y) -> float {
+        // Everything outside the field is far outside the glyph.
+        return 0 <= x && x < fieldWidth && 0 <= y && y < fieldHeight
+                       ? distances[y * fieldWidth + x]
+                       : 0.0f;
+    };
+
+    // The field position of the first pixel center, relative to the first texel center. The
+    // matrix is affine, so the rest are found by stepping.
+    const SkPoint start = deviceToField.mapPoint({bounds.fLeft + 0.5f, bounds.fTop + 0.5f}) -
+                          SkVector{glyph.fBounds.fLeft + 0.5f, glyph.fBounds.fTop + 0.5f};
+    const SkVector stepX = deviceToField.mapVector(1, 0);
+    const SkVector stepY = deviceToField.mapVector(0, 1);
+
+    uint8_t* const coverage = alloc->makeArrayDefault<uint8_t>(bounds.width() * bounds.height());
+    uint8_t* dst = coverage;
+    for (int y = 0; y < bounds.height(); ++y) {
+        SkPoint p = start + stepY * y;
+        for (int x = 0; x < bounds.width(); ++x, p += stepX) {
+            const float fx = std::floor(p.fX),
+                        fy = std::floor(p.fY);
+            const int ix = (int)fx,
+                      iy = (int)fy;
+            const float tx = p.fX - fx,
+                        ty = p.fY - fy;
+            const float t00 = texel(ix, iy    ), t10 = texel(ix + 1, iy    ),
+                        t01 = texel(ix, iy + 1), t11 = texel(ix + 1, iy + 1);
+            const float top    = t00 + (t10 - t00) * tx,
+                        bottom = t01 + (t11 - t01) * tx;
+            const float distance = (top + (bottom - top) * ty - 128.0f) * distanceScale;
+            *dst++ = (uint8_t)(SkTPin(distance + 0.5f, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+    masks->push_back(SkMask{coverage, bounds, SkTo<uint32_t>(bounds.width()), SkMask::kA8_Format});
+}
+#endif
 }  // namespace
 
 // -- SkGlyphRunListPainterCPU ---------------------------------------------------------------------
@@ -194,6 +284,25 @@ void SkGlyphRunListPainterCPU::drawForBitmapDevice(SkCanvas* canvas,
                           ? fDeviceProps
                           : fBitmapFallbackProps;
 
+    // The glyphs of consecutive runs drawn as masks are collected here and painted together, so
+    // the device sets up its blitter once for all of them instead of once per run. The batch is
+    // painted before anything else is drawn, so glyphs still land in order.
+    STArray<64, const SkGlyph*> maskGlyphs;
+    STArray<64, SkPoint> maskPositions;
+    // Runs with the same font as the previous mask run reuse its strike. Strikes replaced while
+    // their glyphs are still in the batch are kept alive until it is painted.
+    const SkFont* maskFont = nullptr;
+    sk_sp<SkStrike> maskStrike;
+    STArray<2, sk_sp<SkStrike>> retiredMaskStrikes;
+    auto paintMaskBatch = [&]() {
+        if (!maskGlyphs.empty()) {
+            bitmapDevice->paintMasks(SkMakeZip(maskGlyphs, maskPositions), paint);
+            maskGlyphs.clear();
+            maskPositions.clear();
+        }
+        retiredMaskStrikes.clear();
+    };
+
     SkPoint drawOrigin = glyphRunList.origin();
     SkMatrix positionMatrix{drawMatrix};
     positionMatrix.preTranslate(drawOrigin.x(), drawOrigin.y());
@@ -202,7 +311,14 @@ void SkGlyphRunListPainterCPU::drawForBitmapDevice(SkCanvas* canvas,
 
         SkZip<const SkGlyphID, const SkPoint> source = glyphRun.source();
 
-        if (SkStrikeSpec::ShouldDrawAsPath(paint, runFont, positionMatrix)) {
+        bool drawAsPaths = SkStrikeSpec::ShouldDrawAsPath(paint, runFont, positionMatrix);
+#if !defined(SK_DISABLE_SDF_TEXT)
+        drawAsPaths = drawAsPaths ||
+                      too_large_for_distance_fields(fDeviceProps, runFont, positionMatrix);
+#endif
+        if (drawAsPaths) {
+            paintMaskBatch();
+
             auto [strikeSpec, strikeToSourceScale] =
                     SkStrikeSpec::MakePath(runFont, paint, props, fScalerContextFlags);
 
@@ -275,21 +391,77 @@ void SkGlyphRunListPainterCPU::drawForBitmapDevice(SkCanvas* canvas,
                 }
             }
         }
-        if (!source.empty() && !positionMatrix.hasPerspective()) {
-            SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
-                    runFont, paint, props, fScalerContextFlags, positionMatrix);
+#if !defined(SK_DISABLE_SDF_TEXT)
+        if (!source.empty() &&
+            can_draw_from_distance_fields(fDeviceProps, paint, runFont, positionMatrix)) {
+            paintMaskBatch();
+
+            // Draw the glyphs from distance fields made at the bucket's text size, scaled back to
+            // the run's text size and then mapped to the device.
+            const SkScalar bucketSize = SkDistanceFieldGlyphCache::BucketTextSize(
+                    runFont.getSize() * positionMatrix.getMaxScale());
+            SkFont bucketFont = runFont;
+            bucketFont.setSize(bucketSize);
+            const SkScalar bucketToSourceScale = runFont.getSize() / bucketSize;
 
-            auto strike = strikeSpec.findOrCreateStrike();
+            auto glyphIDs = source.get<0>();
+            auto positions = source.get<1>();
+            STArray<64, sk_sp<SkDistanceFieldGlyphCache::Glyph>> fieldGlyphs;
+            fieldGlyphs.resize(glyphIDs.size());
+            SkDistanceFieldGlyphCache::Get()->findOrCreate(bucketFont, glyphIDs, fieldGlyphs);
+
+            SkSTArenaAlloc<4096> coverageAlloc;
+            STArray<64, SkMask> coverageMasks;
+            const SkIRect clip = bitmapDevice->deviceClipBounds();
+            int rejectedSize = 0;
+            for (auto [fieldGlyph, glyphID, pos] : SkMakeZip(fieldGlyphs, glyphIDs, positions)) {
+                if (!SkIsFinite(pos.x(), pos.y()) || fieldGlyph->isEmpty()) {
+                    continue;
+                }
+                if (!fieldGlyph->hasDistanceField()) {
+                    rejectedBuffer[rejectedSize++] = std::make_tuple(glyphID, pos);
+                    continue;
+                }
+                SkMatrix fieldToDevice = positionMatrix;
+                fieldToDevice.preTranslate(pos.x(), pos.y());
+                fieldToDevice.preScale(bucketToSourceScale, bucketToSourceScale);
+                make_distance_field_coverage(
+                        *fieldGlyph, fieldToDevice, clip, &coverageAlloc, &coverageMasks);
+            }
+            if (!coverageMasks.empty()) {
+                bitmapDevice->paintDeviceMasks(coverageMasks, paint);
+            }
+            source = rejectedBuffer.first(rejectedSize);
+        }
+#endif
+        if (!source.empty() && !positionMatrix.hasPerspective()) {
+            if (maskFont == nullptr || *maskFont != runFont) {
+                if (!maskGlyphs.empty() && maskStrike) {
+                    retiredMaskStrikes.push_back(std::move(maskStrike));
+                }
+                SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+                        runFont, paint, props, fScalerContextFlags, positionMatrix);
+                maskStrike = strikeSpec.findOrCreateStrike();
+                maskFont = &runFont;
+            }
 
-            auto [accepted, rejected] = prepare_for_direct_mask_drawing(strike.get(),
-                                                                        positionMatrix,
-                                                                        source,
-                                                                        acceptedBuffer,
-                                                                        rejectedBuffer);
+            // Prepare the glyphs straight into the end of the batch.
+            const int batchSize = maskGlyphs.size();
+            maskGlyphs.resize(batchSize + source.size());
+            maskPositions.resize(batchSize + source.size());
+            auto [accepted, rejected] = prepare_for_direct_mask_drawing(
+                    maskStrike.get(),
+                    positionMatrix,
+                    source,
+                    SkMakeZip(maskGlyphs, maskPositions).subspan(batchSize, source.size()),
+                    rejectedBuffer);
+            maskGlyphs.resize(batchSize + accepted.size());
+            maskPositions.resize(batchSize + accepted.size());
             source = rejected;
-            bitmapDevice->paintMasks(accepted, paint);
         }
         if (!source.empty()) {
+            paintMaskBatch();
+
             std::vector<SkPoint> sourcePositions;
 
             // Create a strike is source space to calculate scale information.
@@ -379,4 +551,5 @@ void SkGlyphRunListPainterCPU::drawForBitmapDevice(SkCanvas* canvas,
         // TODO: have the mask stage above reject the glyphs that are too big, and handle the
         //  rejects in a more sophisticated stage.
     }
+    paintMaskBatch();
 }
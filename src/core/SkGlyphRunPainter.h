@@ -9,6 +9,7 @@
 #define SkGlyphRunPainter_DEFINED
 
 #include "include/core/SkSamplingOptions.h"
+#include "include/core/SkSpan.h"
 #include "include/core/SkSurfaceProps.h"
 #include "src/base/SkZip.h"
 
@@ -23,6 +24,8 @@ class SkPaint;
 enum SkColorType : int;
 enum class SkScalerContextFlags : uint32_t;
 namespace sktext { class GlyphRunList; }
+struct SkIRect;
+struct SkMask;
 struct SkPoint;
 struct SkRect;
 
@@ -36,6 +39,11 @@ public:
 
         virtual void paintMasks(SkZip<const SkGlyph*, SkPoint> accepted,
                                 const SkPaint& paint) const = 0;
+        // Draw A8 coverage masks whose bounds are already in device space.
+        virtual void paintDeviceMasks(SkSpan<const SkMask> masks, const SkPaint& paint) const = 0;
+        // The bounds of the clip, in the device space of the matrix passed to
+        // drawForBitmapDevice. For a layer or a tile this differs from the canvas' clip bounds.
+        virtual SkIRect deviceClipBounds() const = 0;
         virtual void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
                                 const SkSamplingOptions&, const SkPaint&) const = 0;
     };
@@ -11,10 +11,12 @@
 #include "src/core/SkBlitMask.h"
 #include "src/core/SkBlitRow.h"
 #include "src/core/SkCpu.h"
+#include "src/core/SkDistanceFieldGlyphCache.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkMemset.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkRuntimeEffectPriv.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkSwizzlePriv.h"
 #include "src/core/SkTypefaceCache.h"
@@ -69,8 +71,21 @@ int SkGraphics::GetFontCacheCountUsed() {
     return SkStrikeCache::GlobalStrikeCache()->getCacheCountUsed();
 }
 
+size_t SkGraphics::GetDistanceFieldTextCacheLimit() {
+    return SkDistanceFieldGlyphCache::Get()->byteLimit();
+}
+
+size_t SkGraphics::SetDistanceFieldTextCacheLimit(size_t bytes) {
+    return SkDistanceFieldGlyphCache::Get()->setByteLimit(bytes);
+}
+
+size_t SkGraphics::GetDistanceFieldTextCacheUsed() {
+    return SkDistanceFieldGlyphCache::Get()->bytesUsed();
+}
+
 void SkGraphics::PurgeFontCache() {
     SkStrikeCache::GlobalStrikeCache()->purgeAll();
+    SkDistanceFieldGlyphCache::Get()->purgeAll();
     SkTypefaceCache::PurgeAll();
 }
 
@@ -90,6 +105,14 @@ int SkGraphics::SetTypefaceCacheCountLimit(int count) {
     return prev;
 }
 
+int SkGraphics::GetRuntimeEffectCacheCountLimit() {
+    return SkRuntimeEffectPriv::GetCacheCountLimit();
+}
+
+int SkGraphics::SetRuntimeEffectCacheCountLimit(int count) {
+    return SkRuntimeEffectPriv::SetCacheCountLimit(count);
+}
+
 static SkGraphics::OpenTypeSVGDecoderFactory gSVGDecoderFactory = nullptr;
 
 SkGraphics::OpenTypeSVGDecoderFactory
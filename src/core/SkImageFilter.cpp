@@ -248,20 +248,60 @@ skif::FilterResult SkImageFilter_Base::filterImage(const skif::Context& context)
                               context.mapping().layerMatrix(),
                               SkIRect(context.desiredOutput()),
                               srcGenID, srcSubset);
-    if (context.backend()->cache() && context.backend()->cache()->get(key, &result)) {
-        context.markCacheHit();
-        return result;
+    SkImageFilterCache* cache = context.backend()->cache();
+    if (!cache) {
+        return this->onFilterImage(context);
     }
 
-    result = this->onFilterImage(context);
-
-    if (context.backend()->cache()) {
-        context.backend()->cache()->set(key, this, result);
+    SkImageFilterCache::PartialMatch partial;
+    switch (cache->find(key, this, &result, &partial)) {
+        case SkImageFilterCache::Match::kHit:
+            context.markCacheHit();
+            return result;
+        case SkImageFilterCache::Match::kPartialHit:
+            context.markPartialCacheHit();
+            result = this->reusePartialResult(context, result, partial);
+            break;
+        case SkImageFilterCache::Match::kMiss:
+            result = this->onFilterImage(context);
+            break;
     }
 
+    cache->set(key, this, result);
     return result;
 }
 
+skif::FilterResult SkImageFilter_Base::reusePartialResult(
+        const skif::Context& context,
+        const skif::FilterResult& cached,
+        const SkImageFilterCache::PartialMatch& partial) const {
+    // The translation is integral, so this only updates the cached result's metadata.
+    const SkMatrix translate = SkMatrix::Translate(partial.fTranslation.fX,
+                                                   partial.fTranslation.fY);
+    const skif::LayerSpace<SkIRect> covered(partial.fCovered);
+    skif::FilterResult reused =
+            cached.applyTransform(context,
+                                  skif::LayerSpace<SkMatrix>(translate),
+                                  skif::FilterResult::kDefaultSampling)
+                  .applyCrop(context, covered);
+    if (partial.fExposed.isEmpty()) {
+        return reused;
+    }
+
+    // Only filter the newly exposed strip and composite it next to the reused pixels. The two
+    // regions are disjoint, so merging with src-over reproduces the full result.
+    const skif::LayerSpace<SkIRect> exposed(partial.fExposed);
+    const skif::Context exposedContext = context.withNewDesiredOutput(exposed);
+    skif::FilterResult fresh =
+            this->onFilterImage(exposedContext).applyCrop(exposedContext, exposed);
+    if (!fresh) {
+        return reused;
+    } else if (!reused) {
+        return fresh;
+    }
+    return skif::FilterResult::Builder(context).add(reused).add(fresh).merge();
+}
+
 sk_sp<SkImage> SkImageFilter_Base::makeImageWithFilter(sk_sp<skif::Backend> backend,
                                                        sk_sp<SkImage> src,
                                                        const SkIRect& subset,
@@ -7,6 +7,8 @@
 
 #include "src/core/SkImageFilterCache.h"
 
+#include "include/core/SkScalar.h"
+#include "include/private/base/SkFloatingPoint.h"
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkOnce.h"
 #include "src/base/SkTInternalLList.h"
@@ -28,6 +30,61 @@ using namespace skia_private;
 
 namespace {
 
+// Returns true if 'newMatrix' equals 'oldMatrix' followed by an integer translation, which is
+// stored in 'translation'.
+bool is_integer_translation_of(const SkMatrix& newMatrix, const SkMatrix& oldMatrix,
+                               SkIVector* translation) {
+    if (newMatrix.hasPerspective() || oldMatrix.hasPerspective() ||
+        newMatrix.getScaleX() != oldMatrix.getScaleX() ||
+        newMatrix.getSkewX()  != oldMatrix.getSkewX()  ||
+        newMatrix.getSkewY()  != oldMatrix.getSkewY()  ||
+        newMatrix.getScaleY() != oldMatrix.getScaleY()) {
+        return false;
+    }
+    const SkScalar dx = newMatrix.getTranslateX() - oldMatrix.getTranslateX();
+    const SkScalar dy = newMatrix.getTranslateY() - oldMatrix.getTranslateY();
+    const int ix = sk_float_saturate2int(dx);
+    const int iy = sk_float_saturate2int(dy);
+    if ((SkScalar) ix != dx || (SkScalar) iy != dy) {
+        return false;
+    }
+    *translation = {ix, iy};
+    return true;
+}
+
+// Returns the part of 'request' that is not covered by 'covered' (which must be contained in
+// 'request'), if that remainder is a single rectangle. This is the case when a clip shifts along one
+// axis, which is what scrolling produces.
+bool single_exposed_rect(const SkIRect& request, const SkIRect& covered, SkIRect* exposed) {
+    SkASSERT(request.contains(covered));
+    if (covered == request) {
+        *exposed = SkIRect::MakeEmpty();
+        return true;
+    }
+    if (covered.fLeft == request.fLeft && covered.fRight == request.fRight) {
+        if (covered.fTop == request.fTop) {
+            *exposed = SkIRect::MakeLTRB(request.fLeft, covered.fBottom,
+                                         request.fRight, request.fBottom);
+            return true;
+        } else if (covered.fBottom == request.fBottom) {
+            *exposed = SkIRect::MakeLTRB(request.fLeft, request.fTop,
+                                         request.fRight, covered.fTop);
+            return true;
+        }
+    } else if (covered.fTop == request.fTop && covered.fBottom == request.fBottom) {
+        if (covered.fLeft == request.fLeft) {
+            *exposed = SkIRect::MakeLTRB(covered.fRight, request.fTop,
+                                         request.fRight, request.fBottom);
+            return true;
+        } else if (covered.fRight == request.fRight) {
+            *exposed = SkIRect::MakeLTRB(request.fLeft, request.fTop,
+                                         covered.fLeft, request.fBottom);
+            return true;
+        }
+    }
+    return false;
+}
+
 class CacheImpl : public SkImageFilterCache {
 public:
     typedef SkImageFilterCacheKey Key;
@@ -57,17 +114,74 @@ public:
 
         SkAutoMutexExclusive mutex(fMutex);
         if (Value* v = fLookup.find(key)) {
-            if (v != fLRU.head()) {
-                fLRU.remove(v);
-                fLRU.addToHead(v);
-            }
+            this->touch(v);
 
             *result = v->fImage;
+            fStats.fHits++;
             return true;
         }
+        fStats.fMisses++;
         return false;
     }
 
+    Match find(const Key& key, const SkImageFilter* filter,
+               skif::FilterResult* result, PartialMatch* partial) const override {
+        SkASSERT(result && partial);
+
+        SkAutoMutexExclusive mutex(fMutex);
+        if (Value* v = fLookup.find(key)) {
+            this->touch(v);
+            *result = v->fImage;
+            fStats.fHits++;
+            return Match::kHit;
+        }
+
+        const Value* best = nullptr;
+        PartialMatch bestMatch;
+        int64_t bestArea = 0;
+        if (const auto* values = fImageFilterValues.find(filter)) {
+            for (const Value* v : *values) {
+                if (v->fKey.fUniqueID != key.fUniqueID ||
+                    v->fKey.fSrcGenID != key.fSrcGenID ||
+                    v->fKey.fSrcSubset != key.fSrcSubset) {
+                    continue;
+                }
+                PartialMatch match;
+                if (!is_integer_translation_of(key.fMatrix, v->fKey.fMatrix,
+                                               &match.fTranslation)) {
+                    continue;
+                }
+                // The source image's placement in the layer is not part of the key, so a result
+                // that depends on the source can only be reused if the layer did not move.
+                if (key.fSrcGenID != SK_InvalidUniqueID &&
+                    (match.fTranslation.fX != 0 || match.fTranslation.fY != 0)) {
+                    continue;
+                }
+                match.fCovered = v->fKey.fClipBounds.makeOffset(match.fTranslation);
+                if (!match.fCovered.intersect(key.fClipBounds) ||
+                    !single_exposed_rect(key.fClipBounds, match.fCovered, &match.fExposed)) {
+                    continue;
+                }
+                const int64_t area = int64_t(match.fCovered.width()) * match.fCovered.height();
+                if (area > bestArea) {
+                    best = v;
+                    bestMatch = match;
+                    bestArea = area;
+                }
+            }
+        }
+
+        if (!best) {
+            fStats.fMisses++;
+            return Match::kMiss;
+        }
+        this->touch(const_cast<Value*>(best));
+        *result = best->fImage;
+        *partial = bestMatch;
+        fStats.fPartialHits++;
+        return Match::kPartialHit;
+    }
+
     void set(const Key& key, const SkImageFilter* filter,
              const skif::FilterResult& result) override {
         SkAutoMutexExclusive mutex(fMutex);
@@ -118,8 +232,20 @@ public:
         fImageFilterValues.remove(filter);
     }
 
+    Stats stats() const override {
+        SkAutoMutexExclusive mutex(fMutex);
+        return fStats;
+    }
+
     SkDEBUGCODE(int count() const override { return fLookup.count(); })
 private:
+    void touch(Value* v) const {
+        if (v != fLRU.head()) {
+            fLRU.remove(v);
+            fLRU.addToHead(v);
+        }
+    }
+
     void removeInternal(Value* v) {
         if (v->fFilter) {
             if (auto* values = fImageFilterValues.find(v->fFilter)) {
@@ -147,6 +273,7 @@ private:
     THashMap<const SkImageFilter*, std::vector<Value*>> fImageFilterValues;
     size_t                                              fMaxBytes;
     size_t                                              fCurrentBytes;
+    mutable Stats                                       fStats;
     mutable SkMutex                                     fMutex;
 };
 
@@ -9,6 +9,7 @@
 #define SkImageFilterCache_DEFINED
 
 #include "include/core/SkMatrix.h"
+#include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/private/base/SkAssert.h"
@@ -54,10 +55,34 @@ struct SkImageFilterCacheKey {
 // This cache maps from (filter's unique ID + CTM + clipBounds + src bitmap generation ID) to result
 // NOTE: this is the _specific_ unique ID of the image filter, so refiltering the same image with a
 // copy of the image filter (with exactly the same parameters) will not yield a cache hit.
+//
+// Besides exact matches, find() can return a partial match: a result for the same filter and source
+// whose layer matrix differs only by an integer translation (e.g. a scrolled layer) and whose clip
+// bounds overlap the requested clip bounds, so only the newly exposed region needs to be refiltered.
 class SkImageFilterCache : public SkRefCnt {
 public:
     static constexpr size_t kDefaultTransientSize = 32 * 1024 * 1024;
 
+    enum class Match { kMiss, kHit, kPartialHit };
+
+    // Describes how a partially matching cached result maps onto a requested key.
+    struct PartialMatch {
+        // Translation from the cached result's layer space to the requested layer space.
+        SkIVector fTranslation = {0, 0};
+        // Region of the requested clip bounds that the translated result is valid for.
+        SkIRect   fCovered = SkIRect::MakeEmpty();
+        // Remainder of the requested clip bounds that must be refiltered. This is always a single
+        // rectangle, and is empty when the cached result covers the entire request.
+        SkIRect   fExposed = SkIRect::MakeEmpty();
+    };
+
+    // Lookup counts accumulated over the lifetime of the cache, by both get() and find().
+    struct Stats {
+        int fHits = 0;
+        int fPartialHits = 0;
+        int fMisses = 0;
+    };
+
     ~SkImageFilterCache() override {}
     static sk_sp<SkImageFilterCache> Create(size_t maxBytes);
 
@@ -69,12 +94,21 @@ public:
     // not in the cache, in which case 'result' is not modified.
     virtual bool get(const SkImageFilterCacheKey& key,
                      skif::FilterResult* result) const = 0;
+    // Like get(), but if there is no exact match for 'key', looks for a result previously set for
+    // 'filter' that can be reused for part of the request. On kPartialHit, 'result' is the cached
+    // result in its original layer space and 'partial' describes how to adapt it. On kMiss,
+    // neither 'result' nor 'partial' are modified.
+    virtual Match find(const SkImageFilterCacheKey& key,
+                       const SkImageFilter* filter,
+                       skif::FilterResult* result,
+                       PartialMatch* partial) const = 0;
     // 'filter' is included in the caching to allow the purging of all of an image filter's cached
     // results when it is destroyed.
     virtual void set(const SkImageFilterCacheKey& key, const SkImageFilter* filter,
                      const skif::FilterResult& result) = 0;
     virtual void purge() = 0;
     virtual void purgeByImageFilter(const SkImageFilter*) = 0;
+    virtual Stats stats() const = 0;
     SkDEBUGCODE(virtual int count() const = 0;)
 };
 
@@ -228,11 +228,13 @@ void Stats::dumpStats() const {
     SkDebugf("ImageFilter Stats:\n"
              "      # visited filters: %d\n"
              "           # cache hits: %d\n"
+             "   # partial cache hits: %d\n"
              "   # offscreen surfaces: %d\n"
              " # shader-clamped draws: %d\n"
              "   # shader-tiled draws: %d\n",
              fNumVisitedImageFilters,
              fNumCacheHits,
+             fNumPartialCacheHits,
              fNumOffscreenSurfaces,
              fNumShaderClampedDraws,
              fNumShaderBasedTilingDraws);
@@ -241,6 +243,8 @@ void Stats::dumpStats() const {
 void Stats::reportStats() const {
     TRACE_EVENT_INSTANT2("skia", "ImageFilter Graph Size", TRACE_EVENT_SCOPE_THREAD,
                          "count", fNumVisitedImageFilters, "cache hits", fNumCacheHits);
+    TRACE_EVENT_INSTANT1("skia", "ImageFilter Partial Cache Hits", TRACE_EVENT_SCOPE_THREAD,
+                         "count", fNumPartialCacheHits);
     TRACE_EVENT_INSTANT1("skia", "ImageFilter Surfaces", TRACE_EVENT_SCOPE_THREAD,
                          "count", fNumOffscreenSurfaces);
     TRACE_EVENT_INSTANT2("skia", "ImageFilter Shader Tiling", TRACE_EVENT_SCOPE_THREAD,
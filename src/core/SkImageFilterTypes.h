@@ -1129,6 +1129,7 @@ sk_sp<Backend> MakeRasterBackend(const SkSurfaceProps& surfaceProps, SkColorType
 struct Stats {
     int fNumVisitedImageFilters = 0; // size of the filter dag
     int fNumCacheHits = 0; // amount of reuse within the dag
+    int fNumPartialCacheHits = 0; // reuse of translated/overlapping results, e.g. when scrolling
     int fNumOffscreenSurfaces = 0; // difference to the # of visited filters shows deferred steps
     int fNumShaderClampedDraws = 0; // shader-emulated clamp is fairly cheap but HW tiling is best
     int fNumShaderBasedTilingDraws = 0; // shader-emulated decal, mirror, repeat are expensive
@@ -1226,6 +1227,11 @@ public:
             fStats->fNumCacheHits++;
         }
     }
+    void markPartialCacheHit() const {
+        if (fStats) {
+            fStats->fNumPartialCacheHits++;
+        }
+    }
     void markNewSurface() const {
         if (fStats) {
             fStats->fNumOffscreenSurfaces++;
@@ -14,6 +14,7 @@
 #include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTemplates.h"
 
+#include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilterTypes.h"
 
 #include <optional>
@@ -206,6 +207,12 @@ private:
 
     static void PurgeCache();
 
+    // Adapts a result cached for a translated layer matrix and/or an overlapping clip to the
+    // request described by 'context', filtering only the region that 'cached' does not cover.
+    skif::FilterResult reusePartialResult(const skif::Context& context,
+                                          const skif::FilterResult& cached,
+                                          const SkImageFilterCache::PartialMatch& partial) const;
+
     // Configuration points for the filter implementation, marked private since they should not
     // need to be invoked by the subclasses. These refer to the node's specific behavior and are
     // not responsible for aggregating the behavior of the entire filter DAG.
@@ -84,6 +84,26 @@ public:
         return fMap.count();
     }
 
+    // Changes the count limit, evicting the least recently used entries if we're over it.
+    void setMaxCount(int maxCount) {
+        fMaxCount = maxCount;
+        while (fMap.count() > fMaxCount) {
+            this->remove(fLRU.tail()->fKey);
+        }
+    }
+
+    // Returns the least recently used value without touching it, or nullptr if the cache is empty.
+    V* leastRecentlyUsed() {
+        Entry* entry = fLRU.tail();
+        return entry ? &entry->fValue : nullptr;
+    }
+
+    // Removes the least recently used entry. The cache must not be empty.
+    void removeLeastRecentlyUsed() {
+        SkASSERT(fLRU.tail());
+        this->remove(fLRU.tail()->fKey);
+    }
+
     template <typename Fn>  // f(K*, V*)
     void foreach(Fn&& fn) {
         typename SkTInternalLList<Entry>::Iter iter;
@@ -18,7 +18,10 @@
 
 enum SkFILE_Flags {
     kRead_SkFILE_Flag   = 0x01,
-    kWrite_SkFILE_Flag  = 0x02
+    kWrite_SkFILE_Flag  = 0x02,
+    // Opens for writing at the end of the file, creating it if needed. Every write appends, even
+    // when other processes append to the same file.
+    kAppend_SkFILE_Flag = 0x04
 };
 
 FILE* sk_fopen(const char path[], SkFILE_Flags);
@@ -26,6 +29,12 @@ void    sk_fclose(FILE*);
 
 size_t  sk_fgetsize(FILE*);
 
+/** Renames the file at from to to, replacing any file already there. On POSIX systems the
+ *  replacement is atomic: readers see either the old file or the new one.
+ *  Returns true if successful.
+ */
+bool    sk_freplace(const char from[], const char to[]);
+
 size_t  sk_fwrite(const void* buffer, size_t byteCount, FILE*);
 
 void    sk_fflush(FILE*);
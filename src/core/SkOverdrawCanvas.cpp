@@ -77,6 +77,19 @@ public:
         }
     }
 
+    void paintDeviceMasks(SkSpan<const SkMask> masks, const SkPaint&) const override {
+        fOverdrawCanvas->save();
+        fOverdrawCanvas->resetMatrix();
+        for (const SkMask& mask : masks) {
+            fOverdrawCanvas->drawRect(SkRect::Make(mask.fBounds), SkPaint());
+        }
+        fOverdrawCanvas->restore();
+    }
+
+    SkIRect deviceClipBounds() const override {
+        return this->devClipBounds();
+    }
+
     void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
                     const SkSamplingOptions&, const SkPaint&) const override {}
 
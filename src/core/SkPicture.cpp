@@ -14,12 +14,16 @@
 #include "include/private/base/SkTFitsIn.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkMathPriv.h"
+#include "src/core/SkBigPicture.h"
 #include "src/core/SkCanvasPriv.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordSerialize.h"
+#include "src/core/SkRecorder.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkStreamPriv.h"
 #include "src/core/SkWriteBuffer.h"
@@ -38,8 +42,15 @@ enum {
     kFailure_TrailingStreamByteAfterPictInfo     = 0,   // nothing follows
     kPictureData_TrailingStreamByteAfterPictInfo = 1,   // SkPictureData follows
     kCustom_TrailingStreamByteAfterPictInfo      = 2,   // -size32 follows
+    kRecord_TrailingStreamByteAfterPictInfo      = 3,   // padding, size32, SkRecordSerialize data
 };
 
+// SkPictInfo is 28 bytes, so after the trailing byte this many bytes of padding put the
+// kRecord_TrailingStreamByteAfterPictInfo payload on a 4-byte boundary. That lets it be read in
+// place from aligned memory, rather than copied out.
+static constexpr size_t kRecordPadding = 3;
+static_assert((sizeof(SkPictInfo) + 1 + kRecordPadding) % 4 == 0);
+
 /* SkPicture impl.  This handles generic responsibilities like unique IDs and serialization. */
 
 SkPicture::SkPicture() {
@@ -166,7 +177,9 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
 }
 
 sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                               SkTypefacePlayback* typefaces, int recursionLimit) {
+                                               SkTypefacePlayback* typefaces, int recursionLimit,
+                                               std::unique_ptr<SkPictureData>* unported,
+                                               SkPictInfo* unportedInfo) {
     if (recursionLimit <= 0) {
         return nullptr;
     }
@@ -187,6 +200,11 @@ sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeseria
             std::unique_ptr<SkPictureData> data(
                     SkPictureData::CreateFromStream(stream, info, procs, typefaces,
                                                     recursionLimit));
+            if (unported && data) {
+                *unportedInfo = info;
+                *unported = std::move(data);
+                return nullptr;
+            }
             return Forwardport(info, data.get(), nullptr);
         }
         case kCustom_TrailingStreamByteAfterPictInfo: {
@@ -204,6 +222,43 @@ sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeseria
             }
             return procs.fPictureProc(data->data(), size, procs.fPictureCtx);
         }
+        case kRecord_TrailingStreamByteAfterPictInfo: {
+            uint32_t size;
+            if (stream->skip(kRecordPadding) != kRecordPadding || !stream->readU32(&size) ||
+                StreamRemainingLengthIsBelow(stream, size)) {
+                return nullptr;
+            }
+            // Memory-backed streams (as used by MakeFromData) are read in place.
+            sk_sp<SkData> data;
+            const char* bytes = nullptr;
+            if (stream->getMemoryBase() && stream->hasPosition()) {
+                bytes = static_cast<const char*>(stream->getMemoryBase()) + stream->getPosition();
+                if (!SkIsAlign4(reinterpret_cast<uintptr_t>(bytes)) || stream->skip(size) != size) {
+                    bytes = nullptr;
+                }
+            }
+            if (!bytes) {
+                data = SkData::MakeUninitialized(size);
+                if (stream->read(data->writable_data(), size) != size) {
+                    return nullptr;
+                }
+                bytes = static_cast<const char*>(data->data());
+            }
+            size_t subPictureBytes = 0;
+            sk_sp<SkRecord> record = SkRecordDeserialize(bytes, size, procs, info.getVersion(),
+                                                         &subPictureBytes);
+            if (!record) {
+                return nullptr;
+            }
+            if (record->count() == 0) {
+                SkPictureRecorder recorder;
+                recorder.beginRecording(info.fCullRect);
+                return recorder.finishRecordingAsPicture();
+            }
+            return sk_make_sp<SkBigPicture>(info.fCullRect, std::move(record),
+                                            /*drawablePicts=*/nullptr, /*bbh=*/nullptr,
+                                            subPictureBytes);
+        }
         default:    // fall out to error return
             break;
     }
@@ -311,6 +366,39 @@ void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procsPtr,
     }
 }
 
+void SkPicturePriv::SerializeCompact(const SkPicture* picture, SkWStream* stream,
+                                     const SkSerialProcs* procsPtr) {
+    SkSerialProcs procs;
+    if (procsPtr) {
+        procs = *procsPtr;
+    }
+    // A custom picture proc takes precedence, as it does for serialize().
+    if (procs.fPictureProc) {
+        picture->serialize(stream, &procs, nullptr);
+        return;
+    }
+
+    // Play back into a fresh record. This draws any drawables as the pictures they were
+    // snapshot into, which the compact format can represent.
+    auto record = sk_make_sp<SkRecord>();
+    SkRecorder recorder(record.get(), picture->cullRect());
+    picture->playback(&recorder);
+
+    SkDynamicMemoryWStream payload;
+    if (!SkRecordSerialize(*record, procs, &payload)) {
+        picture->serialize(stream, &procs, nullptr);
+        return;
+    }
+
+    SkPictInfo info = picture->createHeader();
+    stream->write(&info, sizeof(info));
+    stream->write8(kRecord_TrailingStreamByteAfterPictInfo);
+    const uint8_t padding[kRecordPadding] = {};
+    stream->write(padding, sizeof(padding));
+    stream->write32(SkToU32(payload.bytesWritten()));
+    payload.writeToAndReset(stream);
+}
+
 void SkPicturePriv::Flatten(const sk_sp<const SkPicture> picture, SkWriteBuffer& buffer) {
     SkPictInfo info = picture->createHeader();
     std::unique_ptr<SkPictureData> data(picture->backport());
@@ -24,12 +24,14 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkStreamPriv.h"
 #include "src/core/SkTHash.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTextBlobPriv.h"
 #include "src/core/SkVerticesPriv.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <cstring>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -368,6 +370,38 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             }
             fPictures.reserve_exact(SkToInt(size));
 
+            if (procs.fExecutor) {
+                // Parse every picture first, then replay those stored as SkPictureData into
+                // SkRecords concurrently; replaying is most of the cost of loading a picture.
+                std::vector<std::unique_ptr<SkPictureData>> unported;
+                std::vector<SkPictInfo> unportedInfo;
+                unported.reserve(SkToSizeT(size));
+                unportedInfo.reserve(SkToSizeT(size));
+                for (uint32_t i = 0; i < size; i++) {
+                    unported.emplace_back();
+                    unportedInfo.emplace_back();
+                    auto pic = SkPicture::MakeFromStreamPriv(stream, &procs, topLevelTFPlayback,
+                                                             recursionLimit - 1, &unported.back(),
+                                                             &unportedInfo.back());
+                    if (!pic && !unported.back()) {
+                        return false;
+                    }
+                    fPictures.push_back(std::move(pic));
+                }
+                SkTaskGroup(*procs.fExecutor).batch(SkToInt(size), [&](int i) {
+                    if (unported[i]) {
+                        fPictures[i] = SkPicture::Forwardport(unportedInfo[i], unported[i].get(),
+                                                              nullptr);
+                    }
+                });
+                for (const sk_sp<const SkPicture>& pic : fPictures) {
+                    if (!pic) {
+                        return false;
+                    }
+                }
+                break;
+            }
+
             for (uint32_t i = 0; i < size; i++) {
                 auto pic = SkPicture::MakeFromStreamPriv(stream, &procs,
                                                          topLevelTFPlayback, recursionLimit - 1);
@@ -420,6 +454,29 @@ static sk_sp<SkImage> create_image_from_buffer(SkReadBuffer& buffer) {
     return buffer.readImage();
 }
 
+// Like new_array_from_buffer(), but reads every image's encoded data before decoding them all
+// concurrently on the SkDeserialProcs' executor.
+static bool new_images_from_buffer(SkReadBuffer& buffer, uint32_t inCount,
+                                   TArray<sk_sp<const SkImage>>& array) {
+    if (!buffer.validate(array.empty() && SkTFitsIn<int>(inCount))) {
+        return false;
+    }
+    std::vector<SkReadBuffer::DeferredImage> decoders;
+    for (uint32_t i = 0; i < inCount; ++i) {
+        SkReadBuffer::DeferredImage decoder = buffer.readDeferredImage();
+        if (!buffer.validate(decoder != nullptr)) {
+            return false;
+        }
+        decoders.push_back(std::move(decoder));
+    }
+
+    array.push_back_n(SkToInt(inCount));
+    SkTaskGroup(*buffer.getDeserialProcs().fExecutor).batch(SkToInt(inCount), [&](int i) {
+        array[i] = decoders[i]();
+    });
+    return true;
+}
+
 static sk_sp<SkDrawable> create_drawable_from_buffer(SkReadBuffer& buffer) {
     return sk_sp<SkDrawable>((SkDrawable*)buffer.readFlattenable(SkFlattenable::kSkDrawable_Type));
 }
@@ -487,7 +544,11 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
             new_array_from_buffer(buffer, size, fVertices, SkVerticesPriv::Decode);
             break;
         case SK_PICT_IMAGE_BUFFER_TAG:
-            new_array_from_buffer(buffer, size, fImages, create_image_from_buffer);
+            if (buffer.getDeserialProcs().fExecutor) {
+                new_images_from_buffer(buffer, size, fImages);
+            } else {
+                new_array_from_buffer(buffer, size, fImages, create_image_from_buffer);
+            }
             break;
         case SK_PICT_READER_TAG: {
             // Preflight check that we can initialize all data from the buffer
@@ -13,6 +13,8 @@
 class SkReadBuffer;
 class SkWriteBuffer;
 class SkStream;
+class SkWStream;
+struct SkSerialProcs;
 struct SkPictInfo;
 
 class SkPicturePriv {
@@ -32,6 +34,14 @@ public:
      */
     static void Flatten(const sk_sp<const SkPicture> , SkWriteBuffer& buffer);
 
+    /**
+     *  Serialize to a stream in the compact SkRecord format (see SkRecordSerialize.h), which
+     *  SkPicture::MakeFromStream and MakeFromData load faster than the default format. The
+     *  default format is written instead if the picture holds ops the compact format can't
+     *  represent, or if procs has a picture proc.
+     */
+    static void SerializeCompact(const SkPicture*, SkWStream*, const SkSerialProcs* = nullptr);
+
     // Returns NULL if this is not an SkBigPicture.
     static const SkBigPicture* AsSkBigPicture(const sk_sp<const SkPicture>& picture) {
         return picture->asSkBigPicture();
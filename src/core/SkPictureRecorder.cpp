@@ -40,7 +40,8 @@ SkCanvas* SkPictureRecorder::beginRecording(const SkRect& userCullRect,
     fBBH = std::move(bbh);
 
     if (!fRecord) {
-        fRecord.reset(new SkRecord);
+        fRecord.reset(fPresizeFromPrevious ? new SkRecord(fPresizeOpCount, fPresizeBytes)
+                                           : new SkRecord);
     }
     fRecorder->reset(fRecord.get(), cullRect);
     fActivelyRecording = true;
@@ -64,6 +65,34 @@ public:
     SkRect cullRect()             const override { return SkRect::MakeEmpty(); }
 };
 
+// Moves `size` toward `recorded`: all the way up, so that a growing recording is presized at once,
+// but only halfway down, so that one small recording doesn't undo the presizing and one large
+// recording stops costing memory after a few smaller ones.
+template <typename T>
+static T next_presize(T size, T recorded) {
+    return recorded >= size ? recorded : recorded + (size - recorded) / 2;
+}
+
+// Notes the record's size for setPresizeFromPreviousRecording(), and optimizes it.
+void SkPictureRecorder::finishRecord() {
+    if (fPresizeFromPrevious) {
+        fPresizeOpCount = next_presize(fPresizeOpCount, fRecord->count());
+        fPresizeBytes = next_presize(fPresizeBytes, fRecord->bytesUsed());
+    }
+
+    if (fExtendedOptimizations) {
+        SkRecordOptimizeExtended(fRecord.get(), fCullRect, /*stats=*/nullptr);
+    } else {
+        SkRecordOptimize(fRecord.get());
+    }
+
+    if (fPresizeFromPrevious) {
+        // The picture keeps this record, so don't let it hold on to the op slots that this
+        // recording (or the optimizer) left unused.
+        fRecord->shrinkToFit();
+    }
+}
+
 sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
     fActivelyRecording = false;
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
@@ -73,7 +102,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
     }
 
     // TODO: delay as much of this work until just before first playback?
-    SkRecordOptimize(fRecord.get());
+    this->finishRecord();
 
     SkDrawableList* drawableList = fRecorder->getDrawableList();
     std::unique_ptr<SkBigPicture::SnapshotArray> pictList{
@@ -133,7 +162,7 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable() {
     fActivelyRecording = false;
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
-    SkRecordOptimize(fRecord.get());
+    this->finishRecord();
 
     if (fBBH) {
         AutoTArray<SkRect> bounds(fRecord->count());
@@ -290,6 +290,12 @@ struct SkRasterPipeline_TraceFuncCtx {
     int funcIdx;
 };
 
+// Runs a block of SkSL slot arithmetic that was compiled to machine code (see
+// SkSLRasterPipelineNativeCode.h). The function reads and writes slots relative to `base`.
+struct SkRasterPipeline_NativeCodeCtx {
+    void (*fn)(std::byte* base);
+};
+
 struct SkRasterPipeline_TraceScopeCtx {
     const int* traceMask;
     SkSL::TraceHook* traceHook;
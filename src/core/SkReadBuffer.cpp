@@ -335,8 +335,8 @@ uint32_t SkReadBuffer::getArrayCount() {
     return *((const uint32_t*)fCurr);
 }
 
-static sk_sp<SkImage> deserialize_image(sk_sp<SkData> data, SkDeserialProcs dProcs,
-                                        std::optional<SkAlphaType> alphaType) {
+static sk_sp<SkImage> decode_image(sk_sp<SkData> data, const SkDeserialProcs& dProcs,
+                                   std::optional<SkAlphaType> alphaType) {
     sk_sp<SkImage> image;
     if (dProcs.fImageDataProc) {
         image = dProcs.fImageDataProc(data, alphaType, dProcs.fImageCtx);
@@ -361,9 +361,58 @@ static sk_sp<SkImage> deserialize_image(sk_sp<SkData> data, SkDeserialProcs dPro
 #endif
 }
 
+#if !defined(SK_DISABLE_LEGACY_IMAGE_READBUFFER)
+namespace {
+    // Holds on to an image's encoded data until its pixels are first needed, and only then runs
+    // the image procs on it (see SkDeserialProcs::fLazyImages).
+    class ProcImageGenerator final : public SkImageGenerator {
+    public:
+        ProcImageGenerator(const SkImageInfo& info, sk_sp<SkData> data,
+                           const SkDeserialProcs& procs, std::optional<SkAlphaType> alphaType)
+                : SkImageGenerator(info)
+                , fData(std::move(data))
+                , fProcs(procs)
+                , fAlphaType(alphaType) {
+            fProcs.fLazyImages = false;
+        }
+
+    protected:
+        sk_sp<SkData> onRefEncodedData() override { return fData; }
+
+        bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                         const Options&) override {
+            sk_sp<SkImage> image = decode_image(fData, fProcs, fAlphaType);
+            return image && image->dimensions() == info.dimensions() &&
+                   image->readPixels(nullptr, info, pixels, rowBytes, 0, 0);
+        }
+
+    private:
+        sk_sp<SkData>              fData;
+        SkDeserialProcs            fProcs;
+        std::optional<SkAlphaType> fAlphaType;
+    };
+} // anonymous namespace
+#endif
+
+static sk_sp<SkImage> deserialize_image(sk_sp<SkData> data, const SkDeserialProcs& dProcs,
+                                        std::optional<SkAlphaType> alphaType) {
+#if !defined(SK_DISABLE_LEGACY_IMAGE_READBUFFER)
+    if (dProcs.fLazyImages && (dProcs.fImageDataProc || dProcs.fImageProc)) {
+        // Our codecs only read the header here, to learn the image's info.
+        if (sk_sp<SkImage> header = SkImages::DeferredFromEncodedData(data, alphaType)) {
+            return SkImages::DeferredFromGenerator(std::make_unique<ProcImageGenerator>(
+                    header->imageInfo(), std::move(data), dProcs, alphaType));
+        }
+    }
+#endif
+    return decode_image(std::move(data), dProcs, alphaType);
+}
+
 static sk_sp<SkImage> add_mipmaps(sk_sp<SkImage> img, sk_sp<SkData> data,
                                   SkDeserialProcs dProcs, std::optional<SkAlphaType> alphaType) {
     SkMipmapBuilder builder(img->imageInfo());
+    // Every level is decoded right away, so there's nothing to gain from deferring them.
+    dProcs.fLazyImages = false;
 
     SkReadBuffer buffer(data->data(), data->size());
     int count = buffer.read32();
@@ -409,42 +458,52 @@ static sk_sp<SkImage> add_mipmaps(sk_sp<SkImage> img, sk_sp<SkData> data,
 // If we see a corrupt stream, we return null (fail). If we just fail trying to decode
 // the image, we don't fail, but return a 1x1 empty image.
 sk_sp<SkImage> SkReadBuffer::readImage() {
+    DeferredImage image = this->readDeferredImage();
+    return image ? image() : nullptr;
+}
+
+SkReadBuffer::DeferredImage SkReadBuffer::readDeferredImage() {
     uint32_t flags = this->read32();
 
     std::optional<SkAlphaType> alphaType = std::nullopt;
     if (flags & SkWriteBufferImageFlags::kUnpremul) {
         alphaType = kUnpremul_SkAlphaType;
     }
-    sk_sp<SkImage> image;
-    {
-        sk_sp<SkData> data = this->readByteArrayAsData();
-        if (!data) {
-            this->validate(false);
-            return nullptr;
-        }
-        image = deserialize_image(data, fProcs, alphaType);
+    sk_sp<SkData> data = this->readByteArrayAsData();
+    if (!data) {
+        this->validate(false);
+        return {};
     }
 
     // This flag is not written by new SKPs anymore.
+    std::optional<SkIRect> subset;
     if (flags & SkWriteBufferImageFlags::kHasSubsetRect) {
-        SkIRect subset;
-        this->readIRect(&subset);
-        if (image) {
-            image = image->makeSubset(nullptr, subset);
-        }
+        this->readIRect(&subset.emplace());
     }
 
+    sk_sp<SkData> mipData;
     if (flags & SkWriteBufferImageFlags::kHasMipmap) {
-        sk_sp<SkData> data = this->readByteArrayAsData();
-        if (!data) {
+        mipData = this->readByteArrayAsData();
+        if (!mipData) {
             this->validate(false);
-            return nullptr;
-        }
-        if (image) {
-            image = add_mipmaps(image, std::move(data), fProcs, alphaType);
+            return {};
         }
     }
-    return image ? image : MakeEmptyImage(1, 1);
+    if (!this->isValid()) {
+        return {};
+    }
+
+    return [data = std::move(data), subset, mipData = std::move(mipData), procs = fProcs,
+            alphaType]() mutable {
+        sk_sp<SkImage> image = deserialize_image(std::move(data), procs, alphaType);
+        if (image && subset) {
+            image = image->makeSubset(nullptr, *subset);
+        }
+        if (image && mipData) {
+            image = add_mipmaps(image, std::move(mipData), procs, alphaType);
+        }
+        return image ? image : MakeEmptyImage(1, 1);
+    };
 }
 
 sk_sp<SkTypeface> SkReadBuffer::readTypeface() {
@@ -35,6 +35,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 
 class SkBlender;
 class SkData;
@@ -162,6 +163,13 @@ public:
     // be created (e.g. it was not originally encoded) then this returns an image that doesn't
     // draw.
     sk_sp<SkImage> readImage();
+
+    // Reads the same data as readImage(), but leaves decoding it to the returned function, which
+    // may be called later and on any thread (but only once). Returns an empty function if the data
+    // is corrupt.
+    using DeferredImage = std::function<sk_sp<SkImage>()>;
+    DeferredImage readDeferredImage();
+
     sk_sp<SkTypeface> readTypeface();
 
     void setTypefaceArray(sk_sp<SkTypeface> array[], int count) {
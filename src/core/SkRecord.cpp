@@ -9,6 +9,13 @@
 
 #include <algorithm>
 
+SkRecord::SkRecord(int opCount, size_t bytes) : fAlloc(std::max<size_t>(bytes, 256)) {
+    if (opCount > 0) {
+        fReserved = opCount;
+        fRecords.realloc(fReserved);
+    }
+}
+
 SkRecord::~SkRecord() {
     Destroyer destroyer;
     for (int i = 0; i < this->count(); i++) {
@@ -22,6 +29,13 @@ void SkRecord::grow() {
     fRecords.realloc(fReserved);
 }
 
+void SkRecord::shrinkToFit() {
+    if (fReserved > fCount) {
+        fReserved = fCount;
+        fRecords.realloc(fReserved);
+    }
+}
+
 size_t SkRecord::bytesUsed() const {
     size_t bytes = fApproxBytesAllocated + sizeof(SkRecord);
     return bytes;
@@ -32,6 +32,9 @@
 class SkRecord : public SkRefCnt {
 public:
     SkRecord() = default;
+    // Preallocates room for `opCount` commands holding about `bytes` of data, so that recording
+    // that much doesn't have to grow the record's storage along the way.
+    SkRecord(int opCount, size_t bytes);
     ~SkRecord() override;
 
     // Returns the number of canvas commands in this SkRecord.
@@ -93,6 +96,9 @@ public:
     // need to iterate with a visitor to measure those they care for.
     size_t bytesUsed() const;
 
+    // Releases the room reserved for commands beyond count().
+    void shrinkToFit();
+
     // Rearrange and resize this record to eliminate any NoOps.
     // May change count() and the indices of ops, but preserves their order.
     void defrag();
@@ -7,21 +7,35 @@
 
 #include "src/core/SkRecordOpts.h"
 
+#include "include/core/SkBBHFactory.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkShader.h"
 #include "include/private/base/SkMath.h"
+#include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
 #include "src/core/SkRecordPattern.h"
 #include "src/core/SkRecords.h"
+#include "src/core/SkRectPriv.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 using namespace SkRecords;
+using namespace skia_private;
 
 // Most of the optimizations in this file are pattern-based.  These are all defined as structs with:
 //   - a Match typedef
@@ -266,6 +280,450 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+// The extended optimizations below aren't pattern-based; they walk the record tracking the state
+// that each op sees.
+
+// Follows the matrix, and a bound on the clip, through Saves and Restores. Both are in the
+// record's coordinates. Visit each op with this after looking at it.
+class StateTracker {
+public:
+    struct State {
+        SkM44 matrix;
+        std::optional<SkRect> clipBounds;  // Contains the clip, if known.
+        bool inLayer = false;
+    };
+
+    StateTracker() { fStack.push_back({}); }
+
+    const State& state() const { return fStack.back(); }
+    int depth() const { return SkToInt(fStack.size()) - 1; }
+
+    template <typename T>
+    void operator()(const T&) {}
+
+    void operator()(const Save&)       { this->push(/*layer=*/false); }
+    void operator()(const SaveLayer&)  { this->push(/*layer=*/true); }
+    void operator()(const SaveBehind&) { this->push(/*layer=*/true); }
+    void operator()(const Restore&) {
+        if (fStack.size() > 1) {
+            fStack.pop_back();
+        }
+    }
+
+    void operator()(const SetMatrix& op) { fStack.back().matrix = SkM44(op.matrix); }
+    void operator()(const SetM44& op)    { fStack.back().matrix = op.matrix; }
+    void operator()(const Concat& op)    { fStack.back().matrix.preConcat(op.matrix); }
+    void operator()(const Concat44& op)  { fStack.back().matrix.preConcat(op.matrix); }
+    void operator()(const Translate& op) { fStack.back().matrix.preTranslate(op.dx, op.dy); }
+    void operator()(const Scale& op)     { fStack.back().matrix.preScale(op.sx, op.sy); }
+
+    // ClipRegion (which is in device space) and ClipShader leave the bound as it was.
+    void operator()(const ClipRect& op)  { this->clip(op.rect, op.opAA.op()); }
+    void operator()(const ClipRRect& op) { this->clip(op.rrect.getBounds(), op.opAA.op()); }
+    void operator()(const ClipPath& op) {
+        if (!op.path.isInverseFillType()) {
+            this->clip(op.path.getBounds(), op.opAA.op());
+        }
+    }
+    void operator()(const ResetClip&) { fStack.back().clipBounds.reset(); }
+
+private:
+    void push(bool layer) {
+        fStack.push_back(fStack.back());
+        fStack.back().inLayer |= layer;
+    }
+
+    void clip(const SkRect& bounds, SkClipOp op) {
+        const SkMatrix matrix = fStack.back().matrix.asM33();
+        if (op != SkClipOp::kIntersect || matrix.hasPerspective()) {
+            return;
+        }
+        SkRect deviceBounds = matrix.mapRect(bounds);
+        std::optional<SkRect>& clipBounds = fStack.back().clipBounds;
+        if (clipBounds && !deviceBounds.intersect(*clipBounds)) {
+            deviceBounds.setEmpty();
+        }
+        clipBounds = deviceBounds;
+    }
+
+    std::vector<State> fStack;
+};
+
+enum class MatrixOpKind { kNone, kNoOp, kRestore, kSet, kRelative };
+
+struct ClassifyMatrixOp {
+    template <typename T>
+    MatrixOpKind operator()(const T&) { return MatrixOpKind::kNone; }
+    MatrixOpKind operator()(const NoOp&)      { return MatrixOpKind::kNoOp; }
+    MatrixOpKind operator()(const Restore&)   { return MatrixOpKind::kRestore; }
+    MatrixOpKind operator()(const SetMatrix&) { return MatrixOpKind::kSet; }
+    MatrixOpKind operator()(const SetM44&)    { return MatrixOpKind::kSet; }
+    MatrixOpKind operator()(const Concat&)    { return MatrixOpKind::kRelative; }
+    MatrixOpKind operator()(const Concat44&)  { return MatrixOpKind::kRelative; }
+    MatrixOpKind operator()(const Translate&) { return MatrixOpKind::kRelative; }
+    MatrixOpKind operator()(const Scale&)     { return MatrixOpKind::kRelative; }
+};
+
+void SkRecordNoopRedundantMatrices(SkRecord* record, SkRecordOptimizeStats* stats) {
+    // Matrix ops at the current depth that nothing has used yet.
+    std::vector<int> unused;
+    auto noopUnused = [&] {
+        for (int i : unused) {
+            record->replace<NoOp>(i);
+        }
+        stats->fNoopMatrices += SkToInt(unused.size());
+        unused.clear();
+    };
+
+    StateTracker tracker;
+    for (int i = 0; i < record->count(); i++) {
+        const MatrixOpKind kind = record->visit(i, ClassifyMatrixOp());
+        const SkM44 before = tracker.state().matrix;
+        record->visit(i, tracker);
+
+        switch (kind) {
+            case MatrixOpKind::kNoOp:
+                break;
+            case MatrixOpKind::kRestore:
+                noopUnused();
+                break;
+            case MatrixOpKind::kNone:
+                unused.clear();
+                break;
+            case MatrixOpKind::kSet:
+            case MatrixOpKind::kRelative:
+                if (tracker.state().matrix == before) {
+                    record->replace<NoOp>(i);
+                    stats->fNoopMatrices++;
+                    break;
+                }
+                if (kind == MatrixOpKind::kSet) {
+                    noopUnused();
+                }
+                unused.push_back(i);
+                break;
+        }
+    }
+    // SkRecordDraw() restores the canvas's matrix when it's done.
+    noopUnused();
+}
+
+// Decides whether a clip op leaves the clip unchanged, given a bound on the current clip.
+struct ClipIsRedundant {
+    const StateTracker::State& fState;
+
+    template <typename T>
+    bool operator()(const T&) { return false; }
+
+    bool operator()(const ClipRect& op) {
+        SkRect pixels;
+        SkMatrix matrix;
+        if (!this->prepare(&pixels, &matrix)) {
+            return false;
+        }
+        SkRect rect = matrix.mapRect(op.rect);
+        return op.opAA.op() == SkClipOp::kIntersect
+                       ? rect.contains(pixels)
+                       : rect.isFinite() && !SkRect::Intersects(rect, pixels);
+    }
+
+    bool operator()(const ClipRRect& op) {
+        SkRect pixels;
+        SkMatrix matrix;
+        SkRRect rrect;
+        if (!this->prepare(&pixels, &matrix) || !op.rrect.transform(matrix, &rrect)) {
+            return false;
+        }
+        return op.opAA.op() == SkClipOp::kIntersect
+                       ? rrect.contains(pixels)
+                       : !SkRect::Intersects(rrect.getBounds(), pixels);
+    }
+
+    bool operator()(const ClipPath& op) {
+        SkRect pixels;
+        SkMatrix matrix;
+        if (!this->prepare(&pixels, &matrix) || op.path.isInverseFillType()) {
+            return false;
+        }
+        SkPath path;
+        op.path.transform(matrix, &path);
+        return op.opAA.op() == SkClipOp::kIntersect
+                       ? path.conservativelyContainsRect(pixels)
+                       : path.isFinite() && !SkRect::Intersects(path.getBounds(), pixels);
+    }
+
+    // Finds every pixel the current clip could touch, and the matrix (if it maps rects to rects).
+    bool prepare(SkRect* pixels, SkMatrix* matrix) const {
+        if (!fState.clipBounds || fState.clipBounds->isEmpty() ||
+            !fState.clipBounds->isFinite()) {
+            return false;
+        }
+        *pixels = SkRect::Make(fState.clipBounds->roundOut());
+        *matrix = fState.matrix.asM33();
+        return matrix->rectStaysRect();
+    }
+};
+
+void SkRecordNoopRedundantClips(SkRecord* record, SkRecordOptimizeStats* stats) {
+    StateTracker tracker;
+    for (int i = 0; i < record->count(); i++) {
+        if (record->visit(i, ClipIsRedundant{tracker.state()})) {
+            record->replace<NoOp>(i);
+            stats->fNoopClips++;
+        } else {
+            record->visit(i, tracker);
+        }
+    }
+}
+
+// Non-antialiased rects that share an edge cover exactly the same pixels as their union, so
+// drawing them separately or together gives the same result even if the paint isn't opaque.
+static bool can_merge_rects(const SkPaint& paint) {
+    return !paint.isAntiAlias() && paint.getStyle() == SkPaint::kFill_Style &&
+           !paint.getPathEffect() && !paint.getMaskFilter() && !paint.getImageFilter();
+}
+
+static bool join_if_adjacent(const SkRect& a, const SkRect& b, SkRect* joined) {
+    if (!a.isSorted() || !b.isSorted()) {
+        return false;
+    }
+    const bool sideBySide = a.fTop == b.fTop && a.fBottom == b.fBottom &&
+                            (a.fRight == b.fLeft || b.fRight == a.fLeft);
+    const bool stacked = a.fLeft == b.fLeft && a.fRight == b.fRight &&
+                         (a.fBottom == b.fTop || b.fBottom == a.fTop);
+    if (!sideBySide && !stacked) {
+        return false;
+    }
+    *joined = SkRect::MakeLTRB(std::min(a.fLeft, b.fLeft), std::min(a.fTop, b.fTop),
+                               std::max(a.fRight, b.fRight), std::max(a.fBottom, b.fBottom));
+    return true;
+}
+
+void SkRecordMergeAdjacentRects(SkRecord* record, SkRecordOptimizeStats* stats) {
+    DrawRect* previous = nullptr;
+    int previousIndex = -1;
+    for (int i = 0; i < record->count(); i++) {
+        Is<NoOp> noop;
+        if (record->mutate(i, noop)) {
+            continue;
+        }
+        Is<DrawRect> draw;
+        DrawRect* current = record->mutate(i, draw) ? draw.get() : nullptr;
+        SkRect joined;
+        if (current && previous && current->paint == previous->paint &&
+            can_merge_rects(current->paint) &&
+            join_if_adjacent(previous->rect, current->rect, &joined)) {
+            current->rect = joined;
+            record->replace<NoOp>(previousIndex);
+            stats->fMergedRects++;
+        }
+        previous = current;
+        previousIndex = i;
+    }
+}
+
+// Returns true if drawing with this paint replaces everything beneath it with opaque color.
+static bool paint_covers_opaquely(const SkPaint& paint) {
+    if (paint.getStyle() != SkPaint::kFill_Style || paint.getAlpha() != 0xFF ||
+        paint.getPathEffect() || paint.getMaskFilter() || paint.getImageFilter() ||
+        paint.getColorFilter() || (paint.getShader() && !paint.getShader()->isOpaque())) {
+        return false;
+    }
+    std::optional<SkBlendMode> mode = paint.asBlendMode();
+    return mode == SkBlendMode::kSrcOver || mode == SkBlendMode::kSrc;
+}
+
+// Finds the area (in the record's coordinates) that an op on the base layer covers opaquely, given
+// the matrix and the area inside the base layer's clip. Only aliased edges count: the picture may
+// be played back at any scale, so an antialiased edge may fall partway across any pixel. An aliased
+// edge covers every pixel whose center it contains, at any scale.
+struct OpaqueCoverage {
+    const SkMatrix& fMatrix;
+    const SkRect& fClipInterior;
+
+    template <typename T>
+    SkRect operator()(const T&) { return SkRect::MakeEmpty(); }
+
+    SkRect operator()(const DrawPaint& op) {
+        return paint_covers_opaquely(op.paint) ? fClipInterior : SkRect::MakeEmpty();
+    }
+
+    SkRect operator()(const DrawRect& op) {
+        if (!fMatrix.rectStaysRect() || op.paint.isAntiAlias() ||
+            !paint_covers_opaquely(op.paint)) {
+            return SkRect::MakeEmpty();
+        }
+        SkRect covered = fMatrix.mapRect(op.rect);
+        if (!covered.intersect(fClipInterior)) {
+            return SkRect::MakeEmpty();
+        }
+        return covered;
+    }
+};
+
+struct ChangesClip {
+    template <typename T>
+    bool operator()(const T&) { return false; }
+    bool operator()(const ClipPath&)   { return true; }
+    bool operator()(const ClipRRect&)  { return true; }
+    bool operator()(const ClipRect&)   { return true; }
+    bool operator()(const ClipRegion&) { return true; }
+    bool operator()(const ClipShader&) { return true; }
+    bool operator()(const ResetClip&)  { return true; }
+};
+
+// Whether the pixels an op touches are those whose centers fall inside its bounds, at any scale.
+// Those are covered by an aliased occluder that contains the bounds; the pixels along the edges of
+// anything else may only be covered by an occluder that fills the whole clip.
+struct DrawsAliased {
+    template <typename T>
+    bool operator()(const T&) { return false; }
+
+    bool operator()(const DrawPaint&)     { return true; }
+    bool operator()(const DrawRect& op)   { return aliased(op.paint); }
+    bool operator()(const DrawOval& op)   { return aliased(op.paint); }
+    bool operator()(const DrawRRect& op)  { return aliased(op.paint); }
+    bool operator()(const DrawDRRect& op) { return aliased(op.paint); }
+    bool operator()(const DrawPath& op)   { return aliased(op.paint); }
+    bool operator()(const DrawRegion& op) { return aliased(op.paint); }
+
+    static bool aliased(const SkPaint& paint) {
+        // Hairlines light pixels next to the line, and mask filters blur across the edges.
+        const bool hairline = paint.getStyle() != SkPaint::kFill_Style &&
+                              paint.getStrokeWidth() == 0;
+        return !paint.isAntiAlias() && !hairline && !paint.getMaskFilter();
+    }
+};
+
+// Whether an op may read the pixels drawn before it and move them elsewhere, so that later draws
+// covering those pixels don't hide them.
+struct MayReadDrawnPixels {
+    template <typename T>
+    bool operator()(const T&) { return false; }
+
+    bool operator()(const SaveLayer& op) {
+        return op.backdrop || (op.saveLayerFlags & SkCanvas::kInitWithPrevious_SaveLayerFlag);
+    }
+    bool operator()(const DrawDrawable&) { return true; }  // Could hold either of those layers.
+    bool operator()(const DrawPicture&)  { return true; }
+};
+
+// Whether an op can be dropped once all the pixels it might draw are covered.
+struct OnlyDrawsPixels {
+    template <typename T>
+    bool operator()(const T&) { return (T::kTags & kDraw_Tag) != 0; }
+
+    bool operator()(const DrawDrawable&) { return false; }  // May have side effects.
+    bool operator()(const DrawPicture&)  { return false; }  // May hold annotations.
+};
+
+void SkRecordNoopOccludedDraws(SkRecord* record, const SkRect& cullRect,
+                               SkRecordOptimizeStats* stats) {
+    const int count = record->count();
+    for (int i = 0; i < count; i++) {
+        Is<SaveBehind> saveBehind;
+        if (record->mutate(i, saveBehind)) {
+            // DrawBehind draws beneath content that's already there.
+            return;
+        }
+    }
+
+    AutoTArray<SkRect> bounds(count);
+    AutoTMalloc<SkBBoxHierarchy::Metadata> meta(count);
+    SkRecordFillBounds(cullRect, *record, bounds.data(), meta);
+
+    // Walk forward to find the draws that could be occluded (those on the base layer; layers can
+    // move pixels around when they're restored), and the pixels each op covers opaquely.
+    AutoTArray<bool> occludable(count);
+    AutoTArray<bool> aliased(count);
+    AutoTArray<SkRect> coverage(count);
+    StateTracker tracker;
+    SkRect baseClipInterior = SkRectPriv::MakeLargest();
+    for (int i = 0; i < count; i++) {
+        const StateTracker::State& state = tracker.state();
+        occludable[i] = !state.inLayer && record->visit(i, OnlyDrawsPixels());
+        aliased[i] = record->visit(i, DrawsAliased());
+        coverage[i] = SkRect::MakeEmpty();
+        if (tracker.depth() == 0) {
+            const SkMatrix matrix = state.matrix.asM33();
+            coverage[i] = record->visit(i, OpaqueCoverage{matrix, baseClipInterior});
+
+            Is<ClipRect> clipRect;
+            if (record->mutate(i, clipRect)) {
+                const ClipRect& clip = *clipRect.get();
+                if (clip.opAA.op() != SkClipOp::kIntersect || clip.opAA.aa() ||
+                    !matrix.rectStaysRect() ||
+                    !baseClipInterior.intersect(matrix.mapRect(clip.rect))) {
+                    baseClipInterior.setEmpty();
+                }
+            } else if (record->visit(i, ChangesClip())) {
+                baseClipInterior.setEmpty();
+            }
+        }
+        record->visit(i, tracker);
+    }
+
+    // Walk back, checking each draw against the largest few opaque rects drawn after it.
+    static constexpr int kMaxOccluders = 8;
+    const SkRect wholeClip = SkRectPriv::MakeLargest();
+    STArray<kMaxOccluders, SkRect> occluders;
+    for (int i = count - 1; i >= 0; i--) {
+        if (record->visit(i, MayReadDrawnPixels())) {
+            occluders.clear();
+            continue;
+        }
+        if (occludable[i] && !bounds[i].isEmpty()) {
+            bool occluded = false;
+            for (const SkRect& occluder : occluders) {
+                if ((aliased[i] || occluder == wholeClip) && occluder.contains(bounds[i])) {
+                    occluded = true;
+                    break;
+                }
+            }
+            if (occluded) {
+                record->replace<NoOp>(i);
+                stats->fOccludedDraws++;
+                continue;
+            }
+        }
+        const SkRect& covered = coverage[i];
+        if (covered.isEmpty()) {
+            continue;
+        }
+        if (occluders.size() < kMaxOccluders) {
+            occluders.push_back(covered);
+            continue;
+        }
+        int smallest = 0;
+        for (int j = 1; j < occluders.size(); j++) {
+            if (occluders[j].width() * occluders[j].height() <
+                occluders[smallest].width() * occluders[smallest].height()) {
+                smallest = j;
+            }
+        }
+        if (covered.width() * covered.height() >
+            occluders[smallest].width() * occluders[smallest].height()) {
+            occluders[smallest] = covered;
+        }
+    }
+}
+
+void SkRecordOptimizeExtended(SkRecord* record, const SkRect& cullRect,
+                              SkRecordOptimizeStats* stats) {
+    SkRecordOptimizeStats ignored;
+    if (!stats) {
+        stats = &ignored;
+    }
+    SkRecordNoopRedundantMatrices(record, stats);
+    SkRecordNoopRedundantClips(record, stats);
+    SkRecordMergeAdjacentRects(record, stats);
+    SkRecordNoopOccludedDraws(record, cullRect, stats);
+
+    SkRecordOptimize(record);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 void SkRecordOptimize(SkRecord* record) {
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
@@ -9,6 +9,7 @@
 #define SkRecordOpts_DEFINED
 
 class SkRecord;
+struct SkRect;
 
 // Run all optimizations in recommended order.
 void SkRecordOptimize(SkRecord*);
@@ -26,4 +27,32 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
+// Counts of the ops removed or merged by each of the extended optimizations below.
+struct SkRecordOptimizeStats {
+    int fOccludedDraws = 0;
+    int fMergedRects = 0;
+    int fNoopClips = 0;
+    int fNoopMatrices = 0;
+};
+
+// Runs the extended optimizations and then SkRecordOptimize(). These cost more to run, so they are
+// opt-in (see SkPictureRecorder::setExtendedOptimizations()). `stats` may be null.
+void SkRecordOptimizeExtended(SkRecord*, const SkRect& cullRect, SkRecordOptimizeStats* stats);
+
+// No-ops matrix changes that leave the matrix as it was, or that are overwritten by a later
+// SetMatrix (or discarded by a Restore) before anything uses them.
+void SkRecordNoopRedundantMatrices(SkRecord*, SkRecordOptimizeStats*);
+
+// No-ops intersect clips that contain the current clip, and difference clips that miss it.
+void SkRecordNoopRedundantClips(SkRecord*, SkRecordOptimizeStats*);
+
+// Merges consecutive non-antialiased DrawRects with the same paint that share an edge.
+void SkRecordMergeAdjacentRects(SkRecord*, SkRecordOptimizeStats*);
+
+// No-ops draws whose bounds are entirely covered by a later opaque DrawRect or DrawPaint on the
+// base layer. Antialiased edges are never taken to cover anything, so the result holds at any
+// playback scale, and nothing is hidden behind an op that may read back what was drawn before it
+// (a backdrop or kInitWithPrevious layer, a picture or a drawable).
+void SkRecordNoopOccludedDraws(SkRecord*, const SkRect& cullRect, SkRecordOptimizeStats*);
+
 #endif//SkRecordOpts_DEFINED
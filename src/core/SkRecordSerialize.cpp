@@ -0,0 +1,1146 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkRecordSerialize.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageFilter.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRSXform.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkTypeface.h"
+#include "include/core/SkVertices.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkSafeMath.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDrawShadowInfo.h"
+#include "src/core/SkLatticeIter.h"
+#include "src/core/SkPaintPriv.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkPtrRecorder.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkTHash.h"
+#include "src/core/SkTextBlobPriv.h"
+#include "src/core/SkVerticesPriv.h"
+#include "src/core/SkWriteBuffer.h"
+#include "src/utils/SkPatchUtils.h"
+
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+using namespace skia_private;
+
+// The payload is a sequence of byte arrays, each read with its own SkReadBuffer:
+//
+//   uint32_t           kFormatVersion
+//   uint32_t           typeface count, then each typeface's serialized data
+//   byte array         paint table (count, then flattened paints)
+//   byte array         path table (count, then paths)
+//   byte array         ops (count, then each op's SkRecords::Type and fields)
+//
+// Bump kFormatVersion whenever any of this, or the fields written for an op, changes.
+static constexpr uint32_t kFormatVersion = 1;
+
+// Ops refer to paints by 1-based index into the paint table, using 0 for a missing paint.
+static constexpr uint32_t kNoPaint = 0;
+
+namespace {
+
+// Flattened objects write typefaces as indices into the typeface table. The caller's typeface proc
+// is only applied when that table is written, once per typeface (as SkPictureData does).
+SkSerialProcs skip_typeface_proc(const SkSerialProcs& procs) {
+    SkSerialProcs newProcs = procs;
+    newProcs.fTypefaceProc = nullptr;
+    newProcs.fTypefaceCtx = nullptr;
+    return newProcs;
+}
+
+class Writer {
+public:
+    explicit Writer(const SkSerialProcs& procs)
+            : fProcs(procs)
+            , fBufferProcs(skip_typeface_proc(procs))
+            , fTypefaces(sk_make_sp<SkRefCntSet>())
+            , fPaths(fBufferProcs)
+            , fOps(fBufferProcs) {
+        fPaths.setTypefaceRecorder(fTypefaces);
+        fOps.setTypefaceRecorder(fTypefaces);
+    }
+
+    bool writeOps(const SkRecord& record) {
+        for (int i = 0; i < record.count(); i++) {
+            if (!record.visit(i, *this)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void finish(SkWStream* stream) const {
+        SkBinaryWriteBuffer payload(fBufferProcs);
+        payload.writeUInt(kFormatVersion);
+
+        payload.writeUInt(fTypefaces->count());
+        AutoTMalloc<SkTypeface*> typefaces(fTypefaces->count());
+        fTypefaces->copyToArray(reinterpret_cast<SkRefCnt**>(typefaces.get()));
+        for (int i = 0; i < fTypefaces->count(); i++) {
+            sk_sp<SkData> data;
+            if (fProcs.fTypefaceProc) {
+                data = fProcs.fTypefaceProc(typefaces[i], fProcs.fTypefaceCtx);
+            }
+            if (!data) {
+                data = typefaces[i]->serialize(SkTypeface::SerializeBehavior::kDoIncludeData);
+            }
+            payload.writeDataAsByteArray(data.get());
+        }
+
+        SkBinaryWriteBuffer paints(fBufferProcs);
+        paints.writeUInt(SkToU32(fPaints.size()));
+        for (const sk_sp<SkData>& paint : fPaints) {
+            paints.write(paint->data(), paint->size());
+        }
+        write_section(paints, &payload);
+
+        SkBinaryWriteBuffer paths(fBufferProcs);
+        paths.writeUInt(fPathCount);
+        write_section(fPaths, &paths, /*asByteArray=*/false);
+        write_section(paths, &payload);
+
+        SkBinaryWriteBuffer ops(fBufferProcs);
+        ops.writeUInt(fOpCount);
+        write_section(fOps, &ops, /*asByteArray=*/false);
+        write_section(ops, &payload);
+
+        payload.writeToStream(stream);
+    }
+
+    // NoOps are dropped; the loaded record doesn't need them.
+    bool operator()(const SkRecords::NoOp&) { return true; }
+
+    // Drawables are snapshot as pictures when a picture is finished, and played back as
+    // DrawPicture; SkPicturePriv::SerializeCompact re-records so they never reach us. Meshes and
+    // slugs have no serialized form in any SKP format.
+    bool operator()(const SkRecords::DrawDrawable&) { return false; }
+    bool operator()(const SkRecords::DrawMesh&)     { return false; }
+    bool operator()(const SkRecords::DrawSlug&)     { return false; }
+
+    bool operator()(const SkRecords::Restore& r) {
+        this->begin(r);
+        fOps.writeMatrix(r.matrix);
+        return true;
+    }
+    bool operator()(const SkRecords::Save& r) {
+        this->begin(r);
+        return true;
+    }
+    bool operator()(const SkRecords::SaveLayer& r) {
+        this->begin(r);
+        this->writeOptional(r.bounds);
+        this->writePaint(r.paint);
+        fOps.writeFlattenable(r.backdrop.get());
+        fOps.writeUInt(r.saveLayerFlags);
+        fOps.writeScalar(r.backdropScale);
+        fOps.writeUInt(SkToU32(r.filters.size()));
+        for (size_t i = 0; i < r.filters.size(); i++) {
+            fOps.writeFlattenable(r.filters[i].get());
+        }
+        return true;
+    }
+    bool operator()(const SkRecords::SaveBehind& r) {
+        this->begin(r);
+        this->writeOptional(r.subset);
+        return true;
+    }
+    bool operator()(const SkRecords::SetMatrix& r) {
+        this->begin(r);
+        fOps.writeMatrix(r.matrix);
+        return true;
+    }
+    bool operator()(const SkRecords::SetM44& r) {
+        this->begin(r);
+        fOps.write(r.matrix);
+        return true;
+    }
+    bool operator()(const SkRecords::Concat& r) {
+        this->begin(r);
+        fOps.writeMatrix(r.matrix);
+        return true;
+    }
+    bool operator()(const SkRecords::Concat44& r) {
+        this->begin(r);
+        fOps.write(r.matrix);
+        return true;
+    }
+    bool operator()(const SkRecords::Translate& r) {
+        this->begin(r);
+        fOps.writeScalar(r.dx);
+        fOps.writeScalar(r.dy);
+        return true;
+    }
+    bool operator()(const SkRecords::Scale& r) {
+        this->begin(r);
+        fOps.writeScalar(r.sx);
+        fOps.writeScalar(r.sy);
+        return true;
+    }
+    bool operator()(const SkRecords::ClipPath& r) {
+        this->begin(r);
+        fOps.writeUInt(this->pathIndex(r.path));
+        this->writeOpAA(r.opAA);
+        return true;
+    }
+    bool operator()(const SkRecords::ClipRRect& r) {
+        this->begin(r);
+        this->writeRRect(r.rrect);
+        this->writeOpAA(r.opAA);
+        return true;
+    }
+    bool operator()(const SkRecords::ClipRect& r) {
+        this->begin(r);
+        fOps.writeRect(r.rect);
+        this->writeOpAA(r.opAA);
+        return true;
+    }
+    bool operator()(const SkRecords::ClipRegion& r) {
+        this->begin(r);
+        fOps.writeRegion(r.region);
+        fOps.writeUInt(static_cast<uint32_t>(r.op));
+        return true;
+    }
+    bool operator()(const SkRecords::ClipShader& r) {
+        this->begin(r);
+        fOps.writeFlattenable(r.shader.get());
+        fOps.writeUInt(static_cast<uint32_t>(r.op));
+        return true;
+    }
+    bool operator()(const SkRecords::ResetClip& r) {
+        this->begin(r);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawArc& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        fOps.writeRect(r.oval);
+        fOps.writeScalar(r.startAngle);
+        fOps.writeScalar(r.sweepAngle);
+        fOps.writeBool(r.useCenter);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawDRRect& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        this->writeRRect(r.outer);
+        this->writeRRect(r.inner);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawImage& r) {
+        this->begin(r);
+        this->writePaint(r.paint);
+        fOps.writeImage(r.image.get());
+        fOps.writeScalar(r.left);
+        fOps.writeScalar(r.top);
+        fOps.writeSampling(r.sampling);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawImageLattice& r) {
+        this->begin(r);
+        this->writePaint(r.paint);
+        fOps.writeImage(r.image.get());
+        fOps.writeInt(r.xCount);
+        this->writeArray(r.xDivs, r.xCount);
+        fOps.writeInt(r.yCount);
+        this->writeArray(r.yDivs, r.yCount);
+        fOps.writeInt(r.flagCount);
+        this->writeArray(r.flags, r.flagCount);
+        this->writeNullableArray(r.colors, r.flagCount);
+        fOps.writeIRect(r.src);
+        fOps.writeRect(r.dst);
+        fOps.writeUInt(static_cast<uint32_t>(r.filter));
+        return true;
+    }
+    bool operator()(const SkRecords::DrawImageRect& r) {
+        this->begin(r);
+        this->writePaint(r.paint);
+        fOps.writeImage(r.image.get());
+        fOps.writeRect(r.src);
+        fOps.writeRect(r.dst);
+        fOps.writeSampling(r.sampling);
+        fOps.writeUInt(r.constraint);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawOval& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        fOps.writeRect(r.oval);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawPaint& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawBehind& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawPath& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        fOps.writeUInt(this->pathIndex(r.path));
+        return true;
+    }
+    bool operator()(const SkRecords::DrawPicture& r) {
+        this->begin(r);
+        this->writePaint(r.paint);
+        SkPicturePriv::Flatten(r.picture, fOps);
+        fOps.writeMatrix(r.matrix);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawPoints& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        fOps.writeUInt(r.mode);
+        fOps.writeUInt(r.count);
+        this->writeArray(r.pts, r.count);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawRRect& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        this->writeRRect(r.rrect);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawRect& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        fOps.writeRect(r.rect);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawRegion& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        fOps.writeRegion(r.region);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawTextBlob& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        SkTextBlobPriv::Flatten(*r.blob, fOps);
+        fOps.writeScalar(r.x);
+        fOps.writeScalar(r.y);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawPatch& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        this->writeNullableArray(r.cubics, SkPatchUtils::kNumCtrlPts);
+        this->writeNullableArray(r.colors, SkPatchUtils::kNumCorners);
+        this->writeNullableArray(r.texCoords, SkPatchUtils::kNumCorners);
+        fOps.writeUInt(static_cast<uint32_t>(r.bmode));
+        return true;
+    }
+    bool operator()(const SkRecords::DrawAtlas& r) {
+        this->begin(r);
+        this->writePaint(r.paint);
+        fOps.writeImage(r.atlas.get());
+        fOps.writeInt(r.count);
+        this->writeArray(r.xforms, r.count);
+        this->writeArray(r.texs, r.count);
+        this->writeNullableArray(r.colors, r.count);
+        fOps.writeUInt(static_cast<uint32_t>(r.mode));
+        fOps.writeSampling(r.sampling);
+        this->writeOptional(r.cull);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawVertices& r) {
+        this->begin(r);
+        this->writePaint(&r.paint);
+        r.vertices->priv().encode(fOps);
+        fOps.writeUInt(static_cast<uint32_t>(r.bmode));
+        return true;
+    }
+    bool operator()(const SkRecords::DrawShadowRec& r) {
+        this->begin(r);
+        fOps.writeUInt(this->pathIndex(r.path));
+        fOps.writePoint3(r.rec.fZPlaneParams);
+        fOps.writePoint3(r.rec.fLightPos);
+        fOps.writeScalar(r.rec.fLightRadius);
+        fOps.writeColor(r.rec.fAmbientColor);
+        fOps.writeColor(r.rec.fSpotColor);
+        fOps.writeUInt(r.rec.fFlags);
+        return true;
+    }
+    bool operator()(const SkRecords::DrawAnnotation& r) {
+        this->begin(r);
+        fOps.writeRect(r.rect);
+        fOps.writeString(std::string_view(r.key.c_str(), r.key.size()));
+        fOps.writeBool(r.value != nullptr);
+        if (r.value) {
+            fOps.writeDataAsByteArray(r.value.get());
+        }
+        return true;
+    }
+    bool operator()(const SkRecords::DrawEdgeAAQuad& r) {
+        this->begin(r);
+        fOps.writeRect(r.rect);
+        this->writeNullableArray(r.clip, 4);
+        fOps.writeUInt(r.aa);
+        fOps.writeColor4f(r.color);
+        fOps.writeUInt(static_cast<uint32_t>(r.mode));
+        return true;
+    }
+    bool operator()(const SkRecords::DrawEdgeAAImageSet& r) {
+        this->begin(r);
+        this->writePaint(r.paint);
+        fOps.writeInt(r.count);
+        for (int i = 0; i < r.count; i++) {
+            const SkCanvas::ImageSetEntry& entry = r.set[i];
+            fOps.writeImage(entry.fImage.get());
+            fOps.writeRect(entry.fSrcRect);
+            fOps.writeRect(entry.fDstRect);
+            fOps.writeInt(entry.fMatrixIndex);
+            fOps.writeScalar(entry.fAlpha);
+            fOps.writeUInt(entry.fAAFlags);
+            fOps.writeBool(entry.fHasClip);
+        }
+        int clipCount, matrixCount;
+        SkCanvasPriv::GetDstClipAndMatrixCounts(r.set.data(), r.count, &clipCount, &matrixCount);
+        this->writeArray(r.dstClips, clipCount);
+        for (int i = 0; i < matrixCount; i++) {
+            fOps.writeMatrix(r.preViewMatrices[i]);
+        }
+        fOps.writeSampling(r.sampling);
+        fOps.writeUInt(r.constraint);
+        return true;
+    }
+
+private:
+    static void write_section(const SkBinaryWriteBuffer& src, SkBinaryWriteBuffer* dst,
+                              bool asByteArray = true) {
+        sk_sp<SkData> data = src.snapshotAsData();
+        if (asByteArray) {
+            dst->writeDataAsByteArray(data.get());
+        } else {
+            dst->write(data->data(), data->size());
+        }
+    }
+
+    template <typename T>
+    void begin(const T&) {
+        fOps.writeUInt(T::kType);
+        fOpCount++;
+    }
+
+    void writePaint(const SkPaint* paint) {
+        fOps.writeUInt(paint ? this->paintIndex(*paint) : kNoPaint);
+    }
+
+    // Paints are flattened on their own so that equal paints produce equal bytes; each buffer
+    // starts with an empty flattenable name dictionary.
+    uint32_t paintIndex(const SkPaint& paint) {
+        SkBinaryWriteBuffer buffer(fBufferProcs);
+        buffer.setTypefaceRecorder(fTypefaces);
+        SkPaintPriv::Flatten(paint, buffer);
+        sk_sp<SkData> bytes = buffer.snapshotAsData();
+
+        const uint32_t hash = SkChecksum::Hash32(bytes->data(), bytes->size());
+        if (const uint32_t* index = fPaintIndices.find(hash)) {
+            if (fPaints[*index - 1]->equals(bytes.get())) {
+                return *index;
+            }
+        }
+        fPaints.push_back(std::move(bytes));
+        const uint32_t index = SkToU32(fPaints.size());
+        fPaintIndices.set(hash, index);
+        return index;
+    }
+
+    // The generation ID covers the path's points, verbs and fill type, so paths sharing one
+    // serialize identically.
+    uint32_t pathIndex(const SkPath& path) {
+        const uint32_t genID = path.getGenerationID();
+        if (const uint32_t* index = fPathIndices.find(genID)) {
+            return *index;
+        }
+        fPaths.writePath(path);
+        fPathIndices.set(genID, fPathCount);
+        return fPathCount++;
+    }
+
+    void writeRRect(const SkRRect& rrect) {
+        char storage[SkRRect::kSizeInMemory];
+        rrect.writeToMemory(storage);
+        fOps.writePad32(storage, sizeof(storage));
+    }
+
+    void writeOpAA(const SkRecords::ClipOpAndAA& opAA) {
+        fOps.writeUInt(static_cast<uint32_t>(opAA.op()));
+        fOps.writeBool(opAA.aa());
+    }
+
+    template <typename T>
+    void writeOptional(const SkRecords::Optional<T>& value) {
+        fOps.writeBool(value != nullptr);
+        if (value) {
+            fOps.writePad32(value, sizeof(T));
+        }
+    }
+
+    template <typename T>
+    void writeArray(const SkRecords::PODArray<T>& values, size_t count) {
+        fOps.writePad32(values, count * sizeof(T));
+    }
+
+    template <typename T>
+    void writeNullableArray(const SkRecords::PODArray<T>& values, size_t count) {
+        fOps.writeBool(values != nullptr);
+        if (values) {
+            this->writeArray(values, count);
+        }
+    }
+
+    const SkSerialProcs         fProcs;
+    const SkSerialProcs         fBufferProcs;
+    sk_sp<SkRefCntSet>          fTypefaces;
+
+    std::vector<sk_sp<SkData>>  fPaints;
+    THashMap<uint32_t, uint32_t> fPaintIndices;  // hash of flattened paint -> paint index
+
+    SkBinaryWriteBuffer         fPaths;
+    uint32_t                    fPathCount = 0;
+    THashMap<uint32_t, uint32_t> fPathIndices;   // generation ID -> path index
+
+    SkBinaryWriteBuffer         fOps;
+    uint32_t                    fOpCount = 0;
+};
+
+class Reader {
+public:
+    Reader(SkRecord* record, const SkDeserialProcs& procs, uint32_t pictureVersion)
+            : fRecord(record)
+            , fProcs(procs)
+            , fPictureVersion(pictureVersion) {}
+
+    bool read(const void* data, size_t size) {
+        SkReadBuffer payload(data, size);
+        if (payload.readUInt() != kFormatVersion) {
+            return false;
+        }
+
+        const uint32_t typefaceCount = payload.readUInt();
+        if (!payload.validate(typefaceCount <= payload.available())) {
+            return false;
+        }
+        fTypefaces.reset(typefaceCount);
+        for (uint32_t i = 0; i < typefaceCount && payload.isValid(); i++) {
+            size_t length;
+            const void* bytes = payload.skipByteArray(&length);
+            sk_sp<SkTypeface> typeface;
+            if (bytes && fProcs.fTypefaceProc) {
+                typeface = fProcs.fTypefaceProc(bytes, length, fProcs.fTypefaceCtx);
+            } else if (bytes) {
+                SkMemoryStream stream(bytes, length, /*copyData=*/false);
+                typeface = SkTypeface::MakeDeserialize(&stream, nullptr);
+            }
+            // As in SkPictureData, a typeface that fails to load is replaced rather than failing
+            // the whole picture.
+            fTypefaces[i] = typeface ? std::move(typeface) : SkTypeface::MakeEmpty();
+        }
+
+        SkReadBuffer paints;
+        this->startSection(&payload, &paints);
+        const uint32_t paintCount = paints.readUInt();
+        if (!paints.validate(paintCount <= paints.available())) {
+            return false;
+        }
+        fPaints.reserve(paintCount);
+        for (uint32_t i = 0; i < paintCount && paints.isValid(); i++) {
+            fPaints.push_back(SkPaintPriv::Unflatten(paints));
+        }
+
+        SkReadBuffer paths;
+        this->startSection(&payload, &paths);
+        const uint32_t pathCount = paths.readUInt();
+        if (!paths.validate(pathCount <= paths.available())) {
+            return false;
+        }
+        fPaths.reserve(pathCount);
+        for (uint32_t i = 0; i < pathCount && paths.isValid(); i++) {
+            SkPath path;
+            paths.readPath(&path);
+            fPaths.emplace_back(path);
+        }
+
+        SkReadBuffer ops;
+        this->startSection(&payload, &ops);
+        const uint32_t opCount = ops.readUInt();
+        if (!ops.validate(opCount <= ops.available())) {
+            return false;
+        }
+        for (uint32_t i = 0; i < opCount && ops.isValid(); i++) {
+            this->readOp(ops);
+        }
+        // SkPictureRecorder always finishes with every save restored; the bounds and playback
+        // code relies on that.
+        ops.validate(fSaveDepth == 0);
+        return payload.isValid() && paints.isValid() && paths.isValid() && ops.isValid();
+    }
+
+    size_t subPictureBytes() const { return fSubPictureBytes; }
+
+private:
+    // Points `section` at the next byte array in `payload`. An empty section is invalid as soon
+    // as it is read from, so a truncated payload fails without special cases.
+    void startSection(SkReadBuffer* payload, SkReadBuffer* section) {
+        size_t length = 0;
+        const void* bytes = payload->skipByteArray(&length);
+        section->setMemory(bytes, bytes ? length : 0);
+        section->setVersion(fPictureVersion);
+        section->setDeserialProcs(fProcs);
+        section->setTypefaceArray(fTypefaces.get(), SkToInt(fTypefaces.size()));
+    }
+
+    template <typename T, typename... Args>
+    void append(Args&&... args) {
+        new (fRecord->append<T>()) T{std::forward<Args>(args)...};
+    }
+
+    template <typename T>
+    T* copy(const T* src) {
+        return src ? new (fRecord->alloc<T>()) T(*src) : nullptr;
+    }
+
+    const SkPaint* readPaint(SkReadBuffer& buffer) {
+        const uint32_t index = buffer.readUInt();
+        if (index == kNoPaint || !buffer.validate(index <= fPaints.size())) {
+            return nullptr;
+        }
+        return &fPaints[index - 1];
+    }
+
+    const SkPaint& readRequiredPaint(SkReadBuffer& buffer) {
+        static const SkPaint kDefault;
+        const SkPaint* paint = this->readPaint(buffer);
+        buffer.validate(paint != nullptr);
+        return paint ? *paint : kDefault;
+    }
+
+    const SkPath& readPath(SkReadBuffer& buffer) {
+        static const SkRecords::PreCachedPath kEmpty;
+        const uint32_t index = buffer.readUInt();
+        return buffer.validate(index < fPaths.size()) ? fPaths[index] : kEmpty;
+    }
+
+    SkRRect readRRect(SkReadBuffer& buffer) {
+        SkRRect rrect;
+        buffer.readRRect(&rrect);
+        return rrect;
+    }
+
+    SkRecords::ClipOpAndAA readOpAA(SkReadBuffer& buffer) {
+        SkClipOp op = buffer.read32LE(SkClipOp::kMax_EnumValue);
+        bool aa = buffer.readBool();
+        return {op, aa};
+    }
+
+    SkMatrix readMatrix(SkReadBuffer& buffer) {
+        SkMatrix matrix;
+        buffer.readMatrix(&matrix);
+        return matrix;
+    }
+
+    template <typename T>
+    T* readOptional(SkReadBuffer& buffer) {
+        if (!buffer.readBool()) {
+            return nullptr;
+        }
+        return this->readArray<T>(buffer, 1);
+    }
+
+    // The bulk of an op's data is plain-old-data arrays, copied straight into the record's arena.
+    template <typename T>
+    T* readArray(SkReadBuffer& buffer, size_t count) {
+        const T* src = buffer.skipT<T>(count);
+        if (!src || count == 0) {
+            return nullptr;
+        }
+        T* dst = fRecord->alloc<T>(count);
+        memcpy(dst, src, count * sizeof(T));
+        return dst;
+    }
+
+    template <typename T>
+    T* readNullableArray(SkReadBuffer& buffer, size_t count) {
+        return buffer.readBool() ? this->readArray<T>(buffer, count) : nullptr;
+    }
+
+    int readCount(SkReadBuffer& buffer) {
+        const int count = buffer.readInt();
+        return buffer.validate(count >= 0 && SkToSizeT(count) <= buffer.available()) ? count : 0;
+    }
+
+    // SkCanvas drops draws of null images before they are recorded, so the record never has one.
+    sk_sp<SkImage> readRequiredImage(SkReadBuffer& buffer) {
+        sk_sp<SkImage> image = buffer.readImage();
+        buffer.validate(image != nullptr);
+        return image;
+    }
+
+    void pushSave() {
+        fSaveDepth++;
+    }
+
+    void popSave(SkReadBuffer& buffer) {
+        if (buffer.validate(fSaveDepth > 0)) {
+            fSaveDepth--;
+        }
+    }
+
+    void readOp(SkReadBuffer& buffer) {
+        using namespace SkRecords;
+        switch (buffer.read32LE(DrawEdgeAAImageSet_Type)) {
+            case Restore_Type: {
+                SkMatrix matrix = this->readMatrix(buffer);
+                this->popSave(buffer);
+                if (buffer.isValid()) {
+                    this->append<Restore>(matrix);
+                }
+            } break;
+            case Save_Type:
+                this->pushSave();
+                this->append<Save>();
+                break;
+            case SaveLayer_Type: {
+                SkRect* bounds = this->readOptional<SkRect>(buffer);
+                const SkPaint* paint = this->readPaint(buffer);
+                sk_sp<SkImageFilter> backdrop = buffer.readImageFilter();
+                SkCanvas::SaveLayerFlags flags = buffer.readUInt();
+                SkScalar backdropScale = buffer.readScalar();
+                const int filterCount = this->readCount(buffer);
+                AutoTArray<sk_sp<SkImageFilter>> filters(filterCount);
+                for (int i = 0; i < filterCount && buffer.isValid(); i++) {
+                    filters[i] = buffer.readImageFilter();
+                }
+                if (buffer.isValid()) {
+                    this->pushSave();
+                    this->append<SaveLayer>(bounds, this->copy(paint), std::move(backdrop), flags,
+                                            backdropScale, std::move(filters));
+                }
+            } break;
+            case SaveBehind_Type: {
+                SkRect* subset = this->readOptional<SkRect>(buffer);
+                if (buffer.isValid()) {
+                    this->pushSave();
+                    this->append<SaveBehind>(subset);
+                }
+            } break;
+            case SetMatrix_Type: {
+                SkMatrix matrix = this->readMatrix(buffer);
+                if (buffer.isValid()) {
+                    this->append<SetMatrix>(matrix);
+                }
+            } break;
+            case SetM44_Type: {
+                SkM44 matrix;
+                buffer.read(&matrix);
+                if (buffer.isValid()) {
+                    this->append<SetM44>(matrix);
+                }
+            } break;
+            case Concat_Type: {
+                SkMatrix matrix = this->readMatrix(buffer);
+                if (buffer.isValid()) {
+                    this->append<Concat>(matrix);
+                }
+            } break;
+            case Concat44_Type: {
+                SkM44 matrix;
+                buffer.read(&matrix);
+                if (buffer.isValid()) {
+                    this->append<Concat44>(matrix);
+                }
+            } break;
+            case Translate_Type: {
+                SkScalar dx = buffer.readScalar();
+                SkScalar dy = buffer.readScalar();
+                if (buffer.isValid()) {
+                    this->append<Translate>(dx, dy);
+                }
+            } break;
+            case Scale_Type: {
+                SkScalar sx = buffer.readScalar();
+                SkScalar sy = buffer.readScalar();
+                if (buffer.isValid()) {
+                    this->append<Scale>(sx, sy);
+                }
+            } break;
+            case ClipPath_Type: {
+                const SkPath& path = this->readPath(buffer);
+                ClipOpAndAA opAA = this->readOpAA(buffer);
+                if (buffer.isValid()) {
+                    this->append<ClipPath>(path, opAA);
+                }
+            } break;
+            case ClipRRect_Type: {
+                SkRRect rrect = this->readRRect(buffer);
+                ClipOpAndAA opAA = this->readOpAA(buffer);
+                if (buffer.isValid()) {
+                    this->append<ClipRRect>(rrect, opAA);
+                }
+            } break;
+            case ClipRect_Type: {
+                SkRect rect = buffer.readRect();
+                ClipOpAndAA opAA = this->readOpAA(buffer);
+                if (buffer.isValid()) {
+                    this->append<ClipRect>(rect, opAA);
+                }
+            } break;
+            case ClipRegion_Type: {
+                SkRegion region;
+                buffer.readRegion(&region);
+                SkClipOp op = buffer.read32LE(SkClipOp::kMax_EnumValue);
+                if (buffer.isValid()) {
+                    this->append<ClipRegion>(region, op);
+                }
+            } break;
+            case ClipShader_Type: {
+                sk_sp<SkShader> shader = buffer.readShader();
+                SkClipOp op = buffer.read32LE(SkClipOp::kMax_EnumValue);
+                if (buffer.isValid()) {
+                    this->append<ClipShader>(std::move(shader), op);
+                }
+            } break;
+            case ResetClip_Type:
+                this->append<ResetClip>();
+                break;
+            case DrawArc_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                SkRect oval = buffer.readRect();
+                SkScalar startAngle = buffer.readScalar();
+                SkScalar sweepAngle = buffer.readScalar();
+                bool useCenter = buffer.readBool();
+                if (buffer.isValid()) {
+                    this->append<DrawArc>(paint, oval, startAngle, sweepAngle, useCenter);
+                }
+            } break;
+            case DrawDRRect_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                SkRRect outer = this->readRRect(buffer);
+                SkRRect inner = this->readRRect(buffer);
+                if (buffer.isValid()) {
+                    this->append<DrawDRRect>(paint, outer, inner);
+                }
+            } break;
+            case DrawImage_Type: {
+                const SkPaint* paint = this->readPaint(buffer);
+                sk_sp<SkImage> image = this->readRequiredImage(buffer);
+                SkScalar left = buffer.readScalar();
+                SkScalar top = buffer.readScalar();
+                SkSamplingOptions sampling = buffer.readSampling();
+                if (buffer.isValid()) {
+                    this->append<DrawImage>(this->copy(paint), std::move(image), left, top,
+                                            sampling);
+                }
+            } break;
+            case DrawImageLattice_Type: {
+                const SkPaint* paint = this->readPaint(buffer);
+                sk_sp<SkImage> image = this->readRequiredImage(buffer);
+                const int xCount = this->readCount(buffer);
+                int* xDivs = this->readArray<int>(buffer, xCount);
+                const int yCount = this->readCount(buffer);
+                int* yDivs = this->readArray<int>(buffer, yCount);
+                const int flagCount = this->readCount(buffer);
+                auto* flags = this->readArray<SkCanvas::Lattice::RectType>(buffer, flagCount);
+                for (int i = 0; flags && i < flagCount; i++) {
+                    buffer.validate(flags[i] <= SkCanvas::Lattice::kFixedColor);
+                }
+                SkColor* colors = this->readNullableArray<SkColor>(buffer, flagCount);
+                SkIRect src;
+                buffer.readIRect(&src);
+                SkRect dst = buffer.readRect();
+                SkFilterMode filter = buffer.read32LE(SkFilterMode::kLast);
+                // As SkCanvas::drawImageLattice requires before recording: a rect type (and
+                // optionally a color) for every patch, and divs that fit the image.
+                if (buffer.isValid()) {
+                    SkSafeMath safe;
+                    const size_t patchCount = safe.mul(safe.addInt(xCount, 1),
+                                                       safe.addInt(yCount, 1));
+                    buffer.validate(safe && (flags ? SkToSizeT(flagCount) == patchCount
+                                                   : flagCount == 0 && !colors));
+                }
+                if (buffer.isValid()) {
+                    SkCanvas::Lattice lattice = {xDivs, yDivs, flags, xCount, yCount, &src, colors};
+                    buffer.validate(SkLatticeIter::Valid(image->width(), image->height(), lattice));
+                }
+                if (buffer.isValid()) {
+                    this->append<DrawImageLattice>(this->copy(paint), std::move(image),
+                                                   xCount, xDivs, yCount, yDivs,
+                                                   flagCount, flags, colors, src, dst, filter);
+                }
+            } break;
+            case DrawImageRect_Type: {
+                const SkPaint* paint = this->readPaint(buffer);
+                sk_sp<SkImage> image = this->readRequiredImage(buffer);
+                SkRect src = buffer.readRect();
+                SkRect dst = buffer.readRect();
+                SkSamplingOptions sampling = buffer.readSampling();
+                auto constraint = buffer.read32LE(SkCanvas::kFast_SrcRectConstraint);
+                if (buffer.isValid()) {
+                    this->append<DrawImageRect>(this->copy(paint), std::move(image), src, dst,
+                                                sampling, constraint);
+                }
+            } break;
+            case DrawOval_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                SkRect oval = buffer.readRect();
+                if (buffer.isValid()) {
+                    this->append<DrawOval>(paint, oval);
+                }
+            } break;
+            case DrawPaint_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                if (buffer.isValid()) {
+                    this->append<DrawPaint>(paint);
+                }
+            } break;
+            case DrawBehind_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                if (buffer.isValid()) {
+                    this->append<DrawBehind>(paint);
+                }
+            } break;
+            case DrawPath_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                const SkPath& path = this->readPath(buffer);
+                if (buffer.isValid()) {
+                    this->append<DrawPath>(paint, path);
+                }
+            } break;
+            case DrawPicture_Type: {
+                const SkPaint* paint = this->readPaint(buffer);
+                sk_sp<SkPicture> picture = SkPicturePriv::MakeFromBuffer(buffer);
+                buffer.validate(picture != nullptr);
+                SkMatrix matrix = this->readMatrix(buffer);
+                if (buffer.isValid()) {
+                    fSubPictureBytes += picture->approximateBytesUsed();
+                    this->append<DrawPicture>(this->copy(paint), std::move(picture), matrix);
+                }
+            } break;
+            case DrawPoints_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                auto mode = buffer.read32LE(SkCanvas::kPolygon_PointMode);
+                const int count = this->readCount(buffer);
+                SkPoint* pts = this->readArray<SkPoint>(buffer, count);
+                if (buffer.isValid()) {
+                    this->append<DrawPoints>(paint, mode, SkToUInt(count), pts);
+                }
+            } break;
+            case DrawRRect_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                SkRRect rrect = this->readRRect(buffer);
+                if (buffer.isValid()) {
+                    this->append<DrawRRect>(paint, rrect);
+                }
+            } break;
+            case DrawRect_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                SkRect rect = buffer.readRect();
+                if (buffer.isValid()) {
+                    this->append<DrawRect>(paint, rect);
+                }
+            } break;
+            case DrawRegion_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                SkRegion region;
+                buffer.readRegion(&region);
+                if (buffer.isValid()) {
+                    this->append<DrawRegion>(paint, region);
+                }
+            } break;
+            case DrawTextBlob_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                sk_sp<SkTextBlob> blob = SkTextBlobPriv::MakeFromBuffer(buffer);
+                buffer.validate(blob != nullptr);
+                SkScalar x = buffer.readScalar();
+                SkScalar y = buffer.readScalar();
+                if (buffer.isValid()) {
+                    this->append<DrawTextBlob>(paint, std::move(blob), x, y);
+                }
+            } break;
+            case DrawPatch_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                SkPoint* cubics =
+                        this->readNullableArray<SkPoint>(buffer, SkPatchUtils::kNumCtrlPts);
+                SkColor* colors =
+                        this->readNullableArray<SkColor>(buffer, SkPatchUtils::kNumCorners);
+                SkPoint* texCoords =
+                        this->readNullableArray<SkPoint>(buffer, SkPatchUtils::kNumCorners);
+                SkBlendMode bmode = buffer.read32LE(SkBlendMode::kLastMode);
+                if (buffer.isValid()) {
+                    this->append<DrawPatch>(paint, cubics, colors, texCoords, bmode);
+                }
+            } break;
+            case DrawAtlas_Type: {
+                const SkPaint* paint = this->readPaint(buffer);
+                sk_sp<SkImage> atlas = this->readRequiredImage(buffer);
+                const int count = this->readCount(buffer);
+                SkRSXform* xforms = this->readArray<SkRSXform>(buffer, count);
+                SkRect* texs = this->readArray<SkRect>(buffer, count);
+                SkColor* colors = this->readNullableArray<SkColor>(buffer, count);
+                SkBlendMode mode = buffer.read32LE(SkBlendMode::kLastMode);
+                SkSamplingOptions sampling = buffer.readSampling();
+                SkRect* cull = this->readOptional<SkRect>(buffer);
+                if (buffer.isValid()) {
+                    this->append<DrawAtlas>(this->copy(paint), std::move(atlas), xforms, texs,
+                                            colors, count, mode, sampling, cull);
+                }
+            } break;
+            case DrawVertices_Type: {
+                const SkPaint& paint = this->readRequiredPaint(buffer);
+                sk_sp<SkVertices> vertices = SkVerticesPriv::Decode(buffer);
+                buffer.validate(vertices != nullptr);
+                SkBlendMode bmode = buffer.read32LE(SkBlendMode::kLastMode);
+                if (buffer.isValid()) {
+                    this->append<DrawVertices>(paint, std::move(vertices), bmode);
+                }
+            } break;
+            case DrawShadowRec_Type: {
+                const SkPath& path = this->readPath(buffer);
+                SkDrawShadowRec rec;
+                buffer.readPoint3(&rec.fZPlaneParams);
+                buffer.readPoint3(&rec.fLightPos);
+                rec.fLightRadius = buffer.readScalar();
+                rec.fAmbientColor = buffer.readUInt();
+                rec.fSpotColor = buffer.readUInt();
+                rec.fFlags = buffer.readUInt();
+                if (buffer.isValid()) {
+                    this->append<DrawShadowRec>(path, rec);
+                }
+            } break;
+            case DrawAnnotation_Type: {
+                SkRect rect = buffer.readRect();
+                SkString key;
+                buffer.readString(&key);
+                sk_sp<SkData> value = buffer.readBool() ? buffer.readByteArrayAsData() : nullptr;
+                if (buffer.isValid()) {
+                    this->append<DrawAnnotation>(rect, std::move(key), std::move(value));
+                }
+            } break;
+            case DrawEdgeAAQuad_Type: {
+                SkRect rect = buffer.readRect();
+                SkPoint* clip = this->readNullableArray<SkPoint>(buffer, 4);
+                auto aa = buffer.read32LE(SkCanvas::kAll_QuadAAFlags);
+                SkColor4f color;
+                buffer.readColor4f(&color);
+                SkBlendMode mode = buffer.read32LE(SkBlendMode::kLastMode);
+                if (buffer.isValid()) {
+                    this->append<DrawEdgeAAQuad>(rect, clip, aa, color, mode);
+                }
+            } break;
+            case DrawEdgeAAImageSet_Type: {
+                const SkPaint* paint = this->readPaint(buffer);
+                const int count = this->readCount(buffer);
+                AutoTArray<SkCanvas::ImageSetEntry> set(count);
+                for (int i = 0; i < count && buffer.isValid(); i++) {
+                    SkCanvas::ImageSetEntry& entry = set[i];
+                    entry.fImage = this->readRequiredImage(buffer);
+                    entry.fSrcRect = buffer.readRect();
+                    entry.fDstRect = buffer.readRect();
+                    entry.fMatrixIndex = buffer.readInt();
+                    // Negative indices mean no matrix. Every other index needs a matrix after
+                    // the entries, which bounds it by the bytes left (and keeps the matrix count
+                    // from overflowing).
+                    buffer.validate(entry.fMatrixIndex < 0 ||
+                                    SkToSizeT(entry.fMatrixIndex) < buffer.available());
+                    entry.fAlpha = buffer.readScalar();
+                    entry.fAAFlags = buffer.read32LE(SkCanvas::kAll_QuadAAFlags);
+                    entry.fHasClip = buffer.readBool();
+                }
+                int clipCount = 0, matrixCount = 0;
+                if (buffer.isValid()) {
+                    SkCanvasPriv::GetDstClipAndMatrixCounts(set.data(), count, &clipCount,
+                                                            &matrixCount);
+                }
+                SkPoint* dstClips = this->readArray<SkPoint>(buffer, clipCount);
+                buffer.validate(SkToSizeT(matrixCount) <= buffer.available());
+                SkMatrix* matrices = matrixCount && buffer.isValid()
+                                             ? fRecord->alloc<SkMatrix>(matrixCount)
+                                             : nullptr;
+                for (int i = 0; matrices && i < matrixCount; i++) {
+                    new (matrices + i) SkMatrix(this->readMatrix(buffer));
+                }
+                SkSamplingOptions sampling = buffer.readSampling();
+                auto constraint = buffer.read32LE(SkCanvas::kFast_SrcRectConstraint);
+                if (buffer.isValid()) {
+                    this->append<DrawEdgeAAImageSet>(this->copy(paint), std::move(set), count,
+                                                     dstClips, matrices, sampling, constraint);
+                }
+            } break;
+            default:
+                // NoOp is never written, and the types without a serialized form are refused by
+                // the Writer.
+                buffer.validate(false);
+                break;
+        }
+    }
+
+    SkRecord*                              fRecord;
+    const SkDeserialProcs&                 fProcs;
+    const uint32_t                         fPictureVersion;
+    AutoTArray<sk_sp<SkTypeface>>          fTypefaces;
+    std::vector<SkPaint>                   fPaints;
+    std::vector<SkRecords::PreCachedPath>  fPaths;
+    size_t                                 fSubPictureBytes = 0;
+    int                                    fSaveDepth = 0;
+};
+
+}  // namespace
+
+bool SkRecordSerialize(const SkRecord& record, const SkSerialProcs& procs, SkWStream* stream) {
+    Writer writer(procs);
+    if (!writer.writeOps(record)) {
+        return false;
+    }
+    writer.finish(stream);
+    return true;
+}
+
+sk_sp<SkRecord> SkRecordDeserialize(const void* data, size_t size, const SkDeserialProcs& procs,
+                                    uint32_t pictureVersion, size_t* subPictureBytes) {
+    if (!data || !SkIsAlign4(reinterpret_cast<uintptr_t>(data))) {
+        return nullptr;
+    }
+    auto record = sk_make_sp<SkRecord>();
+    Reader reader(record.get(), procs, pictureVersion);
+    if (!reader.read(data, size)) {
+        return nullptr;
+    }
+    *subPictureBytes = reader.subPictureBytes();
+    return record;
+}
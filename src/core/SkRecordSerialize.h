@@ -0,0 +1,39 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRecordSerialize_DEFINED
+#define SkRecordSerialize_DEFINED
+
+#include "include/core/SkRefCnt.h"
+
+#include <cstddef>
+#include <cstdint>
+
+class SkRecord;
+class SkWStream;
+struct SkDeserialProcs;
+struct SkSerialProcs;
+
+// A compact binary format for SkRecord, written after the SkPictInfo header of an SKP (see
+// SkPicturePriv::SerializeCompact). Ops are stored in record order with their fields inline, and
+// plain-old-data arrays are stored as-is so they load with a single copy into the record's arena.
+// Paints, paths and typefaces live in side tables, so each distinct one is written only once.
+//
+// Loading appends each op directly to an SkRecord. The SkPictureData format instead has to be
+// replayed through an SkCanvas into an SkRecorder, which validates and copies every op again.
+
+// Returns false, having written nothing, if the record holds ops this format can't represent
+// (DrawDrawable, DrawMesh and DrawSlug).
+bool SkRecordSerialize(const SkRecord&, const SkSerialProcs&, SkWStream*);
+
+// Returns null if the data is malformed. `pictureVersion` is the SkPictInfo version the data was
+// written with, which governs how paints and flattenables are read. The approximate size of any
+// nested pictures is returned in `subPictureBytes`.
+sk_sp<SkRecord> SkRecordDeserialize(const void* data, size_t size, const SkDeserialProcs&,
+                                    uint32_t pictureVersion, size_t* subPictureBytes);
+
+#endif//SkRecordSerialize_DEFINED
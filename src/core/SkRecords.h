@@ -166,6 +166,10 @@ enum Tags {
     kDrawWithPaint_Tag = kDraw_Tag | kHasPaint_Tag,
 };
 
+// TODO: Ops hold their SkPaint by value, so recording copies every paint and refs its effects.
+// Interning paints into a per-record table would avoid both, but SkRecordOpts rewrites op paints
+// in place and would first need to copy a shared paint before changing it.
+
 // A macro to make it a little easier to define a struct that can be stored in SkRecord.
 #define RECORD(T, tags, ...)                \
     struct T {                              \
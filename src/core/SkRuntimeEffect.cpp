@@ -13,6 +13,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkData.h"
+#include "include/core/SkMilestone.h"
 #include "include/private/base/SkAlign.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkMutex.h"
@@ -44,6 +45,8 @@
 #include "src/sksl/SkSLCompiler.h"
 #include "src/sksl/SkSLContext.h"
 #include "src/sksl/SkSLDefines.h"
+#include "src/sksl/SkSLLexer.h"
+#include "src/sksl/SkSLModuleData.h"
 #include "src/sksl/SkSLProgramKind.h"
 #include "src/sksl/SkSLProgramSettings.h"
 #include "src/sksl/analysis/SkSLProgramUsage.h"
@@ -61,6 +64,7 @@
 #include "src/sksl/tracing/SkSLDebugTracePriv.h"
 
 #include <algorithm>
+#include <atomic>
 
 using namespace skia_private;
 
@@ -215,6 +219,10 @@ sk_sp<const SkData> SkRuntimeEffectPriv::TransformUniforms(
 }
 
 const SkSL::RP::Program* SkRuntimeEffect::getRPProgram(SkSL::DebugTracePriv* debugTrace) const {
+    // The inliner pass below modifies fBaseProgram, so only the effect that owns it may run it.
+    if (fRPProgramOwner) {
+        return fRPProgramOwner->getRPProgram(debugTrace);
+    }
     // Lazily compile the program the first time `getRPProgram` is called.
     // By using an SkOnce, we avoid thread hazards and behave in a conceptually const way, but we
     // can avoid the cost of invoking the RP code generator until it's actually needed.
@@ -464,19 +472,285 @@ SkSL::ProgramSettings SkRuntimeEffect::MakeSettings(const Options& options) {
 // in the IR generator would provide better errors messages (with locations).
 #define RETURN_FAILURE(...) return Result{nullptr, SkStringPrintf(__VA_ARGS__)}
 
+namespace {
+
+// Process-wide cache of compiled effects. It is split into independently locked shards so that
+// threads creating unrelated effects don't serialize on a single mutex. The count limit is divided
+// among the shards, so that the whole cache never holds more entries than the limit.
+//
+// Effects are found by their exact SkSL or, failing that, by its token stream. The second tier
+// lets edits that only touch whitespace or comments (common while iterating on an effect in a
+// hot-reloading tool) reuse the compiled effect instead of running the whole compiler again.
+// Entries of both tiers share the shards and count against the same limit.
+class RuntimeEffectCache {
+public:
+    enum class Tier : uint32_t { kSource, kTokens };
+
+    static RuntimeEffectCache& Get() {
+        static SkNoDestructor<RuntimeEffectCache> cache;
+        return *cache;
+    }
+
+    // The key holds the tier, the SkSL (or its token stream) and everything else that influences
+    // the compiled result, so a hit is verified by comparing it in full rather than trusting the
+    // hash alone.
+    static std::string MakeKey(Tier tier, SkSpan<const uint32_t> header, std::string_view sksl) {
+        std::string key(reinterpret_cast<const char*>(&tier), sizeof(tier));
+        key.append(reinterpret_cast<const char*>(header.data()), header.size_bytes());
+        key.append(sksl);
+        return key;
+    }
+
+    sk_sp<SkRuntimeEffect> find(const std::string& key, uint64_t hash) {
+        Shard& shard = this->shard(hash);
+        SkAutoMutexExclusive _(shard.fMutex);
+        Entry* entry = shard.fLRU.find(hash);
+        return entry && entry->fKey == key ? entry->fEffect : nullptr;
+    }
+
+    void add(std::string key, uint64_t hash, sk_sp<SkRuntimeEffect> effect) {
+        Shard& shard = this->shard(hash);
+        SkAutoMutexExclusive _(shard.fMutex);
+        if (shard.fCountLimit > 0) {
+            shard.fLRU.insert_or_update(hash, {std::move(key), std::move(effect)});
+        }
+    }
+
+    int countLimit() const { return fCountLimit.load(std::memory_order_relaxed); }
+
+    int setCountLimit(int count) {
+        count = std::max(count, 0);
+        const int prev = fCountLimit.exchange(count, std::memory_order_relaxed);
+        for (int i = 0; i < kShardCount; ++i) {
+            Shard& shard = fShards[i];
+            SkAutoMutexExclusive _(shard.fMutex);
+            shard.fCountLimit = ShardCountLimit(count, i);
+            shard.fLRU.setMaxCount(shard.fCountLimit);
+        }
+        return prev;
+    }
+
+    int count() {
+        int count = 0;
+        for (Shard& shard : fShards) {
+            SkAutoMutexExclusive _(shard.fMutex);
+            count += shard.fLRU.count();
+        }
+        return count;
+    }
+
+private:
+    static constexpr int kShardCount = 8;
+    static constexpr int kDefaultCountLimit = 64;
+
+    // The share of count that shard i holds; the shares add up to count.
+    static int ShardCountLimit(int count, int i) {
+        return count / kShardCount + (i < count % kShardCount ? 1 : 0);
+    }
+
+    struct Entry {
+        std::string            fKey;
+        sk_sp<SkRuntimeEffect> fEffect;
+    };
+
+    struct Shard {
+        SkMutex                       fMutex;
+        int                           fCountLimit = kDefaultCountLimit / kShardCount;
+        SkLRUCache<uint64_t, Entry>   fLRU{kDefaultCountLimit / kShardCount};
+    };
+    static_assert(kDefaultCountLimit % kShardCount == 0);
+
+    Shard& shard(uint64_t hash) { return fShards[hash % kShardCount]; }
+
+    std::atomic<int> fCountLimit{kDefaultCountLimit};
+    Shard            fShards[kShardCount];
+};
+
+// The SkSL's tokens, each followed by a space, without the whitespace and comments between them.
+// Sources with the same token stream compile to the same program. A directive ends at a newline,
+// so that newline is kept.
+std::string token_stream(std::string_view sksl) {
+    using Kind = SkSL::Token::Kind;
+    std::string tokens;
+    tokens.reserve(sksl.size());
+    SkSL::Lexer lexer;
+    lexer.start(sksl);
+    bool inDirective = false;
+    for (;;) {
+        SkSL::Token token = lexer.next();
+        std::string_view text = sksl.substr(token.fOffset, token.fLength);
+        switch (token.fKind) {
+            case Kind::TK_END_OF_FILE:
+                return tokens;
+
+            case Kind::TK_WHITESPACE:
+                if (inDirective && text.find('\n') != std::string_view::npos) {
+                    tokens += '\n';
+                    inDirective = false;
+                }
+                continue;
+
+            case Kind::TK_LINE_COMMENT:
+            case Kind::TK_BLOCK_COMMENT:
+                continue;
+
+            case Kind::TK_DIRECTIVE:
+                inDirective = true;
+                break;
+
+            default:
+                break;
+        }
+        tokens.append(text);
+        tokens += ' ';
+    }
+}
+
+std::atomic<SkRuntimeEffect::PersistentCache*> gPersistentCache{nullptr};
+
+//  SK_RUNTIME_EFFECT_CACHE_BUILD_ID can be set using -D on your compiler commandline, or by using
+//  the defines in SkUserConfig.h
+#ifndef SK_RUNTIME_EFFECT_CACHE_BUILD_ID
+    #define SK_RUNTIME_EFFECT_CACHE_BUILD_ID ""
+#endif
+
+// Identifies the compiler that produced a persistent cache entry, so entries stored by another
+// build are never matched: the format of the stored data, the milestone, the embedder's build ID
+// and a hash of the modules runtime effects are compiled against.
+const std::string& compiler_build_id() {
+    static constexpr uint32_t kStoredFormatVersion = 2;
+    static const SkNoDestructor<std::string> buildID([] {
+        uint64_t moduleHash = 0;
+        for (auto [name, filename] : {
+                 std::pair{SkSL::ModuleName::sksl_shared,    "sksl_shared.sksl"},
+                 std::pair{SkSL::ModuleName::sksl_public,    "sksl_public.sksl"},
+                 std::pair{SkSL::ModuleName::sksl_rt_shader, "sksl_rt_shader.sksl"}}) {
+            const std::string module = SkSL::GetModuleData(name, filename);
+            moduleHash = SkChecksum::Hash64(module.data(), module.size(), moduleHash);
+        }
+        return SkStringPrintf("%u:%d:%s:%016llx:", kStoredFormatVersion, SK_MILESTONE,
+                              SK_RUNTIME_EFFECT_CACHE_BUILD_ID,
+                              (unsigned long long)moduleHash).c_str();
+    }());
+    return *buildID;
+}
+
+// The program's own elements, printed back as SkSL. This is what the persistent tier stores.
+std::string optimized_program_text(const SkSL::Program& program) {
+    std::string text = program.fConfig->versionDescription();
+    for (const std::unique_ptr<SkSL::ProgramElement>& element : program.fOwnedElements) {
+        text += element->description();
+    }
+    return text;
+}
+
+}  // namespace
+
+int SkRuntimeEffectPriv::GetCacheCountLimit() {
+    return RuntimeEffectCache::Get().countLimit();
+}
+
+int SkRuntimeEffectPriv::SetCacheCountLimit(int count) {
+    return RuntimeEffectCache::Get().setCountLimit(count);
+}
+
+int SkRuntimeEffectPriv::GetCacheCountForTesting() {
+    return RuntimeEffectCache::Get().count();
+}
+
+SkRuntimeEffect::PersistentCache* SkRuntimeEffect::SetPersistentCache(PersistentCache* cache) {
+    return gPersistentCache.exchange(cache);
+}
+
 SkRuntimeEffect::Result SkRuntimeEffect::MakeFromSource(SkString sksl,
                                                         const Options& options,
                                                         SkSL::ProgramKind kind) {
-    SkSL::Compiler compiler;
-    SkSL::ProgramSettings settings = MakeSettings(options);
-    std::unique_ptr<SkSL::Program> program =
-            compiler.convertProgram(kind, std::string(sksl.c_str(), sksl.size()), settings);
+    auto compile = [&](std::string source, std::string* optimizedText) -> Result {
+        SkSL::Compiler compiler;
+        SkSL::ProgramSettings settings = MakeSettings(options);
+        std::unique_ptr<SkSL::Program> program =
+                compiler.convertProgram(kind, std::move(source), settings);
+
+        if (!program) {
+            RETURN_FAILURE("%s", compiler.errorText().c_str());
+        }
+        if (optimizedText) {
+            *optimizedText = optimized_program_text(*program);
+        }
+        return MakeInternal(std::move(program), options, kind);
+    };
 
-    if (!program) {
-        RETURN_FAILURE("%s", compiler.errorText().c_str());
+    // Mirrors the Options fields folded into fHash by the SkRuntimeEffect constructor.
+    const uint32_t keyHeader[] = {
+        static_cast<uint32_t>(kind),
+        options.forceUnoptimized,
+        options.allowPrivateAccess,
+        options.optimizeRPStages,
+        options.useRPNativeCode,
+        options.fStableKey,
+        static_cast<uint32_t>(options.maxVersionAllowed),
+    };
+    using Tier = RuntimeEffectCache::Tier;
+    RuntimeEffectCache& cache = RuntimeEffectCache::Get();
+    const std::string_view source(sksl.c_str(), sksl.size());
+    std::string key = RuntimeEffectCache::MakeKey(Tier::kSource, keyHeader, source);
+    const uint64_t hash = SkChecksum::Hash64(key.data(), key.size());
+    std::string tokenKey;
+    uint64_t tokenHash = 0;
+    if (options.useSharedCache) {
+        if (sk_sp<SkRuntimeEffect> effect = cache.find(key, hash)) {
+            return Result{std::move(effect), SkString()};
+        }
+
+        tokenKey = RuntimeEffectCache::MakeKey(Tier::kTokens, keyHeader, token_stream(source));
+        tokenHash = SkChecksum::Hash64(tokenKey.data(), tokenKey.size());
+        if (sk_sp<SkRuntimeEffect> effect = cache.find(tokenKey, tokenHash)) {
+            // Reuse the compiled program, but report the caller's SkSL.
+            if (effect->source() != source) {
+                effect.reset(new SkRuntimeEffect(*effect, std::string(source)));
+            }
+            cache.add(std::move(key), hash, effect);
+            return Result{std::move(effect), SkString()};
+        }
+    }
+    auto addToCache = [&](const sk_sp<SkRuntimeEffect>& effect) {
+        if (options.useSharedCache) {
+            cache.add(std::move(tokenKey), tokenHash, effect);
+            cache.add(std::move(key), hash, effect);
+        }
+    };
+
+    PersistentCache* persistentCache = gPersistentCache.load();
+    sk_sp<SkData> persistentKey;
+    if (persistentCache) {
+        const std::string storedKey = compiler_build_id() + key;
+        persistentKey = SkData::MakeWithCopy(storedKey.data(), storedKey.size());
+        if (sk_sp<SkData> stored = persistentCache->load(*persistentKey)) {
+            Result result = compile(std::string(static_cast<const char*>(stored->data()),
+                                                stored->size()),
+                                    /*optimizedText=*/nullptr);
+            if (result.effect) {
+                // Report the caller's SkSL, not the stored text it was compiled from.
+                result.effect->fSource = std::make_unique<const std::string>(sksl.c_str(),
+                                                                             sksl.size());
+                addToCache(result.effect);
+                return result;
+            }
+        }
     }
 
-    return MakeInternal(std::move(program), options, kind);
+    std::string optimizedText;
+    Result result = compile(std::string(sksl.c_str(), sksl.size()),
+                            persistentCache ? &optimizedText : nullptr);
+    if (result.effect) {
+        if (persistentCache) {
+            persistentCache->store(*persistentKey,
+                                   *SkData::MakeWithCopy(optimizedText.data(),
+                                                         optimizedText.size()));
+        }
+        addToCache(result.effect);
+    }
+    return result;
 }
 
 SkRuntimeEffect::Result SkRuntimeEffect::MakeInternal(std::unique_ptr<SkSL::Program> program,
@@ -512,6 +786,12 @@ SkRuntimeEffect::Result SkRuntimeEffect::MakeInternal(std::unique_ptr<SkSL::Prog
     if (options.forceUnoptimized) {
         flags |= kDisableOptimization_Flag;
     }
+    if (!options.optimizeRPStages) {
+        flags |= kDisableRPStageOpts_Flag;
+    }
+    if (options.useRPNativeCode) {
+        flags |= kUseRPNativeCode_Flag;
+    }
 
     // Find 'main', then locate the sample coords parameter. (It might not be present.)
     const SkSL::FunctionDeclaration* main = program->getFunction("main");
@@ -632,7 +912,7 @@ sk_sp<SkRuntimeEffect> SkRuntimeEffect::makeUnoptimizedClone() {
     SkSL::Compiler compiler;
     SkSL::ProgramSettings settings = MakeSettings(options);
     std::unique_ptr<SkSL::Program> program =
-            compiler.convertProgram(kind, *fBaseProgram->fSource, settings);
+            compiler.convertProgram(kind, this->source(), settings);
 
     if (!program) {
         // Turning off compiler optimizations can theoretically expose a program error that
@@ -680,19 +960,9 @@ SkRuntimeEffect::Result SkRuntimeEffect::MakeForBlender(SkString sksl, const Opt
 sk_sp<SkRuntimeEffect> SkMakeCachedRuntimeEffect(
         SkRuntimeEffect::Result (*make)(SkString sksl, const SkRuntimeEffect::Options&),
         SkString sksl) {
-    static SkNoDestructor<SkMutex> mutex;
-    static SkNoDestructor<SkLRUCache<uint64_t, sk_sp<SkRuntimeEffect>>> cache(11 /*arbitrary*/);
-
-    uint64_t key = SkChecksum::Hash64(sksl.c_str(), sksl.size());
-    {
-        SkAutoMutexExclusive _(*mutex);
-        if (sk_sp<SkRuntimeEffect>* found = cache->find(key)) {
-            return *found;
-        }
-    }
-
     SkRuntimeEffect::Options options;
     SkRuntimeEffectPriv::AllowPrivateAccess(&options);
+    options.useSharedCache = true;
 
     auto [effect, err] = make(std::move(sksl), options);
     if (!effect) {
@@ -700,11 +970,6 @@ sk_sp<SkRuntimeEffect> SkMakeCachedRuntimeEffect(
         return nullptr;
     }
     SkASSERT(err.isEmpty());
-
-    {
-        SkAutoMutexExclusive _(*mutex);
-        cache->insert_or_update(key, effect);
-    }
     return effect;
 }
 
@@ -753,9 +1018,10 @@ SkRuntimeEffect::SkRuntimeEffect(std::unique_ptr<SkSL::Program> baseProgram,
     // Everything from SkRuntimeEffect::Options which could influence the compiled result needs to
     // be accounted for in `fHash`. If you've added a new field to Options and caused the static-
     // assert below to trigger, please incorporate your field into `fHash` and update KnownOptions
-    // to match the layout of Options.
+    // to match the layout of Options. (useSharedCache only decides where the effect is kept.)
     struct KnownOptions {
-        bool forceUnoptimized, allowPrivateAccess;
+        bool forceUnoptimized, useSharedCache;
+        bool allowPrivateAccess, optimizeRPStages, useRPNativeCode;
         uint32_t fStableKey;
         SkSL::Version maxVersionAllowed;
     };
@@ -764,16 +1030,33 @@ SkRuntimeEffect::SkRuntimeEffect(std::unique_ptr<SkSL::Program> baseProgram,
                                sizeof(options.forceUnoptimized), fHash);
     fHash = SkChecksum::Hash32(&options.allowPrivateAccess,
                                sizeof(options.allowPrivateAccess), fHash);
+    fHash = SkChecksum::Hash32(&options.optimizeRPStages,
+                               sizeof(options.optimizeRPStages), fHash);
+    fHash = SkChecksum::Hash32(&options.useRPNativeCode,
+                               sizeof(options.useRPNativeCode), fHash);
     fHash = SkChecksum::Hash32(&options.fStableKey,
                                sizeof(options.fStableKey), fHash);
     fHash = SkChecksum::Hash32(&options.maxVersionAllowed,
                                sizeof(options.maxVersionAllowed), fHash);
 }
 
+SkRuntimeEffect::SkRuntimeEffect(const SkRuntimeEffect& original, std::string source)
+        : fHash(original.fHash)
+        , fStableKey(original.fStableKey)
+        , fBaseProgram(original.fBaseProgram)
+        , fSource(std::make_unique<const std::string>(std::move(source)))
+        , fRPProgramOwner(original.fRPProgramOwner ? original.fRPProgramOwner
+                                                   : sk_ref_sp(&original))
+        , fMain(original.fMain)
+        , fUniforms(original.fUniforms)
+        , fChildren(original.fChildren)
+        , fSampleUsages(original.fSampleUsages)
+        , fFlags(original.fFlags) {}
+
 SkRuntimeEffect::~SkRuntimeEffect() = default;
 
 const std::string& SkRuntimeEffect::source() const {
-    return *fBaseProgram->fSource;
+    return fSource ? *fSource : *fBaseProgram->fSource;
 }
 
 size_t SkRuntimeEffect::uniformSize() const {
@@ -101,6 +101,27 @@ public:
         options->fStableKey = stableKey;
     }
 
+    static void DisableRPStageOptimization(SkRuntimeEffect::Options* options) {
+        options->optimizeRPStages = false;
+    }
+
+    static void UseRPNativeCode(SkRuntimeEffect::Options* options) {
+        options->useRPNativeCode = true;
+    }
+
+    static SkSL::RP::AppendStagesOptions RPAppendStagesOptions(const SkRuntimeEffect& effect) {
+        SkSL::RP::AppendStagesOptions options;
+        options.optimizeStages = !(effect.fFlags & SkRuntimeEffect::kDisableRPStageOpts_Flag);
+        options.useNativeCode = effect.fFlags & SkRuntimeEffect::kUseRPNativeCode_Flag;
+        return options;
+    }
+
+    // Backs SkGraphics::Get/SetRuntimeEffectCacheCountLimit.
+    static int GetCacheCountLimit();
+    static int SetCacheCountLimit(int count);
+    // The number of entries in the shared effect cache now.
+    static int GetCacheCountForTesting();
+
     static SkRuntimeEffect::Uniform VarAsUniform(const SkSL::Variable&,
                                                  const SkSL::Context&,
                                                  size_t* offset);
@@ -145,7 +166,9 @@ public:
 //     2) they're cached.
 //
 // Users of the public SkRuntimeEffect::Make*() can of course cache however they like themselves;
-// keeping these APIs private means users will not be forced into our cache or cache policy.
+// keeping these APIs private means users will not be forced into our cache or cache policy. They
+// can opt in to it with Options::useSharedCache; SkGraphics::SetRuntimeEffectCacheCountLimit
+// sets its size.
 
 sk_sp<SkRuntimeEffect> SkMakeCachedRuntimeEffect(
         SkRuntimeEffect::Result (*make)(SkString sksl, const SkRuntimeEffect::Options&),
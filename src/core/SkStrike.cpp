@@ -16,14 +16,18 @@
 #include "include/core/SkTypeface.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkTFitsIn.h"
+#include "include/private/base/SkTo.h"
 #include "src/core/SkGlyph.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkTHash.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <algorithm>
 #include <cctype>
 #include <new>
 #include <optional>
@@ -255,6 +259,87 @@ SkSpan<const SkGlyph*> SkStrike::prepareDrawables(
     return {results, glyphIDs.size()};
 }
 
+void SkStrike::prerasterize(SkSpan<const SkPackedGlyphID> glyphIDs,
+                            SkExecutor* executor,
+                            bool includePaths) {
+    std::vector<SkPackedGlyphID> missing;
+    {
+        Monitor m{this};
+        skia_private::THashSet<SkPackedGlyphID> seen;
+        for (SkPackedGlyphID packedID : glyphIDs) {
+            if (seen.contains(packedID)) {
+                continue;
+            }
+            seen.add(packedID);
+            SkGlyphDigest* digest = fDigestForPackedGlyphID.find(packedID);
+            const SkGlyph* glyph = digest ? fGlyphForIndex[digest->index()] : nullptr;
+            if (glyph == nullptr ||
+                !glyph->setImageHasBeenCalled() ||
+                (includePaths && !glyph->setPathHasBeenCalled())) {
+                missing.push_back(packedID);
+            }
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    // Every task makes its own scaler context, so give each enough glyphs to be worth it.
+    static constexpr int kMinGlyphsPerTask = 32;
+    static constexpr int kMaxTaskCount = 16;
+    const int taskCount = executor == nullptr
+            ? 1
+            : std::clamp(SkToInt(missing.size()) / kMinGlyphsPerTask, 1, kMaxTaskCount);
+
+    std::vector<std::unique_ptr<SkArenaAlloc>> allocs(taskCount);
+    std::vector<std::vector<SkGlyph*>> generated(taskCount);
+    auto generate = [&](int task) {
+        std::unique_ptr<SkScalerContext> scaler = fStrikeSpec.createScalerContext();
+        allocs[task] = std::make_unique<SkArenaAlloc>(kMinAllocAmount);
+        SkArenaAlloc* alloc = allocs[task].get();
+        // Interleave the glyphs so that runs of complex glyphs are spread over all the tasks.
+        for (size_t i = task; i < missing.size(); i += taskCount) {
+            SkGlyph* glyph = alloc->make<SkGlyph>(scaler->makeGlyph(missing[i], alloc));
+            if (includePaths) {
+                glyph->setPath(alloc, scaler.get());
+            }
+            glyph->setImage(alloc, scaler.get());
+            generated[task].push_back(glyph);
+        }
+    };
+    if (taskCount == 1) {
+        generate(0);
+    } else {
+        SkTaskGroup(*executor).batch(taskCount, generate);
+    }
+
+    // Copy the results into the strike's arena, so that the task arenas can go and everything
+    // the strike keeps is counted in fMemoryIncrease.
+    Monitor m{this};
+    for (const std::vector<SkGlyph*>& glyphs : generated) {
+        for (const SkGlyph* from : glyphs) {
+            SkGlyphDigest* digest = fDigestForPackedGlyphID.find(from->getPackedID());
+            SkGlyph* glyph;
+            if (digest == nullptr) {
+                glyph = fAlloc.make<SkGlyph>(from->getPackedID());
+                fMemoryIncrease += glyph->setMetricsAndImage(&fAlloc, *from) + sizeof(SkGlyph);
+                this->addGlyphAndDigest(glyph);
+            } else {
+                // The strike already had metrics for this glyph, or a draw added it while the
+                // tasks ran. Only copy in what it is still missing.
+                glyph = fGlyphForIndex[digest->index()];
+                if (!glyph->setImageHasBeenCalled() && glyph->setImage(&fAlloc, from->image())) {
+                    fMemoryIncrease += glyph->imageSize();
+                }
+            }
+            if (from->setPathHasBeenCalled() &&
+                glyph->setPath(&fAlloc, from->path(), from->pathIsHairline())) {
+                fMemoryIncrease += glyph->path()->approximateBytesUsed();
+            }
+        }
+    }
+}
+
 void SkStrike::glyphIDsToPaths(SkSpan<sktext::IDOrPath> idsOrPaths) {
     Monitor m{this};
     for (sktext::IDOrPath& idOrPath : idsOrPaths) {
@@ -319,6 +404,13 @@ void SkStrike::dumpMemoryStatistics(SkTraceMemoryDump* dump) const {
     dump->setMemoryBacking(dumpName.c_str(), "malloc", nullptr);
 }
 
+void SkStrike::forEachGlyph(const std::function<void(const SkGlyph&)>& visitor) const {
+    SkAutoMutexExclusive lock{fStrikeLock};
+    for (const SkGlyph* glyph : fGlyphForIndex) {
+        visitor(*glyph);
+    }
+}
+
 SkGlyph* SkStrike::glyph(SkGlyphDigest digest) {
     return fGlyphForIndex[digest.index()];
 }
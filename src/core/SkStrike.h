@@ -22,11 +22,13 @@
 #include "src/text/StrikeForGPU.h"
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <vector>
 
 class SkDescriptor;
 class SkDrawable;
+class SkExecutor;
 class SkPath;
 class SkReadBuffer;
 class SkStrikeCache;
@@ -99,6 +101,16 @@ public:
     SkSpan<const SkGlyph*> prepareDrawables(
             SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) SK_EXCLUDES(fStrikeLock);
 
+    // Generate the metrics and images, and the paths if includePaths is set, of every glyph in
+    // glyphIDs that the strike is still missing them for, splitting the work into tasks run on
+    // executor. Each task uses its own scaler context, so the strike stays usable meanwhile; the
+    // results are added to the strike together, under one lock, once all tasks are done. With a
+    // null executor the glyphs are generated on the calling thread. Scaler contexts that lock
+    // their font face, as FreeType's do, still generate one glyph at a time.
+    void prerasterize(SkSpan<const SkPackedGlyphID> glyphIDs,
+                      SkExecutor* executor,
+                      bool includePaths = false) SK_EXCLUDES(fStrikeLock);
+
     // SkStrikeForGPU APIs
     const SkDescriptor& getDescriptor() const override {
         return fStrikeSpec.descriptor();
@@ -131,6 +143,11 @@ public:
     void dump() const SK_EXCLUDES(fStrikeLock);
     void dumpMemoryStatistics(SkTraceMemoryDump* dump) const SK_EXCLUDES(fStrikeLock);
 
+    // Call visitor with each glyph of the strike, holding the strike lock. A glyph's image and path
+    // never change once set, so they stay valid after the visit for as long as the strike lives.
+    void forEachGlyph(
+            const std::function<void(const SkGlyph&)>& visitor) const SK_EXCLUDES(fStrikeLock);
+
     SkGlyph* glyph(SkGlyphDigest) SK_REQUIRES(fStrikeLock);
 
 private:
@@ -37,12 +37,21 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 }
 
 auto SkStrikeCache::findOrCreateStrike(const SkStrikeSpec& strikeSpec) -> sk_sp<SkStrike> {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
-    if (strike == nullptr) {
-        strike = this->internalCreateStrike(strikeSpec);
+    sk_sp<SkStrike> strike;
+    sk_sp<SkStrikeDiskCache> diskCache;
+    {
+        SkAutoMutexExclusive ac(fLock);
+        strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
+        if (strike == nullptr) {
+            strike = this->internalCreateStrike(strikeSpec);
+            diskCache = fDiskCache;
+        }
+        this->internalPurge();
+    }
+    // Merging glyphs into the strike updates the cache's memory use, which takes fLock.
+    if (diskCache != nullptr) {
+        diskCache->load(strike.get());
     }
-    this->internalPurge();
     return strike;
 }
 
@@ -50,6 +59,11 @@ sk_sp<StrikeForGPU> SkStrikeCache::findOrCreateScopedStrike(const SkStrikeSpec&
     return this->findOrCreateStrike(strikeSpec);
 }
 
+void SkStrikeCache::setDiskCache(sk_sp<SkStrikeDiskCache> diskCache) {
+    SkAutoMutexExclusive ac(fLock);
+    fDiskCache = std::move(diskCache);
+}
+
 void SkStrikeCache::PurgeAll() {
     GlobalStrikeCache()->purgeAll();
 }
@@ -13,6 +13,7 @@
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkThreadAnnotations.h"
 #include "src/core/SkStrike.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
@@ -74,8 +75,13 @@ public:
     size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
     size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
 
+    // Strikes made by findOrCreateStrike() are first filled with the glyphs diskCache has for
+    // them. Nothing is written to diskCache; call SkStrikeDiskCache::storeAll() for that.
+    void setDiskCache(sk_sp<SkStrikeDiskCache> diskCache) SK_EXCLUDES(fLock);
+
 private:
     friend class SkStrike;  // for SkStrike::updateDelta
+    friend class SkStrikeDiskCache;  // for forEachStrike
     static constexpr char kGlyphCacheDumpName[] = "skia/sk_glyph_cache";
     sk_sp<SkStrike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
     sk_sp<SkStrike> internalCreateStrike(
@@ -112,6 +118,7 @@ private:
     int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
     int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
     int32_t fPinnerCount SK_GUARDED_BY(fLock) {0};
+    sk_sp<SkStrikeDiskCache> fDiskCache SK_GUARDED_BY(fLock);
 };
 
 #endif  // SkStrikeCache_DEFINED
@@ -0,0 +1,442 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkStrikeDiskCache.h"
+
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkMilestone.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDescriptor.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrike.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkWriteBuffer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <random>
+
+using namespace skia_private;
+
+// The file starts with a FileHeader. Each record is a RecordHeader followed by fSize bytes of
+// payload: the font hash, the normalized descriptor, then the glyphs.
+static constexpr uint32_t kFileMagic = SkSetFourByteTag('s', 'k', 'g', 'c');
+static constexpr uint32_t kVersion = 2;
+static constexpr uint32_t kRecordMagic = SkSetFourByteTag('s', 'k', 'g', 'r');
+
+// The glyphs in the file depend on the code that rasterized them as much as on the file format,
+// so the header also names the Skia milestone and the caller's build ID.
+struct FileHeader {
+    uint32_t fMagic;
+    uint32_t fVersion;
+    uint32_t fMilestone;
+    uint32_t fBuildHash;
+};
+
+static FileHeader make_file_header(uint32_t buildHash) {
+    return {kFileMagic, kVersion, SK_MILESTONE, buildHash};
+}
+
+struct RecordHeader {
+    uint32_t fMagic;
+    uint32_t fSize;
+    uint32_t fChecksum;
+    uint32_t fReserved;
+};
+
+static bool is_file_header(const uint8_t* bytes, size_t available, uint32_t buildHash) {
+    FileHeader header;
+    if (available < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    const FileHeader expected = make_file_header(buildHash);
+    return memcmp(&header, &expected, sizeof(header)) == 0;
+}
+
+static uint64_t key_hash(uint64_t fontHash, const void* descriptor, size_t size) {
+    return SkChecksum::Hash64(descriptor, size, fontHash);
+}
+
+// Calls fn with the ID of every glyph in data written by SkStrike::FlattenGlyphsByType.
+template <typename Fn>
+static void for_each_glyph_id(const void* data, size_t size, Fn&& fn) {
+    SkReadBuffer buffer{data, size};
+    const int imagesCount = buffer.readInt();
+    for (int i = 0; i < imagesCount && buffer.isValid(); ++i) {
+        std::optional<SkGlyph> glyph = SkGlyph::MakeFromBuffer(buffer);
+        if (!buffer.validate(glyph.has_value())) {
+            return;
+        }
+        if (!glyph->isEmpty() && SkGlyphDigest::FitsInAtlas(*glyph)) {
+            buffer.skipByteArray(nullptr);
+        }
+        fn(glyph->getPackedID());
+    }
+    const int pathsCount = buffer.readInt();
+    for (int i = 0; i < pathsCount && buffer.isValid(); ++i) {
+        std::optional<SkGlyph> glyph = SkGlyph::MakeFromBuffer(buffer);
+        if (!buffer.validate(glyph.has_value())) {
+            return;
+        }
+        if (buffer.readBool()) {
+            SkPath path;
+            buffer.readBool();
+            buffer.readPath(&path);
+        }
+        fn(glyph->getPackedID());
+    }
+}
+
+sk_sp<SkStrikeDiskCache> SkStrikeDiskCache::Open(const char path[],
+                                                 size_t sizeLimit,
+                                                 const char buildID[]) {
+    const uint32_t buildHash = SkChecksum::Hash32(buildID, strlen(buildID));
+    if (!sk_exists(path)) {
+        FILE* file = sk_fopen(path, kAppend_SkFILE_Flag);
+        if (file == nullptr) {
+            return nullptr;
+        }
+        // Another process may have created the file too; a repeated header is skipped on read.
+        const FileHeader header = make_file_header(buildHash);
+        sk_fwrite(&header, sizeof(header), file);
+        sk_fclose(file);
+    }
+
+    // A file written by another build fails its header check, and is rewritten empty.
+    sk_sp<SkStrikeDiskCache> cache{new SkStrikeDiskCache{path, sizeLimit, buildHash}};
+    cache->refresh();
+    return cache;
+}
+
+SkStrikeDiskCache::SkStrikeDiskCache(const char path[], size_t sizeLimit, uint32_t buildHash)
+        : fPath{path}
+        , fSizeLimit{sizeLimit}
+        , fBuildHash{buildHash} {}
+
+void SkStrikeDiskCache::refresh() {
+    SkAutoMutexExclusive lock{fMutex};
+    fRewriteFailed = false;
+    if (!this->map()) {
+        this->rewrite(fSizeLimit);
+    }
+}
+
+size_t SkStrikeDiskCache::sizeInBytesForTesting() const {
+    SkAutoMutexExclusive lock{fMutex};
+    return fData ? fData->size() : 0;
+}
+
+bool SkStrikeDiskCache::map() {
+    fRecords.reset();
+    fKnownGlyphs.reset();
+    fData = SkData::MakeFromFileName(fPath.c_str());
+    if (fData == nullptr) {
+        return true;
+    }
+    if (!is_file_header(fData->bytes(), fData->size(), fBuildHash)) {
+        fData = nullptr;
+        return false;
+    }
+
+    const uint8_t* bytes = fData->bytes();
+    const size_t size = fData->size();
+    size_t offset = sizeof(FileHeader);
+    while (offset < size) {
+        if (is_file_header(bytes + offset, size - offset, fBuildHash)) {
+            offset += sizeof(FileHeader);
+            continue;
+        }
+        // A record that runs past the end is most likely one another process is still
+        // appending, so it ends the data without making the file damaged. If that process died
+        // instead, the next record appended after it will fail its checksum.
+        RecordHeader header;
+        if (size - offset < sizeof(header)) {
+            return true;
+        }
+        memcpy(&header, bytes + offset, sizeof(header));
+        const size_t payload = offset + sizeof(header);
+        if (header.fMagic == kRecordMagic && header.fSize > size - payload) {
+            return true;
+        }
+        if (header.fMagic != kRecordMagic ||
+            header.fChecksum != SkChecksum::Hash32(bytes + payload, header.fSize)) {
+            // Everything from here on may be torn; rewrite() drops it.
+            break;
+        }
+
+        SkReadBuffer buffer{bytes + payload, header.fSize};
+        const uint64_t fontHashLow = buffer.readUInt();
+        const uint64_t fontHash = fontHashLow | (uint64_t)buffer.readUInt() << 32;
+        const size_t descriptorOffset = payload + buffer.offset();
+        std::optional<SkAutoDescriptor> descriptor = SkAutoDescriptor::MakeFromBuffer(buffer);
+        if (!buffer.isValid() || !descriptor.has_value()) {
+            break;
+        }
+        const size_t glyphsOffset = payload + buffer.offset();
+        const uint64_t hash = key_hash(fontHash,
+                                       bytes + descriptorOffset,
+                                       glyphsOffset - descriptorOffset);
+        const size_t end = payload + header.fSize;
+        fRecords[hash].push_back({offset, payload, glyphsOffset, end});
+        offset = end;
+    }
+    return offset == size;
+}
+
+std::optional<uint64_t> SkStrikeDiskCache::fontHash(const SkTypeface& typeface) {
+    {
+        SkAutoMutexExclusive lock{fMutex};
+        if (const uint64_t* hash = fFontHashes.find(typeface.uniqueID())) {
+            return *hash;
+        }
+    }
+
+    int ttcIndex = 0;
+    std::unique_ptr<SkStreamAsset> stream = typeface.openStream(&ttcIndex);
+    if (stream == nullptr) {
+        return std::nullopt;
+    }
+    sk_sp<SkData> data = SkData::MakeFromStream(stream.get(), stream->getLength());
+    if (data == nullptr) {
+        return std::nullopt;
+    }
+    uint64_t hash = SkChecksum::Hash64(data->data(), data->size(), ttcIndex);
+
+    const int axisCount = typeface.getVariationDesignPosition(nullptr, 0);
+    if (axisCount > 0) {
+        AutoSTMalloc<4, SkFontArguments::VariationPosition::Coordinate> position(axisCount);
+        if (typeface.getVariationDesignPosition(position.get(), axisCount) == axisCount) {
+            hash = SkChecksum::Hash64(position.get(), axisCount * sizeof(position[0]), hash);
+        }
+    }
+
+    // Another thread may have hashed the same typeface meanwhile, with the same result.
+    SkAutoMutexExclusive lock{fMutex};
+    fFontHashes.set(typeface.uniqueID(), hash);
+    return hash;
+}
+
+std::optional<SkStrikeDiskCache::Key> SkStrikeDiskCache::makeKey(const SkStrike& strike) {
+    std::optional<uint64_t> fontHash = this->fontHash(strike.strikeSpec().typeface());
+    if (!fontHash.has_value()) {
+        return std::nullopt;
+    }
+
+    // The typeface ID is only meaningful to this process, so clear it.
+    SkAutoDescriptor descriptor{strike.getDescriptor()};
+    uint32_t size;
+    void* ptr = const_cast<void*>(descriptor.getDesc()->findEntry(kRec_SkDescriptorTag, &size));
+    SkScalerContextRec rec;
+    if (!ptr || size != sizeof(rec)) {
+        return std::nullopt;
+    }
+    memcpy((void*)&rec, ptr, size);
+    rec.fTypefaceID = 0;
+    memcpy(ptr, &rec, size);
+    descriptor.getDesc()->computeChecksum();
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(descriptor.getDesc());
+    return Key{*fontHash, {bytes, bytes + descriptor.getDesc()->getLength()}};
+}
+
+bool SkStrikeDiskCache::load(SkStrike* strike) {
+    std::optional<Key> key = this->makeKey(*strike);
+    if (!key.has_value()) {
+        return false;
+    }
+    SkAutoMutexExclusive lock{fMutex};
+    if (fData == nullptr) {
+        return false;
+    }
+    const uint64_t hash = key_hash(key->fFontHash, key->fDescriptor.data(),
+                                   key->fDescriptor.size());
+    std::vector<Record>* records = fRecords.find(hash);
+    if (records == nullptr) {
+        return false;
+    }
+
+    THashSet<SkPackedGlyphID>& known = fKnownGlyphs[hash];
+    bool loaded = false;
+    for (const Record& record : *records) {
+        const uint8_t* bytes = fData->bytes();
+        uint32_t fontHash[2];
+        memcpy(fontHash, bytes + record.fKey, sizeof(fontHash));
+        const size_t descriptorSize = record.fGlyphs - record.fKey - sizeof(fontHash);
+        if ((fontHash[0] | (uint64_t)fontHash[1] << 32) != key->fFontHash ||
+            descriptorSize != key->fDescriptor.size() ||
+            memcmp(bytes + record.fKey + sizeof(fontHash),
+                   key->fDescriptor.data(), descriptorSize) != 0) {
+            continue;
+        }
+
+        SkReadBuffer buffer{bytes + record.fGlyphs, record.fEnd - record.fGlyphs};
+        if (strike->mergeFromBuffer(buffer)) {
+            for_each_glyph_id(bytes + record.fGlyphs, record.fEnd - record.fGlyphs,
+                              [&](SkPackedGlyphID id) { known.add(id); });
+            loaded = true;
+        }
+    }
+    return loaded;
+}
+
+bool SkStrikeDiskCache::store(const SkStrike& strike) {
+    std::optional<Key> key = this->makeKey(strike);
+    if (!key.has_value()) {
+        return false;
+    }
+    SkAutoMutexExclusive lock{fMutex};
+    if (fRewriteFailed) {
+        // The file is over its limit and can't be replaced, so don't let it grow further.
+        return false;
+    }
+    const uint64_t hash = key_hash(key->fFontHash, key->fDescriptor.data(),
+                                   key->fDescriptor.size());
+
+    // Glyphs another process stored for this strike are known too, even if never loaded here.
+    THashSet<SkPackedGlyphID>* known = fKnownGlyphs.find(hash);
+    if (known == nullptr) {
+        known = fKnownGlyphs.set(hash, {});
+        if (const std::vector<Record>* records = fRecords.find(hash)) {
+            for (const Record& record : *records) {
+                for_each_glyph_id(fData->bytes() + record.fGlyphs, record.fEnd - record.fGlyphs,
+                                  [&](SkPackedGlyphID id) { known->add(id); });
+            }
+        }
+    }
+
+    std::vector<SkGlyph> images, paths;
+    strike.forEachGlyph([&](const SkGlyph& glyph) {
+        if (known->contains(glyph.getPackedID())) {
+            return;
+        }
+        // Empty and oversized glyphs are written without image data.
+        if (glyph.setImageHasBeenCalled()) {
+            images.push_back(glyph);
+        }
+        if (glyph.setPathHasBeenCalled()) {
+            paths.push_back(glyph);
+        }
+    });
+    if (images.empty() && paths.empty()) {
+        return true;
+    }
+
+    SkBinaryWriteBuffer buffer({});
+    buffer.writeUInt(static_cast<uint32_t>(key->fFontHash));
+    buffer.writeUInt(static_cast<uint32_t>(key->fFontHash >> 32));
+    buffer.writePad32(key->fDescriptor.data(), key->fDescriptor.size());
+    SkStrike::FlattenGlyphsByType(buffer, images, paths, {});
+    sk_sp<SkData> payload = buffer.snapshotAsData();
+
+    // Write the record with one write, so appends from other processes can't land inside it.
+    const RecordHeader header = {kRecordMagic,
+                                 SkToU32(payload->size()),
+                                 SkChecksum::Hash32(payload->data(), payload->size()),
+                                 0};
+    std::vector<uint8_t> record(sizeof(header) + payload->size());
+    memcpy(record.data(), &header, sizeof(header));
+    memcpy(record.data() + sizeof(header), payload->data(), payload->size());
+
+    FILE* file = sk_fopen(fPath.c_str(), kAppend_SkFILE_Flag);
+    if (file == nullptr) {
+        return false;
+    }
+    setvbuf(file, nullptr, _IONBF, 0);
+    const bool written = sk_fwrite(record.data(), record.size(), file) == record.size();
+    const size_t fileSize = sk_fgetsize(file);
+    sk_fclose(file);
+    if (!written) {
+        return false;
+    }
+
+    for (const SkGlyph& glyph : images) {
+        known->add(glyph.getPackedID());
+    }
+    for (const SkGlyph& glyph : paths) {
+        known->add(glyph.getPackedID());
+    }
+
+    if (fileSize > fSizeLimit) {
+        // Keep half the limit, leaving room to grow before the next rewrite.
+        this->map();
+        fRewriteFailed = !this->rewrite(fSizeLimit / 2);
+    }
+    return true;
+}
+
+void SkStrikeDiskCache::storeAll(const SkStrikeCache& strikeCache) {
+    // Don't hold the strike cache's lock while writing the file.
+    std::vector<sk_sp<const SkStrike>> strikes;
+    strikeCache.forEachStrike([&](const SkStrike& strike) {
+        strikes.push_back(sk_ref_sp(&strike));
+    });
+    for (const sk_sp<const SkStrike>& strike : strikes) {
+        this->store(*strike);
+    }
+}
+
+bool SkStrikeDiskCache::rewrite(size_t byteLimit) {
+    std::vector<const Record*> records;
+    fRecords.foreach([&](uint64_t, const std::vector<Record>& keyRecords) {
+        for (const Record& record : keyRecords) {
+            records.push_back(&record);
+        }
+    });
+    std::sort(records.begin(), records.end(), [](const Record* a, const Record* b) {
+        return a->fStart > b->fStart;
+    });
+    size_t kept = sizeof(FileHeader);
+    size_t keptCount = 0;
+    for (const Record* record : records) {
+        if (kept + (record->fEnd - record->fStart) > byteLimit) {
+            break;
+        }
+        kept += record->fEnd - record->fStart;
+        keptCount++;
+    }
+    records.resize(keptCount);
+    std::reverse(records.begin(), records.end());
+
+    // Caches in processes forked from this one have the same address, so name the temporary file
+    // randomly rather than after this.
+    std::random_device random;
+    SkString tmpPath = SkStringPrintf("%s.%08x%08x.tmp", fPath.c_str(), random(), random());
+    bool written;
+    {
+        SkFILEWStream file{tmpPath.c_str()};
+        if (!file.isValid()) {
+            return false;
+        }
+        const FileHeader header = make_file_header(fBuildHash);
+        written = file.write(&header, sizeof(header));
+        for (const Record* record : records) {
+            written = written && file.write(fData->bytes() + record->fStart,
+                                            record->fEnd - record->fStart);
+        }
+        file.fsync();
+    }
+    // Windows can't replace a file that is mapped, so let go of this process' mapping first.
+    // Mappings in other processes may still make replacing fail there.
+    fRecords.reset();
+    fData = nullptr;
+    const bool replaced = written && sk_freplace(tmpPath.c_str(), fPath.c_str());
+    if (!replaced) {
+        std::remove(tmpPath.c_str());
+    }
+    this->map();
+    return replaced;
+}
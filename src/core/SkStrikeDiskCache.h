@@ -0,0 +1,110 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrikeDiskCache_DEFINED
+#define SkStrikeDiskCache_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkTHash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class SkStrike;
+class SkStrikeCache;
+class SkTypeface;
+
+// A glyph cache kept in a file, so that processes rendering with the same fonts can reuse each
+// other's rasterized glyphs instead of rebuilding every strike from the font at startup.
+//
+// The file is a sequence of records, each holding some glyph images and paths of one strike in
+// the format SkStrike::FlattenGlyphsByType writes. A record is keyed by a hash of the font file
+// and the strike's SkDescriptor, with the typeface ID cleared since it differs between processes.
+// Processes read the file through a shared read-only mapping and only ever append to it, so any
+// number of them can use it at once. A record running past the end of the file is taken to be an
+// append still in progress, and ends the data read. Every record carries a checksum; reading stops
+// at the first record that fails it, which is what a torn or interleaved append looks like, and
+// the file is then rewritten without it, so that records appended later can be read again.
+//
+// When the file grows past its size limit, it is rewritten keeping its newest records, and the new
+// file replaces the old one by rename. Processes still mapping the old file keep using it until
+// they next refresh(). Where the file can't be replaced, e.g. on Windows while another process
+// maps it, nothing more is stored until the next refresh(), so the file stops growing.
+class SkStrikeDiskCache : public SkRefCnt {
+public:
+    // buildID identifies the code that rasterizes glyphs: the build of Skia and of the font
+    // libraries beneath it, such as FreeType. A file written with another buildID, or by another
+    // Skia milestone, is discarded, so that glyphs from an older rasterizer are not served after
+    // an upgrade. Returns null if the file at path can neither be read nor created.
+    static sk_sp<SkStrikeDiskCache> Open(const char path[], size_t sizeLimit,
+                                         const char buildID[]);
+
+    // Merge the glyphs the file has for strike into it. Returns true if there were any.
+    bool load(SkStrike* strike) SK_EXCLUDES(fMutex);
+
+    // Append the glyph images and paths of strike that neither this process loaded nor any
+    // process stored before. Returns false if the file could not be written.
+    bool store(const SkStrike& strike) SK_EXCLUDES(fMutex);
+
+    // Store every strike in strikeCache.
+    void storeAll(const SkStrikeCache& strikeCache) SK_EXCLUDES(fMutex);
+
+    // Map the file again, picking up records other processes appended, or a rewritten file.
+    void refresh() SK_EXCLUDES(fMutex);
+
+    size_t sizeInBytesForTesting() const SK_EXCLUDES(fMutex);
+
+private:
+    // Offsets into fData of the record's header, payload, glyphs and end.
+    struct Record {
+        size_t fStart;
+        size_t fKey;
+        size_t fGlyphs;
+        size_t fEnd;
+    };
+    struct Key {
+        uint64_t fFontHash;
+        std::vector<uint8_t> fDescriptor;
+    };
+
+    SkStrikeDiskCache(const char path[], size_t sizeLimit, uint32_t buildHash);
+
+    std::optional<Key> makeKey(const SkStrike&) SK_EXCLUDES(fMutex);
+    // Hashing reads the whole font, so it is done without holding fMutex, once per typeface.
+    std::optional<uint64_t> fontHash(const SkTypeface&) SK_EXCLUDES(fMutex);
+    // Returns false if the file is damaged: reading stopped before its end, at a record that is
+    // not an unfinished append.
+    bool map() SK_REQUIRES(fMutex);
+    // Rewrite the file with as many of its newest intact records as fit in byteLimit. Returns
+    // false if the file could not be replaced.
+    bool rewrite(size_t byteLimit) SK_REQUIRES(fMutex);
+
+    const SkString fPath;
+    const size_t fSizeLimit;
+    const uint32_t fBuildHash;
+
+    mutable SkMutex fMutex;
+    sk_sp<SkData> fData SK_GUARDED_BY(fMutex);
+    // Records by a hash of their Key, in file order.
+    skia_private::THashMap<uint64_t, std::vector<Record>> fRecords SK_GUARDED_BY(fMutex);
+    // The glyphs loaded from or stored to the file, by the hash of the strike's Key.
+    skia_private::THashMap<uint64_t, skia_private::THashSet<SkPackedGlyphID>> fKnownGlyphs
+            SK_GUARDED_BY(fMutex);
+    skia_private::THashMap<uint32_t, uint64_t> fFontHashes SK_GUARDED_BY(fMutex);
+    // Set when the file went over its limit and could not be rewritten; cleared by refresh().
+    bool fRewriteFailed SK_GUARDED_BY(fMutex) = false;
+};
+
+#endif  // SkStrikeDiskCache_DEFINED
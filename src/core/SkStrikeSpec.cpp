@@ -256,3 +256,8 @@ const SkGlyph* SkBulkGlyphMetricsAndImages::glyph(SkPackedGlyphID packedID) {
 const SkDescriptor& SkBulkGlyphMetricsAndImages::descriptor() const {
     return fStrike->getDescriptor();
 }
+
+void SkBulkGlyphMetricsAndImages::prerasterize(SkSpan<const SkPackedGlyphID> packedIDs,
+                                               SkExecutor* executor) {
+    fStrike->prerasterize(packedIDs, executor);
+}
@@ -62,7 +62,8 @@ bool SkRuntimeColorFilter::appendStages(const SkStageRec& rec, bool) const {
         SkShaders::MatrixRec matrix(SkMatrix::I());
         matrix.markCTMApplied();
         RuntimeEffectRPCallbacks callbacks(rec, matrix, fChildren, fEffect->fSampleUsages);
-        bool success = program->appendStages(rec.fPipeline, rec.fAlloc, &callbacks, uniforms);
+        bool success = program->appendStages(rec.fPipeline, rec.fAlloc, &callbacks, uniforms,
+                                             SkRuntimeEffectPriv::RPAppendStagesOptions(*fEffect));
         return success;
     }
     return false;
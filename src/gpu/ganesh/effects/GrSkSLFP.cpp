@@ -481,7 +481,8 @@ SkPMColor4f GrSkSLFP::constantOutputForConstantInput(const SkPMColor4f& inputCol
         SkRasterPipeline pipeline(&alloc);
         pipeline.appendConstantColor(&alloc, color.vec());
         ConstantOutputForConstantInput_SkRPCallbacks callbacks;
-        if (program->appendStages(&pipeline, &alloc, &callbacks, uniforms)) {
+        if (program->appendStages(&pipeline, &alloc, &callbacks, uniforms,
+                                  SkRuntimeEffectPriv::RPAppendStagesOptions(*fEffect))) {
             SkPMColor4f outputColor;
             SkRasterPipeline_MemoryCtx outputCtx = {&outputColor, 0};
             pipeline.append(SkRasterPipelineOp::store_f32, &outputCtx);
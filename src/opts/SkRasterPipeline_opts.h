@@ -3838,6 +3838,10 @@ STAGE_TAIL(set_base_pointer, std::byte* p) {
     base = p;
 }
 
+STAGE_TAIL(call_native_code, SkRasterPipeline_NativeCodeCtx* ctx) {
+    ctx->fn(base);
+}
+
 // All control flow stages used by SkSL maintain some state in the common registers:
 //   r: condition mask
 //   g: loop mask
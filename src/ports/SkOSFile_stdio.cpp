@@ -16,6 +16,7 @@
 #include <direct.h>
 #include <io.h>
 #include <vector>
+#include "src/base/SkLeanWindows.h"
 #include "src/base/SkUTF.h"
 #endif
 
@@ -33,18 +34,15 @@ static bool is_ascii(const char* s) {
     return true;
 }
 
-static FILE* fopen_win(const char* utf8path, const char* perm) {
-    if (is_ascii(utf8path)) {
-        return fopen(utf8path, perm);
-    }
-
+// Returns the null terminated UTF-16 form of utf8path, or an empty vector if it is malformed.
+static std::vector<uint16_t> to_utf16(const char* utf8path) {
     const char* ptr = utf8path;
     const char* end = utf8path + strlen(utf8path);
     size_t n = 0;
     while (ptr < end) {
         SkUnichar u = SkUTF::NextUTF8(&ptr, end);
         if (u < 0) {
-            return nullptr;  // malformed UTF-8
+            return {};  // malformed UTF-8
         }
         n += SkUTF::ToUTF16(u);
     }
@@ -56,6 +54,18 @@ static FILE* fopen_win(const char* utf8path, const char* perm) {
     }
     SkASSERT(out == &wchars[n]);
     *out = 0; // final null
+    return wchars;
+}
+
+static FILE* fopen_win(const char* utf8path, const char* perm) {
+    if (is_ascii(utf8path)) {
+        return fopen(utf8path, perm);
+    }
+
+    std::vector<uint16_t> wchars = to_utf16(utf8path);
+    if (wchars.empty()) {
+        return nullptr;
+    }
     wchar_t wperms[4] = {(wchar_t)perm[0], (wchar_t)perm[1], (wchar_t)perm[2], (wchar_t)perm[3]};
     return _wfopen((wchar_t*)wchars.data(), wperms);
 }
@@ -70,6 +80,8 @@ FILE* sk_fopen(const char path[], SkFILE_Flags flags) {
     }
     if (flags & kWrite_SkFILE_Flag) {
         *p++ = 'w';
+    } else if (flags & kAppend_SkFILE_Flag) {
+        *p++ = 'a';
     }
     *p = 'b';
 
@@ -89,13 +101,26 @@ FILE* sk_fopen(const char path[], SkFILE_Flags flags) {
     }
 #endif
 
-    if (nullptr == file && (flags & kWrite_SkFILE_Flag)) {
+    if (nullptr == file && (flags & (kWrite_SkFILE_Flag | kAppend_SkFILE_Flag))) {
         SkDEBUGF("sk_fopen: fopen(\"%s\", \"%s\") returned nullptr (errno:%d): %s\n",
                  path, perm, errno, strerror(errno));
     }
     return file;
 }
 
+bool sk_freplace(const char from[], const char to[]) {
+#ifdef _WIN32
+    // rename() fails on Windows when the destination exists.
+    std::vector<uint16_t> wfrom = to_utf16(from),
+                          wto = to_utf16(to);
+    return !wfrom.empty() && !wto.empty() &&
+           MoveFileExW((wchar_t*)wfrom.data(), (wchar_t*)wto.data(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
 size_t sk_fgetsize(FILE* f) {
     SkASSERT(f);
 
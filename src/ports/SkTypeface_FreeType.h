@@ -37,6 +37,8 @@ public:
     /** Return the font data, or nullptr on failure. */
     std::unique_ptr<SkFontData> makeFontData() const;
     class FaceRec;
+    /** The face shared by all of this typeface's scaler contexts, opened on first use. Any use of
+     *  it must hold its mutex; different typefaces' faces may be used concurrently. */
     FaceRec* getFaceRec() const;
 
     static constexpr SkTypeface::FactoryId FactoryId = SkSetFourByteTag('f','r','e','e');
@@ -7,22 +7,76 @@
 
 #include "src/shaders/SkPerlinNoiseShaderImpl.h"
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkShader.h"
+#include "include/core/SkTileMode.h"
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "src/base/SkArenaAlloc.h"
+#include "src/base/SkFloatBits.h"
 #include "src/core/SkEffectPriv.h"
 #include "src/core/SkRasterPipeline.h"
 #include "src/core/SkRasterPipelineOpContexts.h"
 #include "src/core/SkRasterPipelineOpList.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkResourceCache.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/shaders/SkPerlinNoiseShaderType.h"
 
 #include <optional>
 
+namespace {
+
+unsigned gPerlinNoiseKeyNamespaceLabel;
+
+struct PerlinNoiseKey : public SkResourceCache::Key {
+    PerlinNoiseKey(SkScalar seed, SkScalar baseFrequencyX, SkScalar baseFrequencyY,
+                   const SkISize& tileSize)
+            : fSeed(SkFloat2Bits(seed))
+            , fBaseFrequencyX(SkFloat2Bits(baseFrequencyX))
+            , fBaseFrequencyY(SkFloat2Bits(baseFrequencyY))
+            , fTileWidth(tileSize.fWidth)
+            , fTileHeight(tileSize.fHeight) {
+        this->init(&gPerlinNoiseKeyNamespaceLabel, 0,
+                   sizeof(fSeed) + sizeof(fBaseFrequencyX) + sizeof(fBaseFrequencyY) +
+                   sizeof(fTileWidth) + sizeof(fTileHeight));
+    }
+
+    uint32_t fSeed;
+    uint32_t fBaseFrequencyX;
+    uint32_t fBaseFrequencyY;
+    int32_t  fTileWidth;
+    int32_t  fTileHeight;
+};
+
+struct PerlinNoiseRec : public SkResourceCache::Rec {
+    PerlinNoiseRec(const PerlinNoiseKey& key, const SkPerlinNoiseShader::PaintingData& data)
+            : fKey(key)
+            , fData(data) {}
+
+    PerlinNoiseKey                    fKey;
+    SkPerlinNoiseShader::PaintingData fData;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this); }
+    const char* getCategory() const override { return "perlin-noise"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
+        const PerlinNoiseRec& rec = static_cast<const PerlinNoiseRec&>(baseRec);
+        auto* result = static_cast<std::unique_ptr<SkPerlinNoiseShader::PaintingData>*>(context);
+        *result = std::make_unique<SkPerlinNoiseShader::PaintingData>(rec.fData);
+        return true;
+    }
+};
+
+}  // namespace
+
 SkPerlinNoiseShader::SkPerlinNoiseShader(SkPerlinNoiseShaderType type,
                                          SkScalar baseFrequencyX,
                                          SkScalar baseFrequencyY,
@@ -46,6 +100,40 @@ SkPerlinNoiseShader::SkPerlinNoiseShader(SkPerlinNoiseShaderType type,
     static_assert(SkPerlinNoiseShader::kBlockSize == 256);
 }
 
+std::unique_ptr<SkPerlinNoiseShader::PaintingData> SkPerlinNoiseShader::getPaintingData() const {
+    // The cached copy never has its bitmaps generated, since those would point into the cached
+    // tables rather than the returned copy.
+    PerlinNoiseKey key(fSeed, fBaseFrequencyX, fBaseFrequencyY, fTileSize);
+    std::unique_ptr<PaintingData> data;
+    if (!SkResourceCache::Find(key, PerlinNoiseRec::Visitor, &data)) {
+        data = std::make_unique<PaintingData>(fTileSize, fSeed, fBaseFrequencyX, fBaseFrequencyY);
+        SkResourceCache::Add(new PerlinNoiseRec(key, *data));
+    }
+    return data;
+}
+
+sk_sp<SkShader> SkPerlinNoiseShader::makeBakedTileShader() const {
+    if (!fStitchTiles ||
+        fTileSize.width() > kMaxBakedTileSize || fTileSize.height() > kMaxBakedTileSize) {
+        return nullptr;
+    }
+
+    fBakeTileOnce([&] {
+        SkBitmap tile;
+        if (!tile.tryAllocN32Pixels(fTileSize.width(), fTileSize.height())) {
+            return;
+        }
+        SkPaint paint;
+        paint.setShader(sk_ref_sp(this));
+        SkCanvas(tile).drawPaint(paint);
+        tile.setImmutable();
+        fBakedTileShader = tile.asImage()->makeShader(SkTileMode::kRepeat,
+                                                      SkTileMode::kRepeat,
+                                                      SkSamplingOptions(SkFilterMode::kNearest));
+    });
+    return fBakedTileShader;
+}
+
 sk_sp<SkFlattenable> SkPerlinNoiseShader::CreateProc(SkReadBuffer& buffer) {
     SkPerlinNoiseShaderType type = buffer.read32LE(SkPerlinNoiseShaderType::kLast);
 
@@ -98,7 +186,7 @@ bool SkPerlinNoiseShader::appendStages(const SkStageRec& rec,
     ctx->stitchDataInX = fPaintingData->fStitchDataInit.fWidth;
     ctx->stitchDataInY = fPaintingData->fStitchDataInit.fHeight;
     ctx->stitching = fStitchTiles;
-    ctx->numOctaves = fNumOctaves;
+    ctx->numOctaves = this->numOctaves();
     ctx->latticeSelector = fPaintingData->fLatticeSelector;
     ctx->noiseData = &fPaintingData->fNoise[0][0][0];
 
@@ -13,6 +13,7 @@
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPoint.h"
+#include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkTypes.h"
@@ -27,6 +28,7 @@
 #include <memory>
 
 class SkReadBuffer;
+class SkShader;
 enum class SkPerlinNoiseShaderType;
 struct SkStageRec;
 class SkWriteBuffer;
@@ -236,6 +238,10 @@ public:
     };  // struct PaintingData
 
     static const int kMaxOctaves = 255;  // numOctaves must be <= 0 and <= kMaxOctaves
+    // Each octave contributes half as much as the previous one. Past this many octaves the
+    // remaining contributions sum to less than 2^-15 (below the precision of 16-bit channels), so
+    // every backend stops there instead of evaluating all of the up to kMaxOctaves requested.
+    static const int kMaxEvaluatedOctaves = 17;
 
     SkPerlinNoiseShader(SkPerlinNoiseShaderType type,
                         SkScalar baseFrequencyX,
@@ -247,13 +253,24 @@ public:
     ShaderType type() const override { return ShaderType::kPerlinNoise; }
 
     SkPerlinNoiseShaderType noiseType() const { return fType; }
-    int numOctaves() const { return fNumOctaves; }
+    // The number of octaves to evaluate. The requested number is kept for serialization.
+    int numOctaves() const { return std::min(fNumOctaves, kMaxEvaluatedOctaves); }
     bool stitchTiles() const { return fStitchTiles; }
     SkISize tileSize() const { return fTileSize; }
 
-    std::unique_ptr<PaintingData> getPaintingData() const {
-        return std::make_unique<PaintingData>(fTileSize, fSeed, fBaseFrequencyX, fBaseFrequencyY);
-    }
+    // Returns a copy of the permutation and gradient tables for this shader's seed, frequencies
+    // and tile size. The tables are shared through SkResourceCache, since clients such as SVG
+    // filters typically create a new, otherwise identical, shader for every frame.
+    std::unique_ptr<PaintingData> getPaintingData() const;
+
+    // Renders a single stitched tile of this noise into a raster image and returns a shader that
+    // repeats it with nearest-neighbor sampling. For untransformed, pixel-aligned draws into an
+    // sRGB or untagged destination this matches the noise within the first two tiles, and it
+    // makes the noise exactly periodic beyond them. Returns null if this shader doesn't stitch
+    // tiles or the tile is larger than kMaxBakedTileSize in either dimension.
+    sk_sp<SkShader> makeBakedTileShader() const;
+
+    static constexpr int kMaxBakedTileSize = 1024;
 
     bool appendStages(const SkStageRec& rec, const SkShaders::MatrixRec& mRec) const override;
 
@@ -274,6 +291,9 @@ private:
     mutable SkOnce fInitPaintingDataOnce;
     std::unique_ptr<PaintingData> fPaintingData;
 
+    mutable SkOnce fBakeTileOnce;
+    mutable sk_sp<SkShader> fBakedTileShader;
+
     friend void SkRegisterPerlinNoiseShaderFlattenable();
 };
 
@@ -94,7 +94,8 @@ bool SkRuntimeShader::appendStages(const SkStageRec& rec, const SkShaders::Matri
                                                     rec.fDstCS,
                                                     rec.fAlloc);
         RuntimeEffectRPCallbacks callbacks(rec, *newMRec, fChildren, fEffect->fSampleUsages);
-        bool success = program->appendStages(rec.fPipeline, rec.fAlloc, &callbacks, uniforms);
+        bool success = program->appendStages(rec.fPipeline, rec.fAlloc, &callbacks, uniforms,
+                                             SkRuntimeEffectPriv::RPAppendStagesOptions(*fEffect));
         return success;
     }
     return false;
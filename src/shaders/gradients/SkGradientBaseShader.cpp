@@ -12,8 +12,10 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkShader.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTileMode.h"
 #include "include/private/SkColorData.h"
 #include "include/private/base/SkFloatingPoint.h"
@@ -22,6 +24,7 @@
 #include "include/private/base/SkTPin.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkArenaAlloc.h"
+#include "src/base/SkAutoMalloc.h"
 #include "src/base/SkFloatBits.h"
 #include "src/base/SkVx.h"
 #include "src/core/SkColorSpacePriv.h"
@@ -33,10 +36,12 @@
 #include "src/core/SkRasterPipelineOpContexts.h"
 #include "src/core/SkRasterPipelineOpList.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkResourceCache.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <optional>
 #include <utility>
 
@@ -526,6 +531,171 @@ void SkGradientBaseShader::AppendInterpolatedToDstStages(SkRasterPipeline* p,
             ->apply(p);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Gradient LUTs
+//
+// A LUT holds the gradient's final color (after interpolation and conversion to the destination
+// color space) at N evenly spaced t values, stored as an evenly_spaced_gradient context so that the
+// existing vectorized stage interpolates linearly between entries. Colors are exact at the sample
+// points; in between, the error is bounded by how far the exact gradient deviates from a straight
+// line over an interval of 1/(N-1) in t. In particular, hard stops become ramps at most 1/(N-1)
+// wide, and colors interpolated in polar or perceptual spaces are approximated piecewise linearly.
+
+namespace {
+
+// Gradients with more stops than this search fewer, wider bands per pixel with a LUT.
+constexpr int kLUTMinStopCount = 4;
+constexpr int kSmallLUTSize = 256;
+constexpr int kLargeLUTSize = 1024;
+// Stop counts beyond this use the larger LUT so narrow bands keep their shape.
+constexpr int kLargeLUTStopCount = 32;
+
+unsigned gGradientLUTKeyNamespaceLabel;
+
+// SkResourceCache keys must be tightly packed, but the gradient's stops have variable length, so
+// the key header and its contents are written into a single allocation.
+class GradientLUTKey {
+public:
+    GradientLUTKey(const SkGradientBaseShader& shader, const SkColorSpace* dstCS, int lutSize) {
+        const int count = shader.getColorCount();
+        const bool hasPositions = shader.getPositions() != nullptr;
+        const size_t dataSize = sizeof(uint32_t) * kHeaderWords +
+                                sizeof(SkColor4f) * count +
+                                (hasPositions ? sizeof(float) * count : 0);
+        fStorage.reset(sizeof(SkResourceCache::Key) + dataSize);
+
+        uint32_t* data = reinterpret_cast<uint32_t*>(
+                static_cast<char*>(fStorage.get()) + sizeof(SkResourceCache::Key));
+        const SkGradientBaseShader::Interpolation& interp = shader.getInterpolation();
+        *data++ = SkToU32(lutSize);
+        *data++ = SkToU32(count);
+        *data++ = hasPositions;
+        *data++ = (static_cast<uint32_t>(interp.fColorSpace) << 16) |
+                  (static_cast<uint32_t>(interp.fHueMethod) << 8) |
+                  static_cast<uint32_t>(interp.fInPremul);
+        *data++ = shader.fColorSpace->toXYZD50Hash();
+        *data++ = shader.fColorSpace->transferFnHash();
+        *data++ = dstCS ? dstCS->toXYZD50Hash() : 0;
+        *data++ = dstCS ? dstCS->transferFnHash() : 0;
+        memcpy(data, shader.fColors, sizeof(SkColor4f) * count);
+        data += 4 * count;
+        if (hasPositions) {
+            memcpy(data, shader.getPositions(), sizeof(float) * count);
+        }
+
+        new (fStorage.get()) SkResourceCache::Key();
+        this->mutableKey()->init(&gGradientLUTKeyNamespaceLabel, 0, dataSize);
+    }
+
+    GradientLUTKey(const GradientLUTKey& that) {
+        fStorage.reset(that.key().size());
+        memcpy(fStorage.get(), that.fStorage.get(), that.key().size());
+    }
+
+    const SkResourceCache::Key& key() const {
+        return *static_cast<const SkResourceCache::Key*>(fStorage.get());
+    }
+
+private:
+    static constexpr int kHeaderWords = 8;
+
+    SkResourceCache::Key* mutableKey() {
+        return static_cast<SkResourceCache::Key*>(fStorage.get());
+    }
+
+    SkAutoMalloc fStorage;
+};
+
+struct GradientLUTRec : public SkResourceCache::Rec {
+    GradientLUTRec(const GradientLUTKey& key, sk_sp<SkData> lut)
+        : fKey(key)
+        , fLUT(std::move(lut)) {}
+
+    GradientLUTKey fKey;
+    sk_sp<SkData>  fLUT;
+
+    const Key& getKey() const override { return fKey.key(); }
+    size_t bytesUsed() const override { return sizeof(*this) + fKey.key().size() + fLUT->size(); }
+    const char* getCategory() const override { return "gradient-lut"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
+        const GradientLUTRec& rec = static_cast<const GradientLUTRec&>(baseRec);
+        *static_cast<sk_sp<SkData>*>(context) = rec.fLUT;
+        return true;
+    }
+};
+
+// The LUT data is laid out as the eight stop arrays of an SkRasterPipeline_GradientCtx:
+// fs[0..3] followed by bs[0..3], each 'lutSize' floats long.
+void point_ctx_at_lut(SkRasterPipeline_GradientCtx* ctx, const SkData* lut, int lutSize) {
+    float* arrays = const_cast<float*>(static_cast<const float*>(lut->data()));
+    for (int i = 0; i < 4; i++) {
+        ctx->fs[i] = arrays + i * lutSize;
+        ctx->bs[i] = arrays + (4 + i) * lutSize;
+    }
+    ctx->ts = nullptr;
+    ctx->stopCount = lutSize;
+}
+
+}  // namespace
+
+int SkGradientBaseShader::lutSize(const SkSurfaceProps& props) const {
+    if (!props.isGradientLUT()) {
+        return 0;
+    }
+    // A hard stop at either end separates the color used for t < 0 (or t > 1) from the color at
+    // t = 0 (or t = 1), which the LUT can't represent once t is clamped.
+    if (fPositions && fColorCount > 2 &&
+        ((fPositions[0] == fPositions[1] && fColors[0] != fColors[1]) ||
+         (fPositions[fColorCount - 2] == fPositions[fColorCount - 1] &&
+          fColors[fColorCount - 2] != fColors[fColorCount - 1]))) {
+        return 0;
+    }
+    if (fColorCount <= kLUTMinStopCount &&
+        fInterpolation.fColorSpace == Interpolation::ColorSpace::kDestination) {
+        return 0;
+    }
+    return fColorCount > kLargeLUTStopCount ? kLargeLUTSize : kSmallLUTSize;
+}
+
+sk_sp<SkData> SkGradientBaseShader::findOrMakeLUT(SkColorSpace* dstCS, int lutSize) const {
+    GradientLUTKey key(*this, dstCS, lutSize);
+    sk_sp<SkData> lut;
+    if (SkResourceCache::Find(key.key(), GradientLUTRec::Visitor, &lut)) {
+        return lut;
+    }
+
+    // Evaluate the regular gradient pipeline at t = i / (lutSize - 1) for each entry i.
+    SkColor4fXformer xformedColors(this, dstCS);
+    SkRasterPipeline_<256> p;
+    SkSTArenaAlloc<256> alloc;
+    p.append(SkRasterPipelineOp::seed_shader);
+    p.appendMatrix(&alloc, SkMatrix::Scale(1.f / (lutSize - 1), 1.f)
+                                   .postTranslate(-0.5f / (lutSize - 1), 0.f));
+    AppendGradientFillStages(&p, &alloc,
+                             xformedColors.fColors.begin(),
+                             xformedColors.fPositions,
+                             xformedColors.fColors.size());
+    AppendInterpolatedToDstStages(&p, &alloc, fColorsAreOpaque, fInterpolation,
+                                  xformedColors.fIntermediateColorSpace.get(), dstCS);
+    AutoTMalloc<SkPMColor4f> colors(lutSize);
+    SkRasterPipeline_MemoryCtx dst = {colors.get(), lutSize};
+    p.append(SkRasterPipelineOp::store_f32, &dst);
+    p.run(0, 0, lutSize, 1);
+
+    lut = SkData::MakeUninitialized(sizeof(float) * 8 * lutSize);
+    SkRasterPipeline_GradientCtx ctx;
+    point_ctx_at_lut(&ctx, lut.get(), lutSize);
+    const float gapCount = lutSize - 1;
+    for (int i = 0; i < lutSize - 1; i++) {
+        init_stop_evenly(&ctx, gapCount, i, colors[i], colors[i + 1]);
+    }
+    add_const_color(&ctx, lutSize - 1, colors[lutSize - 1]);
+
+    SkResourceCache::Add(new GradientLUTRec(key, lut));
+    return lut;
+}
+
 bool SkGradientBaseShader::appendStages(const SkStageRec& rec,
                                         const SkShaders::MatrixRec& mRec) const {
     SkRasterPipeline* p = rec.fPipeline;
@@ -566,14 +736,28 @@ bool SkGradientBaseShader::appendStages(const SkStageRec& rec,
             break;
     }
 
-    // Transform all of the colors to destination color space, possibly premultiplied
-    SkColor4fXformer xformedColors(this, rec.fDstCS);
-    AppendGradientFillStages(p, alloc,
-                             xformedColors.fColors.begin(),
-                             xformedColors.fPositions,
-                             xformedColors.fColors.size());
-    AppendInterpolatedToDstStages(p, alloc, fColorsAreOpaque, fInterpolation,
-                                  xformedColors.fIntermediateColorSpace.get(), rec.fDstCS);
+    if (int lutSize = this->lutSize(rec.fSurfaceProps)) {
+        // The LUT already holds premultiplied colors in the destination color space.
+        sk_sp<SkData> lut = this->findOrMakeLUT(rec.fDstCS, lutSize);
+        if (fPositions && (fTileMode == SkTileMode::kClamp || fTileMode == SkTileMode::kDecal)) {
+            // Evenly spaced gradients were already clamped above.
+            p->append(SkRasterPipelineOp::clamp_x_1);
+        }
+        auto* ctx = alloc->make<SkRasterPipeline_GradientCtx>();
+        point_ctx_at_lut(ctx, lut.get(), lutSize);
+        // Keep the LUT alive for as long as the pipeline.
+        alloc->make<sk_sp<SkData>>(std::move(lut));
+        p->append(SkRasterPipelineOp::evenly_spaced_gradient, ctx);
+    } else {
+        // Transform all of the colors to destination color space, possibly premultiplied
+        SkColor4fXformer xformedColors(this, rec.fDstCS);
+        AppendGradientFillStages(p, alloc,
+                                 xformedColors.fColors.begin(),
+                                 xformedColors.fPositions,
+                                 xformedColors.fColors.size());
+        AppendInterpolatedToDstStages(p, alloc, fColorsAreOpaque, fInterpolation,
+                                      xformedColors.fIntermediateColorSpace.get(), rec.fDstCS);
+    }
 
     if (decal_ctx) {
         p->append(SkRasterPipelineOp::check_decal_mask, decal_ctx);
@@ -25,9 +25,11 @@
 #include <cstdint>
 
 class SkArenaAlloc;
+class SkData;
 class SkRasterPipeline;
 class SkReadBuffer;
 class SkShader;
+class SkSurfaceProps;
 class SkWriteBuffer;
 enum class SkTileMode;
 struct SkStageRec;
@@ -153,6 +155,12 @@ public:
     void setCachedBitmap(SkBitmap b) const { fColorsAndOffsetsBitmap = b; }
 
 private:
+    // Returns the number of entries to use for a raster LUT, or 0 if this gradient should be
+    // evaluated from its stops directly.
+    int lutSize(const SkSurfaceProps&) const;
+    // Returns the LUT for 'dstCS', computing and adding it to SkResourceCache on a miss.
+    sk_sp<SkData> findOrMakeLUT(SkColorSpace* dstCS, int lutSize) const;
+
     // When the number of stops exceeds Graphite's uniform-based limit the colors and offsets
     // are stored in this bitmap. It is stored in the shader so it can be cached with a stable
     // id and easily regenerated if purged.
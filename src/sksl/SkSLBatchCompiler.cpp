@@ -0,0 +1,99 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "src/sksl/SkSLBatchCompiler.h"
+
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkTo.h"
+#include "src/sksl/SkSLCompiler.h"
+#include "src/sksl/SkSLModuleLoader.h"
+#include "src/sksl/SkSLProgramKind.h"
+#include "src/sksl/ir/SkSLProgram.h"
+
+#if !defined(SKSL_STANDALONE)
+#include "src/core/SkTaskGroup.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace SkSL {
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void compile_job(Compiler* compiler,
+                        const BatchCompileJob& job,
+                        const BatchCodeGenerator& codeGenerator,
+                        BatchCompileResult* result) {
+    // The Program outlives the worker's Compiler (and its Context), so it can't use a memory pool.
+    ProgramSettings settings = job.fSettings;
+    settings.fUseMemoryPool = false;
+
+    auto start = std::chrono::steady_clock::now();
+    result->fProgram = compiler->convertProgram(job.fKind, job.fSource, settings);
+    result->fCompileMs = elapsed_ms(start);
+    if (!result->fProgram) {
+        result->fErrorText = compiler->errorText();
+        return;
+    }
+    if (codeGenerator) {
+        start = std::chrono::steady_clock::now();
+        bool success = codeGenerator(*result->fProgram, &result->fOutput);
+        result->fCodeGenMs = elapsed_ms(start);
+        if (!success) {
+            result->fErrorText = compiler->errorText();
+            result->fProgram = nullptr;
+            result->fOutput.clear();
+        }
+    }
+}
+
+std::vector<BatchCompileResult> CompileBatch(SkSpan<const BatchCompileJob> jobs,
+                                             SkExecutor* executor,
+                                             int parallelism,
+                                             const BatchCodeGenerator& codeGenerator) {
+    std::vector<BatchCompileResult> results(jobs.size());
+    if (jobs.empty()) {
+        return results;
+    }
+    const int workerCount = executor ? std::clamp(parallelism, 1, SkToInt(jobs.size())) : 1;
+
+    // Load every module the batch needs before the workers start, so they don't serialize on the
+    // ModuleLoader mutex as each one discovers a missing module.
+    std::vector<ProgramKind> kinds;
+    for (const BatchCompileJob& job : jobs) {
+        if (std::find(kinds.begin(), kinds.end(), job.fKind) == kinds.end()) {
+            kinds.push_back(job.fKind);
+        }
+    }
+    ModuleLoader::PreloadModules(kinds, workerCount > 1 ? executor : nullptr);
+
+    std::atomic<size_t> nextJob{0};
+    auto worker = [&](int) {
+        Compiler compiler;
+        for (;;) {
+            size_t index = nextJob.fetch_add(1, std::memory_order_relaxed);
+            if (index >= jobs.size()) {
+                break;
+            }
+            compile_job(&compiler, jobs[index], codeGenerator, &results[index]);
+        }
+    };
+#if !defined(SKSL_STANDALONE)
+    if (workerCount > 1) {
+        SkTaskGroup(*executor).batch(workerCount, worker);
+        return results;
+    }
+#endif
+    worker(0);
+    return results;
+}
+
+}  // namespace SkSL
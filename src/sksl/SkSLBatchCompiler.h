@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_BATCHCOMPILER
+#define SKSL_BATCHCOMPILER
+
+#include "include/core/SkSpan.h"
+#include "src/sksl/SkSLProgramSettings.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SkExecutor;
+
+namespace SkSL {
+
+enum class ProgramKind : int8_t;
+struct Program;
+
+struct BatchCompileJob {
+    ProgramKind fKind;
+    std::string fSource;
+    ProgramSettings fSettings;
+};
+
+struct BatchCompileResult {
+    // Null if the program failed to compile or if code generation failed; fErrorText says why.
+    std::unique_ptr<Program> fProgram;
+    // The code generator's output, if one was supplied.
+    std::string fOutput;
+    std::string fErrorText;
+    // Time spent converting the source into an optimized Program, and generating code from it.
+    double fCompileMs = 0;
+    double fCodeGenMs = 0;
+};
+
+// Converts a Program into output text, e.g. by binding SkSL::ToGLSL to a ShaderCaps. It is called
+// from several threads at once, so it must not share mutable state between calls.
+using BatchCodeGenerator = std::function<bool(Program&, std::string* out)>;
+
+/**
+ * Compiles every job, returning results in the same order. The built-in modules needed by the
+ * batch are loaded (concurrently) up front and then shared, read-only, by every worker. Each of the
+ * `parallelism` workers owns a Compiler (and with it a Context and per-Program Pool), and pulls
+ * jobs from the batch until none are left. If `executor` is null, or parallelism is at most one,
+ * the jobs are compiled in order on the calling thread. No lock is held while waiting for the
+ * workers, so this may be called from a task running on `executor` itself.
+ */
+std::vector<BatchCompileResult> CompileBatch(SkSpan<const BatchCompileJob> jobs,
+                                             SkExecutor* executor,
+                                             int parallelism,
+                                             const BatchCodeGenerator& codeGenerator = nullptr);
+
+}  // namespace SkSL
+
+#endif  // SKSL_BATCHCOMPILER
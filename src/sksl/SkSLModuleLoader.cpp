@@ -9,6 +9,7 @@
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkMutex.h"
 #include "src/base/SkNoDestructor.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/sksl/SkSLBuiltinTypes.h"
 #include "src/sksl/SkSLCompiler.h"
 #include "src/sksl/SkSLModuleData.h"
@@ -23,6 +24,7 @@
 #include "src/sksl/ir/SkSLVariable.h"
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <string>
 #include <utility>
@@ -136,6 +138,8 @@ void ModuleLoader::unloadModules() {
     fModuleLoader.fComputeModule          = nullptr;
     fModuleLoader.fGraphiteVertexModule   = nullptr;
     fModuleLoader.fGraphiteFragmentModule = nullptr;
+    fModuleLoader.fGraphiteVertexES2Module   = nullptr;
+    fModuleLoader.fGraphiteFragmentES2Module = nullptr;
     fModuleLoader.fPublicModule           = nullptr;
     fModuleLoader.fRuntimeShaderModule    = nullptr;
 }
@@ -378,6 +382,190 @@ const Module* ModuleLoader::loadGraphiteVertexES2Module(SkSL::Compiler* compiler
 #endif
 }
 
+namespace {
+
+// Describes how each lazily-loaded module is built. Every module's parent appears before it.
+enum ModuleIndex {
+    kShared,
+    kGPU,
+    kPublic,
+    kFragment,
+    kVertex,
+    kCompute,
+    kRuntimeShader,
+    kGraphiteFragment,
+    kGraphiteFragmentES2,
+    kGraphiteVertex,
+    kGraphiteVertexES2,
+
+    kModuleCount,
+    kRootParent = -1,
+};
+
+struct ModuleInfo {
+    int fParent;
+    ProgramKind fKind;
+    ModuleName fName;
+    const char* fModuleName;
+    const char* fFilename;
+};
+
+#define MODULE_INFO(parent, kind, name) {parent, kind, ModuleName::name, #name, #name ".sksl"}
+
+constexpr ModuleInfo kModuleInfo[kModuleCount] = {
+    MODULE_INFO(kRootParent, ProgramKind::kFragment,            sksl_shared),
+    MODULE_INFO(kShared,     ProgramKind::kFragment,            sksl_gpu),
+    MODULE_INFO(kShared,     ProgramKind::kFragment,            sksl_public),
+    MODULE_INFO(kGPU,        ProgramKind::kFragment,            sksl_frag),
+    MODULE_INFO(kGPU,        ProgramKind::kVertex,              sksl_vert),
+    MODULE_INFO(kGPU,        ProgramKind::kCompute,             sksl_compute),
+    MODULE_INFO(kPublic,     ProgramKind::kFragment,            sksl_rt_shader),
+    MODULE_INFO(kFragment,   ProgramKind::kGraphiteFragment,    sksl_graphite_frag),
+    MODULE_INFO(kFragment,   ProgramKind::kGraphiteFragmentES2, sksl_graphite_frag_es2),
+    MODULE_INFO(kVertex,     ProgramKind::kGraphiteVertex,      sksl_graphite_vert),
+    MODULE_INFO(kVertex,     ProgramKind::kGraphiteVertexES2,   sksl_graphite_vert_es2),
+};
+
+#undef MODULE_INFO
+
+// Mirrors Compiler::moduleForProgramKind.
+int module_index_for_program_kind(ProgramKind kind) {
+    switch (kind) {
+        case ProgramKind::kFragment:              return kFragment;
+        case ProgramKind::kVertex:                return kVertex;
+        case ProgramKind::kCompute:               return kCompute;
+#if defined(SK_GRAPHITE)
+        case ProgramKind::kGraphiteFragment:      return kGraphiteFragment;
+        case ProgramKind::kGraphiteVertex:        return kGraphiteVertex;
+        case ProgramKind::kGraphiteFragmentES2:   return kGraphiteFragmentES2;
+        case ProgramKind::kGraphiteVertexES2:     return kGraphiteVertexES2;
+#else
+        case ProgramKind::kGraphiteFragment:
+        case ProgramKind::kGraphiteFragmentES2:   return kFragment;
+        case ProgramKind::kGraphiteVertex:
+        case ProgramKind::kGraphiteVertexES2:     return kVertex;
+#endif
+        case ProgramKind::kPrivateRuntimeShader:  return kRuntimeShader;
+        case ProgramKind::kRuntimeColorFilter:
+        case ProgramKind::kRuntimeShader:
+        case ProgramKind::kRuntimeBlender:
+        case ProgramKind::kPrivateRuntimeColorFilter:
+        case ProgramKind::kPrivateRuntimeBlender:
+        case ProgramKind::kMeshVertex:
+        case ProgramKind::kMeshFragment:          return kPublic;
+    }
+    SkUNREACHABLE;
+}
+
+}  // namespace
+
+void ModuleLoader::PreloadModules(SkSpan<const ProgramKind> kinds, SkExecutor* executor) {
+    // Find every module that is needed, along with its ancestors.
+    std::array<bool, kModuleCount> needed = {};
+    int neededCount = 0;
+    for (ProgramKind kind : kinds) {
+        for (int index = module_index_for_program_kind(kind);
+             index != kRootParent && !needed[index];
+             index = kModuleInfo[index].fParent) {
+            needed[index] = true;
+            ++neededCount;
+        }
+    }
+    if (neededCount == 0) {
+        return;
+    }
+
+    // A batch holds every needed module whose parent is loaded, which can span several generations
+    // (e.g. compute, the private runtime shader and the Graphite modules once their parents were
+    // loaded earlier). Each task in a batch gets its own Compiler; they are created on demand.
+    std::vector<std::unique_ptr<Compiler>> compilers;
+
+    auto slotFor = [](Impl& impl, int index) -> std::unique_ptr<const Module>* {
+        std::unique_ptr<const Module>* slots[kModuleCount] = {
+                &impl.fSharedModule,
+                &impl.fGPUModule,
+                &impl.fPublicModule,
+                &impl.fFragmentModule,
+                &impl.fVertexModule,
+                &impl.fComputeModule,
+                &impl.fRuntimeShaderModule,
+                &impl.fGraphiteFragmentModule,
+                &impl.fGraphiteFragmentES2Module,
+                &impl.fGraphiteVertexModule,
+                &impl.fGraphiteVertexES2Module,
+        };
+        return slots[index];
+    };
+    auto parentOf = [&](Impl& impl, int index) -> const Module* {
+        int parent = kModuleInfo[index].fParent;
+        return parent == kRootParent ? impl.fRootModule.get() : slotFor(impl, parent)->get();
+    };
+
+    // The ModuleLoader is only held while looking at or publishing modules. Compiling a generation
+    // happens without it: the tasks may run on threads which need it for other work, and waiting
+    // for them while holding it could deadlock. Published modules are never replaced (only
+    // unloadModules, which benchmarks use between runs, frees them), so parents stay valid while
+    // their children compile.
+    for (;;) {
+        // Gather the modules whose parent is now available.
+        int batch[kModuleCount];
+        const Module* parents[kModuleCount];
+        int batchCount = 0;
+        {
+            ModuleLoader loader = ModuleLoader::Get();
+            for (int index = 0; index < kModuleCount; ++index) {
+                if (needed[index] && !*slotFor(loader.fModuleLoader, index)) {
+                    if (const Module* parent = parentOf(loader.fModuleLoader, index)) {
+                        parents[batchCount] = parent;
+                        batch[batchCount++] = index;
+                    }
+                }
+            }
+        }
+        if (batchCount == 0) {
+            break;
+        }
+
+        const int compilerCount = executor ? batchCount : 1;
+        while ((int)compilers.size() < compilerCount) {
+            compilers.push_back(std::make_unique<Compiler>());
+        }
+
+        std::unique_ptr<Module> results[kModuleCount];
+        auto compile = [&](int i) {
+            const ModuleInfo& info = kModuleInfo[batch[i]];
+            results[i] = compile_and_shrink(compilers[executor ? i : 0].get(),
+                                            info.fKind,
+                                            info.fModuleName,
+                                            GetModuleData(info.fName, info.fFilename),
+                                            parents[i]);
+        };
+#if !defined(SKSL_STANDALONE)
+        if (executor && batchCount > 1) {
+            SkTaskGroup(*executor).batch(batchCount, compile);
+        } else
+#endif
+        {
+            for (int i = 0; i < batchCount; ++i) {
+                compile(i);
+            }
+        }
+
+        ModuleLoader loader = ModuleLoader::Get();
+        for (int i = 0; i < batchCount; ++i) {
+            // Another thread may have loaded the same module in the meantime; keep its copy,
+            // since programs might already refer to it.
+            std::unique_ptr<const Module>* slot = slotFor(loader.fModuleLoader, batch[i]);
+            if (!*slot) {
+                *slot = std::move(results[i]);
+                if (batch[i] == kPublic) {
+                    loader.addPublicTypeAliases(slot->get());
+                }
+            }
+        }
+    }
+}
+
 void ModuleLoader::Impl::makeRootSymbolTable() {
     auto rootModule = std::make_unique<Module>();
     rootModule->fSymbols = std::make_unique<SymbolTable>(/*builtin=*/true);
@@ -8,14 +8,18 @@
 #ifndef SKSL_MODULELOADER
 #define SKSL_MODULELOADER
 
+#include "include/core/SkSpan.h"
 #include "src/sksl/SkSLBuiltinTypes.h"
 #include <memory>
 
+class SkExecutor;
+
 namespace SkSL {
 
 class Compiler;
 struct Module;
 class Type;
+enum class ProgramKind : int8_t;
 
 using BuiltinTypePtr = const std::unique_ptr<Type> BuiltinTypes::*;
 
@@ -32,6 +36,14 @@ public:
     // allowed to fall out of scope, the mutex will be released.
     static ModuleLoader Get();
 
+    // Loads every module needed to compile programs of the given kinds. Modules that share a
+    // parent don't depend on each other, so each generation of them is compiled concurrently on
+    // `executor` (with a Compiler per task); if `executor` is null, they are loaded in order on the
+    // calling thread. Modules that are already loaded are left as-is. The ModuleLoader is not held
+    // while the modules compile, so this may be called from a task on `executor`. It must not be
+    // called while the caller holds a ModuleLoader.
+    static void PreloadModules(SkSpan<const ProgramKind> kinds, SkExecutor* executor);
+
     // The built-in types and root module are universal, immutable, and shared by every Compiler.
     // They are created when the ModuleLoader is instantiated and never change.
     const BuiltinTypes& builtinTypes();
@@ -18,6 +18,7 @@
 #include "src/core/SkTHash.h"
 #include "src/sksl/SkSLPosition.h"
 #include "src/sksl/SkSLString.h"
+#include "src/sksl/codegen/SkSLRasterPipelineNativeCode.h"
 #include "src/sksl/tracing/SkSLDebugTracePriv.h"
 #include "src/sksl/tracing/SkSLTraceHook.h"
 
@@ -1682,10 +1683,326 @@ Program::SlotData Program::allocateSlotData(SkArenaAlloc* alloc) const {
     return s;
 }
 
+namespace {
+
+// A stage which copies `count` consecutive slots (or a splatted constant) into `dst`.
+struct CopyStage {
+    enum class Kind { kNone, kSlotsUnmasked, kSlotsMasked, kImmutables, kConstant };
+
+    Kind       kind = Kind::kNone;
+    int        count = 0;
+    SkRPOffset dst = 0;
+    SkRPOffset src = 0;    // slots or immutable scalars
+    int32_t    value = 0;  // constants only
+};
+
+}  // namespace
+
+static CopyStage copy_stage_info(ProgramOp op, void* ctx) {
+    using Kind = CopyStage::Kind;
+    auto makeCopy = [&](Kind kind, ProgramOp baseOp) {
+        auto c = SkRPCtxUtils::Unpack((const SkRasterPipeline_BinaryOpCtx*)ctx);
+        return CopyStage{kind, (int)op - (int)baseOp + 1, c.dst, c.src, 0};
+    };
+    auto makeConstant = [&]() {
+        auto c = SkRPCtxUtils::Unpack((const SkRasterPipeline_ConstantCtx*)ctx);
+        return CopyStage{Kind::kConstant, (int)op - (int)ProgramOp::copy_constant + 1,
+                         c.dst, 0, c.value};
+    };
+
+    switch (op) {
+        case ProgramOp::copy_slot_unmasked:
+        case ProgramOp::copy_2_slots_unmasked:
+        case ProgramOp::copy_3_slots_unmasked:
+        case ProgramOp::copy_4_slots_unmasked:
+            return makeCopy(Kind::kSlotsUnmasked, ProgramOp::copy_slot_unmasked);
+
+        case ProgramOp::copy_slot_masked:
+        case ProgramOp::copy_2_slots_masked:
+        case ProgramOp::copy_3_slots_masked:
+        case ProgramOp::copy_4_slots_masked:
+            return makeCopy(Kind::kSlotsMasked, ProgramOp::copy_slot_masked);
+
+        case ProgramOp::copy_immutable_unmasked:
+        case ProgramOp::copy_2_immutables_unmasked:
+        case ProgramOp::copy_3_immutables_unmasked:
+        case ProgramOp::copy_4_immutables_unmasked:
+            return makeCopy(Kind::kImmutables, ProgramOp::copy_immutable_unmasked);
+
+        case ProgramOp::copy_constant:
+        case ProgramOp::splat_2_constants:
+        case ProgramOp::splat_3_constants:
+        case ProgramOp::splat_4_constants:
+            return makeConstant();
+
+        default:
+            return {};
+    }
+}
+
+static bool ranges_overlap(SkRPOffset a, SkRPOffset aSize, SkRPOffset b, SkRPOffset bSize) {
+    return a < b + bSize && b < a + aSize;
+}
+
+bool Program::combineStages(Stage* first,
+                            const Stage& second,
+                            SkArenaAlloc* alloc,
+                            const SlotData& slots) const {
+    using Kind = CopyStage::Kind;
+    const SkRPOffset slotSize = SkOpts::raster_pipeline_highp_stride * sizeof(float);
+    const CopyStage a = copy_stage_info(first->op, first->ctx);
+    const CopyStage b = copy_stage_info(second.op, second.ctx);
+    const bool aReadsSlots = a.kind == Kind::kSlotsUnmasked || a.kind == Kind::kSlotsMasked;
+    const bool bReadsSlots = b.kind == Kind::kSlotsUnmasked || b.kind == Kind::kSlotsMasked;
+
+    // A copy of a slot range onto itself does nothing.
+    if (aReadsSlots && a.dst == a.src) {
+        *first = second;
+        return true;
+    }
+
+    if (a.kind != Kind::kNone && a.kind == b.kind) {
+        // Two copies of consecutive slots can be done by a single wider copy, as long as the
+        // second doesn't read anything the first wrote.
+        const int count = a.count + b.count;
+        const bool adjacent =
+                b.dst == a.dst + a.count * slotSize &&
+                (a.kind == Kind::kConstant   ? b.value == a.value :
+                 a.kind == Kind::kImmutables ? b.src == a.src + a.count * sizeof(float)
+                                             : b.src == a.src + a.count * slotSize);
+        if (count <= 4 && adjacent &&
+            !(aReadsSlots && ranges_overlap(a.dst, count * slotSize, a.src, count * slotSize))) {
+            if (a.kind == Kind::kConstant) {
+                SkRasterPipeline_ConstantCtx ctx;
+                ctx.dst = a.dst;
+                ctx.value = a.value;
+                first->op = (ProgramOp)((int)ProgramOp::copy_constant + count - 1);
+                first->ctx = SkRPCtxUtils::Pack(ctx, alloc);
+            } else {
+                SkRasterPipeline_BinaryOpCtx ctx;
+                ctx.dst = a.dst;
+                ctx.src = a.src;
+                first->op = (ProgramOp)((int)first->op + b.count);
+                first->ctx = SkRPCtxUtils::Pack(ctx, alloc);
+            }
+            return true;
+        }
+    }
+
+    // An unmasked write which is immediately overwritten in full, without being read, is dead.
+    if (a.kind != Kind::kNone && a.kind != Kind::kSlotsMasked &&
+        b.kind != Kind::kNone && b.kind != Kind::kSlotsMasked &&
+        b.dst <= a.dst && a.dst + a.count * slotSize <= b.dst + b.count * slotSize &&
+        !(bReadsSlots && ranges_overlap(a.dst, a.count * slotSize, b.src, b.count * slotSize))) {
+        *first = second;
+        return true;
+    }
+
+    // Two swizzles of the same stack position can be composed into one. The second swizzle
+    // determines how many slots are live afterwards.
+    auto isSmallSwizzle = [](ProgramOp op) {
+        return op == ProgramOp::swizzle_2 || op == ProgramOp::swizzle_3 ||
+               op == ProgramOp::swizzle_4;
+    };
+    if (isSmallSwizzle(first->op) && isSmallSwizzle(second.op)) {
+        auto swizzleA = SkRPCtxUtils::Unpack((const SkRasterPipeline_SwizzleCtx*)first->ctx);
+        auto swizzleB = SkRPCtxUtils::Unpack((const SkRasterPipeline_SwizzleCtx*)second.ctx);
+        if (swizzleA.dst == swizzleB.dst) {
+            const int numSlotsA = (int)first->op - (int)ProgramOp::swizzle_1 + 1;
+            const int numSlotsB = (int)second.op - (int)ProgramOp::swizzle_1 + 1;
+            SkRasterPipeline_SwizzleCtx ctx = swizzleB;
+            for (int index = 0; index < numSlotsB; ++index) {
+                // Slots the first swizzle wrote come from its sources; the rest are untouched.
+                int slot = swizzleB.offsets[index] / slotSize;
+                if (slot < numSlotsA) {
+                    ctx.offsets[index] = swizzleA.offsets[slot];
+                }
+            }
+            *first = {second.op, SkRPCtxUtils::Pack(ctx, alloc)};
+            return true;
+        }
+    }
+
+    // A constant pushed onto the temp stack and immediately consumed by a single-slot binary op
+    // can become an immediate operand. The constant's slot is above the stack top afterwards, so
+    // nothing reads it again.
+    if (a.kind == Kind::kConstant && a.count == 1) {
+        ProgramOp immOp;
+        int32_t value = a.value;
+        switch (second.op) {
+            case ProgramOp::add_float: immOp = ProgramOp::add_imm_float; break;
+            case ProgramOp::mul_float: immOp = ProgramOp::mul_imm_float; break;
+            case ProgramOp::min_float: immOp = ProgramOp::min_imm_float; break;
+            case ProgramOp::max_float: immOp = ProgramOp::max_imm_float; break;
+            case ProgramOp::sub_float:
+                // Subtracting a value is the same as adding its negation.
+                immOp = ProgramOp::add_imm_float;
+                value ^= 0x80000000;
+                break;
+            default:
+                return false;
+        }
+        const auto* basePtr = (const std::byte*)slots.values.data();
+        const SkRPOffset stackBegin = (const std::byte*)slots.stack.data() - basePtr;
+        const SkRPOffset stackEnd = (const std::byte*)slots.stack.end() - basePtr;
+        const SkRPOffset dst = (const std::byte*)second.ctx - basePtr;
+        if (a.dst == dst + slotSize && a.dst >= stackBegin && a.dst < stackEnd) {
+            SkRasterPipeline_ConstantCtx ctx;
+            ctx.dst = dst;
+            ctx.value = value;
+            *first = {immOp, SkRPCtxUtils::Pack(ctx, alloc)};
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Program::optimizeStages(const TArray<Stage>& stages, const SlotData& slots) const {
+    fOptimizedStageAlloc = std::make_unique<SkArenaAlloc>(/*firstHeapAllocation=*/256);
+
+    // Peephole pass: each stage is combined with the stage before it for as long as that works,
+    // so the result of one simplification can feed into the next.
+    TArray<OptimizedStage>& optimized = fOptimizedStages;
+    optimized.reserve_exact(stages.size());
+    for (int index = 0; index < stages.size(); ++index) {
+        optimized.push_back({index, stages[index]});
+        while (optimized.size() >= 2) {
+            OptimizedStage second = optimized.back();
+            OptimizedStage& first = optimized.fromBack(1);
+            if (!this->combineStages(&first.stage, second.stage, fOptimizedStageAlloc.get(),
+                                     slots)) {
+                break;
+            }
+            // combineStages either keeps `second` as it is, or packs a new offset-only context.
+            const bool keptSecond = first.stage.op == second.stage.op &&
+                                    first.stage.ctx == second.stage.ctx;
+            first.source = keptSecond ? second.source : -1;
+            optimized.pop_back();
+        }
+    }
+}
+
+bool Program::assembleNativeOp(NativeCodeAssembler* assembler,
+                               const Stage& stage,
+                               std::byte* basePtr) const {
+    using BinaryOp = NativeCodeAssembler::BinaryOp;
+    const SkRPOffset slotSize = SkOpts::raster_pipeline_highp_stride * sizeof(float);
+
+    auto splatConstant = [&](int numSlots) {
+        auto ctx = SkRPCtxUtils::Unpack((const SkRasterPipeline_ConstantCtx*)stage.ctx);
+        for (int index = 0; index < numSlots; ++index) {
+            assembler->splatConstant(ctx.dst + index * slotSize, ctx.value);
+        }
+        return true;
+    };
+    auto copySlots = [&](int numSlots) {
+        auto ctx = SkRPCtxUtils::Unpack((const SkRasterPipeline_BinaryOpCtx*)stage.ctx);
+        for (int index = 0; index < numSlots; ++index) {
+            assembler->copySlot(ctx.dst + index * slotSize, ctx.src + index * slotSize);
+        }
+        return true;
+    };
+    auto copyImmutables = [&](int numSlots) {
+        auto ctx = SkRPCtxUtils::Unpack((const SkRasterPipeline_BinaryOpCtx*)stage.ctx);
+        for (int index = 0; index < numSlots; ++index) {
+            assembler->splatScalar(ctx.dst + index * slotSize, ctx.src + index * sizeof(float));
+        }
+        return true;
+    };
+    auto binary = [&](BinaryOp op, SkRPOffset dst, SkRPOffset src, int numSlots) {
+        for (int index = 0; index < numSlots; ++index) {
+            assembler->binarySlot(op, dst + index * slotSize, src + index * slotSize);
+        }
+        return true;
+    };
+    auto adjacentBinary = [&](BinaryOp op, int numSlots) {
+        // The context points directly at `dst`, and `src` immediately follows it.
+        SkRPOffset dst = SkToU32((std::byte*)stage.ctx - basePtr);
+        return binary(op, dst, dst + numSlots * slotSize, numSlots);
+    };
+    auto nWayBinary = [&](BinaryOp op) {
+        auto ctx = SkRPCtxUtils::Unpack((const SkRasterPipeline_BinaryOpCtx*)stage.ctx);
+        return binary(op, ctx.dst, ctx.src, (ctx.src - ctx.dst) / slotSize);
+    };
+    auto immediateBinary = [&](BinaryOp op) {
+        auto ctx = SkRPCtxUtils::Unpack((const SkRasterPipeline_ConstantCtx*)stage.ctx);
+        assembler->binaryImmediate(op, ctx.dst, ctx.value);
+        return true;
+    };
+
+    switch (stage.op) {
+        case ProgramOp::copy_constant:              return splatConstant(1);
+        case ProgramOp::splat_2_constants:          return splatConstant(2);
+        case ProgramOp::splat_3_constants:          return splatConstant(3);
+        case ProgramOp::splat_4_constants:          return splatConstant(4);
+        case ProgramOp::copy_slot_unmasked:         return copySlots(1);
+        case ProgramOp::copy_2_slots_unmasked:      return copySlots(2);
+        case ProgramOp::copy_3_slots_unmasked:      return copySlots(3);
+        case ProgramOp::copy_4_slots_unmasked:      return copySlots(4);
+        case ProgramOp::copy_immutable_unmasked:    return copyImmutables(1);
+        case ProgramOp::copy_2_immutables_unmasked: return copyImmutables(2);
+        case ProgramOp::copy_3_immutables_unmasked: return copyImmutables(3);
+        case ProgramOp::copy_4_immutables_unmasked: return copyImmutables(4);
+
+        #define NATIVE_BINARY_FLOAT_CASES(name, op)                                 \
+            case ProgramOp::name##_n_floats: return nWayBinary(op);                 \
+            case ProgramOp::name##_float:    return adjacentBinary(op, 1);          \
+            case ProgramOp::name##_2_floats: return adjacentBinary(op, 2);          \
+            case ProgramOp::name##_3_floats: return adjacentBinary(op, 3);          \
+            case ProgramOp::name##_4_floats: return adjacentBinary(op, 4);
+        NATIVE_BINARY_FLOAT_CASES(add, BinaryOp::kAdd)
+        NATIVE_BINARY_FLOAT_CASES(sub, BinaryOp::kSub)
+        NATIVE_BINARY_FLOAT_CASES(mul, BinaryOp::kMul)
+        NATIVE_BINARY_FLOAT_CASES(div, BinaryOp::kDiv)
+        NATIVE_BINARY_FLOAT_CASES(min, BinaryOp::kMin)
+        NATIVE_BINARY_FLOAT_CASES(max, BinaryOp::kMax)
+        #undef NATIVE_BINARY_FLOAT_CASES
+
+        case ProgramOp::add_imm_float: return immediateBinary(BinaryOp::kAdd);
+        case ProgramOp::mul_imm_float: return immediateBinary(BinaryOp::kMul);
+        case ProgramOp::min_imm_float: return immediateBinary(BinaryOp::kMin);
+        case ProgramOp::max_imm_float: return immediateBinary(BinaryOp::kMax);
+
+        default:
+            return false;
+    }
+}
+
+void Program::compileNativeRuns(const TArray<Stage>& stages, std::byte* basePtr) const {
+    // A run must replace at least this many stages to be worth the extra call.
+    static constexpr int kMinNativeRunLength = 3;
+
+    const int N = SkOpts::raster_pipeline_highp_stride;
+    if (!NativeCodeAssembler::IsSupported(N)) {
+        return;
+    }
+
+    int runStart = 0;
+    auto assembler = std::make_unique<NativeCodeAssembler>(N);
+    auto endRun = [&](int runEnd) {
+        if (runEnd - runStart >= kMinNativeRunLength) {
+            if (std::unique_ptr<NativeCode> code = assembler->finish()) {
+                fNativeRuns.push_back({runStart, runEnd - runStart, std::move(code)});
+            }
+        }
+        assembler = std::make_unique<NativeCodeAssembler>(N);
+    };
+
+    for (int index = 0; index < stages.size(); ++index) {
+        if (!this->assembleNativeOp(assembler.get(), stages[index], basePtr)) {
+            endRun(index);
+            runStart = index + 1;
+        }
+    }
+    endRun(stages.size());
+}
+
 bool Program::appendStages(SkRasterPipeline* pipeline,
                            SkArenaAlloc* alloc,
                            RP::Callbacks* callbacks,
-                           SkSpan<const float> uniforms) const {
+                           SkSpan<const float> uniforms,
+                           const AppendStagesOptions& options) const {
 #if defined(SKSL_STANDALONE)
     return false;
 #else
@@ -1693,6 +2010,16 @@ bool Program::appendStages(SkRasterPipeline* pipeline,
     TArray<Stage> stages;
     SlotData slotData = this->allocateSlotData(alloc);
     this->makeStages(&stages, alloc, uniforms, slotData);
+    const bool stagesOptimized = options.optimizeStages;
+    if (stagesOptimized) {
+        fOptimizeStagesOnce([&] { this->optimizeStages(stages, slotData); });
+        TArray<Stage> optimized;
+        optimized.reserve_exact(fOptimizedStages.size());
+        for (const OptimizedStage& stage : fOptimizedStages) {
+            optimized.push_back(stage.source >= 0 ? stages[stage.source] : stage.stage);
+        }
+        stages = std::move(optimized);
+    }
 
     // Allocate buffers for branch targets and labels; these are needed to convert labels into
     // actual offsets into the pipeline and fix up branches.
@@ -1711,7 +2038,33 @@ bool Program::appendStages(SkRasterPipeline* pipeline,
 
     resetBasePointer();
 
-    for (const Stage& stage : stages) {
+    // Runs of simple slot arithmetic can be replaced with generated code. Traced programs always
+    // use the stages, since they need to report every op.
+    int numNativeRuns = 0;
+    if (options.useNativeCode && !fDebugTrace) {
+        std::byte* basePtr = (std::byte*)slotData.values.data();
+        fNativeRunsOnce([&] {
+            this->compileNativeRuns(stages, basePtr);
+            fNativeRunsOptimized = stagesOptimized;
+        });
+        // The runs refer to stage indices, which are only valid for the same kind of stage list.
+        if (fNativeRunsOptimized == stagesOptimized) {
+            numNativeRuns = fNativeRuns.size();
+        }
+    }
+    int nextNativeRun = 0;
+
+    for (int index = 0; index < stages.size(); ++index) {
+        if (nextNativeRun < numNativeRuns && fNativeRuns[nextNativeRun].start == index) {
+            const NativeRun& run = fNativeRuns[nextNativeRun++];
+            auto* ctx = alloc->make<SkRasterPipeline_NativeCodeCtx>();
+            ctx->fn = run.code->fn();
+            pipeline->append(SkRasterPipelineOp::call_native_code, ctx);
+            index += run.count - 1;
+            continue;
+        }
+
+        const Stage& stage = stages[index];
         switch (stage.op) {
             case ProgramOp::stack_rewind:
                 pipeline->appendStackRewind();
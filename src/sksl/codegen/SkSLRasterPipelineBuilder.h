@@ -12,6 +12,7 @@
 
 #include "include/core/SkSpan.h"
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkOnce.h"
 #include "include/private/base/SkTArray.h"
 #include "src/base/SkUtils.h"
 #include "src/core/SkRasterPipelineOpList.h"
@@ -32,6 +33,9 @@ class TraceHook;
 
 namespace RP {
 
+class NativeCode;
+class NativeCodeAssembler;
+
 // A single scalar in our program consumes one slot.
 using Slot = int;
 constexpr Slot NA = -1;
@@ -149,6 +153,18 @@ public:
     virtual void fromLinearSrgb(const void* color) = 0;
 };
 
+// Choices which only affect how Program::appendStages builds the pipeline, not its results.
+struct AppendStagesOptions {
+    // Runs a peephole pass over the program's stages which merges adjacent copies, drops dead
+    // stores and folds constants into immediate-mode ops. The pass runs once per program; its
+    // result is reused by every later call. Program dumps always show the stages as generated.
+    bool optimizeStages = true;
+    // Replaces runs of simple, unmasked slot arithmetic with generated machine code on platforms
+    // that support it (see SkSLRasterPipelineNativeCode.h). Anything else still goes through the
+    // regular raster pipeline stages.
+    bool useNativeCode = false;
+};
+
 class Program {
 public:
     Program(skia_private::TArray<Instruction> instrs,
@@ -162,7 +178,8 @@ public:
     bool appendStages(SkRasterPipeline* pipeline,
                       SkArenaAlloc* alloc,
                       Callbacks* callbacks,
-                      SkSpan<const float> uniforms) const;
+                      SkSpan<const float> uniforms,
+                      const AppendStagesOptions& options = {}) const;
 
     void dump(SkWStream* out, bool writeInstructionCount = false) const;
 
@@ -280,6 +297,43 @@ private:
     // Appends a stack_rewind op unilaterally.
     void appendStackRewind(skia_private::TArray<Stage>* pipeline) const;
 
+    // A stage of the optimized stage list. Stages which the peephole pass kept are taken from
+    // index `source` of each call's makeStages list. Stages which it created have a negative
+    // `source`; their contexts only hold slot offsets, so `stage` is reused by every call.
+    struct OptimizedStage {
+        int   source;
+        Stage stage;
+    };
+
+    // Runs the peephole pass (see AppendStagesOptions::optimizeStages) over a stage list from
+    // makeStages and stores the result in fOptimizedStages. The pass only looks at slot offsets,
+    // which are the same on every call, so this is only done once.
+    void optimizeStages(const skia_private::TArray<Stage>& stages, const SlotData& slots) const;
+
+    // Replaces `first` with a single stage equivalent to running `first` and then `second`, and
+    // returns true. Returns false, leaving `first` untouched, if there's no such stage.
+    bool combineStages(Stage* first,
+                       const Stage& second,
+                       SkArenaAlloc* alloc,
+                       const SlotData& slots) const;
+
+    // A run of consecutive stages which has been replaced by a single call into native code.
+    struct NativeRun {
+        int start;
+        int count;
+        std::unique_ptr<NativeCode> code;
+    };
+
+    // Assembles `stage` into `assembler` and returns true, or returns false (without emitting
+    // anything) if the op cannot be expressed as native code.
+    bool assembleNativeOp(NativeCodeAssembler* assembler,
+                          const Stage& stage,
+                          std::byte* basePtr) const;
+
+    // Finds runs of native-compatible stages in `stages` and assembles each of them. The stage
+    // list produced by makeStages has the same shape on every call, so this is only done once.
+    void compileNativeRuns(const skia_private::TArray<Stage>& stages, std::byte* basePtr) const;
+
     class Dumper;
     friend class Dumper;
 
@@ -292,6 +346,14 @@ private:
     StackDepths fTempStackMaxDepths;
     DebugTracePriv* fDebugTrace = nullptr;
     std::unique_ptr<SkSL::TraceHook> fTraceHook;
+
+    mutable SkOnce fOptimizeStagesOnce;
+    mutable std::unique_ptr<SkArenaAlloc> fOptimizedStageAlloc;
+    mutable skia_private::TArray<OptimizedStage> fOptimizedStages;
+
+    mutable SkOnce fNativeRunsOnce;
+    mutable skia_private::TArray<NativeRun> fNativeRuns;
+    mutable bool fNativeRunsOptimized = false;
 };
 
 class Builder {
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/sksl/codegen/SkSLRasterPipelineNativeCode.h"
+
+#include "include/private/base/SkTo.h"
+
+#include <cstring>
+#include <initializer_list>
+
+#if defined(SKSL_RP_NATIVE_CODE)
+#include <sys/mman.h>
+#endif
+
+namespace SkSL::RP {
+
+// Every generated function takes `base` in rdi and only touches xmm0/xmm1 and eax, all of which
+// are caller-saved in the System V ABI; no prologue or epilogue is needed.
+static constexpr int kXMM0 = 0;
+static constexpr int kXMM1 = 1;
+
+NativeCode::NativeCode(void* memory, size_t size)
+        : fMemory(memory)
+        , fSize(size)
+        , fFn(reinterpret_cast<Fn>(memory)) {}
+
+NativeCode::~NativeCode() {
+#if defined(SKSL_RP_NATIVE_CODE)
+    munmap(fMemory, fSize);
+#endif
+}
+
+bool NativeCodeAssembler::IsSupported(int stride) {
+#if defined(SKSL_RP_NATIVE_CODE)
+    // Slots are processed one SSE register (four floats) at a time.
+    return stride % 4 == 0;
+#else
+    return false;
+#endif
+}
+
+NativeCodeAssembler::NativeCodeAssembler(int stride) : fStride(stride) {
+    SkASSERT(IsSupported(stride));
+}
+
+void NativeCodeAssembler::emit(std::initializer_list<uint8_t> bytes) {
+    fCode.append(SkToInt(bytes.size()), bytes.begin());
+}
+
+void NativeCodeAssembler::emit32(uint32_t value) {
+    uint8_t bytes[4];
+    memcpy(bytes, &value, sizeof(bytes));
+    fCode.append(4, bytes);
+}
+
+void NativeCodeAssembler::movupsLoad(int xmm, uint32_t offset) {
+    // movups xmm, [rdi + disp32]
+    this->emit({0x0F, 0x10, (uint8_t)(0x87 | (xmm << 3))});
+    this->emit32(offset);
+}
+
+void NativeCodeAssembler::movupsStore(uint32_t offset, int xmm) {
+    // movups [rdi + disp32], xmm
+    this->emit({0x0F, 0x11, (uint8_t)(0x87 | (xmm << 3))});
+    this->emit32(offset);
+}
+
+void NativeCodeAssembler::splatEAX(int xmm) {
+    // movd xmm, eax
+    this->emit({0x66, 0x0F, 0x6E, (uint8_t)(0xC0 | (xmm << 3))});
+    // shufps xmm, xmm, 0
+    this->emit({0x0F, 0xC6, (uint8_t)(0xC0 | (xmm << 3) | xmm), 0x00});
+}
+
+void NativeCodeAssembler::splatConstant(SkRPOffset dst, int32_t value) {
+    // mov eax, imm32
+    this->emit({0xB8});
+    this->emit32(value);
+    this->splatEAX(kXMM1);
+    for (int lane = 0; lane < fStride; lane += 4) {
+        this->movupsStore(dst + lane * sizeof(float), kXMM1);
+    }
+    ++fNumOps;
+}
+
+void NativeCodeAssembler::splatScalar(SkRPOffset dst, SkRPOffset src) {
+    // mov eax, [rdi + disp32]
+    this->emit({0x8B, 0x87});
+    this->emit32(src);
+    this->splatEAX(kXMM1);
+    for (int lane = 0; lane < fStride; lane += 4) {
+        this->movupsStore(dst + lane * sizeof(float), kXMM1);
+    }
+    ++fNumOps;
+}
+
+void NativeCodeAssembler::copySlot(SkRPOffset dst, SkRPOffset src) {
+    for (int lane = 0; lane < fStride; lane += 4) {
+        this->movupsLoad(kXMM0, src + lane * sizeof(float));
+        this->movupsStore(dst + lane * sizeof(float), kXMM0);
+    }
+    ++fNumOps;
+}
+
+void NativeCodeAssembler::binarySlot(BinaryOp op, SkRPOffset dst, SkRPOffset src) {
+    for (int lane = 0; lane < fStride; lane += 4) {
+        this->movupsLoad(kXMM0, dst + lane * sizeof(float));
+        this->movupsLoad(kXMM1, src + lane * sizeof(float));
+        // <op>ps xmm0, xmm1 (operand order matches the stages' `*dst = op(*dst, *src)`)
+        this->emit({0x0F, (uint8_t)op, 0xC1});
+        this->movupsStore(dst + lane * sizeof(float), kXMM0);
+    }
+    ++fNumOps;
+}
+
+void NativeCodeAssembler::binaryImmediate(BinaryOp op, SkRPOffset dst, int32_t value) {
+    // mov eax, imm32
+    this->emit({0xB8});
+    this->emit32(value);
+    this->splatEAX(kXMM1);
+    for (int lane = 0; lane < fStride; lane += 4) {
+        this->movupsLoad(kXMM0, dst + lane * sizeof(float));
+        this->emit({0x0F, (uint8_t)op, 0xC1});
+        this->movupsStore(dst + lane * sizeof(float), kXMM0);
+    }
+    ++fNumOps;
+}
+
+std::unique_ptr<NativeCode> NativeCodeAssembler::finish() {
+#if defined(SKSL_RP_NATIVE_CODE)
+    if (fNumOps == 0) {
+        return nullptr;
+    }
+    // ret
+    this->emit({0xC3});
+
+    const size_t size = fCode.size();
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                        /*fd=*/-1, /*offset=*/0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    memcpy(memory, fCode.data(), size);
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    return std::unique_ptr<NativeCode>(new NativeCode(memory, size));
+#else
+    return nullptr;
+#endif
+}
+
+}  // namespace SkSL::RP
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_RASTERPIPELINENATIVECODE
+#define SKSL_RASTERPIPELINENATIVECODE
+
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkTDArray.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using SkRPOffset = uint32_t;
+
+// Native code generation is only implemented for x86-64 with the System V calling convention, and
+// requires that the platform allow us to map executable pages.
+#if !defined(SKSL_STANDALONE) && !defined(SK_DISABLE_SKSL_RP_NATIVE_CODE) && \
+    defined(__x86_64__) && (defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_ANDROID))
+    #define SKSL_RP_NATIVE_CODE 1
+#endif
+
+namespace SkSL::RP {
+
+/**
+ * A block of executable machine code. The function reads and writes N-wide slots at offsets
+ * relative to its `base` argument, exactly like the SkRasterPipeline stages it replaces.
+ */
+class NativeCode {
+public:
+    using Fn = void (*)(std::byte* base);
+
+    ~NativeCode();
+
+    Fn fn() const { return fFn; }
+
+private:
+    friend class NativeCodeAssembler;
+
+    NativeCode(void* memory, size_t size);
+
+    void*  fMemory;
+    size_t fSize;
+    Fn     fFn;
+};
+
+/**
+ * Assembles straight-line, unmasked float slot arithmetic into SSE code. Each slot is `stride`
+ * floats wide (the highp raster pipeline stride), and is processed four lanes at a time.
+ */
+class NativeCodeAssembler {
+public:
+    // The values are the SSE opcodes for the corresponding packed-float instruction.
+    enum class BinaryOp : uint8_t {
+        kAdd = 0x58,
+        kMul = 0x59,
+        kSub = 0x5C,
+        kMin = 0x5D,
+        kDiv = 0x5E,
+        kMax = 0x5F,
+    };
+
+    // Returns true if native code can be generated for slots of the given stride on this device.
+    static bool IsSupported(int stride);
+
+    explicit NativeCodeAssembler(int stride);
+
+    /** Fills the slot at `dst` with the bits of `value`. */
+    void splatConstant(SkRPOffset dst, int32_t value);
+
+    /** Fills the slot at `dst` with the single scalar at `src`. */
+    void splatScalar(SkRPOffset dst, SkRPOffset src);
+
+    /** Copies the slot at `src` to `dst`. */
+    void copySlot(SkRPOffset dst, SkRPOffset src);
+
+    /** `dst = dst <op> src`, one slot. */
+    void binarySlot(BinaryOp op, SkRPOffset dst, SkRPOffset src);
+
+    /** `dst = dst <op> value`, one slot; `value` holds the bits of a float. */
+    void binaryImmediate(BinaryOp op, SkRPOffset dst, int32_t value);
+
+    int numOps() const { return fNumOps; }
+
+    /**
+     * Copies the assembled code into executable memory. Returns null if no ops were assembled, or
+     * if the platform refuses to map executable pages.
+     */
+    std::unique_ptr<NativeCode> finish();
+
+private:
+    void emit(std::initializer_list<uint8_t> bytes);
+    void emit32(uint32_t value);
+    void movupsLoad(int xmm, uint32_t offset);
+    void movupsStore(uint32_t offset, int xmm);
+    void splatEAX(int xmm);
+
+    SkTDArray<uint8_t> fCode;
+    int fStride;
+    int fNumOps = 0;
+};
+
+}  // namespace SkSL::RP
+
+#endif  // SKSL_RASTERPIPELINENATIVECODE
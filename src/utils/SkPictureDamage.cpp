@@ -0,0 +1,255 @@
+/*
+ * Copyright 2024 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkPictureDamage.h"
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecords.h"
+
+#include <cstring>
+#include <type_traits>
+
+using namespace skia_private;
+
+namespace {
+
+// Op equality used for diffing. Anything not listed here is conservatively treated as changed.
+// Ref-counted effects (shaders, images, blobs, pictures, ...) are immutable, so they are
+// compared by identity.
+using namespace SkRecords;
+
+template <typename T>
+bool equal(const T&, const T&) { return false; }
+
+template <typename T>
+bool equal_opt(const Optional<T>& a, const Optional<T>& b) {
+    const T* pa = a;
+    const T* pb = b;
+    return pa == pb || (pa && pb && *pa == *pb);
+}
+
+bool equal_clip(const ClipOpAndAA& a, const ClipOpAndAA& b) {
+    return a.op() == b.op() && a.aa() == b.aa();
+}
+
+bool equal(const NoOp&, const NoOp&) { return true; }
+bool equal(const Save&, const Save&) { return true; }
+bool equal(const ResetClip&, const ResetClip&) { return true; }
+bool equal(const Restore& a, const Restore& b) { return a.matrix == b.matrix; }
+
+bool equal(const SaveLayer& a, const SaveLayer& b) {
+    if (a.filters.size() != b.filters.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.filters.size(); ++i) {
+        if (a.filters[i] != b.filters[i]) {
+            return false;
+        }
+    }
+    return equal_opt(a.bounds, b.bounds) && equal_opt(a.paint, b.paint) &&
+           a.backdrop == b.backdrop && a.saveLayerFlags == b.saveLayerFlags &&
+           a.backdropScale == b.backdropScale;
+}
+bool equal(const SaveBehind& a, const SaveBehind& b) { return equal_opt(a.subset, b.subset); }
+
+bool equal(const SetMatrix& a, const SetMatrix& b) { return a.matrix == b.matrix; }
+bool equal(const SetM44& a, const SetM44& b) { return a.matrix == b.matrix; }
+bool equal(const Concat& a, const Concat& b) { return a.matrix == b.matrix; }
+bool equal(const Concat44& a, const Concat44& b) { return a.matrix == b.matrix; }
+bool equal(const Translate& a, const Translate& b) { return a.dx == b.dx && a.dy == b.dy; }
+bool equal(const Scale& a, const Scale& b) { return a.sx == b.sx && a.sy == b.sy; }
+
+bool equal(const ClipPath& a, const ClipPath& b) {
+    return a.path == b.path && equal_clip(a.opAA, b.opAA);
+}
+bool equal(const ClipRRect& a, const ClipRRect& b) {
+    return a.rrect == b.rrect && equal_clip(a.opAA, b.opAA);
+}
+bool equal(const ClipRect& a, const ClipRect& b) {
+    return a.rect == b.rect && equal_clip(a.opAA, b.opAA);
+}
+bool equal(const ClipRegion& a, const ClipRegion& b) {
+    return a.region == b.region && a.op == b.op;
+}
+bool equal(const ClipShader& a, const ClipShader& b) {
+    return a.shader == b.shader && a.op == b.op;
+}
+
+bool equal(const DrawArc& a, const DrawArc& b) {
+    return a.paint == b.paint && a.oval == b.oval && a.startAngle == b.startAngle &&
+           a.sweepAngle == b.sweepAngle && a.useCenter == b.useCenter;
+}
+bool equal(const DrawDRRect& a, const DrawDRRect& b) {
+    return a.paint == b.paint && a.outer == b.outer && a.inner == b.inner;
+}
+bool equal(const DrawImage& a, const DrawImage& b) {
+    return equal_opt(a.paint, b.paint) && a.image == b.image && a.left == b.left &&
+           a.top == b.top && a.sampling == b.sampling;
+}
+bool equal(const DrawImageRect& a, const DrawImageRect& b) {
+    return equal_opt(a.paint, b.paint) && a.image == b.image && a.src == b.src &&
+           a.dst == b.dst && a.sampling == b.sampling && a.constraint == b.constraint;
+}
+bool equal(const DrawOval& a, const DrawOval& b) {
+    return a.paint == b.paint && a.oval == b.oval;
+}
+bool equal(const DrawPaint& a, const DrawPaint& b) { return a.paint == b.paint; }
+bool equal(const DrawBehind& a, const DrawBehind& b) { return a.paint == b.paint; }
+bool equal(const DrawPath& a, const DrawPath& b) {
+    return a.paint == b.paint && a.path == b.path;
+}
+bool equal(const DrawPicture& a, const DrawPicture& b) {
+    return equal_opt(a.paint, b.paint) && a.picture == b.picture && a.matrix == b.matrix;
+}
+bool equal(const DrawPoints& a, const DrawPoints& b) {
+    return a.paint == b.paint && a.mode == b.mode && a.count == b.count &&
+           !memcmp(a.pts, b.pts, a.count * sizeof(SkPoint));
+}
+bool equal(const DrawRRect& a, const DrawRRect& b) {
+    return a.paint == b.paint && a.rrect == b.rrect;
+}
+bool equal(const DrawRect& a, const DrawRect& b) {
+    return a.paint == b.paint && a.rect == b.rect;
+}
+bool equal(const DrawRegion& a, const DrawRegion& b) {
+    return a.paint == b.paint && a.region == b.region;
+}
+bool equal(const DrawTextBlob& a, const DrawTextBlob& b) {
+    return a.paint == b.paint && a.blob == b.blob && a.x == b.x && a.y == b.y;
+}
+bool equal(const DrawVertices& a, const DrawVertices& b) {
+    return a.paint == b.paint && a.vertices == b.vertices && a.bmode == b.bmode;
+}
+bool equal(const DrawAnnotation& a, const DrawAnnotation& b) {
+    return a.rect == b.rect && a.key == b.key &&
+           (a.value == b.value || (a.value && a.value->equals(b.value.get())));
+}
+
+struct TypedOp {
+    Type        type;
+    const void* op;
+};
+
+class PictureOps {
+public:
+    explicit PictureOps(const SkBigPicture& picture)
+            : fRecord(*picture.record())
+            , fBounds(fRecord.count()) {
+        AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord.count());
+        SkRecordFillBounds(picture.cullRect(), fRecord, fBounds.data(), meta);
+    }
+
+    int count() const { return fRecord.count(); }
+    const SkRect& bounds(int i) const { return fBounds[i]; }
+
+    TypedOp op(int i) const {
+        return fRecord.visit(i, [](const auto& op) -> TypedOp {
+            return {std::decay_t<decltype(op)>::kType, &op};
+        });
+    }
+
+    // True if op i here draws exactly what op j of 'other' draws, in the same place.
+    bool matches(int i, const PictureOps& other, int j) const {
+        if (fBounds[i] != other.fBounds[j]) {
+            return false;
+        }
+        const TypedOp a = other.op(j);
+        return fRecord.visit(i, [&a](const auto& op) {
+            using T = std::decay_t<decltype(op)>;
+            return a.type == T::kType && equal(*static_cast<const T*>(a.op), op);
+        });
+    }
+
+private:
+    const SkRecord&      fRecord;
+    AutoTArray<SkRect>   fBounds;
+};
+
+void add_damage(SkRegion* damage, const SkRect& bounds) {
+    if (bounds.isFinite() && !bounds.isEmpty()) {
+        damage->op(bounds.roundOut(), SkRegion::kUnion_Op);
+    }
+}
+
+}  // namespace
+
+SkRegion SkPictureDamage::Compute(const SkPicture* prev, const SkPicture& next) {
+    SkRegion damage;
+
+    const SkBigPicture* prevBig = prev ? SkPicturePriv::AsSkBigPicture(sk_ref_sp(prev)) : nullptr;
+    const SkBigPicture* nextBig = SkPicturePriv::AsSkBigPicture(sk_ref_sp(&next));
+    if (!prevBig || !nextBig) {
+        if (prev) {
+            add_damage(&damage, prev->cullRect());
+        }
+        add_damage(&damage, next.cullRect());
+        return damage;
+    }
+
+    const PictureOps before(*prevBig);
+    const PictureOps after(*nextBig);
+
+    // Strip the common prefix and suffix; typically only a few ops in between have changed.
+    int prefix = 0;
+    while (prefix < before.count() && prefix < after.count() &&
+           before.matches(prefix, after, prefix)) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < before.count() - prefix && suffix < after.count() - prefix &&
+           before.matches(before.count() - 1 - suffix, after, after.count() - 1 - suffix)) {
+        ++suffix;
+    }
+
+    const int beforeCount = before.count() - prefix - suffix;
+    const int afterCount = after.count() - prefix - suffix;
+    if (beforeCount == afterCount) {
+        // Same structure: only ops that changed in place damage their old and new bounds. A
+        // changed state op (matrix, clip, save) is given the bounds of everything it affects by
+        // SkRecordFillBounds, so this stays conservative.
+        for (int i = prefix; i < prefix + beforeCount; ++i) {
+            if (!before.matches(i, after, i)) {
+                add_damage(&damage, before.bounds(i));
+                add_damage(&damage, after.bounds(i));
+            }
+        }
+    } else {
+        for (int i = prefix; i < prefix + beforeCount; ++i) {
+            add_damage(&damage, before.bounds(i));
+        }
+        for (int i = prefix; i < prefix + afterCount; ++i) {
+            add_damage(&damage, after.bounds(i));
+        }
+    }
+    return damage;
+}
+
+void SkPictureDamage::Replay(SkCanvas* canvas, const SkPicture& next, const SkRegion& damage) {
+    // Each rect is replayed separately so the BBH only visits the ops that touch it.
+    for (SkRegion::Iterator iter(damage); !iter.done(); iter.next()) {
+        SkAutoCanvasRestore acr(canvas, true);
+        canvas->clipRect(SkRect::Make(iter.rect()));
+        canvas->clear(SK_ColorTRANSPARENT);
+        next.playback(canvas);
+    }
+}
+
+SkRegion SkPictureDamage::Update(SkCanvas* canvas, const SkPicture* prev, const SkPicture& next) {
+    SkRegion damage = Compute(prev, next);
+    Replay(canvas, next, damage);
+    return damage;
+}
@@ -23,9 +23,11 @@
 #include "src/core/SkMatrixUtils.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -263,3 +265,67 @@ DEF_TEST(DrawBitmapRect, reporter) {
 
     test_treatAsSprite(reporter);
 }
+
+// The raster device draws runs of entries that share an image with a single pipeline; that should
+// match drawing each entry on its own.
+DEF_TEST(DrawEdgeAAImageSet_SharedImage, reporter) {
+    SkBitmap src;
+    src.allocN32Pixels(32, 32);
+    for (int y = 0; y < 32; ++y) {
+        for (int x = 0; x < 32; ++x) {
+            *src.getAddr32(x, y) = SkPreMultiplyARGB(0xFF, x * 8, y * 8, (x ^ y) * 8);
+        }
+    }
+    sk_sp<SkImage> image = src.asImage();
+
+    const SkMatrix preViewMatrices[] = { SkMatrix::Translate(4, 2) };
+    std::array<SkCanvas::ImageSetEntry, 4> set;
+    for (int i = 0; i < 4; ++i) {
+        SkRect srcR = SkRect::MakeXYWH((i % 2) * 16, (i / 2) * 16, 16, 16);
+        SkRect dstR = SkRect::MakeXYWH((i % 2) * 24, (i / 2) * 24, 24, 24);
+        set[i] = SkCanvas::ImageSetEntry(image, srcR, dstR, i == 1 ? 0.5f : 1.f,
+                                         i == 2 ? SkCanvas::kAll_QuadAAFlags
+                                                : SkCanvas::kNone_QuadAAFlags);
+    }
+    set[3].fMatrixIndex = 0;
+
+    const SkSamplingOptions sampling(SkFilterMode::kLinear);
+    SkPaint paint;
+    paint.setAlphaf(0.75f);
+
+    SkBitmap batched, single;
+    batched.allocN32Pixels(64, 64);
+    batched.eraseColor(SK_ColorWHITE);
+    single.allocN32Pixels(64, 64);
+    single.eraseColor(SK_ColorWHITE);
+
+    SkCanvas(batched).experimental_DrawEdgeAAImageSet(set.data(), set.size(), nullptr,
+                                                      preViewMatrices, sampling, &paint,
+                                                      SkCanvas::kFast_SrcRectConstraint);
+    SkCanvas singleCanvas(single);
+    for (const SkCanvas::ImageSetEntry& entry : set) {
+        SkPaint entryPaint = paint;
+        entryPaint.setAlphaf(paint.getAlphaf() * entry.fAlpha);
+        entryPaint.setAntiAlias(entry.fAAFlags == SkCanvas::kAll_QuadAAFlags);
+        singleCanvas.save();
+        if (entry.fMatrixIndex >= 0) {
+            singleCanvas.concat(preViewMatrices[entry.fMatrixIndex]);
+        }
+        singleCanvas.drawImageRect(entry.fImage.get(), entry.fSrcRect, entry.fDstRect, sampling,
+                                   &entryPaint, SkCanvas::kFast_SrcRectConstraint);
+        singleCanvas.restore();
+    }
+
+    int maxDiff = 0;
+    for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 64; ++x) {
+            SkPMColor a = *batched.getAddr32(x, y),
+                      b = *single.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                maxDiff = std::max(maxDiff,
+                                   std::abs(int((a >> shift) & 0xFF) - int((b >> shift) & 0xFF)));
+            }
+        }
+    }
+    REPORTER_ASSERT(reporter, maxDiff <= 2, "max channel diff %d", maxDiff);
+}
@@ -12,21 +12,27 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
 #include "include/core/SkPathEffect.h"  // IWYU pragma: keep
+#include "include/core/SkPixmap.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
 #include "include/effects/SkDashPathEffect.h"
+#include "src/core/SkDistanceFieldGlyphCache.h"
 #include "tests/Test.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 
 static const SkColor bgColor = SK_ColorWHITE;
@@ -184,3 +190,160 @@ DEF_TEST(DrawText_noglyphs, r) {
             "\x0d\xf3\xf2\xf2\xe9\x0d\x0d\x0d\x05\x0d\x0d\xe3\xe3\xe3\xe3\xe3\xe3\xe3\xe3\xe3",
             10, 20, font, SkPaint());
 }
+
+#if !defined(SK_DISABLE_SDF_TEXT)
+static int64_t ink(SkSurface* surface) {
+    SkPixmap pixmap;
+    SkAssertResult(surface->peekPixels(&pixmap));
+    int64_t sum = 0;
+    for (int y = 0; y < pixmap.height(); ++y) {
+        for (int x = 0; x < pixmap.width(); ++x) {
+            sum += 255 - SkColorGetR(pixmap.getColor(x, y));
+        }
+    }
+    return sum;
+}
+
+// Text drawn from distance fields should cover about as much as text drawn from masks, at any
+// rotation.
+DEF_TEST(DrawText_distanceFields, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 300);
+    const SkSurfaceProps props(SkSurfaceProps::kDistanceFieldText_Flag, kUnknown_SkPixelGeometry);
+    auto maskSurface = SkSurfaces::Raster(info);
+    auto fieldSurface = SkSurfaces::Raster(info, &props);
+
+    SkFont font = ToolUtils::DefaultPortableFont();
+    font.setSize(40);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+
+    for (SkScalar degrees : {0.0f, 30.0f, 90.0f, 200.0f}) {
+        for (SkSurface* surface : {maskSurface.get(), fieldSurface.get()}) {
+            SkCanvas* canvas = surface->getCanvas();
+            canvas->clear(SK_ColorWHITE);
+            canvas->save();
+            canvas->translate(150, 150);
+            canvas->rotate(degrees);
+            canvas->drawString("Hamburgefons", -120, 15, font, SkPaint());
+            canvas->restore();
+        }
+        const int64_t maskInk = ink(maskSurface.get()),
+                      fieldInk = ink(fieldSurface.get());
+        REPORTER_ASSERT(r, maskInk > 0);
+        REPORTER_ASSERT(r, std::abs(fieldInk - maskInk) < maskInk / 4,
+                        "rotation %g: mask ink %lld, distance field ink %lld",
+                        degrees, (long long)maskInk, (long long)fieldInk);
+    }
+}
+
+// Layers and tiles have their own device space. Distance field text in a layer which is not at the
+// canvas origin should be clipped to the layer, not cut by the canvas' clip mapped into it.
+DEF_TEST(DrawText_distanceFieldsInOffsetLayer, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 300);
+    const SkSurfaceProps props(SkSurfaceProps::kDistanceFieldText_Flag, kUnknown_SkPixelGeometry);
+    auto maskSurface = SkSurfaces::Raster(info);
+    auto fieldSurface = SkSurfaces::Raster(info, &props);
+
+    SkFont font = ToolUtils::DefaultPortableFont();
+    font.setSize(40);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+
+    const SkRect layerBounds = SkRect::MakeLTRB(100, 100, 300, 300);
+    for (SkSurface* surface : {maskSurface.get(), fieldSurface.get()}) {
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->clear(SK_ColorWHITE);
+        canvas->saveLayer(&layerBounds, nullptr);
+        canvas->drawString("Hambur", 110, 200, font, SkPaint());
+        canvas->restore();
+    }
+    const int64_t maskInk = ink(maskSurface.get()),
+                  fieldInk = ink(fieldSurface.get());
+    REPORTER_ASSERT(r, maskInk > 0);
+    REPORTER_ASSERT(r, std::abs(fieldInk - maskInk) < maskInk / 4,
+                    "mask ink %lld, distance field ink %lld",
+                    (long long)maskInk, (long long)fieldInk);
+}
+
+// Text too large to draw from the largest distance field is drawn as paths. The skew keeps each
+// axis of the glyphs under the limit for paths of SkStrikeSpec::ShouldDrawAsPath, while the text
+// is magnified past SkDistanceFieldGlyphCache::kMaxTextSize.
+DEF_TEST(DrawText_distanceFieldsLargeText, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 250);
+    const SkSurfaceProps props(SkSurfaceProps::kDistanceFieldText_Flag, kUnknown_SkPixelGeometry);
+    auto pathSurface = SkSurfaces::Raster(info);
+    auto fieldSurface = SkSurfaces::Raster(info, &props);
+
+    SkFont font = ToolUtils::DefaultPortableFont();
+    font.setSize(170);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    const SkGlyphID glyphID = font.unicharToGlyph('H');
+    SkPath path;
+    REPORTER_ASSERT(r, font.getPath(glyphID, &path));
+
+    const SkMatrix skew = SkMatrix::Skew(1, 0);
+    REPORTER_ASSERT(r,
+                    font.getSize() * skew.getMaxScale() > SkDistanceFieldGlyphCache::kMaxTextSize);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (SkSurface* surface : {pathSurface.get(), fieldSurface.get()}) {
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->clear(SK_ColorWHITE);
+        canvas->translate(150, 200);
+        canvas->concat(skew);
+        if (surface == pathSurface.get()) {
+            canvas->drawPath(path, paint);
+        } else {
+            canvas->drawSimpleText(&glyphID, sizeof(glyphID), SkTextEncoding::kGlyphID,
+                                   0, 0, font, paint);
+        }
+    }
+    const int64_t pathInk = ink(pathSurface.get()),
+                  fieldInk = ink(fieldSurface.get());
+    REPORTER_ASSERT(r, pathInk > 0);
+    REPORTER_ASSERT(r, std::abs(fieldInk - pathInk) < pathInk / 100,
+                    "path ink %lld, distance field surface ink %lld",
+                    (long long)pathInk, (long long)fieldInk);
+}
+
+// The distance field cache stays within its byte limit, and still hands out distance fields when
+// it can't keep them. Uses its own cache rather than the global one other tests draw through.
+DEF_TEST(DrawText_distanceFieldCache, r) {
+    SkFont font = ToolUtils::DefaultPortableFont();
+    font.setSize(SkDistanceFieldGlyphCache::BucketTextSize(40));
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    SkGlyphID glyphIDs[12];
+    const int count = font.textToGlyphs(
+            "Hamburgefons", 12, SkTextEncoding::kUTF8, glyphIDs, std::size(glyphIDs));
+    REPORTER_ASSERT(r, count == 12);
+    sk_sp<SkDistanceFieldGlyphCache::Glyph> glyphs[std::size(glyphIDs)];
+
+    SkDistanceFieldGlyphCache cache;
+    auto hasDistanceFields = [&]() {
+        return std::all_of(std::begin(glyphs), std::end(glyphs), [](const auto& glyph) {
+            return glyph && (glyph->isEmpty() || glyph->hasDistanceField());
+        });
+    };
+    cache.findOrCreate(font, glyphIDs, glyphs);
+    REPORTER_ASSERT(r, hasDistanceFields());
+    const size_t used = cache.bytesUsed();
+    REPORTER_ASSERT(r, used > 0);
+
+    // Found in the cache the second time.
+    sk_sp<SkDistanceFieldGlyphCache::Glyph> first = glyphs[0];
+    cache.findOrCreate(font, glyphIDs, glyphs);
+    REPORTER_ASSERT(r, glyphs[0] == first);
+    REPORTER_ASSERT(r, cache.bytesUsed() == used);
+
+    REPORTER_ASSERT(r, cache.setByteLimit(used / 2) == SK_DEFAULT_DISTANCE_FIELD_TEXT_CACHE_LIMIT);
+    REPORTER_ASSERT(r, cache.bytesUsed() <= used / 2);
+
+    cache.setByteLimit(0);
+    REPORTER_ASSERT(r, cache.bytesUsed() == 0);
+    for (auto& glyph : glyphs) {
+        glyph.reset();
+    }
+    cache.findOrCreate(font, glyphIDs, glyphs);
+    REPORTER_ASSERT(r, hasDistanceFields());
+    REPORTER_ASSERT(r, cache.bytesUsed() == 0);
+}
+#endif
@@ -42,7 +42,9 @@
 #include "tests/CtsEnforcement.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 
@@ -602,6 +604,51 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(TestSweepGradientZeroXGanesh,
 // }
 // #endif
 
+// Gradients evaluated through a raster LUT should stay within a couple of 8-bit levels of the
+// exact evaluation for gradients without hard stops.
+DEF_TEST(Gradient_LUT, reporter) {
+    static constexpr int kWidth = 256;
+    const SkPoint pts[] = {{0, 0}, {kWidth, 0}};
+    const SkColor4f colors[] = {
+        SkColor4f::FromColor(0xFF202020), SkColor4f::FromColor(0xFF406080),
+        SkColor4f::FromColor(0xFF6080A0), SkColor4f::FromColor(0xFF80A0C0),
+        SkColor4f::FromColor(0xFF6090A0), SkColor4f::FromColor(0xFF406070),
+    };
+    const SkScalar pos[] = {0.f, .15f, .35f, .5f, .7f, 1.f};
+
+    using Interpolation = SkGradientShader::Interpolation;
+    for (auto cs : {Interpolation::ColorSpace::kDestination, Interpolation::ColorSpace::kOKLab}) {
+        for (const SkScalar* p : {pos, (const SkScalar*)nullptr}) {
+            Interpolation interpolation;
+            interpolation.fColorSpace = cs;
+            SkPaint paint;
+            paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, p,
+                                                         std::size(colors), SkTileMode::kClamp,
+                                                         interpolation, nullptr));
+
+            SkBitmap exact, lut;
+            exact.allocN32Pixels(kWidth, 1);
+            lut.allocN32Pixels(kWidth, 1);
+
+            SkCanvas(exact).drawPaint(paint);
+            SkCanvas(lut, SkSurfaceProps(SkSurfaceProps::kGradientLUT_Flag,
+                                         kUnknown_SkPixelGeometry)).drawPaint(paint);
+
+            int maxDiff = 0;
+            for (int x = 0; x < kWidth; ++x) {
+                SkColor a = exact.getColor(x, 0),
+                        b = lut.getColor(x, 0);
+                maxDiff = std::max({maxDiff,
+                                    std::abs((int)SkColorGetR(a) - (int)SkColorGetR(b)),
+                                    std::abs((int)SkColorGetG(a) - (int)SkColorGetG(b)),
+                                    std::abs((int)SkColorGetB(a) - (int)SkColorGetB(b)),
+                                    std::abs((int)SkColorGetA(a) - (int)SkColorGetA(b))});
+            }
+            REPORTER_ASSERT(reporter, maxDiff <= 2, "max diff %d", maxDiff);
+        }
+    }
+}
+
 DEF_TEST(Gradient, reporter) {
     TestGradientShaders(reporter);
     TestConstantGradient(reporter);
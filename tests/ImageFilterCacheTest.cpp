@@ -184,6 +184,67 @@ static void test_explicit_purging(skiatest::Reporter* reporter,
     REPORTER_ASSERT(reporter, !cache->get(key2, &foundImage));
 }
 
+// Results for a translated layer matrix or an overlapping clip are found as partial matches, as
+// long as the part of the request they don't cover is a single rectangle.
+static void test_find_partial(skiatest::Reporter* reporter, const sk_sp<SkSpecialImage>& image) {
+    static const size_t kCacheSize = 1000000;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(kCacheSize));
+
+    SkIRect clip = SkIRect::MakeWH(100, 100);
+    SkImageFilterCacheKey key0(0, SkMatrix::I(), clip, SK_InvalidUniqueID, SkIRect::MakeEmpty());
+    // Scrolled up by 10 pixels, so the bottom 10 rows are newly exposed
+    SkImageFilterCacheKey key1(0, SkMatrix::Translate(0, -10), clip,
+                               SK_InvalidUniqueID, SkIRect::MakeEmpty());
+    // Clip shifted within the same layer
+    SkImageFilterCacheKey key2(0, SkMatrix::I(), clip.makeOffset(5, 0),
+                               SK_InvalidUniqueID, SkIRect::MakeEmpty());
+    // Diagonal scroll exposes an L-shaped region, fractional translation requires resampling
+    SkImageFilterCacheKey key3(0, SkMatrix::Translate(3, 3), clip,
+                               SK_InvalidUniqueID, SkIRect::MakeEmpty());
+    SkImageFilterCacheKey key4(0, SkMatrix::Translate(0.5f, 0), clip,
+                               SK_InvalidUniqueID, SkIRect::MakeEmpty());
+    // A translated layer can't reuse results that depend on the source image
+    SkImageFilterCacheKey key5(0, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+    SkImageFilterCacheKey key6(0, SkMatrix::Translate(0, -10), clip,
+                               image->uniqueID(), image->subset());
+
+    auto filter = make_filter();
+    cache->set(key0, filter.get(), skif::FilterResult(image));
+    cache->set(key5, filter.get(), skif::FilterResult(image));
+
+    skif::FilterResult found;
+    SkImageFilterCache::PartialMatch partial;
+    REPORTER_ASSERT(reporter, cache->find(key0, filter.get(), &found, &partial) ==
+                              SkImageFilterCache::Match::kHit);
+
+    REPORTER_ASSERT(reporter, cache->find(key1, filter.get(), &found, &partial) ==
+                              SkImageFilterCache::Match::kPartialHit);
+    REPORTER_ASSERT(reporter, partial.fTranslation == SkIVector::Make(0, -10));
+    REPORTER_ASSERT(reporter, partial.fCovered == SkIRect::MakeLTRB(0, 0, 100, 90));
+    REPORTER_ASSERT(reporter, partial.fExposed == SkIRect::MakeLTRB(0, 90, 100, 100));
+
+    REPORTER_ASSERT(reporter, cache->find(key2, filter.get(), &found, &partial) ==
+                              SkImageFilterCache::Match::kPartialHit);
+    REPORTER_ASSERT(reporter, partial.fTranslation == SkIVector::Make(0, 0));
+    REPORTER_ASSERT(reporter, partial.fExposed == SkIRect::MakeLTRB(100, 0, 105, 100));
+
+    REPORTER_ASSERT(reporter, cache->find(key3, filter.get(), &found, &partial) ==
+                              SkImageFilterCache::Match::kMiss);
+    REPORTER_ASSERT(reporter, cache->find(key4, filter.get(), &found, &partial) ==
+                              SkImageFilterCache::Match::kMiss);
+    REPORTER_ASSERT(reporter, cache->find(key6, filter.get(), &found, &partial) ==
+                              SkImageFilterCache::Match::kMiss);
+
+    auto otherFilter = make_filter();
+    REPORTER_ASSERT(reporter, cache->find(key1, otherFilter.get(), &found, &partial) ==
+                              SkImageFilterCache::Match::kMiss);
+
+    SkImageFilterCache::Stats stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == 1);
+    REPORTER_ASSERT(reporter, stats.fPartialHits == 2);
+    REPORTER_ASSERT(reporter, stats.fMisses == 4);
+}
+
 DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     SkBitmap srcBM = create_bm();
 
@@ -200,6 +261,7 @@ DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
+    test_find_partial(reporter, fullImg);
 }
 
 
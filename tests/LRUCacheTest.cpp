@@ -70,3 +70,44 @@ DEF_TEST(LRUCacheRandom, r) {
     }
     REPORTER_ASSERT(r, 0 == instances);
 }
+
+DEF_TEST(LRUCacheSetMaxCount, r) {
+    int instances = 0;
+    {
+        SkLRUCache<int, std::unique_ptr<Value>> test(4);
+        for (int i = 0; i < 4; i++) {
+            test.insert(i, std::make_unique<Value>(i, &instances));
+        }
+        test.find(0);  // 0 is now the most recently used.
+
+        test.setMaxCount(2);
+        REPORTER_ASSERT(r, 2 == instances);
+        REPORTER_ASSERT(r, test.find(0));
+        REPORTER_ASSERT(r, test.find(3));
+        REPORTER_ASSERT(r, !test.find(1));
+
+        test.setMaxCount(8);
+        test.insert(5, std::make_unique<Value>(5, &instances));
+        REPORTER_ASSERT(r, 3 == test.count());
+    }
+    REPORTER_ASSERT(r, 0 == instances);
+}
+
+DEF_TEST(LRUCacheLeastRecentlyUsed, r) {
+    int instances = 0;
+    {
+        SkLRUCache<int, std::unique_ptr<Value>> test(4);
+        REPORTER_ASSERT(r, !test.leastRecentlyUsed());
+        for (int i = 0; i < 3; i++) {
+            test.insert(i, std::make_unique<Value>(i, &instances));
+        }
+        test.find(0);  // 1 is now the least recently used.
+
+        REPORTER_ASSERT(r, 1 == (*test.leastRecentlyUsed())->fValue);
+        test.removeLeastRecentlyUsed();
+        REPORTER_ASSERT(r, 2 == instances);
+        REPORTER_ASSERT(r, !test.find(1));
+        REPORTER_ASSERT(r, 2 == (*test.leastRecentlyUsed())->fValue);
+    }
+    REPORTER_ASSERT(r, 0 == instances);
+}
@@ -24,20 +24,28 @@
 #include "include/core/SkPixelRef.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/utils/SkPictureDamage.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkPicturePriv.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordSerialize.h"
+#include "src/core/SkRecords.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
 #include "tools/fonts/FontToolUtils.h"
 
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <new>
 #include <vector>
 
 class SkRRect;
@@ -924,3 +932,190 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+DEF_TEST(Picture_damage, r) {
+    auto make_frame = [](SkScalar x, SkColor color) {
+        SkRTreeFactory factory;
+        SkPictureRecorder rec;
+        SkCanvas* c = rec.beginRecording({0, 0, 100, 100}, &factory);
+        SkPaint paint;
+        paint.setColor(SK_ColorBLUE);
+        c->drawRect({10, 10, 30, 30}, paint);
+        paint.setColor(color);
+        c->drawRect({x, 50, x + 20, 70}, paint);
+        paint.setColor(SK_ColorGREEN);
+        c->drawRect({70, 10, 90, 30}, paint);
+        return rec.finishRecordingAsPicture();
+    };
+
+    sk_sp<SkPicture> prev = make_frame(10, SK_ColorRED);
+
+    // Identical content recorded twice produces no damage.
+    sk_sp<SkPicture> same = make_frame(10, SK_ColorRED);
+    REPORTER_ASSERT(r, SkPictureDamage::Compute(prev.get(), *same).isEmpty());
+
+    // Moving one rect damages its old and new positions, but not the untouched rects.
+    sk_sp<SkPicture> next = make_frame(40, SK_ColorRED);
+    SkRegion damage = SkPictureDamage::Compute(prev.get(), *next);
+    REPORTER_ASSERT(r, damage.contains(SkIRect::MakeLTRB(10, 50, 30, 70)));
+    REPORTER_ASSERT(r, damage.contains(SkIRect::MakeLTRB(40, 50, 60, 70)));
+    REPORTER_ASSERT(r, !damage.intersects(SkIRect::MakeLTRB(10, 10, 30, 30)));
+    REPORTER_ASSERT(r, !damage.intersects(SkIRect::MakeLTRB(70, 10, 90, 30)));
+
+    // Without a previous frame everything is damaged.
+    REPORTER_ASSERT(r, SkPictureDamage::Compute(nullptr, *next)
+                               .contains(SkIRect::MakeWH(100, 100)));
+
+    // A partial update must match a full redraw.
+    SkBitmap full, partial;
+    full.allocN32Pixels(100, 100);
+    full.eraseColor(SK_ColorTRANSPARENT);
+    partial.allocN32Pixels(100, 100);
+    partial.eraseColor(SK_ColorTRANSPARENT);
+
+    SkCanvas(full).drawPicture(next);
+    SkCanvas partialCanvas(partial);
+    partialCanvas.drawPicture(prev);
+    damage = SkPictureDamage::Update(&partialCanvas, prev.get(), *next);
+    REPORTER_ASSERT(r, !damage.isEmpty());
+    REPORTER_ASSERT(r, !memcmp(full.getPixels(), partial.getPixels(), full.computeByteSize()));
+}
+
+DEF_TEST(Picture_presizeFromPreviousRecording, r) {
+    SkPictureRecorder recorder;
+    recorder.setPresizeFromPreviousRecording(true);
+    for (int ops : {100, 300, 50}) {
+        SkCanvas* canvas = recorder.beginRecording({0, 0, 100, 100});
+        for (int i = 0; i < ops; i++) {
+            SkPaint paint;
+            paint.setColor(SkColorSetARGB(0x80, i & 0xFF, 0, 0));
+            canvas->drawRect(SkRect::MakeXYWH(i % 90, i % 70, 10, 10), paint);
+        }
+        sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+        REPORTER_ASSERT(r, picture->approximateOpCount() == ops);
+    }
+}
+
+DEF_TEST(Picture_compactSerial, r) {
+    SkBitmap bm;
+    make_bm(&bm, 10, 10, SK_ColorRED, true);
+
+    SkPictureRecorder nestedRecorder;
+    SkCanvas* nestedCanvas = nestedRecorder.beginRecording({0, 0, 50, 50});
+    nestedCanvas->drawColor(SK_ColorCYAN);
+    nestedCanvas->drawRect({5, 5, 15, 15}, SkPaint());
+    sk_sp<SkPicture> nested = nestedRecorder.finishRecordingAsPicture();
+
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording({0, 0, 100, 100});
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    SkPath path = SkPath::Circle(50, 50, 20);
+    canvas->drawRect({10, 10, 30, 30}, paint);
+    canvas->drawPath(path, paint);
+    canvas->save();
+    canvas->translate(20, 0);
+    canvas->clipPath(path, /*doAntiAlias=*/true);
+    canvas->drawPath(path, paint);
+    canvas->restore();
+    SkPaint layerPaint;
+    layerPaint.setAlphaf(0.5f);
+    canvas->saveLayer(nullptr, &layerPaint);
+    canvas->drawImage(bm.asImage(), 60, 60);
+    canvas->drawPicture(nested);
+    canvas->restore();
+    const SkPoint pts[] = {{5, 90}, {95, 90}, {50, 5}};
+    canvas->drawPoints(SkCanvas::kPolygon_PointMode, std::size(pts), pts, paint);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    SkDynamicMemoryWStream stream;
+    SkPicturePriv::SerializeCompact(picture.get(), &stream);
+    sk_sp<SkData> data = stream.detachAsData();
+
+    sk_sp<SkPicture> loaded = SkPicture::MakeFromData(data.get());
+    REPORTER_ASSERT(r, loaded);
+    if (!loaded) {
+        return;
+    }
+    REPORTER_ASSERT(r, loaded->cullRect() == picture->cullRect());
+    REPORTER_ASSERT(r, loaded->approximateOpCount(/*nested=*/true) ==
+                       picture->approximateOpCount(/*nested=*/true));
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(100, 100);
+    expected.eraseColor(SK_ColorTRANSPARENT);
+    actual.allocN32Pixels(100, 100);
+    actual.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas(expected).drawPicture(picture);
+    SkCanvas(actual).drawPicture(loaded);
+    REPORTER_ASSERT(r, !memcmp(expected.getPixels(), actual.getPixels(),
+                               expected.computeByteSize()));
+
+    // Streams that aren't memory-backed load the same picture.
+    struct CopyingStream : public SkStream {
+        explicit CopyingStream(sk_sp<SkData> data) : fStream(std::move(data)) {}
+        size_t read(void* buffer, size_t size) override { return fStream.read(buffer, size); }
+        bool isAtEnd() const override { return fStream.isAtEnd(); }
+        SkMemoryStream fStream;
+    } copyingStream(data);
+    sk_sp<SkPicture> streamed = SkPicture::MakeFromStream(&copyingStream);
+    REPORTER_ASSERT(r, streamed && streamed->approximateOpCount() == loaded->approximateOpCount());
+
+    // Truncated data is rejected.
+    REPORTER_ASSERT(r, !SkPicture::MakeFromData(data->data(), data->size() - 8));
+}
+
+DEF_TEST(Picture_compactSerialValidation, r) {
+    // Serializes `record` and reads it back, as a stand-in for hand-crafted untrusted data. The
+    // writer doesn't validate, so it writes whatever the record holds.
+    auto loads = [](const SkRecord& record) {
+        SkDynamicMemoryWStream stream;
+        if (!SkRecordSerialize(record, SkSerialProcs(), &stream)) {
+            return false;
+        }
+        sk_sp<SkData> data = stream.detachAsData();
+        size_t subPictureBytes;
+        return SkRecordDeserialize(data->data(), data->size(), SkDeserialProcs(),
+                                   SkPicturePriv::kCurrent_Version, &subPictureBytes) != nullptr;
+    };
+
+    {
+        SkRecord balanced;
+        new (balanced.append<SkRecords::Save>()) SkRecords::Save{};
+        new (balanced.append<SkRecords::Restore>()) SkRecords::Restore{SkMatrix::I()};
+        REPORTER_ASSERT(r, loads(balanced));
+    }
+    {
+        // A restore without a save would underflow the save stack of SkRecordFillBounds.
+        SkRecord unmatchedRestore;
+        new (unmatchedRestore.append<SkRecords::Restore>()) SkRecords::Restore{SkMatrix::I()};
+        REPORTER_ASSERT(r, !loads(unmatchedRestore));
+    }
+    {
+        SkRecord unrestoredSave;
+        new (unrestoredSave.append<SkRecords::Save>()) SkRecords::Save{};
+        REPORTER_ASSERT(r, !loads(unrestoredSave));
+    }
+
+    SkBitmap bm;
+    make_bm(&bm, 10, 10, SK_ColorRED, true);
+    sk_sp<SkImage> image = bm.asImage();
+    int divs[] = {3};
+    SkCanvas::Lattice::RectType rectTypes[] = {SkCanvas::Lattice::kDefault,
+                                               SkCanvas::Lattice::kTransparent,
+                                               SkCanvas::Lattice::kDefault,
+                                               SkCanvas::Lattice::kTransparent};
+    auto lattice = [&](int flagCount, int div) {
+        divs[0] = div;
+        auto record = std::make_unique<SkRecord>();
+        new (record->append<SkRecords::DrawImageLattice>()) SkRecords::DrawImageLattice{
+                nullptr, image, 1, divs, 1, divs, flagCount, rectTypes, nullptr,
+                SkIRect::MakeWH(10, 10), SkRect::MakeWH(50, 50), SkFilterMode::kNearest};
+        return record;
+    };
+    REPORTER_ASSERT(r, loads(*lattice(/*flagCount=*/4, /*div=*/3)));
+    // Every patch needs a rect type.
+    REPORTER_ASSERT(r, !loads(*lattice(/*flagCount=*/1, /*div=*/3)));
+    // Divs must lie inside the image.
+    REPORTER_ASSERT(r, !loads(*lattice(/*flagCount=*/4, /*div=*/30)));
+}
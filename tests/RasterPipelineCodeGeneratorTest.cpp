@@ -250,3 +250,52 @@ DEF_TEST(SkSLRasterPipelineCodeGeneratorComparisonIntrinsicTest, r) {
          /*startingColor=*/SkColor4f{0.0, 0.0, 0.0, 0.0},
          /*expectedResult=*/SkColor4f{0.0, 1.0, 0.0, 1.0});
 }
+
+DEF_TEST(SkSLRasterPipelineCodeGeneratorOptimizeStages, r) {
+    // The stage optimizer must not change results, and must never add stages.
+    SkSL::Compiler compiler;
+    std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+            SkSL::ProgramKind::kRuntimeColorFilter,
+            R"__SkSL__(
+                half4 main(half4 color) {
+                    half4 a = color, b = color.yxwz;
+                    half3 c = half3(a.x - 0.25, b.y * 2, min(a.z, 0.5));
+                    a.xy = c.zx;
+                    b = half4(c, 1) + a;
+                    return (a + b.wzyx) * 0.25 - half4(0.125, c.x, 0, 0);
+                }
+            )__SkSL__",
+            SkSL::ProgramSettings{});
+    REPORTER_ASSERT(r, program);
+    const SkSL::FunctionDeclaration* main = program->getFunction("main");
+    std::unique_ptr<SkSL::RP::Program> rasterProg =
+            SkSL::MakeRasterPipelineProgram(*program, *main->definition());
+    REPORTER_ASSERT(r, rasterProg);
+
+    // The second optimized run reuses the stage list which the first one optimized.
+    static constexpr bool kOptimize[] = {false, true, true};
+    int numStages[3];
+    uint32_t out[3][SkRasterPipeline_kMaxStride_highp] = {};
+    for (int run = 0; run < 3; ++run) {
+        SkSL::RP::AppendStagesOptions options;
+        options.optimizeStages = kOptimize[run];
+        SkArenaAlloc alloc(/*firstHeapAllocation=*/1000);
+        SkRasterPipeline pipeline(&alloc);
+        pipeline.appendConstantColor(&alloc, SkColor4f{0.75f, 0.5f, 0.25f, 1.0f});
+        rasterProg->appendStages(&pipeline, &alloc, /*callbacks=*/nullptr, /*uniforms=*/{},
+                                 options);
+        numStages[run] = pipeline.getNumStages();
+
+        SkRasterPipeline_MemoryCtx outCtx{/*pixels=*/out[run],
+                                          /*stride=*/SkRasterPipeline_kMaxStride_highp};
+        pipeline.append(SkRasterPipelineOp::store_8888, &outCtx);
+        pipeline.run(0, 0, 1, 1);
+    }
+
+    REPORTER_ASSERT(r, numStages[1] <= numStages[0], "%d stages > %d stages",
+                    numStages[1], numStages[0]);
+    REPORTER_ASSERT(r, numStages[2] == numStages[1], "%d stages != %d stages",
+                    numStages[2], numStages[1]);
+    REPORTER_ASSERT(r, out[2][0] == out[1][0], "%08X != %08X", out[2][0], out[1][0]);
+    REPORTER_ASSERT(r, out[0][0] == out[1][0], "%08X != %08X", out[0][0], out[1][0]);
+}
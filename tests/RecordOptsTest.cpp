@@ -5,12 +5,14 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
@@ -28,6 +30,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 static const int W = 1920, H = 1080;
 
@@ -359,6 +362,192 @@ DEF_TEST(RecordOpts_MergeSvgOpacityAndFilterLayers, r) {
     index += 4;
 }
 
+DEF_TEST(RecordOpts_NoopRedundantMatrices, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.translate(10, 10);                            // Replaced before it's used.
+    recorder.setMatrix(SkMatrix::Scale(2, 2));
+    recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+    recorder.setMatrix(SkMatrix::Scale(2, 2));             // Already the matrix.
+    recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+    recorder.save();
+        recorder.scale(3, 3);                              // Discarded by the restore.
+    recorder.restore();
+    recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+
+    SkRecordOptimizeStats stats;
+    SkRecordNoopRedundantMatrices(&record, &stats);
+    REPORTER_ASSERT(r, stats.fNoopMatrices == 3);
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::SetM44>(r, record, 1);
+    assert_type<SkRecords::NoOp>(r, record, 3);
+    assert_type<SkRecords::NoOp>(r, record, 6);
+}
+
+DEF_TEST(RecordOpts_NoopRedundantClips, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.clipRect(SkRect::MakeWH(100, 100));
+    recorder.save();
+        recorder.clipRect(SkRect::MakeWH(200, 200));        // Contains the clip.
+        recorder.clipRect(SkRect::MakeXYWH(300, 300, 10, 10), SkClipOp::kDifference);  // Misses it.
+        recorder.clipRect(SkRect::MakeWH(50, 50));
+        recorder.drawRect(SkRect::MakeWH(80, 80), SkPaint());
+    recorder.restore();
+
+    SkRecordOptimizeStats stats;
+    SkRecordNoopRedundantClips(&record, &stats);
+    REPORTER_ASSERT(r, stats.fNoopClips == 2);
+    assert_type<SkRecords::ClipRect>(r, record, 0);
+    assert_type<SkRecords::NoOp>(r, record, 2);
+    assert_type<SkRecords::NoOp>(r, record, 3);
+    assert_type<SkRecords::ClipRect>(r, record, 4);
+}
+
+DEF_TEST(RecordOpts_MergeAdjacentRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint paint;
+    paint.setColor(0x800000FF);
+    SkPaint aaPaint = paint;
+    aaPaint.setAntiAlias(true);
+    recorder.drawRect(SkRect::MakeLTRB( 0,  0, 10, 10), paint);
+    recorder.drawRect(SkRect::MakeLTRB(10,  0, 20, 10), paint);
+    recorder.drawRect(SkRect::MakeLTRB( 0, 10, 20, 20), paint);
+    recorder.drawRect(SkRect::MakeLTRB(20,  0, 30, 20), aaPaint);
+
+    SkRecordOptimizeStats stats;
+    SkRecordMergeAdjacentRects(&record, &stats);
+    REPORTER_ASSERT(r, stats.fMergedRects == 2);
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    const SkRecords::DrawRect* merged = assert_type<SkRecords::DrawRect>(r, record, 2);
+    REPORTER_ASSERT(r, merged && merged->rect == SkRect::MakeLTRB(0, 0, 20, 20));
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+}
+
+DEF_TEST(RecordOpts_NoopOccludedDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque;
+    opaque.setColor(SK_ColorRED);
+    SkPaint translucent;
+    translucent.setColor(0x80FF0000);
+    recorder.drawRect(SkRect::MakeLTRB(10, 10, 50, 50), SkPaint());      // Occluded.
+    recorder.saveLayer(nullptr, nullptr);
+        recorder.drawRect(SkRect::MakeLTRB(10, 10, 50, 50), SkPaint());  // In a layer.
+    recorder.restore();
+    recorder.drawRect(SkRect::MakeLTRB(100, 100, 200, 200), SkPaint());  // Not covered.
+    recorder.drawRect(SkRect::MakeLTRB(5, 5, 60, 60), translucent);      // Occluded.
+    recorder.drawRect(SkRect::MakeLTRB(0, 0, 80, 80), opaque);
+
+    SkRecordOptimizeStats stats;
+    SkRecordNoopOccludedDraws(&record, SkRect::MakeWH(W, H), &stats);
+    REPORTER_ASSERT(r, stats.fOccludedDraws == 2);
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 4);
+    assert_type<SkRecords::NoOp>(r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+}
+
+DEF_TEST(RecordOpts_NoopOccludedDrawsKeepsWhatShowsThrough, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque;
+    opaque.setColor(SK_ColorRED);
+    SkPaint antialiased;
+    antialiased.setAntiAlias(true);
+    recorder.drawRect(SkRect::MakeLTRB(10, 10, 50, 50), SkPaint());    // Read by the backdrop.
+    recorder.saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr,
+                                              SkImageFilters::Offset(100, 0, nullptr).get(), 0));
+    recorder.restore();
+    recorder.drawRect(SkRect::MakeLTRB(10, 10, 50, 50), antialiased);  // Edges may show.
+    recorder.drawRect(SkRect::MakeLTRB(10, 10, 50, 50), SkPaint());    // Occluded.
+    recorder.drawRect(SkRect::MakeLTRB(0, 0, 80, 80), opaque);
+
+    SkRecordOptimizeStats stats;
+    SkRecordNoopOccludedDraws(&record, SkRect::MakeWH(W, H), &stats);
+    REPORTER_ASSERT(r, stats.fOccludedDraws == 1);
+    assert_type<SkRecords::DrawRect>(r, record, 0);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::NoOp>(r, record, 4);
+    assert_type<SkRecords::DrawRect>(r, record, 5);
+
+    // An opaque paint over the whole clip hides antialiased edges too.
+    SkRecord paintRecord;
+    SkRecorder paintRecorder(&paintRecord, W, H);
+    paintRecorder.drawRect(SkRect::MakeLTRB(10.5f, 10.5f, 50.5f, 50.5f), antialiased);
+    paintRecorder.drawPaint(opaque);
+    SkRecordOptimizeStats paintStats;
+    SkRecordNoopOccludedDraws(&paintRecord, SkRect::MakeWH(W, H), &paintStats);
+    REPORTER_ASSERT(r, paintStats.fOccludedDraws == 1);
+    assert_type<SkRecords::NoOp>(r, paintRecord, 0);
+}
+
+DEF_TEST(RecordOpts_ExtendedDrawsTheSame, r) {
+    auto draw = [](SkCanvas* canvas) {
+        SkPaint paint;
+        paint.setColor(0x8000FF00);
+        canvas->drawColor(SK_ColorWHITE);
+        canvas->drawCircle(30, 30, 20, paint);
+        canvas->save();
+            canvas->clipRect(SkRect::MakeWH(60, 60), /*doAntiAlias=*/true);
+            canvas->translate(5, 5);
+            canvas->save();
+                canvas->clipRect(SkRect::MakeLTRB(-10, -10, 70, 70));
+                canvas->drawRect(SkRect::MakeLTRB(0, 0, 25, 25), paint);
+                canvas->drawRect(SkRect::MakeLTRB(25, 0, 50, 25), paint);
+            canvas->restore();
+        canvas->restore();
+        canvas->drawRect(SkRect::MakeLTRB(10, 10, 20, 20), paint);
+        SkPaint opaque;
+        opaque.setColor(SK_ColorBLUE);
+        opaque.setAntiAlias(true);
+        canvas->drawRect(SkRect::MakeLTRB(0.5f, 0.5f, 40.5f, 40.5f), opaque);
+
+        // A backdrop copies the rect below to the right of the opaque rect drawn over it.
+        canvas->drawRect(SkRect::MakeLTRB(55, 5, 65, 15), paint);
+        canvas->saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr,
+                                                 SkImageFilters::Offset(20, 0, nullptr).get(),
+                                                 0));
+        canvas->restore();
+        SkPaint aliased;
+        aliased.setColor(SK_ColorRED);
+        canvas->drawRect(SkRect::MakeLTRB(50.25f, 0.25f, 70.25f, 20.25f), aliased);
+
+        // An antialiased draw under an aliased opaque rect with fractional edges.
+        SkPaint antialiased = paint;
+        antialiased.setAntiAlias(true);
+        canvas->drawRect(SkRect::MakeLTRB(10.3f, 60.3f, 29.7f, 79.7f), antialiased);
+        canvas->drawRect(SkRect::MakeLTRB(10.3f, 60.3f, 29.7f, 79.7f), aliased);
+    };
+
+    // Pictures may be played back at any scale, not only the one they were recorded at.
+    for (const SkMatrix& playback : {SkMatrix::I(),
+                                     SkMatrix::Scale(0.75f, 0.75f).postTranslate(0.3f, 0.3f),
+                                     SkMatrix::Scale(1.4f, 1.4f)}) {
+        SkBitmap expected, actual;
+        for (SkBitmap* bitmap : {&expected, &actual}) {
+            SkPictureRecorder recorder;
+            recorder.setExtendedOptimizations(bitmap == &actual);
+            draw(recorder.beginRecording(100, 100));
+            bitmap->allocN32Pixels(150, 150);
+            bitmap->eraseColor(SK_ColorTRANSPARENT);
+            SkCanvas canvas(*bitmap);
+            canvas.concat(playback);
+            canvas.drawPicture(recorder.finishRecordingAsPicture());
+        }
+        REPORTER_ASSERT(r, !memcmp(expected.getPixels(), actual.getPixels(),
+                                   expected.computeByteSize()));
+    }
+}
+
 static void do_draw(SkCanvas* canvas, SkColor color, bool doLayer) {
     canvas->drawColor(SK_ColorWHITE);
 
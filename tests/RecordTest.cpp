@@ -97,6 +97,32 @@ DEF_TEST(Record_defrag, r) {
     assert_type<SkRecords::Restore >(r, record, 3);
 }
 
+DEF_TEST(Record_presized, r) {
+    // Appending past the preallocated size still grows the record.
+    SkRecord record(/*opCount=*/4, /*bytes=*/64);
+    for (int i = 0; i < 10; i++) {
+        APPEND(record, SkRecords::DrawRect, SkPaint(), SkRect::MakeWH(10, 10));
+    }
+    REPORTER_ASSERT(r, record.count() == 10);
+
+    AreaSummer summer;
+    summer.apply(record);
+    REPORTER_ASSERT(r, summer.area() == 1000);
+
+    // Trimming the unused room keeps the ops, and appending afterwards grows the record again.
+    record.shrinkToFit();
+    REPORTER_ASSERT(r, record.count() == 10);
+    APPEND(record, SkRecords::DrawRect, SkPaint(), SkRect::MakeWH(10, 10));
+    REPORTER_ASSERT(r, record.count() == 11);
+    summer.apply(record);
+    REPORTER_ASSERT(r, summer.area() == 2100);
+
+    SkRecord empty(/*opCount=*/16, /*bytes=*/64);
+    empty.shrinkToFit();
+    APPEND(empty, SkRecords::DrawRect, SkPaint(), SkRect::MakeWH(10, 10));
+    REPORTER_ASSERT(r, empty.count() == 1);
+}
+
 #undef APPEND
 
 template <typename T>
@@ -13,6 +13,7 @@
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontArguments.h"
 #include "include/core/SkFontMetrics.h"
@@ -62,6 +63,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -1039,3 +1041,59 @@ DEF_TEST(ReadBuffer_empty, reporter) {
     REPORTER_ASSERT(reporter, data->size() == 0);
     REPORTER_ASSERT(reporter, reader.readInt() == 321);
 }
+
+DEF_TEST(Serialization_ConcurrentAndLazyImages, reporter) {
+    // A picture with its own images, and nested pictures that each have theirs.
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkIntToScalar(kBitmapSize),
+                                               SkIntToScalar(kBitmapSize));
+    for (int i = 0; i < 4; ++i) {
+        SkPictureRecorder nestedRecorder;
+        draw_something(nestedRecorder.beginRecording(SkIntToScalar(kBitmapSize),
+                                                     SkIntToScalar(kBitmapSize)));
+        canvas->save();
+        canvas->translate(SkIntToScalar(i * kBitmapSize / 4), 0);
+        canvas->scale(0.25f, 0.25f);
+        canvas->drawPicture(nestedRecorder.finishRecordingAsPicture());
+        canvas->restore();
+    }
+    draw_something(canvas);
+    sk_sp<SkPicture> pict = recorder.finishRecordingAsPicture();
+
+    SkSerialProcs sProcs;
+    sProcs.fImageProc = [](SkImage* img, void*) -> sk_sp<SkData> {
+        return SkPngEncoder::Encode(nullptr, img, SkPngEncoder::Options{});
+    };
+    sk_sp<SkData> data = pict->serialize(&sProcs);
+    REPORTER_ASSERT(reporter, data);
+    sk_sp<SkImage> expected = render(*pict);
+
+    // Decodes eagerly, counting how many images it has decoded.
+    std::atomic<int> decodeCount{0};
+    SkDeserialProcs dProcs;
+    dProcs.fImageProc = [](const void* data, size_t length, void* ctx) -> sk_sp<SkImage> {
+        static_cast<std::atomic<int>*>(ctx)->fetch_add(1);
+        sk_sp<SkData> encoded = SkData::MakeWithCopy(data, length);
+        sk_sp<SkImage> image = SkImages::DeferredFromEncodedData(std::move(encoded));
+        return image ? image->makeRasterImage() : nullptr;
+    };
+    dProcs.fImageCtx = &decodeCount;
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(3);
+    for (bool lazy : {false, true}) {
+        skiatest::ReporterContext subtest(reporter, lazy ? "lazy" : "eager");
+        decodeCount = 0;
+        dProcs.fExecutor = executor.get();
+        dProcs.fLazyImages = lazy;
+        sk_sp<SkPicture> readPict = SkPicture::MakeFromData(data.get(), &dProcs);
+        REPORTER_ASSERT(reporter, readPict);
+        if (!readPict) {
+            continue;
+        }
+        REPORTER_ASSERT(reporter, (decodeCount == 0) == lazy, "%d decodes", decodeCount.load());
+
+        sk_sp<SkImage> actual = render(*readPict);
+        REPORTER_ASSERT(reporter, actual && ToolUtils::equal_pixels(expected.get(), actual.get()));
+        REPORTER_ASSERT(reporter, decodeCount > 0);
+    }
+}
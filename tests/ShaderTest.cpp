@@ -30,6 +30,7 @@
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/effects/SkRuntimeEffect.h"
 #include "include/private/base/SkAssert.h"
+#include "src/shaders/SkPerlinNoiseShaderImpl.h"
 #include "tests/CtsEnforcement.h"
 #include "tests/Test.h"
 
@@ -104,6 +105,32 @@ DEF_TEST(ComposeShaderSingle, reporter) {
     canvas.drawRRect(rr, p);
 }
 
+// A baked, stitched noise tile should reproduce the noise shader within the first two tiles.
+DEF_TEST(PerlinNoiseBakedTile, reporter) {
+    const SkISize tileSize = {16, 12};
+    sk_sp<SkShader> noise = SkShaders::MakeTurbulence(0.1f, 0.2f, 4, 3.0f, &tileSize);
+    sk_sp<SkShader> baked = static_cast<SkPerlinNoiseShader*>(noise.get())->makeBakedTileShader();
+    REPORTER_ASSERT(reporter, baked);
+    REPORTER_ASSERT(reporter, !static_cast<SkPerlinNoiseShader*>(
+            SkShaders::MakeTurbulence(0.1f, 0.2f, 4, 3.0f).get())->makeBakedTileShader());
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(2 * tileSize.width(), 2 * tileSize.height());
+    actual.allocN32Pixels(2 * tileSize.width(), 2 * tileSize.height());
+    SkPaint paint;
+    paint.setShader(noise);
+    SkCanvas(expected).drawPaint(paint);
+    paint.setShader(baked);
+    SkCanvas(actual).drawPaint(paint);
+
+    for (int y = 0; y < expected.height(); ++y) {
+        for (int x = 0; x < expected.width(); ++x) {
+            REPORTER_ASSERT(reporter, expected.getColor(x, y) == actual.getColor(x, y),
+                            "mismatch at (%d, %d)", x, y);
+        }
+    }
+}
+
 // Tests that nested blending will render as expected.
 static void test_nested_blends(skiatest::Reporter* reporter, SkSurface* surface) {
     auto [redEffect, redError] = SkRuntimeEffect::MakeForShader(SkString(R"(
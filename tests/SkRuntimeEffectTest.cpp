@@ -6,6 +6,7 @@
  */
 
 #include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
 #include "include/core/SkCanvas.h"
@@ -14,6 +15,7 @@
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPixmap.h"
@@ -37,9 +39,12 @@
 #include "include/private/base/SkTArray.h"
 #include "include/sksl/SkSLDebugTrace.h"
 #include "include/sksl/SkSLVersion.h"
+#include "src/base/SkArenaAlloc.h"
 #include "src/base/SkStringView.h"
 #include "src/base/SkTLazy.h"
 #include "src/core/SkColorSpacePriv.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkRasterPipeline.h"
 #include "src/core/SkRuntimeEffectPriv.h"
 #include "src/gpu/KeyBuilder.h"
 #include "src/gpu/SkBackingFit.h"
@@ -51,16 +56,26 @@
 #include "src/gpu/ganesh/GrPixmap.h"
 #include "src/gpu/ganesh/SurfaceFillContext.h"
 #include "src/gpu/ganesh/effects/GrSkSLFP.h"
+#include "src/sksl/SkSLCompiler.h"
+#include "src/sksl/SkSLProgramKind.h"
+#include "src/sksl/SkSLProgramSettings.h"
 #include "src/sksl/SkSLString.h"
+#include "src/sksl/codegen/SkSLRasterPipelineBuilder.h"
+#include "src/sksl/codegen/SkSLRasterPipelineCodeGenerator.h"
+#include "src/sksl/codegen/SkSLRasterPipelineNativeCode.h"
+#include "src/sksl/ir/SkSLFunctionDeclaration.h"
+#include "src/sksl/ir/SkSLProgram.h"
 #include "tests/CtsEnforcement.h"
 #include "tests/Test.h"
 
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <utility>
 
@@ -712,6 +727,170 @@ static void test_RuntimeEffect_Shaders(skiatest::Reporter* r,
     effect.test(0xFF00FFFF);
 }
 
+// The cache and its limit are shared by the whole process, so this runs alone.
+DEF_SERIAL_TEST(SkRuntimeEffectCache, r) {
+    const int prevLimit = SkGraphics::SetRuntimeEffectCacheCountLimit(1024);
+
+    const SkString sksl("uniform half4 gColor;"
+                        "half4 main(float2 p) { return gColor; }  // SkRuntimeEffectCache");
+    SkRuntimeEffect::Options shared;
+    shared.useSharedCache = true;
+    sk_sp<SkRuntimeEffect> a = SkRuntimeEffect::MakeForShader(sksl, shared).effect;
+    sk_sp<SkRuntimeEffect> b = SkRuntimeEffect::MakeForShader(sksl, shared).effect;
+    REPORTER_ASSERT(r, a && a == b);
+
+    // Effects made without opting in are neither found in the cache nor added to it.
+    sk_sp<SkRuntimeEffect> unshared = SkRuntimeEffect::MakeForShader(sksl).effect;
+    REPORTER_ASSERT(r, unshared && unshared != a);
+    REPORTER_ASSERT(r, SkRuntimeEffect::MakeForShader(sksl).effect != unshared);
+
+    // The same SkSL with different options is a different effect.
+    SkRuntimeEffect::Options options = shared;
+    options.forceUnoptimized = true;
+    sk_sp<SkRuntimeEffect> c = SkRuntimeEffect::MakeForShader(sksl, options).effect;
+    REPORTER_ASSERT(r, c && c != a);
+
+    // Whitespace and comments don't change the program, so reformatted SkSL reuses the compiled
+    // program. The effect still reports the SkSL it was made from.
+    const SkString reformatted("uniform half4 gColor;  /* reformatted */\n"
+                               "half4 main(float2 p) {\n"
+                               "    return gColor;\n"
+                               "}\n");
+    sk_sp<SkRuntimeEffect> d = SkRuntimeEffect::MakeForShader(reformatted, shared).effect;
+    REPORTER_ASSERT(r, d && d != a);
+    REPORTER_ASSERT(r, &SkRuntimeEffectPriv::Program(*d) == &SkRuntimeEffectPriv::Program(*a));
+    REPORTER_ASSERT(r, SkRuntimeEffectPriv::Hash(*d) == SkRuntimeEffectPriv::Hash(*a));
+    REPORTER_ASSERT(r, d->source() == reformatted.c_str());
+    REPORTER_ASSERT(r, a->source() == sksl.c_str());
+    REPORTER_ASSERT(r, SkRuntimeEffect::MakeForShader(reformatted, shared).effect == d);
+
+    // ... but any change to the tokens does.
+    const SkString edited("uniform half4 gColor;"
+                          "half4 main(float2 p) { return gColor.bgra; }  // SkRuntimeEffectCache");
+    sk_sp<SkRuntimeEffect> e = SkRuntimeEffect::MakeForShader(edited, shared).effect;
+    REPORTER_ASSERT(r, e && e != a);
+
+    // The limit holds for the whole cache, not for each of its shards.
+    for (int limit : {1, 5, 16}) {
+        SkGraphics::SetRuntimeEffectCacheCountLimit(limit);
+        for (int i = 0; i < 40; ++i) {
+            SkString numbered = SkStringPrintf("half4 main(float2 p) { return half4(%d); }", i);
+            REPORTER_ASSERT(r, SkRuntimeEffect::MakeForShader(numbered, shared).effect);
+            REPORTER_ASSERT(r, SkRuntimeEffectPriv::GetCacheCountForTesting() <= limit);
+        }
+    }
+
+    // Only responds to keys for this test's SkSL; other tests may be creating effects too.
+    struct TestPersistentCache : public SkRuntimeEffect::PersistentCache {
+        static bool IsOurs(const SkData& key) {
+            return std::string_view(static_cast<const char*>(key.data()), key.size())
+                           .find("// SkRuntimeEffectPersistentCache") != std::string_view::npos;
+        }
+        sk_sp<SkData> load(const SkData& key) override {
+            if (!IsOurs(key)) {
+                return nullptr;
+            }
+            fLoads++;
+            return fData;
+        }
+        void store(const SkData& key, const SkData& data) override {
+            if (IsOurs(key)) {
+                fStores++;
+                fData = SkData::MakeWithCopy(data.data(), data.size());
+            }
+        }
+        sk_sp<SkData> fData;
+        int fLoads = 0;
+        int fStores = 0;
+    } persistentCache;
+
+    // With the in-memory cache disabled, every request for the effect goes to the persistent tier.
+    SkGraphics::SetRuntimeEffectCacheCountLimit(0);
+    REPORTER_ASSERT(r, SkRuntimeEffectPriv::GetCacheCountForTesting() == 0);
+    SkRuntimeEffect::PersistentCache* prevPersistentCache =
+            SkRuntimeEffect::SetPersistentCache(&persistentCache);
+
+    const SkString persistedSksl("uniform half4 gColor;"
+                                 "half4 helper() { return gColor; }"
+                                 "half4 main(float2 p) { return helper(); }"
+                                 "  // SkRuntimeEffectPersistentCache");
+    sk_sp<SkRuntimeEffect> compiled = SkRuntimeEffect::MakeForShader(persistedSksl).effect;
+    REPORTER_ASSERT(r, compiled);
+    REPORTER_ASSERT(r, persistentCache.fLoads == 1 && persistentCache.fStores == 1);
+
+    // The second effect is built from the stored program; a failure would fall back to the
+    // original SkSL and store again.
+    sk_sp<SkRuntimeEffect> loaded = SkRuntimeEffect::MakeForShader(persistedSksl).effect;
+    REPORTER_ASSERT(r, loaded && loaded != compiled);
+    REPORTER_ASSERT(r, persistentCache.fLoads == 2 && persistentCache.fStores == 1);
+    REPORTER_ASSERT(r, loaded->uniformSize() == compiled->uniformSize());
+    REPORTER_ASSERT(r, loaded->findUniform("gColor"));
+    // Both report the SkSL they were asked for, not the stored program text.
+    REPORTER_ASSERT(r, compiled->source() == persistedSksl.c_str());
+    REPORTER_ASSERT(r, loaded->source() == persistedSksl.c_str());
+
+    SkRuntimeEffect::SetPersistentCache(prevPersistentCache);
+    SkGraphics::SetRuntimeEffectCacheCountLimit(prevLimit);
+}
+
+// Slot arithmetic replaced by generated code must produce exactly what the pipeline stages do.
+DEF_TEST(SkRuntimeEffectNativeCode, r) {
+    const SkString sksl(R"(
+        half4 main(float2 p) {
+            float2 q = p * 0.03125 + float2(0.25, 0.5);
+            float a = min(q.x, q.y) / max(q.x + 1, 2);
+            float b = (q.x - q.y) * (q.y + 0.75) + a;
+            return half4(fract(a), fract(b), a * b, 1);
+        }
+    )");
+    SkRuntimeEffect::Options nativeOptions;
+    SkRuntimeEffectPriv::UseRPNativeCode(&nativeOptions);
+    sk_sp<SkRuntimeEffect> stagesEffect = SkRuntimeEffect::MakeForShader(sksl).effect;
+    sk_sp<SkRuntimeEffect> nativeEffect = SkRuntimeEffect::MakeForShader(sksl, nativeOptions).effect;
+    REPORTER_ASSERT(r, stagesEffect && nativeEffect && stagesEffect != nativeEffect);
+
+    SkBitmap stages, native;
+    stages.allocN32Pixels(64, 64);
+    native.allocN32Pixels(64, 64);
+
+    SkPaint paint;
+    paint.setShader(stagesEffect->makeShader(/*uniforms=*/nullptr, /*children=*/{}));
+    SkCanvas(stages).drawPaint(paint);
+    paint.setShader(nativeEffect->makeShader(/*uniforms=*/nullptr, /*children=*/{}));
+    SkCanvas(native).drawPaint(paint);
+
+    REPORTER_ASSERT(r, !memcmp(stages.getPixels(), native.getPixels(),
+                               stages.computeByteSize()));
+
+    // Where native code is supported, some of the stages must actually have been replaced.
+    SkSL::Compiler compiler;
+    std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+            SkSL::ProgramKind::kRuntimeShader, std::string(sksl.c_str()), SkSL::ProgramSettings{});
+    REPORTER_ASSERT(r, program);
+    const SkSL::FunctionDeclaration* main = program->getFunction("main");
+    std::unique_ptr<SkSL::RP::Program> rasterProg =
+            SkSL::MakeRasterPipelineProgram(*program, *main->definition());
+    REPORTER_ASSERT(r, rasterProg);
+
+    int numStages[2];
+    for (bool useNativeCode : {false, true}) {
+        SkSL::RP::AppendStagesOptions options;
+        options.useNativeCode = useNativeCode;
+        SkArenaAlloc alloc(/*firstHeapAllocation=*/1000);
+        SkRasterPipeline pipeline(&alloc);
+        REPORTER_ASSERT(r, rasterProg->appendStages(&pipeline, &alloc, /*callbacks=*/nullptr,
+                                                    /*uniforms=*/{}, options));
+        numStages[useNativeCode] = pipeline.getNumStages();
+    }
+    if (SkSL::RP::NativeCodeAssembler::IsSupported(SkOpts::raster_pipeline_highp_stride)) {
+        REPORTER_ASSERT(r, numStages[1] < numStages[0], "%d stages >= %d stages",
+                        numStages[1], numStages[0]);
+    } else {
+        REPORTER_ASSERT(r, numStages[1] == numStages[0], "%d stages != %d stages",
+                        numStages[1], numStages[0]);
+    }
+}
+
 DEF_TEST(SkRuntimeEffectSimple, r) {
     test_RuntimeEffect_Shaders(r, /*grContext=*/nullptr, /*graphite=*/nullptr);
 }
@@ -6,12 +6,16 @@
  */
 
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkString.h"
 #include "src/base/SkNoDestructor.h"
 #include "src/core/SkOSFile.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTHash.h"
+#include "src/sksl/SkSLBatchCompiler.h"
 #include "src/sksl/SkSLCompiler.h"
+#include "src/sksl/SkSLModuleLoader.h"
 #include "src/sksl/SkSLProgramKind.h"
 #include "src/sksl/SkSLProgramSettings.h"
 #include "src/sksl/SkSLUtil.h"
@@ -20,6 +24,7 @@
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <memory>
@@ -221,3 +226,98 @@ DEF_TEST(SkSLRuntimeBlenderErrorTest, r) {
         test_expect_fail(r, path, SkSL::ProgramKind::kRuntimeBlender);
     });
 }
+
+DEF_TEST(SkSLBatchCompileErrorTest, r) {
+    // Failures in a batch are reported against the job that caused them, and don't disturb the
+    // programs compiled around them on the same worker.
+    std::vector<SkSL::BatchCompileJob> jobs;
+    for (int i = 0; i < 12; ++i) {
+        const char* src = (i % 3 == 1) ? "half4 main(float2 xy) { return undeclared; }"
+                                       : "half4 main(float2 xy) { return half4(xy.x); }";
+        jobs.push_back({SkSL::ProgramKind::kRuntimeShader, src, SkSL::ProgramSettings{}});
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(3);
+    std::vector<SkSL::BatchCompileResult> results =
+            SkSL::CompileBatch(jobs, executor.get(), /*parallelism=*/3);
+
+    REPORTER_ASSERT(r, results.size() == jobs.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i % 3 == 1) {
+            REPORTER_ASSERT(r, !results[i].fProgram);
+            REPORTER_ASSERT(r, results[i].fErrorText.find("undeclared") != std::string::npos,
+                            "%s", results[i].fErrorText.c_str());
+        } else {
+            REPORTER_ASSERT(r, results[i].fProgram);
+            REPORTER_ASSERT(r, results[i].fErrorText.empty(), "%s", results[i].fErrorText.c_str());
+        }
+    }
+}
+
+DEF_TEST(SkSLBatchCompileFromExecutorTask, r) {
+    // A batch can be compiled from a task on the executor it uses, alongside other tasks which
+    // compile SkSL. Waiting on the executor runs those tasks on the waiting thread, so neither
+    // CompileBatch nor the module preload may hold the ModuleLoader while they wait.
+    std::vector<SkSL::BatchCompileJob> jobs;
+    for (int i = 0; i < 4; ++i) {
+        jobs.push_back({SkSL::ProgramKind::kRuntimeShader,
+                        "half4 main(float2 xy) { return half4(xy.x); }", SkSL::ProgramSettings{}});
+        jobs.push_back({SkSL::ProgramKind::kFragment,
+                        "void main() { sk_FragColor = half4(1); }", SkSL::ProgramSettings{}});
+        jobs.push_back({SkSL::ProgramKind::kVertex,
+                        "void main() { sk_Position = float4(0); }", SkSL::ProgramSettings{}});
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    std::vector<SkSL::BatchCompileResult> results;
+    std::atomic<int> otherPrograms{0};
+
+    SkTaskGroup group(*executor);
+    group.add([&] { results = SkSL::CompileBatch(jobs, executor.get(), /*parallelism=*/2); });
+    for (int i = 0; i < 4; ++i) {
+        group.add([&] {
+            SkSL::Compiler compiler;
+            if (compiler.convertProgram(SkSL::ProgramKind::kRuntimeColorFilter,
+                                        "half4 main(half4 color) { return color.bgra; }",
+                                        SkSL::ProgramSettings{})) {
+                ++otherPrograms;
+            }
+        });
+    }
+    group.wait();
+
+    REPORTER_ASSERT(r, results.size() == jobs.size());
+    for (const SkSL::BatchCompileResult& result : results) {
+        REPORTER_ASSERT(r, result.fProgram, "%s", result.fErrorText.c_str());
+    }
+    REPORTER_ASSERT(r, otherPrograms == 4);
+}
+
+DEF_TEST(SkSLPreloadModulesWideBatch, r) {
+    // Once the public, fragment and vertex modules are loaded, every remaining module has a parent
+    // available, so the next preload compiles them all in a single batch, spanning generations.
+    static constexpr SkSL::ProgramKind kFirstKinds[] = {
+            SkSL::ProgramKind::kFragment,
+            SkSL::ProgramKind::kVertex,
+            SkSL::ProgramKind::kRuntimeShader,
+    };
+    static constexpr SkSL::ProgramKind kAllKinds[] = {
+            SkSL::ProgramKind::kCompute,
+            SkSL::ProgramKind::kPrivateRuntimeShader,
+            SkSL::ProgramKind::kGraphiteFragment,
+            SkSL::ProgramKind::kGraphiteFragmentES2,
+            SkSL::ProgramKind::kGraphiteVertex,
+            SkSL::ProgramKind::kGraphiteVertexES2,
+    };
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    SkSL::ModuleLoader::PreloadModules(kFirstKinds, executor.get());
+    SkSL::ModuleLoader::PreloadModules(kAllKinds, executor.get());
+
+    SkSL::Compiler compiler;
+    REPORTER_ASSERT(r, compiler.convertProgram(SkSL::ProgramKind::kCompute,
+                                               "layout(local_size_x = 16) in; void main() {}",
+                                               SkSL::ProgramSettings{}),
+                    "%s", compiler.errorText().c_str());
+    REPORTER_ASSERT(r, compiler.convertProgram(SkSL::ProgramKind::kPrivateRuntimeShader,
+                                               "half4 main(float2 xy) { return half4(xy.x); }",
+                                               SkSL::ProgramSettings{}),
+                    "%s", compiler.errorText().c_str());
+}
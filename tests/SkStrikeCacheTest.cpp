@@ -12,14 +12,21 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypeface.h"
+#include "src/core/SkOSFile.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrike.h"  // IWYU pragma: keep
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <cstdio>
+#include <optional>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -61,3 +68,175 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+static int count_glyph_images(const SkStrike& strike) {
+    int count = 0;
+    strike.forEachGlyph([&](const SkGlyph& glyph) {
+        count += glyph.setImageHasBeenCalled() ? 1 : 0;
+    });
+    return count;
+}
+
+DEF_TEST(SkStrikeDiskCache, reporter) {
+    static constexpr char kBuildID[] = "SkStrikeDiskCache test";
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "strike_disk_cache");
+    std::remove(path.c_str());
+
+    auto makeStrikeSpec = []() -> std::optional<SkStrikeSpec> {
+        // Each call makes a new typeface, with its own ID, like another process would.
+        sk_sp<SkTypeface> typeface =
+                ToolUtils::CreateTypefaceFromResource("fonts/Roboto-Regular.ttf");
+        if (!typeface) {
+            return std::nullopt;
+        }
+        SkFont font{typeface, 20};
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        return SkStrikeSpec::MakeMask(font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                      SkScalerContextFlags::kNone, SkMatrix::I());
+    };
+
+    std::optional<SkStrikeSpec> strikeSpec = makeStrikeSpec();
+    if (!strikeSpec) {
+        return;
+    }
+    std::vector<SkPackedGlyphID> glyphIDs;
+    for (SkGlyphID id = 1; id < 64; ++id) {
+        glyphIDs.emplace_back(id);
+    }
+    std::vector<const SkGlyph*> glyphs(glyphIDs.size());
+
+    // Rasterize some glyphs and store them.
+    size_t storedSize;
+    {
+        sk_sp<SkStrikeDiskCache> diskCache =
+                SkStrikeDiskCache::Open(path.c_str(), 1 << 20, kBuildID);
+        REPORTER_ASSERT(reporter, diskCache);
+        if (!diskCache) {
+            return;
+        }
+        SkStrikeCache cache;
+        sk_sp<SkStrike> strike = strikeSpec->findOrCreateStrike(&cache);
+        strike->prepareImages(glyphIDs, glyphs.data());
+        diskCache->storeAll(cache);
+        diskCache->refresh();
+        storedSize = diskCache->sizeInBytesForTesting();
+        REPORTER_ASSERT(reporter, storedSize > 1024);
+
+        // Nothing new to store.
+        diskCache->storeAll(cache);
+        diskCache->refresh();
+        REPORTER_ASSERT(reporter, diskCache->sizeInBytesForTesting() == storedSize);
+    }
+
+    // A fresh cache with a new typeface for the same font gets the glyphs from the file.
+    {
+        sk_sp<SkStrikeDiskCache> diskCache =
+                SkStrikeDiskCache::Open(path.c_str(), 1 << 20, kBuildID);
+        SkStrikeCache cache;
+        cache.setDiskCache(diskCache);
+        std::optional<SkStrikeSpec> otherSpec = makeStrikeSpec();
+        sk_sp<SkStrike> strike = otherSpec->findOrCreateStrike(&cache);
+        REPORTER_ASSERT(reporter, count_glyph_images(*strike) == SkToInt(glyphIDs.size()));
+
+        // The loaded glyphs are not stored again.
+        diskCache->storeAll(cache);
+        diskCache->refresh();
+        REPORTER_ASSERT(reporter, diskCache->sizeInBytesForTesting() == storedSize);
+    }
+
+    // A damaged record, as a torn append leaves, is dropped when the file is next mapped, so that
+    // records appended after it are read again.
+    {
+        FILE* file = sk_fopen(path.c_str(), kAppend_SkFILE_Flag);
+        REPORTER_ASSERT(reporter, file);
+        if (!file) {
+            return;
+        }
+        const char garbage[] = "not a glyph record";
+        sk_fwrite(garbage, sizeof(garbage), file);
+        sk_fclose(file);
+
+        sk_sp<SkStrikeDiskCache> diskCache =
+                SkStrikeDiskCache::Open(path.c_str(), 1 << 20, kBuildID);
+        REPORTER_ASSERT(reporter, diskCache->sizeInBytesForTesting() == storedSize);
+
+        SkStrikeCache cache;
+        std::optional<SkStrikeSpec> otherSpec = makeStrikeSpec();
+        SkFont otherFont = SkFont(sk_ref_sp(&otherSpec->typeface()), 30);
+        SkStrikeSpec otherSizeSpec = SkStrikeSpec::MakeMask(
+                otherFont, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I());
+        sk_sp<SkStrike> strike = otherSizeSpec.findOrCreateStrike(&cache);
+        strike->prepareImages(glyphIDs, glyphs.data());
+        diskCache->store(*strike);
+        diskCache->refresh();
+
+        SkStrikeCache loadingCache;
+        loadingCache.setDiskCache(diskCache);
+        sk_sp<SkStrike> loaded = otherSizeSpec.findOrCreateStrike(&loadingCache);
+        REPORTER_ASSERT(reporter, count_glyph_images(*loaded) == SkToInt(glyphIDs.size()));
+    }
+
+    // A record that runs past the end of the file is one another process is still appending. It
+    // ends the data, but is not taken for damage: rewriting the file would lose it.
+    {
+        FILE* file = sk_fopen(path.c_str(), kAppend_SkFILE_Flag);
+        REPORTER_ASSERT(reporter, file);
+        if (!file) {
+            return;
+        }
+        const uint32_t unfinished[] = {SkSetFourByteTag('s', 'k', 'g', 'r'), 4096, 0, 0, 0, 0};
+        sk_fwrite(unfinished, sizeof(unfinished), file);
+        const size_t fileSize = sk_fgetsize(file);
+        sk_fclose(file);
+
+        sk_sp<SkStrikeDiskCache> diskCache =
+                SkStrikeDiskCache::Open(path.c_str(), 1 << 20, kBuildID);
+        REPORTER_ASSERT(reporter, diskCache->sizeInBytesForTesting() == fileSize);
+
+        SkStrikeCache cache;
+        cache.setDiskCache(diskCache);
+        std::optional<SkStrikeSpec> otherSpec = makeStrikeSpec();
+        sk_sp<SkStrike> strike = otherSpec->findOrCreateStrike(&cache);
+        REPORTER_ASSERT(reporter, count_glyph_images(*strike) == SkToInt(glyphIDs.size()));
+    }
+
+    // A file written by another build is discarded rather than served.
+    {
+        sk_sp<SkStrikeDiskCache> diskCache =
+                SkStrikeDiskCache::Open(path.c_str(), 1 << 20, "another build");
+        SkStrikeCache cache;
+        cache.setDiskCache(diskCache);
+        std::optional<SkStrikeSpec> otherSpec = makeStrikeSpec();
+        sk_sp<SkStrike> strike = otherSpec->findOrCreateStrike(&cache);
+        REPORTER_ASSERT(reporter, count_glyph_images(*strike) == 0);
+        REPORTER_ASSERT(reporter, diskCache->sizeInBytesForTesting() < 1024);
+
+        strike->prepareImages(glyphIDs, glyphs.data());
+        diskCache->storeAll(cache);
+        diskCache->refresh();
+        REPORTER_ASSERT(reporter, diskCache->sizeInBytesForTesting() == storedSize);
+    }
+
+    // Going over the size limit evicts the records that don't fit in half of it.
+    {
+        sk_sp<SkStrikeDiskCache> diskCache =
+                SkStrikeDiskCache::Open(path.c_str(), storedSize, kBuildID);
+        SkStrikeCache cache;
+        std::optional<SkStrikeSpec> otherSpec = makeStrikeSpec();
+        SkFont bigFont = SkFont(sk_ref_sp(&otherSpec->typeface()), 40);
+        SkStrikeSpec bigSpec = SkStrikeSpec::MakeMask(
+                bigFont, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I());
+        sk_sp<SkStrike> strike = bigSpec.findOrCreateStrike(&cache);
+        strike->prepareImages(glyphIDs, glyphs.data());
+        diskCache->store(*strike);
+        REPORTER_ASSERT(reporter, diskCache->sizeInBytesForTesting() <= storedSize / 2);
+    }
+
+    std::remove(path.c_str());
+}
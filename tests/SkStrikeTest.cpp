@@ -43,6 +43,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
 #include <memory>
@@ -292,3 +293,58 @@ DEF_TEST(SkStrike_FlattenByType, reporter) {
     REPORTER_ASSERT(reporter, dstDrawableGlyph->setDrawableHasBeenCalled());
     REPORTER_ASSERT(reporter, dstDrawableGlyph->drawable() != nullptr);
 }
+
+DEF_TEST(SkStrike_Prerasterize, reporter) {
+    sk_sp<SkTypeface> typeface = ToolUtils::CreatePortableTypeface("serif", SkFontStyle());
+    SkFont font{typeface, 24};
+    font.setEdging(SkFont::Edging::kAntiAlias);
+
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (SkUnichar c = ' '; c < 'z'; c++) {
+        packedIDs.emplace_back(font.unicharToGlyph(c));
+    }
+
+    SkPaint defaultPaint;
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    SkStrikeCache strikeCache;
+    sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&strikeCache);
+
+    // Some glyphs already have metrics, which must be kept.
+    SkGlyphID someIDs[] = {packedIDs[10].glyphID(), packedIDs[20].glyphID()};
+    const SkGlyph* someGlyphs[std::size(someIDs)];
+    strike->metrics(someIDs, someGlyphs);
+
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+    const size_t memoryBefore = strikeCache.getTotalMemoryUsed();
+    strike->prerasterize(packedIDs, executor.get(), /*includePaths=*/true);
+
+    std::unique_ptr<SkScalerContext> scaler = strikeSpec.createScalerContext();
+    SkArenaAlloc alloc{1024};
+    size_t imageBytes = 0;
+    for (SkPackedGlyphID packedID : packedIDs) {
+        SkGlyph* glyph = SkStrikeTestingPeer::GetGlyph(strike.get(), packedID);
+        REPORTER_ASSERT(reporter, glyph->setImageHasBeenCalled());
+        REPORTER_ASSERT(reporter, glyph->setPathHasBeenCalled());
+        if (glyph->image() != nullptr) {
+            imageBytes += glyph->imageSize();
+        }
+
+        SkGlyph expected = scaler->makeGlyph(packedID, &alloc);
+        expected.setImage(&alloc, scaler.get());
+        REPORTER_ASSERT(reporter, glyph->rect() == expected.rect());
+        if (expected.image() != nullptr) {
+            REPORTER_ASSERT(reporter, glyph->image() != nullptr);
+            REPORTER_ASSERT(reporter,
+                            !memcmp(glyph->image(), expected.image(), glyph->imageSize()));
+        }
+    }
+    for (size_t i = 0; i < std::size(someIDs); ++i) {
+        const SkGlyph* glyph =
+                SkStrikeTestingPeer::GetGlyph(strike.get(), SkPackedGlyphID{someIDs[i]});
+        REPORTER_ASSERT(reporter, glyph == someGlyphs[i]);
+    }
+    // The cache accounts for everything the strike kept.
+    REPORTER_ASSERT(reporter, strikeCache.getTotalMemoryUsed() - memoryBefore >= imageBytes);
+}
@@ -5,10 +5,13 @@
 #include "src/base/SkUTF.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstddef>
 #include <cstring>
+#include <string>
+#include <vector>
 
 DEF_TEST(SkUTF_UTF16, reporter) {
     // Test non-basic-multilingual-plane unicode.
@@ -146,3 +149,45 @@ DEF_TEST(SkUTF_NextUTF8_ToUTF8, r) {
 #undef LEADING_THREE_BYTE
 #undef LEADING_FOUR_BYTE
 #undef INVALID_BYTE
+
+DEF_TEST(SkUTF_LongText, r) {
+    // Long enough runs of ASCII to go through the bulk paths, broken up at every offset by
+    // multi-byte characters.
+    for (size_t prefix = 0; prefix < 40; ++prefix) {
+        std::string utf8(prefix, 'a');
+        utf8 += "\xC3\x83" "bcdefghijklmnopqrstuvwxyz" "\xF0\x90\x8C\xB0" "0123456789ABCDEF";
+
+        int count = SkUTF::CountUTF8(utf8.data(), utf8.size());
+        REPORTER_ASSERT(r, count == (int)prefix + 1 + 25 + 1 + 16);
+
+        int utf16Length = SkUTF::UTF8ToUTF16(nullptr, 0, utf8.data(), utf8.size());
+        REPORTER_ASSERT(r, utf16Length == count + 1);
+        std::vector<uint16_t> utf16(utf16Length);
+        REPORTER_ASSERT(r, utf16Length ==
+                           SkUTF::UTF8ToUTF16(utf16.data(), utf16Length, utf8.data(), utf8.size()));
+        REPORTER_ASSERT(r, utf16[prefix] == 0xC3);
+        REPORTER_ASSERT(r, utf16[utf16Length - 1] == 'F');
+        REPORTER_ASSERT(r, SkUTF::CountUTF16(utf16.data(), utf16Length * 2) == count);
+
+        // A short destination is filled as far as it goes.
+        std::vector<uint16_t> shortUtf16(prefix / 2 + 1, 0);
+        REPORTER_ASSERT(r, utf16Length == SkUTF::UTF8ToUTF16(shortUtf16.data(), shortUtf16.size(),
+                                                             utf8.data(), utf8.size()));
+        REPORTER_ASSERT(r, std::equal(shortUtf16.begin(), shortUtf16.end(), utf16.begin()));
+
+        std::string roundTrip(utf8.size(), '\0');
+        REPORTER_ASSERT(r, (int)utf8.size() == SkUTF::UTF16ToUTF8(roundTrip.data(),
+                                                                  roundTrip.size(),
+                                                                  utf16.data(), utf16Length));
+        REPORTER_ASSERT(r, roundTrip == utf8);
+
+        std::string invalid = utf8;
+        invalid[prefix] = '\xFC';
+        REPORTER_ASSERT(r, SkUTF::CountUTF8(invalid.data(), invalid.size()) == -1);
+        REPORTER_ASSERT(r, SkUTF::UTF8ToUTF16(nullptr, 0, invalid.data(), invalid.size()) == -1);
+
+        std::vector<uint16_t> loneSurrogate = utf16;
+        loneSurrogate[prefix] = 0xDC00;
+        REPORTER_ASSERT(r, SkUTF::CountUTF16(loneSurrogate.data(), utf16Length * 2) == -1);
+    }
+}
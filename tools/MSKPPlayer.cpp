@@ -385,6 +385,7 @@ private:
 
 std::unique_ptr<MSKPPlayer> MSKPPlayer::Make(SkStreamSeekable* stream) {
     auto deserialContext = std::make_unique<SkSharingDeserialContext>();
+    deserialContext->fDecodeLazily = true;
     SkDeserialProcs procs;
     procs.fImageProc = SkSharingDeserialContext::deserializeImage;
     procs.fImageCtx = deserialContext.get();
@@ -7,6 +7,7 @@
 
 #include "tools/SkSharingProc.h"
 
+#include "include/codec/SkCodec.h"
 #include "include/codec/SkPngDecoder.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
@@ -88,6 +89,11 @@ sk_sp<SkImage> SkSharingDeserialContext::deserializeImage(
         SkDebugf("Cannot deserialize image - might not be a PNG.\n");
         return nullptr;
     }
+    if (context->fDecodeLazily) {
+        sk_sp<SkImage> image = SkCodecs::DeferredImage(std::move(codec), kPremul_SkAlphaType);
+        context->fImages.push_back(image);
+        return image;
+    }
     SkImageInfo info = codec->getInfo().makeAlphaType(kPremul_SkAlphaType);
     auto [image, result] = codec->getImage(info);
     if (result != SkCodec::Result::kSuccess) {
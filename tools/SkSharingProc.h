@@ -68,6 +68,10 @@ struct SkSharingDeserialContext {
     // Subsequent occurrences of an image refer to it by it's index in this list.
     std::vector<sk_sp<SkImage>> fImages;
 
+    // If true, images stay encoded until they are first drawn, rather than being decoded as the
+    // file is read. This makes large files much faster to open.
+    bool fDecodeLazily = false;
+
     // A deserial proc that can interpret id's in place of images as references to previous images.
     // Can also deserialize a SKP where all images are inlined (it's backwards compatible)
     static sk_sp<SkImage> deserializeImage(const void* data, size_t length, void* ctx);
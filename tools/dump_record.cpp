@@ -25,6 +25,8 @@
 static DEFINE_string2(skps, r, "", ".SKPs to dump.");
 static DEFINE_string(match, "", "The usual filters on file names to dump.");
 static DEFINE_bool2(optimize, O, false, "Run SkRecordOptimize before dumping.");
+static DEFINE_bool(extendedOpts, false,
+                   "Run SkRecordOptimizeExtended before dumping, and print what it did.");
 static DEFINE_int(tile, 1000000000, "Simulated tile size.");
 static DEFINE_bool(timeWithCommand, false,
                    "If true, print time next to command, else in first column.");
@@ -168,7 +170,12 @@ int main(int argc, char** argv) {
         SkRecorder rec(&record, w, h);
         src->playback(&rec);
 
-        if (FLAGS_optimize) {
+        if (FLAGS_extendedOpts) {
+            SkRecordOptimizeStats stats;
+            SkRecordOptimizeExtended(&record, SkRect::MakeIWH(w, h), &stats);
+            printf("occluded draws %d, merged rects %d, no-op clips %d, no-op matrices %d\n",
+                   stats.fOccludedDraws, stats.fMergedRects, stats.fNoopClips, stats.fNoopMatrices);
+        } else if (FLAGS_optimize) {
             SkRecordOptimize(&record);
         }
 
@@ -178,7 +185,8 @@ int main(int argc, char** argv) {
         canvas.clipRect(SkRect::MakeWH(SkIntToScalar(FLAGS_tile),
                                        SkIntToScalar(FLAGS_tile)));
 
-        printf("%s %s\n", FLAGS_optimize ? "optimized" : "not-optimized", FLAGS_skps[i]);
+        printf("%s %s\n", FLAGS_optimize || FLAGS_extendedOpts ? "optimized" : "not-optimized",
+               FLAGS_skps[i]);
 
         Dumper dumper(&canvas, record.count());
         for (int j = 0; j < record.count(); j++) {
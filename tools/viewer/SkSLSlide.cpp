@@ -96,6 +96,7 @@ void SkSLSlide::load(SkScalar winWidth, SkScalar winHeight) {
 
 void SkSLSlide::unload() {
     fEffect.reset();
+    fCodeIsDirty = true;
     fInputs.reset();
     fChildren.clear();
     fShaders.clear();
@@ -112,6 +113,10 @@ bool SkSLSlide::rebuild() {
     }
     sksl.append(fSkSL);
 
+    // Compile each edit once. If it fails we keep drawing the last good effect, rather than
+    // recompiling the same broken code every frame until the next keystroke.
+    fCodeIsDirty = false;
+
     // It shouldn't happen, but it's possible to assert in the compiler, especially mid-edit.
     // To guard against losing your work, write out the shader to a backup file, then remove it
     // when we compile successfully.
@@ -121,7 +126,10 @@ bool SkSLSlide::rebuild() {
         fwrite(fSkSL.c_str(), 1, fSkSL.size(), backup);
         fclose(backup);
     }
-    auto [effect, errorText] = SkRuntimeEffect::MakeForShader(sksl);
+    // Through the shared cache, edits that only touch whitespace or comments skip the compiler.
+    SkRuntimeEffect::Options options;
+    options.useSharedCache = true;
+    auto [effect, errorText] = SkRuntimeEffect::MakeForShader(sksl, options);
     if (backup) {
         std::remove(kBackupFile);
     }
@@ -139,7 +147,6 @@ bool SkSLSlide::rebuild() {
     fChildren.resize_back(effect->children().size());
 
     fEffect = effect;
-    fCodeIsDirty = false;
     return true;
 }
 
@@ -160,7 +167,7 @@ void SkSLSlide::draw(SkCanvas* canvas) {
         fCodeIsDirty = true;
     }
 
-    if (fCodeIsDirty || !fEffect) {
+    if (fCodeIsDirty) {
         this->rebuild();
     }
 